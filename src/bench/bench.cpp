@@ -0,0 +1,140 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "util.h"
+#include "json/json_spirit_value.h"
+#include "json/json_spirit_writer_template.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+
+using namespace json_spirit;
+
+static int64_t GetNanos() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+CBenchState::CBenchState(uint64_t ullIterations) :
+		m_ullIterations(ullIterations), m_ullCount(0), m_llStart(0), m_llElapsed(0) {
+}
+
+bool CBenchState::KeepRunning() {
+	if (m_ullCount == 0) {
+		m_llStart = GetNanos();
+	}
+	if (m_ullCount < m_ullIterations) {
+		++m_ullCount;
+		return true;
+	}
+	m_llElapsed = GetNanos() - m_llStart;
+	return false;
+}
+
+double ST_BenchResult::Percentile(double dPercent) const {
+	if (vdNsPerOp.empty()) {
+		return 0.0;
+	}
+	// nearest rank
+	size_t unRank = (size_t) (dPercent / 100.0 * vdNsPerOp.size() + 0.5);
+	unRank = max<size_t>(unRank, 1);
+	return vdNsPerOp[min(unRank, vdNsPerOp.size()) - 1];
+}
+
+double ST_BenchResult::Mean() const {
+	if (vdNsPerOp.empty()) {
+		return 0.0;
+	}
+	return std::accumulate(vdNsPerOp.begin(), vdNsPerOp.end(), 0.0) / vdNsPerOp.size();
+}
+
+CBenchRunner::CBenchRunner(const string &strName, BenchFunction func, uint64_t ullIterations) {
+	ST_Bench tBench;
+	tBench.func = func;
+	tBench.ullIterations = ullIterations;
+	Benchmarks().insert(make_pair(strName, tBench));
+}
+
+map<string, CBenchRunner::ST_Bench> &CBenchRunner::Benchmarks() {
+	static map<string, ST_Bench> s_mapBenchmarks;
+	return s_mapBenchmarks;
+}
+
+void CBenchRunner::List() {
+	for (const auto &item : Benchmarks()) {
+		cout << item.first << "\n";
+	}
+}
+
+ST_BenchResult CBenchRunner::Run(const string &strName, const ST_Bench &tBench, const ST_BenchOptions &tOptions) {
+	ST_BenchResult tResult;
+	tResult.strName = strName;
+	tResult.ullIterations = max<uint64_t>(1, (uint64_t) (tBench.ullIterations * tOptions.dScale));
+	for (int i = 0; i < tOptions.nWarmup; ++i) {
+		CBenchState cState(tResult.ullIterations);
+		tBench.func(cState);
+	}
+	for (int i = 0; i < tOptions.nSamples; ++i) {
+		CBenchState cState(tResult.ullIterations);
+		tBench.func(cState);
+		tResult.vdNsPerOp.push_back((double) cState.GetElapsed() / tResult.ullIterations);
+	}
+	sort(tResult.vdNsPerOp.begin(), tResult.vdNsPerOp.end());
+
+	return tResult;
+}
+
+bool CBenchRunner::WriteJson(const vector<ST_BenchResult> &vtResults, const string &strFile) {
+	Array arrBenchmarks;
+	for (const auto &tResult : vtResults) {
+		Object obj;
+		obj.push_back(Pair("name", tResult.strName));
+		obj.push_back(Pair("iterations", (int64_t) tResult.ullIterations));
+		obj.push_back(Pair("samples", (int) tResult.vdNsPerOp.size()));
+		obj.push_back(Pair("min_ns", tResult.vdNsPerOp.front()));
+		obj.push_back(Pair("p50_ns", tResult.Percentile(50)));
+		obj.push_back(Pair("p90_ns", tResult.Percentile(90)));
+		obj.push_back(Pair("p99_ns", tResult.Percentile(99)));
+		obj.push_back(Pair("max_ns", tResult.vdNsPerOp.back()));
+		obj.push_back(Pair("mean_ns", tResult.Mean()));
+		arrBenchmarks.push_back(obj);
+	}
+	Object objReport;
+	objReport.push_back(Pair("benchmarks", arrBenchmarks));
+
+	ofstream cFile(strFile.c_str(), ios::out | ios::trunc);
+	if (!cFile) {
+		cerr << "Cannot open " << strFile << "\n";
+		return false;
+	}
+	cFile << write_string(Value(objReport), true) << "\n";
+	return cFile.good();
+}
+
+bool CBenchRunner::RunAll(const ST_BenchOptions &tOptions) {
+	vector<ST_BenchResult> vtResults;
+	cout << strprintf("%-32s %12s %14s %14s %14s %14s\n", "# benchmark", "iterations", "min ns/op", "p50 ns/op",
+			"p90 ns/op", "p99 ns/op");
+	for (const auto &item : Benchmarks()) {
+		if (!tOptions.strFilter.empty() && item.first.find(tOptions.strFilter) == string::npos) {
+			continue;
+		}
+		ST_BenchResult tResult = Run(item.first, item.second, tOptions);
+		if (tResult.vdNsPerOp.empty()) {
+			continue;
+		}
+		cout << strprintf("%-32s %12u %14.1f %14.1f %14.1f %14.1f\n", tResult.strName, tResult.ullIterations,
+				tResult.vdNsPerOp.front(), tResult.Percentile(50), tResult.Percentile(90), tResult.Percentile(99));
+		vtResults.push_back(tResult);
+	}
+	if (!tOptions.strOutput.empty()) {
+		return WriteJson(vtResults, tOptions.strOutput);
+	}
+	return true;
+}
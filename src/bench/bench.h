@@ -0,0 +1,90 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DACRS_BENCH_BENCH_H_
+#define DACRS_BENCH_BENCH_H_
+
+#include <stdint.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Handed to a benchmark, which prepares its data first and then runs the code under test in a
+ *     while (cState.KeepRunning()) { ... }
+ * loop. Only the loop is timed, from the first KeepRunning() call to the one returning false.
+ */
+class CBenchState {
+ public:
+	explicit CBenchState(uint64_t ullIterations);
+
+	bool KeepRunning();
+
+	uint64_t GetIterations() const {
+		return m_ullIterations;
+	}
+	// nanoseconds spent in the loop
+	int64_t GetElapsed() const {
+		return m_llElapsed;
+	}
+
+ private:
+	uint64_t m_ullIterations;
+	uint64_t m_ullCount;
+	int64_t m_llStart;
+	int64_t m_llElapsed;
+};
+
+typedef std::function<void(CBenchState &)> BenchFunction;
+
+struct ST_BenchOptions {
+	ST_BenchOptions() :
+			nWarmup(1), nSamples(10), dScale(1.0) {
+	}
+
+	string strFilter; 		// only run benchmarks whose name contains it
+	int nWarmup; 			// untimed runs before the samples
+	int nSamples; 			// timed runs the percentiles are taken over
+	double dScale; 			// multiplies the iterations of every benchmark
+	string strOutput; 		// file the JSON report is written to, none if empty
+};
+
+struct ST_BenchResult {
+	string strName;
+	uint64_t ullIterations; 		// per sample
+	vector<double> vdNsPerOp; 		// one per sample, sorted
+
+	double Percentile(double dPercent) const;
+	double Mean() const;
+};
+
+/**
+ * Registry of the benchmarks, filled by the BENCHMARK macro from static initializers.
+ */
+class CBenchRunner {
+ public:
+	CBenchRunner(const string &strName, BenchFunction func, uint64_t ullIterations);
+
+	static bool RunAll(const ST_BenchOptions &tOptions);
+	static void List();
+
+ private:
+	struct ST_Bench {
+		BenchFunction func;
+		uint64_t ullIterations;
+	};
+
+	static map<string, ST_Bench> &Benchmarks();
+	static ST_BenchResult Run(const string &strName, const ST_Bench &tBench, const ST_BenchOptions &tOptions);
+	static bool WriteJson(const vector<ST_BenchResult> &vtResults, const string &strFile);
+};
+
+// Register function n, whose timed loop runs `iterations` times per sample
+#define BENCHMARK(n, iterations) \
+	static CBenchRunner g_cBench_##n(#n, n, iterations);
+
+#endif // DACRS_BENCH_BENCH_H_
@@ -0,0 +1,56 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "chainparams.h"
+#include "key.h"
+#include "util.h"
+
+#include <iostream>
+
+#include <boost/filesystem.hpp>
+
+static void PrintUsage() {
+	cout << "Usage: bench_dacrs [options]\n\n"
+			<< "Options:\n"
+			<< "  -?                     This help message\n"
+			<< "  -list                  List the benchmarks and exit\n"
+			<< "  -filter=<text>         Only run benchmarks whose name contains <text>\n"
+			<< "  -warmup=<n>            Untimed runs of each benchmark before sampling (default: 1)\n"
+			<< "  -samples=<n>           Timed runs of each benchmark (default: 10)\n"
+			<< "  -scale=<f>             Multiply the iterations of every benchmark by <f> (default: 1.0)\n"
+			<< "  -json=<file>           Write the results as JSON to <file>\n";
+}
+
+int main(int argc, char* argv[]) {
+	CBaseParams::ParseParameters(argc, argv);
+	if (CBaseParams::IsArgCount("-?") || CBaseParams::IsArgCount("-help")) {
+		PrintUsage();
+		return 0;
+	}
+	if (CBaseParams::GetBoolArg("-list", false)) {
+		CBenchRunner::List();
+		return 0;
+	}
+
+	// the views open their in-memory databases under the data directory, keep it away from a real node
+	boost::filesystem::path cDataDir = GetTempPath() / strprintf("bench_dacrs_%lu_%i", GetTime(), GetRand(100000));
+	CBaseParams::SoftSetBoolArg("-regtest", true);
+	CBaseParams::SoftSetArg("-datadir", cDataDir.string());
+	SysCfg().InitalConfig();
+	SetNativeSigVerify(true, 50000);
+
+	ST_BenchOptions tOptions;
+	tOptions.strFilter = CBaseParams::GetArg("-filter", "");
+	tOptions.nWarmup = max<int64_t>(0, CBaseParams::GetArg("-warmup", tOptions.nWarmup));
+	tOptions.nSamples = max<int64_t>(1, CBaseParams::GetArg("-samples", tOptions.nSamples));
+	tOptions.dScale = max(0.0, atof(CBaseParams::GetArg("-scale", "1.0").c_str()));
+	tOptions.strOutput = CBaseParams::GetArg("-json", "");
+
+	bool bRet = CBenchRunner::RunAll(tOptions);
+
+	boost::filesystem::remove_all(cDataDir);
+	return bRet ? 0 : 1;
+}
@@ -0,0 +1,667 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// Generates a regtest chain with a configurable transaction mix and replays
+// blk files through LoadExternalBlockFile, timing each phase of the import.
+
+#include "base58.h"
+#include "chainparams.h"
+#include "eventserver.h"
+#include "init.h"
+#include "key.h"
+#include "main.h"
+#include "miner.h"
+#include "noui.h"
+#include "tx.h"
+#include "txdb.h"
+#include "util.h"
+#include "vm/script.h"
+#include "wallet/wallet.h"
+#include "json/json_spirit_value.h"
+#include "json/json_spirit_writer_template.h"
+
+#include <fstream>
+#include <iostream>
+#include <random>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/thread.hpp>
+
+using namespace json_spirit;
+
+// Keys of the regtest genesis accounts and of the accounts funded in the system tests
+static const char *arrpszRegTestKeys[] = {
+	"cUa4v77hiXteMFkHoyuPVVbCCULS1CnFBhU1MhgKHEGRTHmd4BC5",
+	"cTAqnCwjuLwXqHxGe5c6KrGqQw5yjHH6Na6yYRQCgKKnf6cJBPxF",
+	"cVFWoy8jmJVVSNnMs3YRizkR7XEekMTta4MzvuRshKuQEEJ4kbNg",
+	"cNcJkU44oG3etbWoEvY46i5qWPeE8jVb7K44keXxEQxsXUZ85MKU",
+	"cStrXy6NowsDyaLRJMhQCJu4WnP6WR6SMC1c3dmxDeeLKFcYHDsQ",
+	"cSu84vACzZkWqnP2LUdJQLX3M1PYYXo2gEDDCEKLWNWfM7B4zLiP",
+	"cSVY69D9aUo4MugzUG9rM14DtV21cBAbZUVXmgAC2RpJwtZRUbsM",
+	"cTCcDyQvX6ucP9NEjhyHfTixamKQHQkFiSyfupm4CGZZYV7YYnf8",
+	"cUwPkEYdg3d3CmNctg2aegdyeq7dbLta1HAVHcGQTp33kWqzMSuT",
+	"cPqVgscsWpPgkLHZP3pKJVSU5ZTCCvVhkd5cmXVWVydXdMTtBGj7",
+	"cU1dxQgvyKt8yEqqkKiNLK9jfyW498RKi8y2evqzjtLXrLD4fBMs",
+	"cRYYMN1EFd9X4sGqEkUkWLi38GCFyAccKQEuF1WiYFwUWsqBGwHe",
+	"cR5wPiv3Vp4sQmww2gWzShkDUaamYrJ6QHHtDd1Pm4nVJFTxnksC",
+	"cT1BuRbx5Cvmvic2dX2aq3ep2fu75CDwYk8fCQPtrftKiBEQiPJm",
+	"cQXpVRxwXqeh8FjSxkGE7sYrzXLXPdoHeUQCdJk9uLy17F3WKbPM",
+	"cVNeGiYHhtaVSvmCswUs8jootYPFJisVwx6gqBbkeWSftkXeaHbC",
+	"cNjb55M6fqNVuhKmNE95C8weWYr6iD2yW6QqifYWSvuVGKUJRTt9",
+	"cN2xNMvvNCtqh1K87J9o35cHHQttdZi1MYgUj8FYZPdtaFTtxbtd",
+	"cU8kr9JvCXotPoBQZ4TPxkD2S98ZFz2AKLDupMt8hgNG4JLQ1b2x",
+	"cSvRSiQGS6d11CbY4Mac1sCN84YHyNsFvNZ5xgBM1FHUSi7fgcaA",
+	"cMv5HP4EPsX4Fmvj2Zgtpq5MfAbVRxwunqNtK2qjVrMdfvv36Zr3",
+};
+
+static const uint64_t GEN_TX_FEE 		= 100000;
+static const uint64_t GEN_CONTRACT_FEE 	= COIN / 100;
+static const uint64_t GEN_REG_APP_FEE 	= COIN;
+static const uint64_t GEN_FUND_VALUE 	= 10 * COIN;
+
+/**
+ * Default 8051 app: counts down 20 x 250 in two DJNZ loops, sets the success flag
+ * at 0xEFFD and leaves through the 0x0008 exit vector
+ */
+static const unsigned char arrchDefault8051App[] = {
+	0x02, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x7F, 0x14, 0x7E, 0xFA, 0xDE, 0xFE, 0xDF, 0xFA, 0x90, 0xEF, 0xFD, 0x74, 0x01, 0xF0, 0x02, 0x00,
+	0x08,
+};
+
+// Default Lua app: table work over the contract bytes, no host calls
+static const char *pszDefaultLuaApp =
+		"mylib = require \"mylib\"\n"
+		"local t = {}\n"
+		"for i = 1, 500 do\n"
+		"  t[i] = (i * 7919) % 1000\n"
+		"end\n"
+		"local sum = 0\n"
+		"for i = 1, #t do\n"
+		"  sum = sum + t[i] * contract[(i % #contract) + 1]\n"
+		"end\n";
+
+enum emGenTxType {
+	EM_GEN_TRANSFER,
+	EM_GEN_REGISTER,
+	EM_GEN_8051,
+	EM_GEN_LUA,
+	EM_GEN_MAX,
+};
+
+static const char *arrpszGenTxType[EM_GEN_MAX] = { "transfer", "register", "8051", "lua" };
+
+struct ST_GenAccount {
+	ST_GenAccount() :
+			bFunded(false), bRegPending(false) {
+	}
+
+	CKey cKey;
+	CKeyID cKeyId;
+	CRegID cRegId; 			// empty until the registration is confirmed
+	bool bFunded;
+	bool bRegPending;
+};
+
+struct ST_GenApp {
+	vector<unsigned char> vchScript; 		// CVmScript as registered
+	vector<unsigned char> vchContract; 		// contract of every call
+	uint256 cRegTxHash;
+	CRegID cAppId; 							// empty until the registration is confirmed
+};
+
+/**
+ * Builds blocks on the running regtest node: the transactions are signed with keys derived
+ * from the seed and go through AcceptToMemoryPool, the blocks are mined with the wallet's
+ * genesis keys and processed as if received from a peer.
+ */
+class CChainGenerator {
+ public:
+	CChainGenerator(uint32_t unSeed, int nTxPerBlock, const vector<int> &vnMix, int nMaxAccounts) :
+			m_cRng(unSeed), m_unSeed(unSeed), m_nTxPerBlock(nTxPerBlock), m_vnMix(vnMix),
+			m_nMaxAccounts(nMaxAccounts), m_nFunders(0), m_nKeyCount(0), m_nRejected(0), m_pRegistering(NULL) {
+		memset(m_arrnAccepted, 0, sizeof(m_arrnAccepted));
+	}
+
+	bool Init(const vector<unsigned char> &vch8051Rom, const vector<unsigned char> &vch8051Contract,
+			const vector<unsigned char> &vchLuaRom, const vector<unsigned char> &vchLuaContract);
+	bool GenerateBlock();
+	void PrintSummary() const;
+
+ private:
+	unsigned int Rand(unsigned int unMax) {
+		return m_cRng() % unMax;
+	}
+	void Refresh();
+	ST_GenAccount *NewAccount();
+	ST_GenAccount *RandomRegistered(bool bFunderOnly);
+	std::shared_ptr<CBaseTransaction> CreateTransfer(int nHeight);
+	std::shared_ptr<CBaseTransaction> CreateRegister(int nHeight);
+	std::shared_ptr<CBaseTransaction> CreateContract(ST_GenApp &tApp, int nHeight);
+	std::shared_ptr<CBaseTransaction> CreateRegisterApp(ST_GenApp &tApp, int nHeight);
+	bool Submit(CBaseTransaction *pTx);
+	bool Mine();
+
+	std::mt19937 m_cRng;
+	uint32_t m_unSeed;
+	int m_nTxPerBlock;
+	vector<int> m_vnMix; 			// weight of each emGenTxType
+	int m_nMaxAccounts;
+	vector<ST_GenAccount> m_vtAccounts; 	// the genesis funders come first
+	int m_nFunders;
+	int m_nKeyCount;
+	ST_GenApp m_arrtApps[2]; 		// 8051 and Lua
+	int m_arrnAccepted[EM_GEN_MAX];
+	int m_nRejected;
+	ST_GenAccount *m_pRegistering; 	// account of the registration being submitted
+};
+
+static vector<unsigned char> SerializeScript(const vector<unsigned char> &vchRom) {
+	CVmScript cScript;
+	cScript.m_vuchRom = vchRom;
+	CDataStream cDs(SER_DISK, g_sClientVersion);
+	cDs << cScript;
+	return vector<unsigned char>(cDs.begin(), cDs.end());
+}
+
+bool CChainGenerator::Init(const vector<unsigned char> &vch8051Rom, const vector<unsigned char> &vch8051Contract,
+		const vector<unsigned char> &vchLuaRom, const vector<unsigned char> &vchLuaContract) {
+	LOCK2(g_cs_main, g_pwalletMain->m_cs_wallet);
+	for (const char *pszKey : arrpszRegTestKeys) {
+		CDacrsSecret cSecret;
+		if (!cSecret.SetString(pszKey)) {
+			continue;
+		}
+		ST_GenAccount tAccount;
+		tAccount.cKey = cSecret.GetKey();
+		tAccount.cKeyId = tAccount.cKey.GetPubKey().GetKeyID();
+		CAccount cAccount;
+		if (!g_pAccountViewTip->GetAccount(CUserID(tAccount.cKeyId), cAccount) || !cAccount.IsRegister()
+				|| cAccount.GetRawBalance() < GEN_FUND_VALUE) {
+			continue;
+		}
+		// the genesis accounts mine the blocks
+		if (!g_pwalletMain->HaveKey(tAccount.cKeyId) && !g_pwalletMain->AddKey(tAccount.cKey)) {
+			return ERRORMSG("CChainGenerator::Init : adding key %s to the wallet failed", tAccount.cKeyId.ToAddress());
+		}
+		tAccount.cRegId = cAccount.m_cRegID;
+		tAccount.bFunded = true;
+		m_vtAccounts.push_back(tAccount);
+	}
+	m_nFunders = m_vtAccounts.size();
+	if (m_nFunders < 2) {
+		return ERRORMSG("CChainGenerator::Init : need two funded regtest genesis accounts, found %d", m_nFunders);
+	}
+	m_arrtApps[0].vchScript = SerializeScript(vch8051Rom);
+	m_arrtApps[0].vchContract = vch8051Contract;
+	m_arrtApps[1].vchScript = SerializeScript(vchLuaRom);
+	m_arrtApps[1].vchContract = vchLuaContract;
+
+	return true;
+}
+
+// pick up the registrations, funding and app ids confirmed by the last block
+void CChainGenerator::Refresh() {
+	LOCK(g_cs_main);
+	for (auto &tAccount : m_vtAccounts) {
+		if (!tAccount.cRegId.IsEmpty()) {
+			continue;
+		}
+		CAccount cAccount;
+		if (g_pAccountViewTip->GetAccount(CUserID(tAccount.cKeyId), cAccount)) {
+			tAccount.bFunded = cAccount.GetRawBalance() >= GEN_TX_FEE * 2;
+			if (cAccount.IsRegister()) {
+				tAccount.cRegId = cAccount.m_cRegID;
+				tAccount.bRegPending = false;
+			}
+		}
+	}
+
+	CBlock cBlock;
+	if (!ReadBlockFromDisk(cBlock, g_cChainActive.Tip())) {
+		return;
+	}
+	for (auto &tApp : m_arrtApps) {
+		if (!tApp.cAppId.IsEmpty() || tApp.cRegTxHash.IsNull()) {
+			continue;
+		}
+		for (unsigned int i = 0; i < cBlock.vptx.size(); ++i) {
+			if (cBlock.vptx[i]->GetHash() == tApp.cRegTxHash) {
+				tApp.cAppId = CRegID(cBlock.GetHeight(), i);
+			}
+		}
+	}
+}
+
+// accounts are derived from the seed so every run with the same options builds the same chain
+ST_GenAccount *CChainGenerator::NewAccount() {
+	uint256 cSecret = Hash(BEGIN(m_unSeed), END(m_unSeed), BEGIN(m_nKeyCount), END(m_nKeyCount));
+	++m_nKeyCount;
+	ST_GenAccount tAccount;
+	tAccount.cKey.Set(cSecret.begin(), cSecret.end(), true);
+	if (!tAccount.cKey.IsValid()) {
+		return NULL;
+	}
+	tAccount.cKeyId = tAccount.cKey.GetPubKey().GetKeyID();
+	m_vtAccounts.push_back(tAccount);
+	return &m_vtAccounts.back();
+}
+
+ST_GenAccount *CChainGenerator::RandomRegistered(bool bFunderOnly) {
+	if (bFunderOnly) {
+		return &m_vtAccounts[Rand(m_nFunders)];
+	}
+	for (int nTry = 0; nTry < 16; ++nTry) {
+		ST_GenAccount &tAccount = m_vtAccounts[Rand(m_vtAccounts.size())];
+		if (!tAccount.cRegId.IsEmpty() && tAccount.bFunded) {
+			return &tAccount;
+		}
+	}
+	return &m_vtAccounts[Rand(m_nFunders)];
+}
+
+std::shared_ptr<CBaseTransaction> CChainGenerator::CreateTransfer(int nHeight) {
+	ST_GenAccount *pSender = NULL;
+	ST_GenAccount *pReceiver = NULL;
+	uint64_t ullValue = 0;
+	if ((int) m_vtAccounts.size() - m_nFunders < m_nMaxAccounts) {
+		// new accounts are funded by the genesis accounts
+		pSender = RandomRegistered(true);
+		CKeyID cSenderKeyId = pSender->cKeyId;
+		pReceiver = NewAccount();
+		if (pReceiver == NULL) {
+			return std::shared_ptr<CBaseTransaction>();
+		}
+		// NewAccount may have moved the accounts
+		for (auto &tAccount : m_vtAccounts) {
+			if (tAccount.cKeyId == cSenderKeyId) {
+				pSender = &tAccount;
+			}
+		}
+		ullValue = GEN_FUND_VALUE;
+	} else {
+		pSender = RandomRegistered(false);
+		pReceiver = &m_vtAccounts[Rand(m_vtAccounts.size())];
+		ullValue = 1000 + Rand(100000);
+	}
+	std::shared_ptr<CTransaction> pTx = std::make_shared<CTransaction>(pSender->cRegId, pReceiver->cKeyId, GEN_TX_FEE,
+			ullValue, nHeight);
+	if (!pSender->cKey.Sign(pTx->SignatureHash(), pTx->m_vchSignature)) {
+		return std::shared_ptr<CBaseTransaction>();
+	}
+	return pTx;
+}
+
+std::shared_ptr<CBaseTransaction> CChainGenerator::CreateRegister(int nHeight) {
+	vector<ST_GenAccount *> vpCandidates;
+	for (auto &tAccount : m_vtAccounts) {
+		if (tAccount.bFunded && tAccount.cRegId.IsEmpty() && !tAccount.bRegPending) {
+			vpCandidates.push_back(&tAccount);
+		}
+	}
+	if (vpCandidates.empty()) {
+		return std::shared_ptr<CBaseTransaction>();
+	}
+	ST_GenAccount *pAccount = vpCandidates[Rand(vpCandidates.size())];
+	std::shared_ptr<CRegisterAccountTx> pTx = std::make_shared<CRegisterAccountTx>(pAccount->cKey.GetPubKey(),
+			CNullID(), GEN_TX_FEE, nHeight);
+	if (!pAccount->cKey.Sign(pTx->SignatureHash(), pTx->m_vchSignature)) {
+		return std::shared_ptr<CBaseTransaction>();
+	}
+	pAccount->bRegPending = true;
+	m_pRegistering = pAccount;
+	return pTx;
+}
+
+std::shared_ptr<CBaseTransaction> CChainGenerator::CreateContract(ST_GenApp &tApp, int nHeight) {
+	if (tApp.cAppId.IsEmpty()) {
+		return std::shared_ptr<CBaseTransaction>();
+	}
+	ST_GenAccount *pSender = RandomRegistered(false);
+	std::shared_ptr<CTransaction> pTx = std::make_shared<CTransaction>(pSender->cRegId, tApp.cAppId,
+			GEN_CONTRACT_FEE, 0, nHeight, tApp.vchContract);
+	if (!pSender->cKey.Sign(pTx->SignatureHash(), pTx->m_vchSignature)) {
+		return std::shared_ptr<CBaseTransaction>();
+	}
+	return pTx;
+}
+
+std::shared_ptr<CBaseTransaction> CChainGenerator::CreateRegisterApp(ST_GenApp &tApp, int nHeight) {
+	ST_GenAccount &tFunder = m_vtAccounts[0];
+	std::shared_ptr<CRegisterAppTx> pTx = std::make_shared<CRegisterAppTx>();
+	pTx->m_cRegAcctId = tFunder.cRegId;
+	pTx->m_vchScript = tApp.vchScript;
+	pTx->m_ullFees = GEN_REG_APP_FEE;
+	pTx->m_ullRunStep = tApp.vchScript.size();
+	pTx->m_nValidHeight = nHeight;
+	if (!tFunder.cKey.Sign(pTx->SignatureHash(), pTx->m_vchSignature)) {
+		return std::shared_ptr<CBaseTransaction>();
+	}
+	tApp.cRegTxHash = pTx->GetHash();
+	return pTx;
+}
+
+bool CChainGenerator::Submit(CBaseTransaction *pTx) {
+	LOCK(g_cs_main);
+	CValidationState cValidationState;
+	if (!AcceptToMemoryPool(g_cTxMemPool, cValidationState, pTx, true)) {
+		LogPrint("chaingen", "tx %s rejected: %s\n", pTx->GetHash().GetHex(), cValidationState.GetRejectReason());
+		++m_nRejected;
+		return false;
+	}
+	return true;
+}
+
+bool CChainGenerator::Mine() {
+	CBlockIndex *pPrevIndex = NULL;
+	{
+		LOCK(g_cs_main);
+		pPrevIndex = g_cChainActive.Tip();
+	}
+	CAccountViewCache cAccountViewCache(*g_pAccountViewTip, true);
+	CTransactionDBCache cTxDBCache(*g_pTxCacheTip, true);
+	CScriptDBViewCache cScriptDBCache(*g_pScriptDBTip, true);
+	std::shared_ptr<ST_BlockTemplate> pTemplate(CreateNewBlock(cAccountViewCache, cTxDBCache, cScriptDBCache));
+	if (!pTemplate.get()) {
+		return ERRORMSG("CChainGenerator::Mine : CreateNewBlock failed");
+	}
+	CBlock *pBlock = &pTemplate->cBlock;
+	// a new block time gives CreatePosTx a new set of hashes to try
+	for (int nTry = 0; nTry < 600; ++nTry) {
+		pBlock->SetTime(max(pPrevIndex->GetMedianTimePast() + 1, GetAdjustedTime()));
+		set<CKeyID> setCreateKey;
+		if (CreatePosTx(pPrevIndex, pBlock, setCreateKey, cAccountViewCache, cTxDBCache, cScriptDBCache)) {
+			return CheckWork(pBlock, *g_pwalletMain);
+		}
+		MilliSleep(100);
+	}
+	return ERRORMSG("CChainGenerator::Mine : no proof of stake found on height %d", pPrevIndex->m_nHeight + 1);
+}
+
+bool CChainGenerator::GenerateBlock() {
+	Refresh();
+	int nHeight = 0;
+	{
+		LOCK(g_cs_main);
+		nHeight = g_cChainActive.Height();
+	}
+	// register the apps first, the contract calls start once they are confirmed
+	for (auto &tApp : m_arrtApps) {
+		if (tApp.cRegTxHash.IsNull()) {
+			std::shared_ptr<CBaseTransaction> pTx = CreateRegisterApp(tApp, nHeight);
+			if (!pTx || !Submit(pTx.get())) {
+				return ERRORMSG("CChainGenerator::GenerateBlock : app registration rejected");
+			}
+		}
+	}
+
+	int nMixTotal = 0;
+	for (int nWeight : m_vnMix) {
+		nMixTotal += nWeight;
+	}
+	for (int i = 0; i < m_nTxPerBlock; ++i) {
+		unsigned int unPick = Rand(nMixTotal);
+		int nType = 0;
+		while (unPick >= (unsigned int) m_vnMix[nType]) {
+			unPick -= m_vnMix[nType];
+			++nType;
+		}
+		std::shared_ptr<CBaseTransaction> pTx;
+		if (EM_GEN_REGISTER == nType) {
+			pTx = CreateRegister(nHeight);
+		} else if (EM_GEN_8051 == nType || EM_GEN_LUA == nType) {
+			pTx = CreateContract(m_arrtApps[nType - EM_GEN_8051], nHeight);
+		}
+		// transfers fill in while nothing is left to register or the apps are not confirmed yet
+		if (!pTx) {
+			nType = EM_GEN_TRANSFER;
+			pTx = CreateTransfer(nHeight);
+		}
+		if (pTx && Submit(pTx.get())) {
+			++m_arrnAccepted[nType];
+		} else if (EM_GEN_REGISTER == nType && m_pRegistering != NULL) {
+			m_pRegistering->bRegPending = false;
+		}
+		m_pRegistering = NULL;
+	}
+
+	return Mine();
+}
+
+void CChainGenerator::PrintSummary() const {
+	LOCK(g_cs_main);
+	cout << strprintf("height %d, %u transactions in the chain, %d accounts\n", g_cChainActive.Height(),
+			g_cChainActive.Tip()->m_unChainTx, m_vtAccounts.size());
+	for (int i = 0; i < EM_GEN_MAX; ++i) {
+		cout << strprintf("  %-10s %d\n", arrpszGenTxType[i], m_arrnAccepted[i]);
+	}
+	cout << strprintf("  %-10s %d\n", "rejected", m_nRejected);
+}
+
+static bool ReadFileToVector(const string &strPath, vector<unsigned char> &vchData) {
+	ifstream cFile(strPath.c_str(), ios::in | ios::binary);
+	if (!cFile) {
+		return false;
+	}
+	vchData.assign(istreambuf_iterator<char>(cFile), istreambuf_iterator<char>());
+	return !vchData.empty();
+}
+
+static bool Generate(int nBlocks) {
+	vector<int> vnMix;
+	vector<string> vstrMix;
+	string strMix = SysCfg().GetArg("-txmix", "70,10,10,10");
+	boost::split(vstrMix, strMix, boost::is_any_of(","));
+	for (const auto &strWeight : vstrMix) {
+		vnMix.push_back(max(0, atoi(strWeight.c_str())));
+	}
+	vnMix.resize(EM_GEN_MAX, 0);
+	if (vnMix[EM_GEN_TRANSFER] + vnMix[EM_GEN_REGISTER] + vnMix[EM_GEN_8051] + vnMix[EM_GEN_LUA] <= 0) {
+		return ERRORMSG("Generate : -txmix=%s has no positive weight", strMix);
+	}
+
+	vector<unsigned char> vch8051Rom(arrchDefault8051App, arrchDefault8051App + sizeof(arrchDefault8051App));
+	vector<unsigned char> vchLuaRom(pszDefaultLuaApp, pszDefaultLuaApp + strlen(pszDefaultLuaApp));
+	string strApp8051 = SysCfg().GetArg("-app8051", "");
+	string strAppLua = SysCfg().GetArg("-applua", "");
+	if (!strApp8051.empty() && !ReadFileToVector(strApp8051, vch8051Rom)) {
+		return ERRORMSG("Generate : cannot read %s", strApp8051);
+	}
+	if (!strAppLua.empty() && !ReadFileToVector(strAppLua, vchLuaRom)) {
+		return ERRORMSG("Generate : cannot read %s", strAppLua);
+	}
+	vector<unsigned char> vch8051Contract = ParseHex(SysCfg().GetArg("-app8051contract", "00"));
+	vector<unsigned char> vchLuaContract = ParseHex(SysCfg().GetArg("-appluacontract", "0102030405060708"));
+
+	CChainGenerator cGenerator(SysCfg().GetArg("-seed", 1), max<int64_t>(0, SysCfg().GetArg("-txperblock", 50)), vnMix,
+			max<int64_t>(0, SysCfg().GetArg("-accounts", 500)));
+	if (!cGenerator.Init(vch8051Rom, vch8051Contract, vchLuaRom, vchLuaContract)) {
+		return false;
+	}
+	int64_t llStart = GetTimeMillis();
+	for (int i = 0; i < nBlocks && !ShutdownRequested(); ++i) {
+		if (!cGenerator.GenerateBlock()) {
+			return false;
+		}
+		if ((i + 1) % 100 == 0) {
+			cout << strprintf("%d blocks generated\n", i + 1);
+		}
+	}
+	cout << strprintf("generated %d blocks in %.1fs\n", nBlocks, (GetTimeMillis() - llStart) / 1000.0);
+	cGenerator.PrintSummary();
+
+	return true;
+}
+
+static vector<boost::filesystem::path> ListBlockFiles(const boost::filesystem::path &cDir) {
+	vector<boost::filesystem::path> vcFiles;
+	if (!boost::filesystem::is_directory(cDir)) {
+		return vcFiles;
+	}
+	for (boost::filesystem::directory_iterator it(cDir); it != boost::filesystem::directory_iterator(); ++it) {
+		string strName = it->path().filename().string();
+		if (boost::starts_with(strName, "blk") && boost::ends_with(strName, ".dat")) {
+			vcFiles.push_back(it->path());
+		}
+	}
+	sort(vcFiles.begin(), vcFiles.end());
+	return vcFiles;
+}
+
+static bool Replay(const boost::filesystem::path &cDir) {
+	vector<boost::filesystem::path> vcFiles = ListBlockFiles(cDir);
+	if (vcFiles.empty()) {
+		return ERRORMSG("Replay : no blk*.dat files in %s", cDir.string());
+	}
+	int nStartHeight = 0;
+	unsigned int unStartTx = 0;
+	{
+		LOCK(g_cs_main);
+		nStartHeight = g_cChainActive.Height();
+		unStartTx = g_cChainActive.Tip()->m_unChainTx;
+	}
+
+	ResetBlockPhaseTimes();
+	int64_t llStart = GetMonotonicMicros();
+	SysCfg().SetImporting(true);
+	for (const auto &cFile : vcFiles) {
+		if (ShutdownRequested()) {
+			break;
+		}
+		FILE *pFile = fopen(cFile.string().c_str(), "rb");
+		if (!pFile) {
+			SysCfg().SetImporting(false);
+			return ERRORMSG("Replay : cannot open %s", cFile.string());
+		}
+		LogPrint("INFO", "Replaying blocks from %s\n", cFile.string());
+		LoadExternalBlockFile(pFile); 		// closes the file
+	}
+	SysCfg().SetImporting(false);
+	int64_t llElapsed = max<int64_t>(1, GetMonotonicMicros() - llStart);
+
+	int nBlocks = 0;
+	unsigned int unTxs = 0;
+	{
+		LOCK(g_cs_main);
+		nBlocks = g_cChainActive.Height() - nStartHeight;
+		unTxs = g_cChainActive.Tip()->m_unChainTx - unStartTx;
+	}
+	double dSeconds = llElapsed / 1000000.0;
+	cout << strprintf("replayed %d blocks, %u transactions in %.3fs: %.1f blocks/s, %.1f tx/s\n", nBlocks, unTxs,
+			dSeconds, nBlocks / dSeconds, unTxs / dSeconds);
+	cout << strprintf("%-18s %10s %12s %8s\n", "# phase", "calls", "ms", "share");
+	Array arrPhases;
+	for (int i = 0; i < EM_BLOCK_PHASE_MAX; ++i) {
+		int64_t llMicros = g_arrtBlockPhaseStats[i].llMicros;
+		uint64_t ullCalls = g_arrtBlockPhaseStats[i].ullCalls;
+		cout << strprintf("%-18s %10u %12.1f %7.1f%%\n", GetBlockPhaseName((emBlockPhase) i), ullCalls,
+				llMicros / 1000.0, 100.0 * llMicros / llElapsed);
+		Object obj;
+		obj.push_back(Pair("phase", GetBlockPhaseName((emBlockPhase) i)));
+		obj.push_back(Pair("calls", (int64_t) ullCalls));
+		obj.push_back(Pair("ms", llMicros / 1000.0));
+		arrPhases.push_back(obj);
+	}
+
+	string strJson = SysCfg().GetArg("-json", "");
+	if (!strJson.empty()) {
+		Object objReport;
+		objReport.push_back(Pair("blocks", nBlocks));
+		objReport.push_back(Pair("transactions", (int64_t) unTxs));
+		objReport.push_back(Pair("seconds", dSeconds));
+		objReport.push_back(Pair("blocks_per_second", nBlocks / dSeconds));
+		objReport.push_back(Pair("tx_per_second", unTxs / dSeconds));
+		objReport.push_back(Pair("phases", arrPhases));
+		ofstream cOut(strJson.c_str(), ios::out | ios::trunc);
+		if (!cOut) {
+			return ERRORMSG("Replay : cannot open %s", strJson);
+		}
+		cOut << write_string(Value(objReport), true) << "\n";
+	}
+
+	return true;
+}
+
+static void PrintUsage() {
+	cout << "Usage: chain_dacrs -generate=<blocks> -out=<dir> [options]\n"
+			<< "       chain_dacrs -replay=<dir> [options]\n\n"
+			<< "Options:\n"
+			<< "  -?                       This help message\n"
+			<< "  -datadir=<dir>           Data directory of the node, a temporary one is used by default\n"
+			<< "  -generate=<blocks>       Mine <blocks> blocks on regtest and copy the blk files to -out\n"
+			<< "  -out=<dir>               Directory the generated blk files are copied to\n"
+			<< "  -txperblock=<n>          Transactions per generated block (default: 50)\n"
+			<< "  -txmix=<t,r,8,l>         Weights of transfers, account registrations, 8051 and Lua\n"
+			<< "                           contract calls (default: 70,10,10,10)\n"
+			<< "  -accounts=<n>            Accounts funded by the genesis accounts (default: 500)\n"
+			<< "  -seed=<n>                Seed of the keys and of the transaction mix (default: 1)\n"
+			<< "  -app8051=<file>          8051 app binary, e.g. one of the ptest apps (default: a built-in loop)\n"
+			<< "  -app8051contract=<hex>   Contract of the 8051 calls (default: 00)\n"
+			<< "  -applua=<file>           Lua app script (default: a built-in table loop)\n"
+			<< "  -appluacontract=<hex>    Contract of the Lua calls (default: 0102030405060708)\n"
+			<< "  -replay=<dir>            Import the blk*.dat files in <dir> through LoadExternalBlockFile\n"
+			<< "                           and report the time spent in each phase\n"
+			<< "  -json=<file>             Write the replay report as JSON to <file>\n";
+}
+
+int main(int argc, char* argv[]) {
+	CBaseParams::ParseParameters(argc, argv);
+	int nGenerate = CBaseParams::GetArg("-generate", 0);
+	string strReplay = CBaseParams::GetArg("-replay", "");
+	string strOut = CBaseParams::GetArg("-out", "");
+	if (CBaseParams::IsArgCount("-?") || CBaseParams::IsArgCount("-help") || (nGenerate > 0) == !strReplay.empty()
+			|| (nGenerate > 0 && strOut.empty())) {
+		PrintUsage();
+		return 1;
+	}
+
+	boost::filesystem::path cTempDir;
+	if (!CBaseParams::IsArgCount("-datadir")) {
+		cTempDir = GetTempPath() / strprintf("chain_dacrs_%lu_%i", GetTime(), GetRand(100000));
+		boost::filesystem::create_directories(cTempDir);
+		CBaseParams::SoftSetArg("-datadir", cTempDir.string());
+	}
+	// a generated chain only replays on a node with the same consensus settings
+	CBaseParams::SoftSetBoolArg("-regtest", true);
+	CBaseParams::SoftSetArg("-intervalpos", "1");
+	CBaseParams::SoftSetBoolArg("-listen", false);
+	CBaseParams::SoftSetBoolArg("-dnsseed", false);
+	CBaseParams::SoftSetBoolArg("-persistmempool", false);
+	SysCfg().InitalConfig();
+	SetupEnvironment();
+	noui_connect();
+
+	boost::thread_group threadGroup;
+	bool bRet = false;
+	try {
+		if (AppInit2(threadGroup)) {
+			bRet = nGenerate > 0 ? Generate(nGenerate) : Replay(strReplay);
+		}
+	} catch (std::exception& e) {
+		PrintExceptionContinue(&e, "chain_dacrs");
+	} catch (...) {
+		PrintExceptionContinue(NULL, "chain_dacrs");
+	}
+	StartShutdown();
+	threadGroup.interrupt_all();
+	threadGroup.join_all();
+	g_cEventServer.Stop();
+	Shutdown();
+
+	if (bRet && nGenerate > 0) {
+		boost::filesystem::path cOutDir(strOut);
+		boost::filesystem::create_directories(cOutDir);
+		for (const auto &cFile : ListBlockFiles(GetDataDir() / "blocks")) {
+			boost::filesystem::copy_file(cFile, cOutDir / cFile.filename(),
+					boost::filesystem::copy_option::overwrite_if_exists);
+		}
+		cout << strprintf("blk files written to %s\n", cOutDir.string());
+	}
+	if (!cTempDir.empty()) {
+		boost::filesystem::remove_all(cTempDir);
+	}
+	return bRet ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "core.h"
+#include "database.h"
+#include "main.h"
+#include "tx.h"
+#include "txdb.h"
+
+#include <assert.h>
+
+static const unsigned int BENCH_BLOCK_TX_COUNT = 1000;
+static const int BENCH_BLOCK_HEIGHT = 1000;
+static const size_t BENCH_DB_CACHE = 8 << 20;
+
+static CKeyID BenchKeyId(unsigned int i) {
+	uint160 cId;
+	memcpy(cId.begin(), &i, sizeof(i));
+	return CKeyID(cId);
+}
+
+/**
+ * Runs the transactions of a synthetic block the way ConnectBlock's serial loop does:
+ * ExecuteTx on the block's caches, one CTxUndo per transaction gathered into the block
+ * undo, which is then sized for the undo file. Each source account pays the next one.
+ */
+static void ExecuteBlockTxs(CBenchState &cState) {
+	CAccountViewDB cAccountDB(BENCH_DB_CACHE, true, false);
+	CTransactionDB cTxDB(BENCH_DB_CACHE, true, false);
+	CScriptDB cScriptDB(BENCH_DB_CACHE, true, false);
+	{
+		CAccountViewCache cCache(cAccountDB, true);
+		for (unsigned int i = 0; i <= BENCH_BLOCK_TX_COUNT; ++i) {
+			CAccount cAccount;
+			cAccount.m_cKeyID = BenchKeyId(i);
+			cAccount.SetRegId(CRegID(1, i + 1));
+			cAccount.m_ullValues = 100 * COIN;
+			cCache.SaveAccountInfo(CRegID(1, i + 1), cAccount.m_cKeyID, cAccount);
+		}
+		bool bFlushed = cCache.Flush();
+		assert(bFlushed);
+	}
+
+	CBlock cBlock;
+	cBlock.SetHeight(BENCH_BLOCK_HEIGHT);
+	for (unsigned int i = 0; i < BENCH_BLOCK_TX_COUNT; ++i) {
+		cBlock.vptx.push_back(std::make_shared<CTransaction>(CRegID(1, i + 1), BenchKeyId(i + 1), 10000, COIN,
+				BENCH_BLOCK_HEIGHT));
+	}
+
+	while (cState.KeepRunning()) {
+		CAccountViewCache cAccountCache(cAccountDB, true);
+		CTransactionDBCache cTxCache(cTxDB, true);
+		CScriptDBViewCache cScriptCache(cScriptDB, true);
+		CBlockUndo cUndoBlock;
+		for (unsigned int i = 0; i < cBlock.vptx.size(); ++i) {
+			CValidationState cValidationState;
+			CTxUndo cUndoTx;
+			bool bExecuted = cBlock.vptx[i]->ExecuteTx(i + 1, cAccountCache, cValidationState, cUndoTx,
+					BENCH_BLOCK_HEIGHT, cTxCache, cScriptCache);
+			assert(bExecuted);
+			cUndoBlock.m_vcTxUndo.push_back(cUndoTx);
+		}
+		::GetSerializeSize(cUndoBlock, SER_DISK, g_sClientVersion);
+	}
+}
+
+BENCHMARK(ExecuteBlockTxs, 20);
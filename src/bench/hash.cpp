@@ -0,0 +1,45 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "core.h"
+#include "hash.h"
+#include "tx.h"
+#include "version.h"
+
+static void HashBuffer1KB(CBenchState &cState) {
+	vector<unsigned char> vchData(1024, 0x5a);
+	uint256 cHash;
+	while (cState.KeepRunning()) {
+		cHash = Hash(vchData.begin(), vchData.end());
+		vchData[0] = *cHash.begin();
+	}
+}
+
+static void HashWriterBlockHeader(CBenchState &cState) {
+	CBlockHeader cHeader;
+	cHeader.SetHeight(100000);
+	cHeader.SetNonce(1);
+	while (cState.KeepRunning()) {
+		CHashWriter cHashWriter(SER_GETHASH, g_sProtocolVersion);
+		cHashWriter << cHeader;
+		cHeader.SetNonce(cHeader.GetNonce() + 1);
+		cHashWriter.GetHash();
+	}
+}
+
+static void SerializeHashTransaction(CBenchState &cState) {
+	vector_unsigned_char vchContract(64, 0x01);
+	CTransaction cTx(CRegID(100, 1), CRegID(200, 2), 10000, 100000, 100, vchContract);
+	cTx.m_vchSignature.assign(72, 0x30);
+	while (cState.KeepRunning()) {
+		++cTx.m_ullValues;
+		SerializeHash(cTx);
+	}
+}
+
+BENCHMARK(HashBuffer1KB, 100000);
+BENCHMARK(HashWriterBlockHeader, 100000);
+BENCHMARK(SerializeHashTransaction, 50000);
@@ -0,0 +1,71 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "core.h"
+#include "serialize.h"
+#include "tx.h"
+#include "version.h"
+
+// a block shaped like a full regtest block: one reward and many plain transfers
+static CBlock MakeBlock(unsigned int unTxCount) {
+	CBlock cBlock;
+	cBlock.SetHeight(1000);
+	cBlock.vptx.push_back(std::make_shared<CRewardTransaction>(CRegID(1, 1).GetVec6(), 0, 1000));
+	for (unsigned int i = 0; i < unTxCount; ++i) {
+		std::shared_ptr<CTransaction> pTx = std::make_shared<CTransaction>(CRegID(100, i + 1), CRegID(200, i + 1),
+				10000, 100000 + i, 1000);
+		pTx->m_vchSignature.assign(72, 0x30);
+		cBlock.vptx.push_back(pTx);
+	}
+	cBlock.SetHashMerkleRoot(cBlock.BuildMerkleTree());
+	return cBlock;
+}
+
+static void SerializeTransaction(CBenchState &cState) {
+	vector_unsigned_char vchContract(64, 0x01);
+	CTransaction cTx(CRegID(100, 1), CRegID(200, 2), 10000, 100000, 100, vchContract);
+	cTx.m_vchSignature.assign(72, 0x30);
+	while (cState.KeepRunning()) {
+		CDataStream cDs(SER_NETWORK, g_sProtocolVersion);
+		cDs << cTx;
+	}
+}
+
+static void DeserializeTransaction(CBenchState &cState) {
+	vector_unsigned_char vchContract(64, 0x01);
+	CTransaction cTx(CRegID(100, 1), CRegID(200, 2), 10000, 100000, 100, vchContract);
+	cTx.m_vchSignature.assign(72, 0x30);
+	CDataStream cDs(SER_NETWORK, g_sProtocolVersion);
+	cDs << cTx;
+	while (cState.KeepRunning()) {
+		CDataStream cIn(cDs.begin(), cDs.end(), SER_NETWORK, g_sProtocolVersion);
+		CTransaction cRead;
+		cIn >> cRead;
+	}
+}
+
+static void SerializeBlock(CBenchState &cState) {
+	CBlock cBlock = MakeBlock(1000);
+	while (cState.KeepRunning()) {
+		CDataStream cDs(SER_DISK, g_sClientVersion);
+		cDs << cBlock;
+	}
+}
+
+static void DeserializeBlock(CBenchState &cState) {
+	CDataStream cDs(SER_DISK, g_sClientVersion);
+	cDs << MakeBlock(1000);
+	while (cState.KeepRunning()) {
+		CDataStream cIn(cDs.begin(), cDs.end(), SER_DISK, g_sClientVersion);
+		CBlock cRead;
+		cIn >> cRead;
+	}
+}
+
+BENCHMARK(SerializeTransaction, 100000);
+BENCHMARK(DeserializeTransaction, 100000);
+BENCHMARK(SerializeBlock, 100);
+BENCHMARK(DeserializeBlock, 100);
@@ -0,0 +1,67 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "key.h"
+#include "crypto/secp256k1.h"
+#include "hash.h"
+#include "uint256.h"
+
+#include <assert.h>
+
+static const unsigned int BENCH_SIG_COUNT = 64;
+
+struct ST_SignedData {
+	vector<CPubKey> vcPubKeys;
+	vector<uint256> vcHashes;
+	vector<vector<unsigned char> > vvchSigs;
+};
+
+static const ST_SignedData &GetSignedData() {
+	static ST_SignedData s_tData;
+	if (s_tData.vcPubKeys.empty()) {
+		for (unsigned int i = 0; i < BENCH_SIG_COUNT; ++i) {
+			CKey cKey;
+			cKey.MakeNewKey(true);
+			uint256 cHash = Hash(BEGIN(i), END(i));
+			vector<unsigned char> vchSig;
+			bool bSigned = cKey.Sign(cHash, vchSig);
+			assert(bSigned);
+			s_tData.vcPubKeys.push_back(cKey.GetPubKey());
+			s_tData.vcHashes.push_back(cHash);
+			s_tData.vvchSigs.push_back(vchSig);
+		}
+	}
+	return s_tData;
+}
+
+static void VerifySignatures(CBenchState &cState, bool bNative) {
+	const ST_SignedData &tData = GetSignedData();
+	// the native verifier keeps the parsed keys cached as the node does by default
+	SetNativeSigVerify(bNative, BENCH_SIG_COUNT);
+	unsigned int unIndex = 0;
+	unsigned int unValid = 0;
+	while (cState.KeepRunning()) {
+		unValid += tData.vcPubKeys[unIndex].Verify(tData.vcHashes[unIndex], tData.vvchSigs[unIndex]);
+		unIndex = (unIndex + 1) % BENCH_SIG_COUNT;
+	}
+	assert(unValid == cState.GetIterations());
+	SetNativeSigVerify(true, BENCH_SIG_COUNT);
+}
+
+#ifdef USE_NATIVE_SECP256K1
+static void VerifyNative(CBenchState &cState) {
+	VerifySignatures(cState, true);
+}
+#endif
+
+static void VerifyOpenSSL(CBenchState &cState) {
+	VerifySignatures(cState, false);
+}
+
+#ifdef USE_NATIVE_SECP256K1
+BENCHMARK(VerifyNative, 2000);
+#endif
+BENCHMARK(VerifyOpenSSL, 2000);
@@ -0,0 +1,117 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "database.h"
+#include "tx.h"
+#include "txdb.h"
+
+#include <assert.h>
+
+static const unsigned int BENCH_ACCOUNT_COUNT = 10000;
+static const size_t BENCH_DB_CACHE = 8 << 20;
+
+static CKeyID BenchKeyId(unsigned int i) {
+	uint160 cId;
+	memcpy(cId.begin(), &i, sizeof(i));
+	return CKeyID(cId);
+}
+
+static CAccount BenchAccount(unsigned int i) {
+	CAccount cAccount;
+	cAccount.m_cKeyID = BenchKeyId(i);
+	cAccount.SetRegId(CRegID(1, i + 1));
+	cAccount.m_ullValues = 100000 + i;
+	return cAccount;
+}
+
+// in-memory account db holding BENCH_ACCOUNT_COUNT flushed accounts
+static void FillAccounts(CAccountViewDB &cAccountDB) {
+	CAccountViewCache cCache(cAccountDB, true);
+	for (unsigned int i = 0; i < BENCH_ACCOUNT_COUNT; ++i) {
+		CAccount cAccount = BenchAccount(i);
+		cCache.SaveAccountInfo(CRegID(1, i + 1), cAccount.m_cKeyID, cAccount);
+	}
+	bool bFlushed = cCache.Flush();
+	assert(bFlushed);
+}
+
+static void AccountCacheGet(CBenchState &cState) {
+	CAccountViewDB cAccountDB(BENCH_DB_CACHE, true, false);
+	FillAccounts(cAccountDB);
+	CAccountViewCache cCache(cAccountDB, true);
+	unsigned int unIndex = 0;
+	CAccount cAccount;
+	while (cState.KeepRunning()) {
+		cCache.GetAccount(CUserID(CRegID(1, unIndex + 1)), cAccount);
+		unIndex = (unIndex + 7919) % BENCH_ACCOUNT_COUNT;
+	}
+}
+
+static void AccountCacheSetFlush(CBenchState &cState) {
+	CAccountViewDB cAccountDB(BENCH_DB_CACHE, true, false);
+	FillAccounts(cAccountDB);
+	unsigned int unIndex = 0;
+	while (cState.KeepRunning()) {
+		// one block's worth of account updates, then the flush to the db
+		CAccountViewCache cCache(cAccountDB, true);
+		for (unsigned int i = 0; i < 100; ++i) {
+			CAccount cAccount = BenchAccount(unIndex);
+			cAccount.m_ullValues += i;
+			cCache.SetAccount(CUserID(cAccount.m_cKeyID), cAccount);
+			unIndex = (unIndex + 7919) % BENCH_ACCOUNT_COUNT;
+		}
+		cCache.Flush();
+	}
+}
+
+static vector<unsigned char> BenchScriptKey(unsigned int i) {
+	vector<unsigned char> vchKey(8, 'k');
+	memcpy(&vchKey[0], &i, sizeof(i));
+	return vchKey;
+}
+
+static void ScriptCacheGet(CBenchState &cState) {
+	CScriptDB cScriptDB(BENCH_DB_CACHE, true, false);
+	CRegID cAppId(10, 1);
+	vector<unsigned char> vchValue(32, 0x01);
+	{
+		CScriptDBViewCache cCache(cScriptDB, true);
+		for (unsigned int i = 0; i < BENCH_ACCOUNT_COUNT; ++i) {
+			CScriptDBOperLog cOperLog;
+			cCache.SetScriptData(cAppId, BenchScriptKey(i), vchValue, cOperLog);
+		}
+		bool bFlushed = cCache.Flush();
+		assert(bFlushed);
+	}
+	CScriptDBViewCache cCache(cScriptDB, true);
+	unsigned int unIndex = 0;
+	while (cState.KeepRunning()) {
+		cCache.GetScriptData(1000, cAppId, BenchScriptKey(unIndex), vchValue);
+		unIndex = (unIndex + 7919) % BENCH_ACCOUNT_COUNT;
+	}
+}
+
+static void ScriptCacheSetFlush(CBenchState &cState) {
+	CScriptDB cScriptDB(BENCH_DB_CACHE, true, false);
+	CRegID cAppId(10, 1);
+	vector<unsigned char> vchValue(32, 0x01);
+	unsigned int unIndex = 0;
+	while (cState.KeepRunning()) {
+		CScriptDBViewCache cCache(cScriptDB, true);
+		for (unsigned int i = 0; i < 100; ++i) {
+			CScriptDBOperLog cOperLog;
+			vchValue[0] = i;
+			cCache.SetScriptData(cAppId, BenchScriptKey(unIndex), vchValue, cOperLog);
+			unIndex = (unIndex + 7919) % BENCH_ACCOUNT_COUNT;
+		}
+		cCache.Flush();
+	}
+}
+
+BENCHMARK(AccountCacheGet, 100000);
+BENCHMARK(AccountCacheSetFlush, 200);
+BENCHMARK(ScriptCacheGet, 100000);
+BENCHMARK(ScriptCacheSetFlush, 200);
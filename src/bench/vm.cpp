@@ -0,0 +1,77 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "vm/vm8051.h"
+#include "vm/vmlua.h"
+#include "vm/vmrunevn.h"
+
+#include <assert.h>
+#include <string.h>
+#include <memory>
+
+static const uint64_t BENCH_MAX_STEP = 10000000;
+
+/**
+ * 8051 contract spinning in two nested DJNZ loops (200 x 250) before it sets the
+ * success flag at 0xEFFD and jumps to the 0x0008 exit vector:
+ *
+ * 0000: LJMP 0020
+ * 0020: MOV R7,#200
+ * 0022: MOV R6,#250
+ * 0024: DJNZ R6,0024
+ * 0026: DJNZ R7,0022
+ * 0028: MOV DPTR,#EFFD
+ * 002B: MOV A,#01
+ * 002D: MOVX @DPTR,A
+ * 002E: LJMP 0008
+ */
+static vector<unsigned char> Make8051Rom() {
+	vector<unsigned char> vchRom(0x20, 0x00);
+	vchRom[0] = 0x02;
+	vchRom[2] = 0x20;
+	const unsigned char arrchBody[] = { 0x7F, 0xC8, 0x7E, 0xFA, 0xDE, 0xFE, 0xDF, 0xFA, 0x90, 0xEF, 0xFD, 0x74, 0x01,
+			0xF0, 0x02, 0x00, 0x08 };
+	vchRom.insert(vchRom.end(), arrchBody, arrchBody + sizeof(arrchBody));
+	return vchRom;
+}
+
+static void Vm8051Run(CBenchState &cState) {
+	vector<unsigned char> vchRom = Make8051Rom();
+	vector<unsigned char> vchInput(16, 0x01);
+	CVmRunEvn cVmRunEvn;
+	while (cState.KeepRunning()) {
+		// the 8051 memory images are too large for the stack
+		std::shared_ptr<CVm8051> pVm = std::make_shared<CVm8051>(vchRom, vchInput);
+		int64_t llStep = pVm->run(BENCH_MAX_STEP, &cVmRunEvn);
+		assert(llStep > 0);
+	}
+}
+
+// compute-only Lua contract, the same shape of loops and table work as the sample apps
+static const char *pszLuaContract =
+		"local t = {}\n"
+		"for i = 1, 2000 do\n"
+		"  t[i] = (i * 7919) % 1000\n"
+		"end\n"
+		"local sum = 0\n"
+		"for i = 1, #t do\n"
+		"  sum = sum + t[i] * contract[(i % #contract) + 1]\n"
+		"end\n"
+		"local s = string.format(\"%d\", sum)\n";
+
+static void VmLuaRun(CBenchState &cState) {
+	vector<unsigned char> vchRom(pszLuaContract, pszLuaContract + strlen(pszLuaContract) + 1);
+	vector<unsigned char> vchInput(16, 0x01);
+	CVmRunEvn cVmRunEvn;
+	while (cState.KeepRunning()) {
+		std::shared_ptr<CVmlua> pVm = std::make_shared<CVmlua>(vchRom, vchInput);
+		int64_t llStep = pVm->run(BENCH_MAX_STEP, &cVmRunEvn);
+		assert(llStep >= 0);
+	}
+}
+
+BENCHMARK(Vm8051Run, 200);
+BENCHMARK(VmLuaRun, 200);
@@ -593,6 +593,7 @@ CBaseParams::CBaseParams() {
 	m_bReindex 				= false;
 	m_bBenchmark 			= false;
 	m_bTxIndex 				= false;
+	m_bBlockCompression 	= false;
 	m_nIntervalPos 			= 1;
 	m_nLogmaxsize 			= 100 * 1024 * 1024;//100M
 	m_nTxCacheHeight 		= 500;
@@ -95,6 +95,7 @@ class CBaseParams {
 		strTep += strprintf("m_bReindex:%d\n",m_bReindex);
 		strTep += strprintf("m_bBenchmark:%d\n",m_bBenchmark);
 		strTep += strprintf("m_bTxIndex:%d\n",m_bTxIndex);
+		strTep += strprintf("m_bBlockCompression:%d\n",m_bBlockCompression);
 		strTep += strprintf("m_llTimeBestReceived:%d\n",m_llTimeBestReceived);
 		strTep += strprintf("m_llpaytxfee:%d\n",m_llpaytxfee);
 		strTep += strprintf("m_llTargetSpacing:%d\n",m_llTargetSpacing);
@@ -180,6 +181,9 @@ class CBaseParams {
 	bool IsTxIndex() const {
 		return m_bTxIndex;
 	}
+	bool IsBlockCompression() const {
+		return m_bBlockCompression;
+	}
 	int64_t GetTargetSpacing() const {
 		return m_llTargetSpacing;
 	}
@@ -219,6 +223,9 @@ class CBaseParams {
 	void SetTxIndex(bool flag)const {
 		m_bTxIndex = flag;
 	}
+	void SetBlockCompression(bool flag)const {
+		m_bBlockCompression = flag;
+	}
 	void SetBestRecvTime(int64_t nTime)const {
 		m_llTimeBestReceived = nTime;
 	}
@@ -368,6 +375,7 @@ protected:
 	mutable bool m_bReindex;
 	mutable bool m_bBenchmark;
 	mutable bool m_bTxIndex;
+	mutable bool m_bBlockCompression;
 	mutable int64_t m_llTimeBestReceived;
 	mutable int64_t m_llpaytxfee;
 	int64_t m_llTargetSpacing;   								//һʱ
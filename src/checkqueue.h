@@ -160,9 +160,9 @@ template<typename T> class CCheckQueueControl {
 		m_pCheckQueue(pQueueIn), m_bDone(false) {
 		// passed queue is supposed to be unused, or NULL
 		if (m_pCheckQueue != NULL) {
-			assert(m_pCheckQueue->nTotal == m_pCheckQueue->nIdle);
-			assert(m_pCheckQueue->nTodo == 0);
-			assert(m_pCheckQueue->fAllOk == true);
+			assert(m_pCheckQueue->m_nTotal == m_pCheckQueue->m_nIdle);
+			assert(m_pCheckQueue->m_unTodo == 0);
+			assert(m_pCheckQueue->m_bAllOk == true);
 		}
 	}
 
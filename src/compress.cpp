@@ -0,0 +1,155 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "compress.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+
+static const size_t LZ4_MIN_MATCH 		= 4;
+static const size_t LZ4_MAX_OFFSET 		= 65535;
+static const size_t LZ4_LAST_LITERALS 	= 5; 	// the format ends with at least this many literals
+static const size_t LZ4_MATCH_LIMIT 	= 12; 	// and no match starts within this many bytes of the end
+static const int LZ4_HASH_BITS 			= 14;
+static const int LZ4_SKIP_TRIGGER 		= 6; 	// step up the search every 2^6 misses in a row
+
+static inline uint32_t Read32(const unsigned char *p) {
+	uint32_t unValue;
+	memcpy(&unValue, p, sizeof(unValue));
+	return unValue;
+}
+
+static inline uint32_t HashSequence(uint32_t unSequence) {
+	return (unSequence * 2654435761U) >> (32 - LZ4_HASH_BITS);
+}
+
+static void WriteLength(vector<unsigned char> &vchOut, size_t unLength) {
+	for (; unLength >= 255; unLength -= 255) {
+		vchOut.push_back(255);
+	}
+	vchOut.push_back((unsigned char) unLength);
+}
+
+// unMatch is 0 for the last sequence, which has literals only
+static void WriteSequence(vector<unsigned char> &vchOut, const unsigned char *pLiterals, size_t unLiterals,
+		size_t unOffset, size_t unMatch) {
+	size_t unMatchCode = unMatch > 0 ? unMatch - LZ4_MIN_MATCH : 0;
+	vchOut.push_back((unsigned char) ((min(unLiterals, (size_t) 15) << 4) | min(unMatchCode, (size_t) 15)));
+	if (unLiterals >= 15) {
+		WriteLength(vchOut, unLiterals - 15);
+	}
+	vchOut.insert(vchOut.end(), pLiterals, pLiterals + unLiterals);
+	if (unMatch > 0) {
+		vchOut.push_back((unsigned char) (unOffset & 0xff));
+		vchOut.push_back((unsigned char) (unOffset >> 8));
+		if (unMatchCode >= 15) {
+			WriteLength(vchOut, unMatchCode - 15);
+		}
+	}
+}
+
+void CompressLZ4(const unsigned char *pData, size_t unSize, vector<unsigned char> &vchOut) {
+	vchOut.reserve(vchOut.size() + unSize + unSize / 255 + 16);
+	size_t unAnchor = 0;
+	if (unSize > LZ4_MATCH_LIMIT) {
+		vector<uint32_t> vunTable(1 << LZ4_HASH_BITS, 0);
+		size_t unMatchEnd = unSize - LZ4_LAST_LITERALS;
+		size_t unPos = 1;
+		size_t unMisses = 0;
+		while (unPos < unSize - LZ4_MATCH_LIMIT) {
+			uint32_t unSequence = Read32(pData + unPos);
+			uint32_t &unEntry = vunTable[HashSequence(unSequence)];
+			size_t unRef = unEntry;
+			unEntry = (uint32_t) unPos;
+			if (unPos - unRef > LZ4_MAX_OFFSET || Read32(pData + unRef) != unSequence) {
+				unPos += 1 + (unMisses++ >> LZ4_SKIP_TRIGGER);
+				continue;
+			}
+			unMisses = 0;
+			size_t unEnd = unPos + LZ4_MIN_MATCH;
+			while (unEnd < unMatchEnd && pData[unEnd] == pData[unRef + unEnd - unPos]) {
+				++unEnd;
+			}
+			while (unPos > unAnchor && unRef > 0 && pData[unPos - 1] == pData[unRef - 1]) {
+				--unPos;
+				--unRef;
+			}
+			WriteSequence(vchOut, pData + unAnchor, unPos - unAnchor, unPos - unRef, unEnd - unPos);
+			unPos = unAnchor = unEnd;
+		}
+	}
+	WriteSequence(vchOut, pData + unAnchor, unSize - unAnchor, 0, 0);
+}
+
+static bool ReadLength(const unsigned char *&pIn, const unsigned char *pInEnd, size_t &unLength) {
+	unsigned char chByte;
+	do {
+		if (pIn == pInEnd) {
+			return false;
+		}
+		chByte = *pIn++;
+		unLength += chByte;
+	} while (chByte == 255);
+	return true;
+}
+
+bool DecompressLZ4(const unsigned char *pData, size_t unDataSize, unsigned char *pOut, size_t unSize,
+		bool bPrefix) {
+	const unsigned char *pIn = pData;
+	const unsigned char *pInEnd = pData + unDataSize;
+	size_t unOut = 0;
+	while (pIn < pInEnd) {
+		unsigned char chToken = *pIn++;
+		size_t unLiterals = chToken >> 4;
+		if (unLiterals == 15 && !ReadLength(pIn, pInEnd, unLiterals)) {
+			return false;
+		}
+		size_t unCopy = min(unLiterals, unSize - unOut);
+		if ((unCopy < unLiterals && !bPrefix) || unCopy > (size_t) (pInEnd - pIn)) {
+			return false;
+		}
+		memcpy(pOut + unOut, pIn, unCopy);
+		unOut += unCopy;
+		if (bPrefix && unOut == unSize) {
+			return true;
+		}
+		pIn += unLiterals;
+		if (pIn == pInEnd) {
+			break;
+		}
+		if (pInEnd - pIn < 2) {
+			return false;
+		}
+		size_t unOffset = pIn[0] | (pIn[1] << 8);
+		pIn += 2;
+		if (unOffset == 0 || unOffset > unOut) {
+			return false;
+		}
+		size_t unMatch = chToken & 15;
+		if (unMatch == 15 && !ReadLength(pIn, pInEnd, unMatch)) {
+			return false;
+		}
+		unMatch += LZ4_MIN_MATCH;
+		unCopy = min(unMatch, unSize - unOut);
+		if (unCopy < unMatch && !bPrefix) {
+			return false;
+		}
+		const unsigned char *pRef = pOut + unOut - unOffset;
+		if (unOffset >= unCopy) {
+			memcpy(pOut + unOut, pRef, unCopy);
+		} else {
+			// the copy overlaps what it produces, repeating the last unOffset bytes
+			for (size_t i = 0; i < unCopy; ++i) {
+				pOut[unOut + i] = pRef[i];
+			}
+		}
+		unOut += unCopy;
+		if (bPrefix && unOut == unSize) {
+			return true;
+		}
+	}
+	return unOut == unSize;
+}
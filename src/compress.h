@@ -0,0 +1,31 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DACRS_COMPRESS_H_
+#define DACRS_COMPRESS_H_
+
+#include <stddef.h>
+#include <vector>
+
+using namespace std;
+
+/**
+ * A fast LZ77 codec writing the LZ4 block format: sequences of literals, each followed by a copy
+ * of at least 4 bytes from the last 64KB of output, without framing or checksum. It trades ratio
+ * for speed, decompressing at memory speed, which suits data read back on every block lookup.
+ */
+
+/** Append the compressed form of the unSize bytes at pData to vchOut */
+void CompressLZ4(const unsigned char *pData, size_t unSize, vector<unsigned char> &vchOut);
+
+/**
+ * Decompress unDataSize bytes at pData into the unSize bytes at pOut. Fails on malformed input,
+ * copies from before the start of the output, or input that does not decode to exactly unSize
+ * bytes. With bPrefix only the first unSize bytes are decoded, the rest of the input, which may
+ * be cut short, is ignored.
+ */
+bool DecompressLZ4(const unsigned char *pData, size_t unDataSize, unsigned char *pOut, size_t unSize,
+		bool bPrefix = false);
+
+#endif // DACRS_COMPRESS_H_
@@ -0,0 +1,844 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "crypto/secp256k1.h"
+
+#ifdef USE_NATIVE_SECP256K1
+
+#include <string.h>
+
+namespace secp256k1 {
+
+namespace {
+
+typedef unsigned __int128 uint128_t;
+
+// p = 2^256 - 0x1000003D1
+const uint64_t g_kFieldP[4] = { 0xFFFFFFFEFFFFFC2FULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL };
+const uint64_t g_kFieldC = 0x1000003D1ULL;
+const uint64_t g_kFieldPMinus2[4] = { 0xFFFFFFFEFFFFFC2DULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL };
+const uint64_t g_kFieldSqrtExp[4] = { 0xFFFFFFFFBFFFFF0CULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0x3FFFFFFFFFFFFFFFULL };
+// cube root of unity in the field, (x, y) -> (beta * x, y) is multiplication by lambda
+const uint64_t g_kFieldBeta[4] = { 0xC1396C28719501EEULL, 0x9CF0497512F58995ULL, 0x6E64479EAC3434E9ULL, 0x7AE96A2B657C0710ULL };
+
+// group order n, 2^256 - n, n / 2, n - 2, p - n
+const uint64_t g_kOrderN[4] = { 0xBFD25E8CD0364141ULL, 0xBAAEDCE6AF48A03BULL, 0xFFFFFFFFFFFFFFFEULL, 0xFFFFFFFFFFFFFFFFULL };
+const uint64_t g_kOrderNC[3] = { 0x402DA1732FC9BEBFULL, 0x4551231950B75FC4ULL, 0x0000000000000001ULL };
+const uint64_t g_kOrderHalf[4] = { 0xDFE92F46681B20A0ULL, 0x5D576E7357A4501DULL, 0xFFFFFFFFFFFFFFFFULL, 0x7FFFFFFFFFFFFFFFULL };
+const uint64_t g_kOrderNMinus2[4] = { 0xBFD25E8CD036413FULL, 0xBAAEDCE6AF48A03BULL, 0xFFFFFFFFFFFFFFFEULL, 0xFFFFFFFFFFFFFFFFULL };
+const uint64_t g_kFieldPMinusN[4] = { 0x402DA1722FC9BAEEULL, 0x4551231950B75FC4ULL, 0x0000000000000001ULL, 0x0000000000000000ULL };
+
+// GLV decomposition constants
+const uint64_t g_kLambda[4] = { 0xDF02967C1B23BD72ULL, 0x122E22EA20816678ULL, 0xA5261C028812645AULL, 0x5363AD4CC05C30E0ULL };
+const uint64_t g_kMinusB1[4] = { 0x6F547FA90ABFE4C3ULL, 0xE4437ED6010E8828ULL, 0x0000000000000000ULL, 0x0000000000000000ULL };
+const uint64_t g_kMinusB2[4] = { 0xD765CDA83DB1562CULL, 0x8A280AC50774346DULL, 0xFFFFFFFFFFFFFFFEULL, 0xFFFFFFFFFFFFFFFFULL };
+const uint64_t g_kG1[4] = { 0xE893209A45DBB031ULL, 0x3DAA8A1471E8CA7FULL, 0xE86C90E49284EB15ULL, 0x3086D221A7D46BCDULL };
+const uint64_t g_kG2[4] = { 0x1571B4AE8AC47F71ULL, 0x221208AC9DF506C6ULL, 0x6F547FA90ABFE4C4ULL, 0xE4437ED6010E8828ULL };
+
+// generator
+const uint64_t g_kGx[4] = { 0x59F2815B16F81798ULL, 0x029BFCDB2DCE28D9ULL, 0x55A06295CE870B07ULL, 0x79BE667EF9DCBBACULL };
+const uint64_t g_kGy[4] = { 0x9C47D08FFB10D4B8ULL, 0xFD17B448A6855419ULL, 0x5DA4FBFC0E1108A8ULL, 0x483ADA7726A3C465ULL };
+
+const int g_kWindowA = 5;								// wNAF window for u2*Q
+const int g_kWindowATableSize = 1 << (g_kWindowA - 2);	// odd multiples 1P .. 15P
+
+/////////////////////////////////////////////////////////////////////////////
+// 256 bit helpers, limbs are little endian
+
+int Cmp4(const uint64_t *a, const uint64_t *b) {
+	for (int i = 3; i >= 0; --i) {
+		if (a[i] != b[i]) {
+			return a[i] < b[i] ? -1 : 1;
+		}
+	}
+	return 0;
+}
+
+bool Add4(uint64_t *r, const uint64_t *a, const uint64_t *b) {
+	uint128_t acc = 0;
+	for (int i = 0; i < 4; ++i) {
+		acc += (uint128_t) a[i] + b[i];
+		r[i] = (uint64_t) acc;
+		acc >>= 64;
+	}
+	return acc != 0;
+}
+
+bool Sub4(uint64_t *r, const uint64_t *a, const uint64_t *b) {
+	uint64_t ullBorrow = 0;
+	for (int i = 0; i < 4; ++i) {
+		uint64_t ullDiff = a[i] - b[i];
+		uint64_t ullNewBorrow = (a[i] < b[i]) || (ullDiff < ullBorrow);
+		r[i] = ullDiff - ullBorrow;
+		ullBorrow = ullNewBorrow;
+	}
+	return ullBorrow != 0;
+}
+
+void AddSmall4(uint64_t *r, uint64_t ullValue) {
+	uint128_t acc = (uint128_t) r[0] + ullValue;
+	r[0] = (uint64_t) acc;
+	for (int i = 1; i < 4 && (acc >> 64); ++i) {
+		acc = (uint128_t) r[i] + 1;
+		r[i] = (uint64_t) acc;
+	}
+}
+
+void SubSmall4(uint64_t *r, uint64_t ullValue) {
+	uint64_t ullBorrow = r[0] < ullValue;
+	r[0] -= ullValue;
+	for (int i = 1; i < 4 && ullBorrow; ++i) {
+		ullBorrow = r[i] == 0;
+		r[i] -= 1;
+	}
+}
+
+bool IsZero4(const uint64_t *a) {
+	return (a[0] | a[1] | a[2] | a[3]) == 0;
+}
+
+void Mul4(uint64_t *r, const uint64_t *a, const uint64_t *b) {
+	memset(r, 0, 8 * sizeof(uint64_t));
+	for (int i = 0; i < 4; ++i) {
+		uint128_t carry = 0;
+		for (int j = 0; j < 4; ++j) {
+			uint128_t acc = (uint128_t) a[i] * b[j] + r[i + j] + carry;
+			r[i + j] = (uint64_t) acc;
+			carry = acc >> 64;
+		}
+		r[i + 4] = (uint64_t) carry;
+	}
+}
+
+void Set4B32(uint64_t *r, const unsigned char *pchInput) {
+	for (int i = 0; i < 4; ++i) {
+		uint64_t ullLimb = 0;
+		for (int j = 0; j < 8; ++j) {
+			ullLimb = (ullLimb << 8) | pchInput[(3 - i) * 8 + j];
+		}
+		r[i] = ullLimb;
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// field elements, always fully reduced modulo p
+
+struct ST_Fe {
+	uint64_t n[4];
+};
+
+void FeSet(ST_Fe &r, const uint64_t *a) {
+	memcpy(r.n, a, sizeof(r.n));
+}
+
+bool FeIsZero(const ST_Fe &a) {
+	return IsZero4(a.n);
+}
+
+bool FeEqual(const ST_Fe &a, const ST_Fe &b) {
+	return Cmp4(a.n, b.n) == 0;
+}
+
+bool FeIsOdd(const ST_Fe &a) {
+	return a.n[0] & 1;
+}
+
+void FeAdd(ST_Fe &r, const ST_Fe &a, const ST_Fe &b) {
+	uint64_t t[4];
+	if (Add4(t, a.n, b.n)) {
+		// a + b - 2^256 < p - C, adding 2^256 mod p cannot carry again
+		AddSmall4(t, g_kFieldC);
+	}
+	if (Cmp4(t, g_kFieldP) >= 0) {
+		Sub4(t, t, g_kFieldP);
+	}
+	memcpy(r.n, t, sizeof(t));
+}
+
+void FeSub(ST_Fe &r, const ST_Fe &a, const ST_Fe &b) {
+	uint64_t t[4];
+	if (Sub4(t, a.n, b.n)) {
+		// t = a - b + 2^256, a - b + p = t - C
+		SubSmall4(t, g_kFieldC);
+	}
+	memcpy(r.n, t, sizeof(t));
+}
+
+void FeNeg(ST_Fe &r, const ST_Fe &a) {
+	if (FeIsZero(a)) {
+		r = a;
+		return;
+	}
+	Sub4(r.n, g_kFieldP, a.n);
+}
+
+void FeMul(ST_Fe &r, const ST_Fe &a, const ST_Fe &b) {
+	uint64_t m[8];
+	Mul4(m, a.n, b.n);
+	// m = L + H * 2^256 = L + H * C (mod p)
+	uint64_t t[4];
+	uint128_t acc = 0;
+	for (int i = 0; i < 4; ++i) {
+		acc += (uint128_t) m[4 + i] * g_kFieldC + m[i];
+		t[i] = (uint64_t) acc;
+		acc >>= 64;
+	}
+	acc = (uint128_t) ((uint64_t) acc) * g_kFieldC + t[0];
+	t[0] = (uint64_t) acc;
+	acc >>= 64;
+	for (int i = 1; i < 4; ++i) {
+		acc += t[i];
+		t[i] = (uint64_t) acc;
+		acc >>= 64;
+	}
+	if (acc) {
+		// wrapped past 2^256, the remainder is tiny so this cannot carry
+		AddSmall4(t, g_kFieldC);
+	}
+	if (Cmp4(t, g_kFieldP) >= 0) {
+		Sub4(t, t, g_kFieldP);
+	}
+	memcpy(r.n, t, sizeof(t));
+}
+
+void FeSqr(ST_Fe &r, const ST_Fe &a) {
+	FeMul(r, a, a);
+}
+
+void FeMulInt(ST_Fe &r, const ST_Fe &a, int nFactor) {
+	ST_Fe t = a;
+	for (int i = 1; i < nFactor; ++i) {
+		FeAdd(t, t, a);
+	}
+	r = t;
+}
+
+void FePow(ST_Fe &r, const ST_Fe &a, const uint64_t *pExp) {
+	ST_Fe t;
+	memset(t.n, 0, sizeof(t.n));
+	t.n[0] = 1;
+	for (int i = 255; i >= 0; --i) {
+		FeSqr(t, t);
+		if ((pExp[i >> 6] >> (i & 63)) & 1) {
+			FeMul(t, t, a);
+		}
+	}
+	r = t;
+}
+
+void FeInv(ST_Fe &r, const ST_Fe &a) {
+	FePow(r, a, g_kFieldPMinus2);
+}
+
+// p = 3 mod 4, so a^((p+1)/4) is a square root whenever one exists
+bool FeSqrt(ST_Fe &r, const ST_Fe &a) {
+	ST_Fe t, check;
+	FePow(t, a, g_kFieldSqrtExp);
+	FeSqr(check, t);
+	if (!FeEqual(check, a)) {
+		return false;
+	}
+	r = t;
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// scalars modulo the group order
+
+struct ST_Scalar {
+	uint64_t d[4];
+};
+
+void ScalarSet(ST_Scalar &r, const uint64_t *a) {
+	memcpy(r.d, a, sizeof(r.d));
+}
+
+bool ScalarIsZero(const ST_Scalar &a) {
+	return IsZero4(a.d);
+}
+
+bool ScalarIsHigh(const ST_Scalar &a) {
+	return Cmp4(a.d, g_kOrderHalf) > 0;
+}
+
+void ScalarReduce512(ST_Scalar &r, const uint64_t *m) {
+	uint64_t x[8];
+	memcpy(x, m, sizeof(x));
+	// fold the high half with 2^256 = 2^256 - n (mod n) until it vanishes
+	while (x[4] | x[5] | x[6] | x[7]) {
+		uint64_t y[8];
+		memset(y, 0, sizeof(y));
+		for (int i = 0; i < 4; ++i) {
+			uint128_t carry = 0;
+			for (int j = 0; j < 3; ++j) {
+				uint128_t acc = (uint128_t) x[4 + i] * g_kOrderNC[j] + y[i + j] + carry;
+				y[i + j] = (uint64_t) acc;
+				carry = acc >> 64;
+			}
+			for (int k = i + 3; k < 8 && carry; ++k) {
+				uint128_t acc = (uint128_t) y[k] + carry;
+				y[k] = (uint64_t) acc;
+				carry = acc >> 64;
+			}
+		}
+		uint128_t carry = 0;
+		for (int k = 0; k < 8; ++k) {
+			uint128_t acc = (uint128_t) y[k] + (k < 4 ? x[k] : 0) + carry;
+			y[k] = (uint64_t) acc;
+			carry = acc >> 64;
+		}
+		memcpy(x, y, sizeof(x));
+	}
+	while (Cmp4(x, g_kOrderN) >= 0) {
+		Sub4(x, x, g_kOrderN);
+	}
+	memcpy(r.d, x, sizeof(r.d));
+}
+
+// returns true if the 256 bit input was not below n
+bool ScalarSetB32(ST_Scalar &r, const unsigned char *pchInput) {
+	Set4B32(r.d, pchInput);
+	if (Cmp4(r.d, g_kOrderN) >= 0) {
+		Sub4(r.d, r.d, g_kOrderN);
+		return true;
+	}
+	return false;
+}
+
+void ScalarAdd(ST_Scalar &r, const ST_Scalar &a, const ST_Scalar &b) {
+	uint64_t t[4];
+	bool bCarry = Add4(t, a.d, b.d);
+	if (bCarry || Cmp4(t, g_kOrderN) >= 0) {
+		Sub4(t, t, g_kOrderN);
+	}
+	memcpy(r.d, t, sizeof(t));
+}
+
+void ScalarNeg(ST_Scalar &r, const ST_Scalar &a) {
+	if (ScalarIsZero(a)) {
+		r = a;
+		return;
+	}
+	Sub4(r.d, g_kOrderN, a.d);
+}
+
+void ScalarMul(ST_Scalar &r, const ST_Scalar &a, const ST_Scalar &b) {
+	uint64_t m[8];
+	Mul4(m, a.d, b.d);
+	ScalarReduce512(r, m);
+}
+
+void ScalarInv(ST_Scalar &r, const ST_Scalar &a) {
+	ST_Scalar t;
+	memset(t.d, 0, sizeof(t.d));
+	t.d[0] = 1;
+	for (int i = 255; i >= 0; --i) {
+		ScalarMul(t, t, t);
+		if ((g_kOrderNMinus2[i >> 6] >> (i & 63)) & 1) {
+			ScalarMul(t, t, a);
+		}
+	}
+	r = t;
+}
+
+// round(a * b / 2^384), b is one of the GLV g1/g2 constants
+void ScalarMulShift384(ST_Scalar &r, const ST_Scalar &a, const uint64_t *b) {
+	uint64_t m[8];
+	Mul4(m, a.d, b);
+	uint64_t ullRound = m[5] >> 63;
+	r.d[0] = m[6];
+	r.d[1] = m[7];
+	r.d[2] = 0;
+	r.d[3] = 0;
+	uint128_t acc = (uint128_t) r.d[0] + ullRound;
+	r.d[0] = (uint64_t) acc;
+	acc = (uint128_t) r.d[1] + (uint64_t) (acc >> 64);
+	r.d[1] = (uint64_t) acc;
+	r.d[2] = (uint64_t) (acc >> 64);
+}
+
+// k = k1 + k2 * lambda (mod n) with |k1|, |k2| < 2^128
+void ScalarSplitLambda(ST_Scalar &k1, ST_Scalar &k2, const ST_Scalar &k) {
+	ST_Scalar c1, c2, cMinusB1, cMinusB2, cLambda;
+	ScalarSet(cMinusB1, g_kMinusB1);
+	ScalarSet(cMinusB2, g_kMinusB2);
+	ScalarSet(cLambda, g_kLambda);
+	ScalarMulShift384(c1, k, g_kG1);
+	ScalarMulShift384(c2, k, g_kG2);
+	ScalarMul(c1, c1, cMinusB1);
+	ScalarMul(c2, c2, cMinusB2);
+	ScalarAdd(k2, c1, c2);
+	ScalarMul(k1, k2, cLambda);
+	ScalarNeg(k1, k1);
+	ScalarAdd(k1, k1, k);
+}
+
+int ScalarGetBits(const ST_Scalar &a, int nOffset, int nCount) {
+	int nLimb = nOffset >> 6;
+	int nShift = nOffset & 63;
+	uint64_t ullValue = a.d[nLimb] >> nShift;
+	if (nShift + nCount > 64 && nLimb < 3) {
+		ullValue |= a.d[nLimb + 1] << (64 - nShift);
+	}
+	return (int) (ullValue & ((1ULL << nCount) - 1));
+}
+
+// width-w non adjacent form, returns the number of digits used
+int ScalarToWNAF(int *pWnaf, const ST_Scalar &a, int nWindow) {
+	memset(pWnaf, 0, 256 * sizeof(int));
+	int nBit = 0;
+	int nCarry = 0;
+	int nLast = -1;
+	while (nBit < 256) {
+		if (ScalarGetBits(a, nBit, 1) == nCarry) {
+			++nBit;
+			continue;
+		}
+		int nNow = nWindow;
+		if (nNow > 256 - nBit) {
+			nNow = 256 - nBit;
+		}
+		int nWord = ScalarGetBits(a, nBit, nNow) + nCarry;
+		nCarry = (nWord >> (nWindow - 1)) & 1;
+		nWord -= nCarry << nWindow;
+		pWnaf[nBit] = nWord;
+		nLast = nBit;
+		nBit += nNow;
+	}
+	return nLast + 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// group elements
+
+struct ST_Ge {
+	ST_Fe x;
+	ST_Fe y;
+	bool bInfinity;
+};
+
+struct ST_Gej {
+	ST_Fe x;
+	ST_Fe y;
+	ST_Fe z;
+	bool bInfinity;
+};
+
+void GejSetInfinity(ST_Gej &r) {
+	memset(&r, 0, sizeof(r));
+	r.bInfinity = true;
+}
+
+void GejSetGe(ST_Gej &r, const ST_Ge &a) {
+	r.x = a.x;
+	r.y = a.y;
+	memset(r.z.n, 0, sizeof(r.z.n));
+	r.z.n[0] = 1;
+	r.bInfinity = a.bInfinity;
+}
+
+void GeSetGej(ST_Ge &r, const ST_Gej &a) {
+	if (a.bInfinity) {
+		memset(&r, 0, sizeof(r));
+		r.bInfinity = true;
+		return;
+	}
+	ST_Fe zinv, zinv2, zinv3;
+	FeInv(zinv, a.z);
+	FeSqr(zinv2, zinv);
+	FeMul(zinv3, zinv2, zinv);
+	FeMul(r.x, a.x, zinv2);
+	FeMul(r.y, a.y, zinv3);
+	r.bInfinity = false;
+}
+
+bool GeIsValid(const ST_Ge &a) {
+	// y^2 = x^3 + 7
+	ST_Fe y2, x3, seven;
+	FeSqr(y2, a.y);
+	FeSqr(x3, a.x);
+	FeMul(x3, x3, a.x);
+	memset(seven.n, 0, sizeof(seven.n));
+	seven.n[0] = 7;
+	FeAdd(x3, x3, seven);
+	return FeEqual(y2, x3);
+}
+
+void GejDouble(ST_Gej &r, const ST_Gej &a) {
+	if (a.bInfinity || FeIsZero(a.y)) {
+		GejSetInfinity(r);
+		return;
+	}
+	ST_Fe A, B, C, D, E, F, t;
+	FeSqr(A, a.x);
+	FeSqr(B, a.y);
+	FeSqr(C, B);
+	FeAdd(t, a.x, B);
+	FeSqr(t, t);
+	FeSub(t, t, A);
+	FeSub(t, t, C);
+	FeAdd(D, t, t);
+	FeMulInt(E, A, 3);
+	FeSqr(F, E);
+	ST_Fe z3;
+	FeMul(z3, a.y, a.z);
+	FeAdd(z3, z3, z3);
+	ST_Fe x3;
+	FeSub(x3, F, D);
+	FeSub(x3, x3, D);
+	ST_Fe y3;
+	FeSub(t, D, x3);
+	FeMul(y3, E, t);
+	FeMulInt(t, C, 8);
+	FeSub(y3, y3, t);
+	r.x = x3;
+	r.y = y3;
+	r.z = z3;
+	r.bInfinity = false;
+}
+
+void GejAddGe(ST_Gej &r, const ST_Gej &a, const ST_Ge &b) {
+	if (b.bInfinity) {
+		r = a;
+		return;
+	}
+	if (a.bInfinity) {
+		GejSetGe(r, b);
+		return;
+	}
+	ST_Fe z1z1, u2, s2, h, rr;
+	FeSqr(z1z1, a.z);
+	FeMul(u2, b.x, z1z1);
+	FeMul(s2, b.y, z1z1);
+	FeMul(s2, s2, a.z);
+	FeSub(h, u2, a.x);
+	FeSub(rr, s2, a.y);
+	if (FeIsZero(h)) {
+		if (FeIsZero(rr)) {
+			GejDouble(r, a);
+		} else {
+			GejSetInfinity(r);
+		}
+		return;
+	}
+	ST_Fe h2, h3, v, x3, y3, z3, t;
+	FeSqr(h2, h);
+	FeMul(h3, h2, h);
+	FeMul(v, a.x, h2);
+	FeSqr(x3, rr);
+	FeSub(x3, x3, h3);
+	FeSub(x3, x3, v);
+	FeSub(x3, x3, v);
+	FeSub(t, v, x3);
+	FeMul(y3, rr, t);
+	FeMul(t, a.y, h3);
+	FeSub(y3, y3, t);
+	FeMul(z3, a.z, h);
+	r.x = x3;
+	r.y = y3;
+	r.z = z3;
+	r.bInfinity = false;
+}
+
+void GejAdd(ST_Gej &r, const ST_Gej &a, const ST_Gej &b) {
+	if (b.bInfinity) {
+		r = a;
+		return;
+	}
+	if (a.bInfinity) {
+		r = b;
+		return;
+	}
+	ST_Fe z1z1, z2z2, u1, u2, s1, s2, h, rr;
+	FeSqr(z1z1, a.z);
+	FeSqr(z2z2, b.z);
+	FeMul(u1, a.x, z2z2);
+	FeMul(u2, b.x, z1z1);
+	FeMul(s1, a.y, z2z2);
+	FeMul(s1, s1, b.z);
+	FeMul(s2, b.y, z1z1);
+	FeMul(s2, s2, a.z);
+	FeSub(h, u2, u1);
+	FeSub(rr, s2, s1);
+	if (FeIsZero(h)) {
+		if (FeIsZero(rr)) {
+			GejDouble(r, a);
+		} else {
+			GejSetInfinity(r);
+		}
+		return;
+	}
+	ST_Fe h2, h3, v, x3, y3, z3, t;
+	FeSqr(h2, h);
+	FeMul(h3, h2, h);
+	FeMul(v, u1, h2);
+	FeSqr(x3, rr);
+	FeSub(x3, x3, h3);
+	FeSub(x3, x3, v);
+	FeSub(x3, x3, v);
+	FeSub(t, v, x3);
+	FeMul(y3, rr, t);
+	FeMul(t, s1, h3);
+	FeSub(y3, y3, t);
+	FeMul(z3, a.z, b.z);
+	FeMul(z3, z3, h);
+	r.x = x3;
+	r.y = y3;
+	r.z = z3;
+	r.bInfinity = false;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// multiplication
+
+/** m_table[i][j] = j * 16^i * G in affine form, so u*G needs 64 additions and no doublings */
+class CGeneratorTable {
+ public:
+	CGeneratorTable() {
+		ST_Gej cBase;
+		FeSet(cBase.x, g_kGx);
+		FeSet(cBase.y, g_kGy);
+		memset(cBase.z.n, 0, sizeof(cBase.z.n));
+		cBase.z.n[0] = 1;
+		cBase.bInfinity = false;
+		for (int i = 0; i < 64; ++i) {
+			memset(&m_table[i][0], 0, sizeof(ST_Ge));
+			m_table[i][0].bInfinity = true;
+			ST_Gej cAcc = cBase;
+			GeSetGej(m_table[i][1], cAcc);
+			for (int j = 2; j < 16; ++j) {
+				GejAdd(cAcc, cAcc, cBase);
+				GeSetGej(m_table[i][j], cAcc);
+			}
+			for (int j = 0; j < 4; ++j) {
+				GejDouble(cBase, cBase);
+			}
+		}
+	}
+
+	ST_Ge m_table[64][16];
+};
+
+const CGeneratorTable &GetGeneratorTable() {
+	static const CGeneratorTable s_cTable;
+	return s_cTable;
+}
+
+void EcmultGen(ST_Gej &r, const ST_Scalar &u) {
+	const CGeneratorTable &cTable = GetGeneratorTable();
+	GejSetInfinity(r);
+	for (int i = 0; i < 64; ++i) {
+		int nIndex = ScalarGetBits(u, i * 4, 4);
+		if (nIndex) {
+			GejAddGe(r, r, cTable.m_table[i][nIndex]);
+		}
+	}
+}
+
+void EcmultAddWNAF(ST_Gej &r, const ST_Gej *pTable, int nDigit) {
+	if (nDigit > 0) {
+		GejAdd(r, r, pTable[(nDigit - 1) / 2]);
+	} else if (nDigit < 0) {
+		ST_Gej cNeg = pTable[(-nDigit - 1) / 2];
+		FeNeg(cNeg.y, cNeg.y);
+		GejAdd(r, r, cNeg);
+	}
+}
+
+// r = u * Q, with u split into two 128 bit halves over Q and lambda * Q
+void EcmultGLV(ST_Gej &r, const ST_Ge &cPoint, const ST_Scalar &u) {
+	ST_Scalar k1, k2;
+	ScalarSplitLambda(k1, k2, u);
+	bool bNeg1 = ScalarIsHigh(k1);
+	bool bNeg2 = ScalarIsHigh(k2);
+	if (bNeg1) {
+		ScalarNeg(k1, k1);
+	}
+	if (bNeg2) {
+		ScalarNeg(k2, k2);
+	}
+
+	// odd multiples of +-Q, and the same multiples mapped through the endomorphism
+	ST_Gej table1[g_kWindowATableSize];
+	ST_Gej table2[g_kWindowATableSize];
+	ST_Gej cDouble;
+	GejSetGe(table1[0], cPoint);
+	if (bNeg1) {
+		FeNeg(table1[0].y, table1[0].y);
+	}
+	GejDouble(cDouble, table1[0]);
+	for (int i = 1; i < g_kWindowATableSize; ++i) {
+		GejAdd(table1[i], table1[i - 1], cDouble);
+	}
+	ST_Fe cBeta;
+	FeSet(cBeta, g_kFieldBeta);
+	for (int i = 0; i < g_kWindowATableSize; ++i) {
+		table2[i] = table1[i];
+		FeMul(table2[i].x, table2[i].x, cBeta);
+		if (bNeg1 != bNeg2) {
+			FeNeg(table2[i].y, table2[i].y);
+		}
+	}
+
+	int wnaf1[256];
+	int wnaf2[256];
+	int nBits1 = ScalarToWNAF(wnaf1, k1, g_kWindowA);
+	int nBits2 = ScalarToWNAF(wnaf2, k2, g_kWindowA);
+	int nBits = nBits1 > nBits2 ? nBits1 : nBits2;
+
+	GejSetInfinity(r);
+	for (int i = nBits - 1; i >= 0; --i) {
+		GejDouble(r, r);
+		EcmultAddWNAF(r, table1, wnaf1[i]);
+		EcmultAddWNAF(r, table2, wnaf2[i]);
+	}
+}
+
+bool ParseDERInteger(const unsigned char *pchInput, size_t unSize, uint64_t *r) {
+	if (unSize == 0 || unSize > 33) {
+		return false;
+	}
+	// negative numbers and superfluous padding are not strict DER
+	if (pchInput[0] & 0x80) {
+		return false;
+	}
+	if (unSize > 1 && pchInput[0] == 0 && !(pchInput[1] & 0x80)) {
+		return false;
+	}
+	// 33 bytes only leave room for the sign pad of a value with the top bit set,
+	// any other leading byte makes the value at least 2^256 and OpenSSL rejects it
+	if (unSize == 33) {
+		if (pchInput[0] != 0) {
+			return false;
+		}
+		++pchInput;
+		--unSize;
+	}
+	unsigned char chBuf[32];
+	memset(chBuf, 0, sizeof(chBuf));
+	memcpy(chBuf + 32 - unSize, pchInput, unSize);
+	Set4B32(r, chBuf);
+	return !IsZero4(r) && Cmp4(r, g_kOrderN) < 0;
+}
+
+}
+
+void InitContext() {
+	GetGeneratorTable();
+}
+
+bool ParsePubKey(const unsigned char *pchInput, size_t unSize, CPoint &cPoint) {
+	ST_Ge cGe;
+	if (unSize == 33 && (pchInput[0] == 0x02 || pchInput[0] == 0x03)) {
+		Set4B32(cGe.x.n, pchInput + 1);
+		if (Cmp4(cGe.x.n, g_kFieldP) >= 0) {
+			return false;
+		}
+		ST_Fe x3, seven;
+		FeSqr(x3, cGe.x);
+		FeMul(x3, x3, cGe.x);
+		memset(seven.n, 0, sizeof(seven.n));
+		seven.n[0] = 7;
+		FeAdd(x3, x3, seven);
+		if (!FeSqrt(cGe.y, x3)) {
+			return false;
+		}
+		if (FeIsOdd(cGe.y) != (pchInput[0] == 0x03)) {
+			FeNeg(cGe.y, cGe.y);
+		}
+	} else if (unSize == 65 && pchInput[0] == 0x04) {
+		Set4B32(cGe.x.n, pchInput + 1);
+		Set4B32(cGe.y.n, pchInput + 33);
+		if (Cmp4(cGe.x.n, g_kFieldP) >= 0 || Cmp4(cGe.y.n, g_kFieldP) >= 0) {
+			return false;
+		}
+		if (!GeIsValid(cGe)) {
+			return false;
+		}
+	} else {
+		return false;
+	}
+	memcpy(cPoint.m_ullX, cGe.x.n, sizeof(cPoint.m_ullX));
+	memcpy(cPoint.m_ullY, cGe.y.n, sizeof(cPoint.m_ullY));
+	return true;
+}
+
+bool ParseSignatureDER(const unsigned char *pchInput, size_t unSize, CSignature &cSig) {
+	// 0x30 [total-length] 0x02 [R-length] [R] 0x02 [S-length] [S]
+	if (unSize < 8 || unSize > 72) {
+		return false;
+	}
+	if (pchInput[0] != 0x30 || pchInput[1] != unSize - 2) {
+		return false;
+	}
+	if (pchInput[2] != 0x02) {
+		return false;
+	}
+	size_t unLenR = pchInput[3];
+	if (5 + unLenR >= unSize) {
+		return false;
+	}
+	if (pchInput[4 + unLenR] != 0x02) {
+		return false;
+	}
+	size_t unLenS = pchInput[5 + unLenR];
+	if (6 + unLenR + unLenS != unSize) {
+		return false;
+	}
+	if (!ParseDERInteger(pchInput + 4, unLenR, cSig.m_ullR)) {
+		return false;
+	}
+	if (!ParseDERInteger(pchInput + 6 + unLenR, unLenS, cSig.m_ullS)) {
+		return false;
+	}
+	return true;
+}
+
+bool Verify(const unsigned char *pchHash, const CSignature &cSig, const CPoint &cPoint) {
+	ST_Scalar r, s, e, sinv, u1, u2;
+	ScalarSet(r, cSig.m_ullR);
+	ScalarSet(s, cSig.m_ullS);
+	if (ScalarIsZero(r) || ScalarIsZero(s)) {
+		return false;
+	}
+	ScalarSetB32(e, pchHash);
+	ScalarInv(sinv, s);
+	ScalarMul(u1, e, sinv);
+	ScalarMul(u2, r, sinv);
+
+	ST_Ge cGe;
+	FeSet(cGe.x, cPoint.m_ullX);
+	FeSet(cGe.y, cPoint.m_ullY);
+	cGe.bInfinity = false;
+
+	ST_Gej cR, cG;
+	EcmultGLV(cR, cGe, u2);
+	EcmultGen(cG, u1);
+	GejAdd(cR, cR, cG);
+	if (cR.bInfinity) {
+		return false;
+	}
+
+	// compare x(R) mod n with r without leaving jacobian coordinates: r * Z^2 == X
+	ST_Fe xr, z2, t;
+	FeSet(xr, r.d);
+	FeSqr(z2, cR.z);
+	FeMul(t, xr, z2);
+	if (FeEqual(t, cR.x)) {
+		return true;
+	}
+	// x(R) may also be r + n when that is still below p
+	if (Cmp4(r.d, g_kFieldPMinusN) >= 0) {
+		return false;
+	}
+	ST_Fe n;
+	FeSet(n, g_kOrderN);
+	FeAdd(xr, xr, n);
+	FeMul(t, xr, z2);
+	return FeEqual(t, cR.x);
+}
+
+}
+
+#endif
@@ -0,0 +1,66 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef _DACRS_CRYPTO_SECP256K1_H
+#define _DACRS_CRYPTO_SECP256K1_H
+
+#if defined(HAVE_CONFIG_H)
+#include "dacrs-config.h"
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Native ECDSA verification over secp256k1.
+ *
+ * Field elements are kept as four 64 bit limbs reduced modulo p = 2^256 - 0x1000003D1,
+ * u1*G uses a precomputed table of the generator (64 windows of 4 bits, no doublings)
+ * and u2*Q is split with the GLV endomorphism into two 128 bit halves evaluated by
+ * interleaved wNAF. Only verification lives here, signing stays on OpenSSL.
+ *
+ * The limb arithmetic needs unsigned __int128. Without it (32 bit targets, MSVC)
+ * USE_NATIVE_SECP256K1 stays undefined and every signature is verified by OpenSSL.
+ */
+#if defined(HAVE___INT128)
+#define USE_NATIVE_SECP256K1 1
+#endif
+
+#ifdef USE_NATIVE_SECP256K1
+namespace secp256k1 {
+
+/** Affine point of a parsed public key, coordinates as little endian 64 bit limbs */
+class CPoint {
+ public:
+	uint64_t m_ullX[4];
+	uint64_t m_ullY[4];
+};
+
+/** r and s of a DER signature, both in [1, n-1] */
+class CSignature {
+ public:
+	uint64_t m_ullR[4];
+	uint64_t m_ullS[4];
+};
+
+/** Build the generator table, it is otherwise built on first use */
+void InitContext();
+
+/** Parse a compressed (33 bytes) or uncompressed (65 bytes) public key, false if it is not on the curve */
+bool ParsePubKey(const unsigned char *pchInput, size_t unSize, CPoint &cPoint);
+
+/**
+ * Parse a strictly DER encoded signature. Encodings OpenSSL would accept after
+ * re-serialization (padding, trailing data, negative numbers) are rejected, callers
+ * hand those to OpenSSL so that both verifiers accept the same set of signatures.
+ */
+bool ParseSignatureDER(const unsigned char *pchInput, size_t unSize, CSignature &cSig);
+
+/** Verify sig over the 32 byte digest, the digest is read big endian like OpenSSL's ECDSA_verify */
+bool Verify(const unsigned char *pchHash, const CSignature &cSig, const CPoint &cPoint);
+
+}
+#endif
+
+#endif
@@ -10,7 +10,7 @@
 #include "noui.h"
 #include "ui_interface.h"
 #include "util.h"
-#include "cuiserver.h"
+#include "eventserver.h"
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem.hpp>
 
@@ -44,7 +44,7 @@ void DetectShutdownThread(boost::thread_group* threadGroup) {
 		threadGroup->join_all();
 	}
 	g_cUIInterface.NotifyMessage("server closed");
-	CUIServer::StopServer();
+	g_cEventServer.Stop();
 }
 
 //////////////////////////////////////////////////////////////////////////////
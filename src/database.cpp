@@ -4,6 +4,7 @@
 #include "core.h"
 #include "main.h"
 #include "chainparams.h"
+#include "memusage.h"
 #include "vm/vmrunevn.h"
 #include <algorithm>
 
@@ -141,7 +142,50 @@ uint64_t CAccountViewBacked::TraverseAccount() {
 }
 
 CAccountViewCache::CAccountViewCache(CAccountView &cAccountView, bool bDummy) :
-		CAccountViewBacked(cAccountView), m_cHashBlock(uint256()) {
+		CAccountViewBacked(cAccountView), m_cHashBlock(uint256()), m_unCacheBytes(0) {
+}
+
+static size_t AccountEntryUsage() {
+	// the account's regid keeps its 6 bytes on the heap
+	return memusage::MapEntryUsage<CKeyID, CAccount>() + memusage::MallocUsage(6);
+}
+
+static size_t KeyIdEntryUsage(const vector<unsigned char> &vchAccountId) {
+	return memusage::MapEntryUsage<vector<unsigned char>, CKeyID>() + memusage::DynamicUsage(vchAccountId);
+}
+
+void CAccountViewCache::SetCacheAccount(const CKeyID &cKeyId, const CAccount &cAccount) {
+	auto ret = m_mapCacheAccounts.insert(make_pair(cKeyId, cAccount));
+	if (ret.second) {
+		m_unCacheBytes += AccountEntryUsage();
+	} else {
+		ret.first->second = cAccount;
+	}
+}
+
+void CAccountViewCache::EraseCacheAccount(const CKeyID &cKeyId) {
+	if (m_mapCacheAccounts.erase(cKeyId)) {
+		m_unCacheBytes -= AccountEntryUsage();
+	}
+}
+
+void CAccountViewCache::SetCacheKeyId(const vector<unsigned char> &vchAccountId, const CKeyID &cKeyId) {
+	auto ret = m_mapCacheKeyIds.insert(make_pair(vchAccountId, cKeyId));
+	if (ret.second) {
+		m_unCacheBytes += KeyIdEntryUsage(ret.first->first);
+	} else {
+		ret.first->second = cKeyId;
+	}
+}
+
+void CAccountViewCache::SetCacheMap(const map<CKeyID, CAccount> &mapAccounts,
+		const map<vector<unsigned char>, CKeyID> &mapKeyIds) {
+	m_mapCacheAccounts = mapAccounts;
+	m_mapCacheKeyIds = mapKeyIds;
+	m_unCacheBytes = m_mapCacheAccounts.size() * AccountEntryUsage();
+	for (const auto &item : m_mapCacheKeyIds) {
+		m_unCacheBytes += KeyIdEntryUsage(item.first);
+	}
 }
 
 bool CAccountViewCache::GetAccount(const CKeyID &cKeyId, CAccount &cAccount) {
@@ -154,7 +198,7 @@ bool CAccountViewCache::GetAccount(const CKeyID &cKeyId, CAccount &cAccount) {
 		}
 	}
 	if (m_pBaseAccountView->GetAccount(cKeyId, cAccount)) {
-		m_mapCacheAccounts[cKeyId] = cAccount;
+		SetCacheAccount(cKeyId, cAccount);
 		return true;
 	}
 
@@ -162,7 +206,7 @@ bool CAccountViewCache::GetAccount(const CKeyID &cKeyId, CAccount &cAccount) {
 }
 
 bool CAccountViewCache::SetAccount(const CKeyID &cKeyId, const CAccount &cAccount) {
-	m_mapCacheAccounts[cKeyId] = cAccount;
+	SetCacheAccount(cKeyId, cAccount);
 
 	return true;
 }
@@ -172,7 +216,7 @@ bool CAccountViewCache::SetAccount(const vector<unsigned char> &vchAccountId, co
 		return false;
 	}
 	if (m_mapCacheKeyIds.count(vchAccountId)) {
-		m_mapCacheAccounts[m_mapCacheKeyIds[vchAccountId]] = cAccount;
+		SetCacheAccount(m_mapCacheKeyIds[vchAccountId], cAccount);
 		return true;
 	}
 
@@ -206,15 +250,15 @@ bool CAccountViewCache::BatchWrite(const map<CKeyID, CAccount> &mapAccounts,
 	for (map<CKeyID, CAccount>::const_iterator it = mapAccounts.begin(); it != mapAccounts.end(); ++it) {
 		if (uint160() == it->second.m_cKeyID) {
 			m_pBaseAccountView->EraseAccount(it->first);
-			m_mapCacheAccounts.erase(it->first);
+			EraseCacheAccount(it->first);
 		} else {
-			m_mapCacheAccounts[it->first] = it->second;
+			SetCacheAccount(it->first, it->second);
 		}
 	}
 
 	for (map<vector<unsigned char>, CKeyID>::const_iterator itKeyId = mapKeyIds.begin(); itKeyId != mapKeyIds.end();
 			++itKeyId) {
-		m_mapCacheKeyIds[itKeyId->first] = itKeyId->second;
+		SetCacheKeyId(itKeyId->first, itKeyId->second);
 	}
 	m_cHashBlock = cHashBlockIn;
 
@@ -224,10 +268,10 @@ bool CAccountViewCache::BatchWrite(const map<CKeyID, CAccount> &mapAccounts,
 bool CAccountViewCache::BatchWrite(const vector<CAccount> &vcAccounts) {
 	for (vector<CAccount>::const_iterator it = vcAccounts.begin(); it != vcAccounts.end(); ++it) {
 		if (it->IsEmptyValue() && !it->IsRegister()) {
-			m_mapCacheAccounts[it->m_cKeyID] = *it;
+			SetCacheAccount(it->m_cKeyID, *it);
 			m_mapCacheAccounts[it->m_cKeyID].m_cKeyID = uint160();
 		} else {
-			m_mapCacheAccounts[it->m_cKeyID] = *it;
+			SetCacheAccount(it->m_cKeyID, *it);
 		}
 	}
 	return true;
@@ -241,7 +285,7 @@ bool CAccountViewCache::EraseAccount(const CKeyID &cKeyId) {
 		CAccount cAccount;
 		if (m_pBaseAccountView->GetAccount(cKeyId, cAccount)) {
 			cAccount.m_cKeyID = uint160();
-			m_mapCacheAccounts[cKeyId] = cAccount;
+			SetCacheAccount(cKeyId, cAccount);
 		}
 	}
 
@@ -252,7 +296,7 @@ bool CAccountViewCache::SetKeyId(const vector<unsigned char> &vchAccountId, cons
 	if(vchAccountId.empty()) {
 		return false;
 	}
-	m_mapCacheKeyIds[vchAccountId] = cKeyId;
+	SetCacheKeyId(vchAccountId, cKeyId);
 
 	return true;
 }
@@ -270,7 +314,7 @@ bool CAccountViewCache::GetKeyId(const vector<unsigned char> &vchAccountId, CKey
 		}
 	}
 	if (m_pBaseAccountView->GetKeyId(vchAccountId, cKeyId)) {
-		m_mapCacheKeyIds[vchAccountId] = cKeyId;
+		SetCacheKeyId(vchAccountId, cKeyId);
 		return true;
 	}
 
@@ -282,11 +326,11 @@ bool CAccountViewCache::EraseKeyId(const vector<unsigned char> &vchAccountId) {
 		return false;
 	}
 	if (m_mapCacheKeyIds.count(vchAccountId)) {
-		m_mapCacheKeyIds[vchAccountId] = uint160();
+		SetCacheKeyId(vchAccountId, uint160());
 	} else {
 		CKeyID cKeyId;
 		if (m_pBaseAccountView->GetKeyId(vchAccountId, cKeyId)) {
-			m_mapCacheKeyIds[vchAccountId] = uint160();
+			SetCacheKeyId(vchAccountId, uint160());
 		}
 	}
 
@@ -316,7 +360,7 @@ bool CAccountViewCache::GetAccount(const vector<unsigned char> &vchAccountId, CA
 	} else {
 		CKeyID cKeyId;
 		if (m_pBaseAccountView->GetKeyId(vchAccountId, cKeyId)) {
-			m_mapCacheKeyIds[vchAccountId] = cKeyId;
+			SetCacheKeyId(vchAccountId, cKeyId);
 			if (m_mapCacheAccounts.count(cKeyId) > 0) {
 				cAccount = m_mapCacheAccounts[cKeyId];
 				if (cAccount.m_cKeyID != uint160()) { // жϴʻǷɾ
@@ -327,7 +371,7 @@ bool CAccountViewCache::GetAccount(const vector<unsigned char> &vchAccountId, CA
 			}
 			bool bRet = m_pBaseAccountView->GetAccount(cKeyId, cAccount);
 			if (bRet) {
-				m_mapCacheAccounts[cKeyId] = cAccount;
+				SetCacheAccount(cKeyId, cAccount);
 				return true;
 			}
 		}
@@ -337,8 +381,8 @@ bool CAccountViewCache::GetAccount(const vector<unsigned char> &vchAccountId, CA
 }
 
 bool CAccountViewCache::SaveAccountInfo(const CRegID &cRegId, const CKeyID &cKeyId, const CAccount &cAccount) {
-	m_mapCacheKeyIds[cRegId.GetVec6()] = cKeyId;
-	m_mapCacheAccounts[cKeyId] = cAccount;
+	SetCacheKeyId(cRegId.GetVec6(), cKeyId);
+	SetCacheAccount(cKeyId, cAccount);
 	return true;
 }
 
@@ -441,6 +485,7 @@ bool CAccountViewCache::Flush(){
 	 if (bOk) {
 		 m_mapCacheAccounts.clear();
 		 m_mapCacheKeyIds.clear();
+		 m_unCacheBytes = 0;
 	 }
 
 	 return bOk;
@@ -471,9 +516,8 @@ int64_t CAccountViewCache::GetRawBalance(const CUserID& cUserId) const {
 	return 0;
 }
 
-unsigned int CAccountViewCache::GetCacheSize() {
-	return ::GetSerializeSize(m_mapCacheAccounts, SER_DISK, g_sClientVersion)
-			+ ::GetSerializeSize(m_mapCacheKeyIds, SER_DISK, g_sClientVersion);
+size_t CAccountViewCache::GetCacheSize() const {
+	return m_unCacheBytes;
 }
 
 Object CAccountViewCache::ToJosnObj() const {
@@ -568,6 +612,11 @@ bool CScriptDBView::GetAllScriptAcc(const CRegID& cRegId, map<vector<unsigned ch
 	return false;
 }
 
+bool CScriptDBView::GetPrefixData(const vector<unsigned char> &vchPrefix,
+		map<vector<unsigned char>, vector<unsigned char> > &mapDatas) {
+	return true;
+}
+
 Object CScriptDBView::ToJosnObj(string strPrefix) {
 	Object obj;
 	return obj;
@@ -640,11 +689,40 @@ bool CScriptDBViewBacked::GetAllScriptAcc(const CRegID& cRegId,
 	return m_pBase->GetAllScriptAcc(cRegId, mapAcc);
 }
 
+bool CScriptDBViewBacked::GetPrefixData(const vector<unsigned char> &vchPrefix,
+		map<vector<unsigned char>, vector<unsigned char> > &mapDatas) {
+	return m_pBase->GetPrefixData(vchPrefix, mapDatas);
+}
+
 CScriptDBViewCache::CScriptDBViewCache(CScriptDBView &cScriptDBView, bool bDummy) :
-		CScriptDBViewBacked(cScriptDBView) {
+		CScriptDBViewBacked(cScriptDBView), m_unCacheBytes(0) {
 	m_mapDatas.clear();
 }
 
+static size_t DataEntryUsage(const vector<unsigned char> &vchKey, const vector<unsigned char> &vchValue) {
+	return memusage::MapEntryUsage<vector<unsigned char>, vector<unsigned char> >() + memusage::DynamicUsage(vchKey)
+			+ memusage::DynamicUsage(vchValue);
+}
+
+void CScriptDBViewCache::SetCacheData(const vector<unsigned char> &vchKey, const vector<unsigned char> &vchValue) {
+	auto it = m_mapDatas.find(vchKey);
+	if (it == m_mapDatas.end()) {
+		it = m_mapDatas.insert(make_pair(vchKey, vchValue)).first;
+	} else {
+		m_unCacheBytes -= DataEntryUsage(it->first, it->second);
+		it->second = vchValue;
+	}
+	m_unCacheBytes += DataEntryUsage(it->first, it->second);
+}
+
+void CScriptDBViewCache::SetCacheMap(const map<vector<unsigned char>, vector<unsigned char> > &mapDatas) {
+	m_mapDatas = mapDatas;
+	m_unCacheBytes = 0;
+	for (const auto &item : m_mapDatas) {
+		m_unCacheBytes += DataEntryUsage(item.first, item.second);
+	}
+}
+
 bool CScriptDBViewCache::GetData(const vector<unsigned char> &vchKey, vector<unsigned char> &vchValue) {
 	if (m_mapDatas.count(vchKey) > 0) {
 		if (!m_mapDatas[vchKey].empty()) {
@@ -657,13 +735,13 @@ bool CScriptDBViewCache::GetData(const vector<unsigned char> &vchKey, vector<uns
 	if (!m_pBase->GetData(vchKey, vchValue)) {
 		return false;
 	}
-	m_mapDatas[vchKey] = vchValue;
+	SetCacheData(vchKey, vchValue);
 
 	return true;
 }
 
 bool CScriptDBViewCache::SetData(const vector<unsigned char> &vchKey, const vector<unsigned char> &vchValue) {
-	m_mapDatas[vchKey] = vchValue;
+	SetCacheData(vchKey, vchValue);
 	return true;
 }
 
@@ -706,15 +784,17 @@ bool CScriptDBViewCache::UndoScriptData(const vector<unsigned char> &vchKey, con
 				}
 			}
 		}
+	} else if (vchKey.size() == 9 && equal(vchKey.begin(), vchKey.begin() + 3, "def")) {
+		g_cVmScriptCache.Erase(vector<unsigned char>(vchKey.begin() + 3, vchKey.end()));
 	}
-	m_mapDatas[vchKey] = vchValue;
+	SetCacheData(vchKey, vchValue);
 
 	return true;
 }
 
 bool CScriptDBViewCache::BatchWrite(const map<vector<unsigned char>, vector<unsigned char> > &mapDatas) {
 	for (auto &items : mapDatas) {
-		m_mapDatas[items.first] = items.second;
+		SetCacheData(items.first, items.second);
 	}
 
 	return true;
@@ -722,12 +802,12 @@ bool CScriptDBViewCache::BatchWrite(const map<vector<unsigned char>, vector<unsi
 
 bool CScriptDBViewCache::EraseKey(const vector<unsigned char> &vchKey) {
 	if (m_mapDatas.count(vchKey) > 0) {
-		m_mapDatas[vchKey].clear();
+		SetCacheData(vchKey, vector<unsigned char>());
 	} else {
 		vector<unsigned char> vchValue;
 		if (m_pBase->GetData(vchKey, vchValue)) {
 			vchValue.clear();
-			m_mapDatas[vchKey] = vchValue;
+			SetCacheData(vchKey, vchValue);
 		} else {
 			return false;
 		}
@@ -787,7 +867,7 @@ bool CScriptDBViewCache::GetScript(const int nIndex, vector<unsigned char> &vchS
 				if (m_mapDatas.count(vchDataKeyTemp) == 0) {
 					return true;
 				} else {
-					m_mapDatas[vchDataKeyTemp].clear();  //ڻdataKeyTempѾɾˣ½keyӦvalue
+					SetCacheData(vchDataKeyTemp, vector<unsigned char>());  //ڻdataKeyTempѾɾˣ½keyӦvalue
 					return GetScript(nIndex, vchScriptId, vchValue); //´ݿлȡһ
 				}
 			} else {  //ϼѯkeyڵڱkey,ر
@@ -843,7 +923,7 @@ bool CScriptDBViewCache::GetScript(const int nIndex, vector<unsigned char> &vchS
 				if (m_mapDatas.count(vchDataKeyTemp) == 0) {
 					return true;
 				} else {
-					m_mapDatas[vchDataKeyTemp].clear();  //ڻdataKeyTempѾɾˣ½keyӦvalue
+					SetCacheData(vchDataKeyTemp, vector<unsigned char>());  //ڻdataKeyTempѾɾˣ½keyӦvalue
 					return GetScript(nIndex, vchScriptId, vchValue); //´ݿлȡһ
 				}
 			} else { //ϼѯkeyڵڱkey,ر
@@ -873,6 +953,7 @@ bool CScriptDBViewCache::SetScript(const vector<unsigned char> &vchScriptId, con
 			return false;
 		}
 	}
+	g_cVmScriptCache.Erase(vchScriptId);
 
 	return SetData(vchScriptKey, vchValue);
 }
@@ -881,13 +962,14 @@ bool CScriptDBViewCache::Flush() {
 	bool ok = m_pBase->BatchWrite(m_mapDatas);
 	if (ok) {
 		m_mapDatas.clear();
+		m_unCacheBytes = 0;
 	}
 
 	return ok;
 }
 
-unsigned int CScriptDBViewCache::GetCacheSize() {
-	return ::GetSerializeSize(m_mapDatas, SER_DISK, g_sClientVersion);
+size_t CScriptDBViewCache::GetCacheSize() const {
+	return m_unCacheBytes;
 }
 
 bool CScriptDBViewCache::WriteTxOutPut(const uint256 &cTxId, const vector<CVmOperate> &vcOutput,
@@ -960,6 +1042,25 @@ bool CScriptDBViewCache::GetAllScriptAcc(const CRegID& cRegId,
 	return m_pBase->GetAllScriptAcc(cRegId, mapAcc);
 }
 
+bool CScriptDBViewCache::GetPrefixData(const vector<unsigned char> &vchPrefix,
+		map<vector<unsigned char>, vector<unsigned char> > &mapDatas) {
+	if (!m_pBase->GetPrefixData(vchPrefix, mapDatas)) {
+		return false;
+	}
+	for (auto it = m_mapDatas.lower_bound(vchPrefix); it != m_mapDatas.end(); ++it) {
+		if (it->first.size() < vchPrefix.size() || !equal(vchPrefix.begin(), vchPrefix.end(), it->first.begin())) {
+			break;
+		}
+		if (it->second.empty()) {
+			mapDatas.erase(it->first);
+		} else {
+			mapDatas[it->first] = it->second;
+		}
+	}
+
+	return true;
+}
+
 
 bool CScriptDBViewCache::ReadTxOutPut(const uint256 &cTxId, vector<CVmOperate> &vcOutput) {
 	vector<unsigned char> vchKey = { 'o', 'u', 't', 'p', 'u', 't' };
@@ -978,6 +1079,17 @@ bool CScriptDBViewCache::ReadTxOutPut(const uint256 &cTxId, vector<CVmOperate> &
 }
 
 
+// entries written before the undo record was indexed end after the tx offset
+static void UnserializeTxPos(const vector<unsigned char> &vchTxPos, ST_DiskTxPos &cDiskTxPos) {
+	CDataStream cDsPos(vchTxPos, SER_DISK, g_sClientVersion);
+	cDsPos >> *(ST_DiskBlockPos *) &cDiskTxPos;
+	cDsPos >> VARINT(cDiskTxPos.m_unTxOffset);
+	cDiskTxPos.m_unUndoPos = 0;
+	if (!cDsPos.empty()) {
+		cDsPos >> VARINT(cDiskTxPos.m_unUndoPos);
+	}
+}
+
 bool CScriptDBViewCache::ReadTxIndex(const uint256 &cTxId, ST_DiskTxPos &cDiskTxPos) {
 	CDataStream cDS(SER_DISK, g_sClientVersion);
 	cDS << cTxId;
@@ -990,14 +1102,12 @@ bool CScriptDBViewCache::ReadTxIndex(const uint256 &cTxId, ST_DiskTxPos &cDiskTx
 			return false;
 		}
 		vchTxPos = m_mapDatas[vchTxHash];
-		CDataStream cDsPos(vchTxPos, SER_DISK, g_sClientVersion);
-		cDsPos >> cDiskTxPos;
+		UnserializeTxPos(vchTxPos, cDiskTxPos);
 	} else {
 		if (!GetData(vchTxHash, vchTxPos)) {
 			return false;
 		}
-		CDataStream cDsPos(vchTxPos, SER_DISK, g_sClientVersion);
-		cDsPos >> cDiskTxPos;
+		UnserializeTxPos(vchTxPos, cDiskTxPos);
 	}
 
 	return true;
@@ -1006,8 +1116,8 @@ bool CScriptDBViewCache::ReadTxIndex(const uint256 &cTxId, ST_DiskTxPos &cDiskTx
 bool CScriptDBViewCache::WriteTxIndex(const vector<pair<uint256, ST_DiskTxPos> > &list,
 		vector<CScriptDBOperLog> &vTxIndexOperDB) {
 	for (vector<pair<uint256, ST_DiskTxPos> >::const_iterator it = list.begin(); it != list.end(); it++) {
-		LogPrint("txindex", "txhash:%s dispos: nFile=%d, nPos=%d nTxOffset=%d\n", it->first.GetHex(), it->second.nFile,
-				it->second.unPos, it->second.m_unTxOffset);
+		LogPrint("txindex", "txhash:%s dispos: nFile=%d, nPos=%d nTxOffset=%d nUndoPos=%d\n", it->first.GetHex(),
+				it->second.nFile, it->second.unPos, it->second.m_unTxOffset, it->second.m_unUndoPos);
 		CDataStream cDS(SER_DISK, g_sClientVersion);
 		cDS << it->first;
 		vector<unsigned char> vchTxHash = { 'T' };
@@ -1509,6 +1619,7 @@ bool CScriptDBViewCache::SetScriptCount(const int nCount) {
 bool CScriptDBViewCache::EraseScript(const vector<unsigned char> &vchScriptId) {
 	vector<unsigned char> vchScriptKey = { 'd', 'e', 'f' };
 	vchScriptKey.insert(vchScriptKey.end(), vchScriptId.begin(), vchScriptId.end());
+	g_cVmScriptCache.Erase(vchScriptId);
 	if (HaveScript(vchScriptId)) {
 		int nCount(0);
 		if (!GetScriptCount(nCount)) {
@@ -1942,13 +2053,40 @@ void CTransactionDBCache::SetCacheMap(const map<uint256, vector<uint256> > &mapC
 	mapTxHashByBlockHash = mapCache;
 }
 
-bool CScriptDBViewCache::GetScriptAcc(const CRegID &cRegId, const vector<unsigned char> &vchAccKey,
-		CAppUserAccout& cAppUserAccOut) {
+static vector<unsigned char> GetAppAccKey(const CRegID &cRegId, const vector<unsigned char> &vchAccKey) {
 	vector<unsigned char> vchScriptKey = { 'a', 'c', 'c', 't' };
 	vector<unsigned char> vchRegId = cRegId.GetVec6();
 	vchScriptKey.insert(vchScriptKey.end(), vchRegId.begin(), vchRegId.end());
 	vchScriptKey.push_back('_');
 	vchScriptKey.insert(vchScriptKey.end(), vchAccKey.begin(), vchAccKey.end());
+	return vchScriptKey;
+}
+
+// the user id is length prefixed so that one user's funds never fall under another user's prefix
+static vector<unsigned char> GetAppFundPrefix(const CRegID &cRegId, const vector<unsigned char> &vchAccKey) {
+	vector<unsigned char> vchPrefix = { 'a', 'f', 'n', 'd' };
+	vector<unsigned char> vchRegId = cRegId.GetVec6();
+	vchPrefix.insert(vchPrefix.end(), vchRegId.begin(), vchRegId.end());
+	vchPrefix.push_back('_');
+	vchPrefix.push_back((unsigned char) vchAccKey.size());
+	vchPrefix.insert(vchPrefix.end(), vchAccKey.begin(), vchAccKey.end());
+	return vchPrefix;
+}
+
+static vector<unsigned char> GetAppFundKey(const vector<unsigned char> &vchPrefix, const CAppUserAccout::FundKey &tKey) {
+	vector<unsigned char> vchKey(vchPrefix);
+	uint32_t unHeight = (uint32_t) tKey.first;
+	vchKey.push_back((unHeight >> 24) & 0xff);
+	vchKey.push_back((unHeight >> 16) & 0xff);
+	vchKey.push_back((unHeight >> 8) & 0xff);
+	vchKey.push_back(unHeight & 0xff);
+	vchKey.insert(vchKey.end(), tKey.second.begin(), tKey.second.end());
+	return vchKey;
+}
+
+bool CScriptDBViewCache::GetScriptAcc(const CRegID &cRegId, const vector<unsigned char> &vchAccKey,
+		CAppUserAccout& cAppUserAccOut) {
+	vector<unsigned char> vchScriptKey = GetAppAccKey(cRegId, vchAccKey);
 	vector<unsigned char> vchValue;
 
 	if (!GetData(vchScriptKey, vchValue)) {
@@ -1957,26 +2095,259 @@ bool CScriptDBViewCache::GetScriptAcc(const CRegID &cRegId, const vector<unsigne
 	CDataStream cDS(vchValue, SER_DISK, g_sClientVersion);
 	cDS >> cAppUserAccOut;
 
+	vector<unsigned char> vchPrefix = GetAppFundPrefix(cRegId, vchAccKey);
+	map<vector<unsigned char>, vector<unsigned char> > mapFunds;
+	if (!GetPrefixData(vchPrefix, mapFunds)) {
+		return false;
+	}
+	for (const auto &item : mapFunds) {
+		if (item.first.size() < vchPrefix.size() + 4) {
+			return ERRORMSG("GetScriptAcc() : bad frozen fund key %s", HexStr(item.first));
+		}
+		vector<unsigned char>::const_iterator itHeight = item.first.begin() + vchPrefix.size();
+		uint32_t unHeight = ((uint32_t) itHeight[0] << 24) | ((uint32_t) itHeight[1] << 16)
+				| ((uint32_t) itHeight[2] << 8) | (uint32_t) itHeight[3];
+		vector<unsigned char> vchTag(itHeight + 4, item.first.end());
+		uint64_t ullValue = 0;
+		CDataStream cDSFund(item.second, SER_DISK, g_sClientVersion);
+		cDSFund >> VARINT(ullValue);
+		cAppUserAccOut.LoadAppCFund(CAppCFund(vchTag, ullValue, (int) unHeight));
+	}
+
 	return true;
 }
 
 bool CScriptDBViewCache::SetScriptAcc(const CRegID &cRegId, const CAppUserAccout& cAppUserAccIn,
-		CScriptDBOperLog &cScriptDBOperLog) {
-	vector<unsigned char> vchScriptKey = { 'a', 'c', 'c', 't' };
-	vector<unsigned char> vchRegId = cRegId.GetVec6();
+		vector<CScriptDBOperLog> &vcScriptDBOperLog) {
 	vector<unsigned char> vchAccKey = cAppUserAccIn.getaccUserId();
-	vchScriptKey.insert(vchScriptKey.end(), vchRegId.begin(), vchRegId.end());
-	vchScriptKey.push_back('_');
-	vchScriptKey.insert(vchScriptKey.end(), vchAccKey.begin(), vchAccKey.end());
+	vector<unsigned char> vchScriptKey = GetAppAccKey(cRegId, vchAccKey);
 	vector<unsigned char> vchValue;
+	CScriptDBOperLog cScriptDBOperLog;
 	cScriptDBOperLog.m_vchKey = vchScriptKey;
 	if (GetData(vchScriptKey, vchValue)) {
 		cScriptDBOperLog.m_vchValue = vchValue;
 	}
 	CDataStream cDS(SER_DISK, g_sClientVersion);
 	cDS << cAppUserAccIn;
-	vchValue.clear();
-	vchValue.insert(vchValue.end(), cDS.begin(), cDS.end());
+	vchValue.assign(cDS.begin(), cDS.end());
+	if (!SetData(vchScriptKey, vchValue)) {
+		return false;
+	}
+	vcScriptDBOperLog.push_back(cScriptDBOperLog);
 
-	return SetData(vchScriptKey, vchValue);
+	vector<unsigned char> vchPrefix = GetAppFundPrefix(cRegId, vchAccKey);
+	const map<CAppUserAccout::FundKey, CAppCFund> &mapFunds = cAppUserAccIn.getFreezedFundMap();
+	for (const auto &tKey : cAppUserAccIn.getChangedFund()) {
+		vector<unsigned char> vchFundKey = GetAppFundKey(vchPrefix, tKey);
+		vector<unsigned char> vchOldValue;
+		bool bHaveOld = GetData(vchFundKey, vchOldValue);
+		auto it = mapFunds.find(tKey);
+		if (it != mapFunds.end()) {
+			CDataStream cDSFund(SER_DISK, g_sClientVersion);
+			uint64_t ullValue = it->second.getValue();
+			cDSFund << VARINT(ullValue);
+			if (!SetData(vchFundKey, vector<unsigned char>(cDSFund.begin(), cDSFund.end()))) {
+				return false;
+			}
+		} else if (bHaveOld) {
+			if (!SetData(vchFundKey, vector<unsigned char>())) {
+				return false;
+			}
+		} else {
+			continue;
+		}
+		vcScriptDBOperLog.push_back(CScriptDBOperLog(vchFundKey, vchOldValue));
+	}
+
+	return true;
+}
+
+CReadTrackingAccountView::CReadTrackingAccountView(CAccountView &cBase, CCriticalSection &cs) :
+		m_bUntracked(false), m_pBase(&cBase), m_pCs(&cs) {
+}
+
+bool CReadTrackingAccountView::GetAccount(const CKeyID &cKeyId, CAccount &cAccount) {
+	bool bRet;
+	{
+		LOCK(*m_pCs);
+		bRet = m_pBase->GetAccount(cKeyId, cAccount);
+	}
+	m_setReadAccounts.insert(cKeyId);
+	if (!m_mapReadValues.count(cKeyId)) {
+		vector<unsigned char> &vchValue = m_mapReadValues[cKeyId];
+		if (bRet) {
+			CDataStream cDS(SER_DISK, g_sClientVersion);
+			cDS << cAccount;
+			vchValue.assign(cDS.begin(), cDS.end());
+		}
+	}
+
+	return bRet;
+}
+
+bool CReadTrackingAccountView::HaveAccount(const CKeyID &cKeyId) {
+	m_setReadAccounts.insert(cKeyId);
+	LOCK(*m_pCs);
+	return m_pBase->HaveAccount(cKeyId);
+}
+
+uint256 CReadTrackingAccountView::GetBestBlock() {
+	LOCK(*m_pCs);
+	return m_pBase->GetBestBlock();
+}
+
+bool CReadTrackingAccountView::GetKeyId(const vector<unsigned char> &vchAccountId, CKeyID &cKeyId) {
+	bool bRet;
+	{
+		LOCK(*m_pCs);
+		bRet = m_pBase->GetKeyId(vchAccountId, cKeyId);
+	}
+	m_setReadKeyIds.insert(vchAccountId);
+	if (!m_mapReadKeyIds.count(vchAccountId)) {
+		m_mapReadKeyIds[vchAccountId] = bRet ? cKeyId : CKeyID();
+	}
+
+	return bRet;
+}
+
+bool CReadTrackingAccountView::GetAccount(const vector<unsigned char> &vchAccountId, CAccount &cAccount) {
+	CKeyID cKeyId;
+	if (!GetKeyId(vchAccountId, cKeyId)) {
+		return false;
+	}
+
+	return GetAccount(cKeyId, cAccount);
+}
+
+uint64_t CReadTrackingAccountView::TraverseAccount() {
+	m_bUntracked = true;
+	LOCK(*m_pCs);
+	return m_pBase->TraverseAccount();
+}
+
+void CReadTrackingAccountView::GetWrites(const CAccountViewCache &cCache, map<CKeyID, CAccount> &mapAccounts,
+		map<vector<unsigned char>, CKeyID> &mapKeyIds) const {
+	for (const auto &item : cCache.m_mapCacheAccounts) {
+		map<CKeyID, vector<unsigned char> >::const_iterator iterRead = m_mapReadValues.find(item.first);
+		if (iterRead != m_mapReadValues.end()) {
+			CDataStream cDS(SER_DISK, g_sClientVersion);
+			cDS << item.second;
+			if (iterRead->second.size() == cDS.size() && equal(cDS.begin(), cDS.end(), iterRead->second.begin())) {
+				continue;
+			}
+		}
+		mapAccounts.insert(item);
+	}
+	for (const auto &item : cCache.m_mapCacheKeyIds) {
+		map<vector<unsigned char>, CKeyID>::const_iterator iterRead = m_mapReadKeyIds.find(item.first);
+		if (iterRead != m_mapReadKeyIds.end() && iterRead->second == item.second) {
+			continue;
+		}
+		mapKeyIds.insert(item);
+	}
+}
+
+CReadTrackingScriptDBView::CReadTrackingScriptDBView(CScriptDBView &cBase, CCriticalSection &cs) :
+		m_bUntracked(false), m_pBase(&cBase), m_pCs(&cs) {
+}
+
+bool CReadTrackingScriptDBView::GetData(const vector<unsigned char> &vchKey, vector<unsigned char> &vchValue) {
+	bool bRet;
+	{
+		LOCK(*m_pCs);
+		bRet = m_pBase->GetData(vchKey, vchValue);
+	}
+	m_setReadKeys.insert(vchKey);
+	if (!m_mapReadValues.count(vchKey)) {
+		m_mapReadValues[vchKey] = bRet ? vchValue : vector<unsigned char>();
+	}
+
+	return bRet;
+}
+
+bool CReadTrackingScriptDBView::HaveData(const vector<unsigned char> &vchKey) {
+	m_setReadKeys.insert(vchKey);
+	LOCK(*m_pCs);
+	return m_pBase->HaveData(vchKey);
+}
+
+bool CReadTrackingScriptDBView::GetScript(const int &nIndex, vector<unsigned char> &vchScriptId,
+		vector<unsigned char> &vchValue) {
+	m_bUntracked = true;
+	LOCK(*m_pCs);
+	return m_pBase->GetScript(nIndex, vchScriptId, vchValue);
+}
+
+bool CReadTrackingScriptDBView::GetScriptData(const int nCurBlockHeight, const vector<unsigned char> &vchScriptId,
+		const int &nIndex, vector<unsigned char> &vchScriptKey, vector<unsigned char> &vchScriptData) {
+	m_bUntracked = true;
+	LOCK(*m_pCs);
+	return m_pBase->GetScriptData(nCurBlockHeight, vchScriptId, nIndex, vchScriptKey, vchScriptData);
+}
+
+bool CReadTrackingScriptDBView::ReadTxIndex(const uint256 &cTxId, ST_DiskTxPos &tDiskTxPos) {
+	m_bUntracked = true;
+	LOCK(*m_pCs);
+	return m_pBase->ReadTxIndex(cTxId, tDiskTxPos);
+}
+
+bool CReadTrackingScriptDBView::ReadTxOutPut(const uint256 &cTxId, vector<CVmOperate> &vcOutput) {
+	m_bUntracked = true;
+	LOCK(*m_pCs);
+	return m_pBase->ReadTxOutPut(cTxId, vcOutput);
+}
+
+bool CReadTrackingScriptDBView::GetTxHashByAddress(const CKeyID &cKeyId, int nHeight,
+		map<vector<unsigned char>, vector<unsigned char> > &mapTxHash) {
+	m_bUntracked = true;
+	LOCK(*m_pCs);
+	return m_pBase->GetTxHashByAddress(cKeyId, nHeight, mapTxHash);
+}
+
+bool CReadTrackingScriptDBView::GetAllScriptAcc(const CRegID& cRegId,
+		map<vector<unsigned char>, vector<unsigned char> > &mapAcc) {
+	m_bUntracked = true;
+	LOCK(*m_pCs);
+	return m_pBase->GetAllScriptAcc(cRegId, mapAcc);
+}
+bool CReadTrackingScriptDBView::GetPrefixData(const vector<unsigned char> &vchPrefix,
+		map<vector<unsigned char>, vector<unsigned char> > &mapDatas) {
+	map<vector<unsigned char>, vector<unsigned char> > mapRead;
+	{
+		LOCK(*m_pCs);
+		if (!m_pBase->GetPrefixData(vchPrefix, mapRead)) {
+			return false;
+		}
+	}
+	m_setReadPrefixes.insert(vchPrefix);
+	for (const auto &item : mapRead) {
+		if (!m_mapReadValues.count(item.first)) {
+			m_mapReadValues[item.first] = item.second;
+		}
+		mapDatas[item.first] = item.second;
+	}
+
+	return true;
+}
+
+void CReadTrackingScriptDBView::GetWrites(const CScriptDBViewCache &cCache,
+		map<vector<unsigned char>, vector<unsigned char> > &mapDatas) const {
+	for (const auto &item : cCache.m_mapDatas) {
+		map<vector<unsigned char>, vector<unsigned char> >::const_iterator iterRead = m_mapReadValues.find(item.first);
+		if (iterRead != m_mapReadValues.end() && iterRead->second == item.second) {
+			continue;
+		}
+		mapDatas.insert(item);
+	}
+}
+
+bool IntersectsPrefixes(const set<vector<unsigned char> > &setPrefixes, const set<vector<unsigned char> > &setWrites) {
+	for (const auto &vchPrefix : setPrefixes) {
+		auto it = setWrites.lower_bound(vchPrefix);
+		if (it != setWrites.end() && it->size() >= vchPrefix.size()
+				&& equal(vchPrefix.begin(), vchPrefix.end(), it->begin())) {
+			return true;
+		}
+	}
+	return false;
 }
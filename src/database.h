@@ -4,6 +4,7 @@
 #include <map>
 #include <vector>
 #include "serialize.h"
+#include "sync.h"
 #include "tx.h"
 #include "./vm/appaccount.h"
 using namespace std;
@@ -88,12 +89,18 @@ class CAccountViewCache: public CAccountViewBacked {
 	bool SaveAccountInfo(const CRegID &cRegId, const CKeyID &cKeyId, const CAccount &cAccount);
 	uint64_t TraverseAccount();
 	bool Flush();
-	unsigned int GetCacheSize();
+	/** Heap bytes held by the cached entries, kept up to date on every write */
+	size_t GetCacheSize() const;
 	Object ToJosnObj() const;
 	void SetBaseData(CAccountView * pAccountView);
+	/** Write straight into this cache layer, bypassing the base view; use instead of the maps */
+	void SetCacheAccount(const CKeyID &cKeyId, const CAccount &cAccount);
+	void SetCacheKeyId(const vector<unsigned char> &vchAccountId, const CKeyID &cKeyId);
+	void SetCacheMap(const map<CKeyID, CAccount> &mapAccounts, const map<vector<unsigned char>, CKeyID> &mapKeyIds);
 
  public:
  	uint256 m_cHashBlock;
+ 	// read only outside this class, writes go through SetCache* to keep m_unCacheBytes right
  	map<CKeyID, CAccount> m_mapCacheAccounts;
  	map<vector<unsigned char>, CKeyID> m_mapCacheKeyIds; // vector  accountId
 
@@ -107,6 +114,9 @@ class CAccountViewCache: public CAccountViewBacked {
  	bool GetKeyId(const vector<unsigned char> &vchAccountId, CKeyID &cKeyId);
  	bool EraseKeyId(const vector<unsigned char> &vchAccountId);
  	bool GetAccount(const vector<unsigned char> &vchAccountId, CAccount &cAccount);
+	void EraseCacheAccount(const CKeyID &cKeyId);
+
+ 	size_t m_unCacheBytes;
 };
 
 
@@ -130,6 +140,12 @@ class CScriptDBView {
 	virtual bool SetTxHashByAddress(const CKeyID &cKeyId, int nHeight, int nIndex, const string &strTxHash,
 			CScriptDBOperLog &cScriptDBOperLog);
 	virtual bool GetAllScriptAcc(const CRegID& cRegId, map<vector<unsigned char>, vector<unsigned char> > &mapAcc);
+	/**
+	 * @brief Get all the entries whose key starts with vchPrefix
+	 * @param mapDatas entries found are added, erased ones in a cache above are removed from it
+	 * @return false on a read error
+	 */
+	virtual bool GetPrefixData(const vector<unsigned char> &vchPrefix, map<vector<unsigned char>, vector<unsigned char> > &mapDatas);
 	virtual ~CScriptDBView() {
 	};
 };
@@ -155,6 +171,7 @@ class CScriptDBViewBacked: public CScriptDBView {
 	bool SetTxHashByAddress(const CKeyID &cKeyId, int nHeight, int nIndex, const string &strTxHash,
 			CScriptDBOperLog &cScriptDBOperLog);
 	bool GetAllScriptAcc(const CRegID& cRegId, map<vector<unsigned char>, vector<unsigned char> > &mapAcc);
+	bool GetPrefixData(const vector<unsigned char> &vchPrefix, map<vector<unsigned char>, vector<unsigned char> > &mapDatas);
 
  protected:
  	CScriptDBView * m_pBase;
@@ -167,7 +184,13 @@ class CScriptDBViewCache: public CScriptDBViewBacked {
 	bool GetScript(const CRegID &cRegId, vector<unsigned char> &vchValue);
 
 	bool GetScriptAcc(const CRegID &cRegId, const vector<unsigned char> &vchAccKey, CAppUserAccout& cAppUserAccOut);
-	bool SetScriptAcc(const CRegID &cRegId, const CAppUserAccout& cAppUserAccIn, CScriptDBOperLog &cScriptDBOperLog);
+	/**
+	 * @brief Write an app user account, its record and each frozen fund it changed, which are stored
+	 * under "afnd" + scriptid + "_" + userid length + userid + height (big endian) + tag
+	 * @param vcScriptDBOperLog gets the undo record of every key written
+	 */
+	bool SetScriptAcc(const CRegID &cRegId, const CAppUserAccout& cAppUserAccIn,
+			vector<CScriptDBOperLog> &vcScriptDBOperLog);
 
 	bool GetScript(const int nIndex, CRegID &cRegId, vector<unsigned char> &vchValue);
 	bool SetScript(const CRegID &cRegId, const vector<unsigned char> &vchValue);
@@ -198,7 +221,11 @@ class CScriptDBViewCache: public CScriptDBViewBacked {
 	 * @return
 	 */
 	bool Flush();
-	unsigned int GetCacheSize();
+	/** Heap bytes held by the cached entries, kept up to date on every write */
+	size_t GetCacheSize() const;
+	/** Write straight into this cache layer, bypassing the base view; use instead of m_mapDatas */
+	void SetCacheData(const vector<unsigned char> &vchKey, const vector<unsigned char> &vchValue);
+	void SetCacheMap(const map<vector<unsigned char>, vector<unsigned char> > &mapDatas);
 	Object ToJosnObj() const;
 	CScriptDBView * GetBaseScriptDB() {
 		return m_pBase;
@@ -214,8 +241,10 @@ class CScriptDBViewCache: public CScriptDBViewBacked {
 	bool SetTxHashByAddress(const CKeyID &cKeyId, int nHeight, int nIndex, const string &strTxHash,
 			CScriptDBOperLog &cScriptDBOperLog);
 	bool GetAllScriptAcc(const CRegID& cRegId, map<vector<unsigned char>, vector<unsigned char> > &mapAcc);
+	bool GetPrefixData(const vector<unsigned char> &vchPrefix, map<vector<unsigned char>, vector<unsigned char> > &mapDatas);
 
  public:
+	// read only outside this class, writes go through SetCacheData to keep m_unCacheBytes right
 	map<vector<unsigned char>, vector<unsigned char> > m_mapDatas;
 	/*ȡű ʱ һvector scriptKey = "def" + "scriptid";
 	 ȡӦ˻ʱһvectorscriptKey = "acct" + "scriptid"+"_" + "accUserId";
@@ -333,8 +362,89 @@ class CScriptDBViewCache: public CScriptDBViewBacked {
 	 */
 	bool SetScriptData(const vector<unsigned char> &vchScriptId, const vector<unsigned char> &vchScriptKey,
 			const vector<unsigned char> &vchScriptData, CScriptDBOperLog &cScriptDBOperLog);
+
+	size_t m_unCacheBytes;
+};
+
+/**
+ * Read-only pass-through to a view shared by several threads, recording every account and
+ * RegID read through it. Stacked under a private CAccountViewCache it lets a transaction run
+ * speculatively and tells afterwards which of its inputs a conflicting write would invalidate.
+ * Reads are serialized on the lock passed in because the caches below fill themselves on reads.
+ */
+class CReadTrackingAccountView: public CAccountView {
+ public:
+	CReadTrackingAccountView(CAccountView &cBase, CCriticalSection &cs);
+	bool GetAccount(const CKeyID &cKeyId, CAccount &cAccount);
+	bool HaveAccount(const CKeyID &cKeyId);
+	uint256 GetBestBlock();
+	bool GetKeyId(const vector<unsigned char> &vchAccountId, CKeyID &cKeyId);
+	bool GetAccount(const vector<unsigned char> &vchAccountId, CAccount &cAccount);
+	uint64_t TraverseAccount();
+	/**
+	 * @brief Changes a cache stacked on this view holds relative to what was read through it
+	 * @param cCache the cache stacked directly on this view
+	 */
+	void GetWrites(const CAccountViewCache &cCache, map<CKeyID, CAccount> &mapAccounts,
+			map<vector<unsigned char>, CKeyID> &mapKeyIds) const;
+
+ public:
+	set<CKeyID> m_setReadAccounts;
+	set<vector<unsigned char> > m_setReadKeyIds;
+	bool m_bUntracked;      // a read covered more than single keys
+
+ private:
+	CAccountView *m_pBase;
+	CCriticalSection *m_pCs;
+	map<CKeyID, vector<unsigned char> > m_mapReadValues;	// serialized account as read
+	map<vector<unsigned char>, CKeyID> m_mapReadKeyIds;
 };
 
+// Script db counterpart of CReadTrackingAccountView, range reads are not tracked per key
+class CReadTrackingScriptDBView: public CScriptDBView {
+ public:
+	CReadTrackingScriptDBView(CScriptDBView &cBase, CCriticalSection &cs);
+	bool GetData(const vector<unsigned char> &vchKey, vector<unsigned char> &vchValue);
+	bool HaveData(const vector<unsigned char> &vchKey);
+	bool GetScript(const int &nIndex, vector<unsigned char> &vchScriptId, vector<unsigned char> &vchValue);
+	bool GetScriptData(const int nCurBlockHeight, const vector<unsigned char> &vchScriptId, const int &nIndex,
+			vector<unsigned char> &vchScriptKey, vector<unsigned char> &vchScriptData);
+	bool ReadTxIndex(const uint256 &cTxId, ST_DiskTxPos &tDiskTxPos);
+	bool ReadTxOutPut(const uint256 &cTxId, vector<CVmOperate> &vcOutput);
+	bool GetTxHashByAddress(const CKeyID &cKeyId, int nHeight,
+			map<vector<unsigned char>, vector<unsigned char> > &mapTxHash);
+	bool GetAllScriptAcc(const CRegID& cRegId, map<vector<unsigned char>, vector<unsigned char> > &mapAcc);
+	bool GetPrefixData(const vector<unsigned char> &vchPrefix, map<vector<unsigned char>, vector<unsigned char> > &mapDatas);
+	void GetWrites(const CScriptDBViewCache &cCache, map<vector<unsigned char>, vector<unsigned char> > &mapDatas) const;
+
+ public:
+	set<vector<unsigned char> > m_setReadKeys;
+	set<vector<unsigned char> > m_setReadPrefixes;		// a write to any key under them conflicts
+	bool m_bUntracked;
+
+ private:
+	CScriptDBView *m_pBase;
+	CCriticalSection *m_pCs;
+	map<vector<unsigned char>, vector<unsigned char> > m_mapReadValues;	// empty if the key was missing
+};
+
+// whether a transaction that read setReads read anything in setWrites
+template<typename K>
+bool IntersectsKeys(const set<K> &setReads, const set<K> &setWrites) {
+	if (setReads.size() > setWrites.size()) {
+		return IntersectsKeys(setWrites, setReads);
+	}
+	for (const auto &key : setReads) {
+		if (setWrites.count(key)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// whether a key in setWrites starts with one of the prefixes read by a range read
+bool IntersectsPrefixes(const set<vector<unsigned char> > &setPrefixes, const set<vector<unsigned char> > &setWrites);
+
 class CTransactionDBView {
  public:
 	virtual uint256 IsContainTx(const uint256 & cTxHash);
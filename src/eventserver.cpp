@@ -0,0 +1,617 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "eventserver.h"
+
+#include "main.h"
+#include "txdb.h"
+#include "util.h"
+#include "vm/vmrunevn.h"
+#include "json/json_spirit_reader_template.h"
+#include "json/json_spirit_utils.h"
+#include "json/json_spirit_value.h"
+#include "json/json_spirit_writer_template.h"
+
+#include <boost/bind.hpp>
+
+using namespace json_spirit;
+using boost::asio::ip::tcp;
+
+// longest subscription request line a client may send
+static const size_t MAX_EVENT_REQUEST = 4096;
+
+CEventServer g_cEventServer;
+
+static const struct {
+	int nTopic;
+	const char *pszName;
+} g_arrEventTopics[] = {
+	{ EM_TOPIC_BLOCK, "block" },
+	{ EM_TOPIC_WALLET_TX, "wallettx" },
+	{ EM_TOPIC_APP_TX, "apptx" },
+	{ EM_TOPIC_MEMPOOL, "mempool" },
+	{ EM_TOPIC_MESSAGE, "message" },
+};
+
+int GetEventTopic(emEventType emType) {
+	switch (emType) {
+	case EM_EVENT_BLOCK:
+		return EM_TOPIC_BLOCK;
+	case EM_EVENT_WALLET_TX:
+	case EM_EVENT_SYNC_HEIGHT:
+	case EM_EVENT_SYNC_TX:
+		return EM_TOPIC_WALLET_TX;
+	case EM_EVENT_APP_TX:
+		return EM_TOPIC_APP_TX;
+	case EM_EVENT_MEMPOOL_ADD:
+	case EM_EVENT_MEMPOOL_REMOVE:
+	case EM_EVENT_MEMPOOL_RELEASE:
+		return EM_TOPIC_MEMPOOL;
+	case EM_EVENT_MESSAGE:
+		return EM_TOPIC_MESSAGE;
+	}
+	return 0;
+}
+
+bool ST_EventFilter::Matches(emEventType emType, const vector<unsigned char> &vchAppId) const {
+	if (!(nTopics & GetEventTopic(emType))) {
+		return false;
+	}
+	return EM_EVENT_APP_TX != emType || setAppIds.empty() || setAppIds.count(vchAppId) > 0;
+}
+
+bool ST_EventFilter::Parse(const string &strRequest, string &strError) {
+	Value valRequest;
+	if (!read_string(strRequest, valRequest) || valRequest.type() != obj_type) {
+		strError = "subscription request must be a JSON object";
+		return false;
+	}
+	ST_EventFilter tFilter(*this);
+	try {
+		const Object &objRequest = valRequest.get_obj();
+		const Value &valTopics = find_value(objRequest, "topics");
+		if (valTopics.type() != null_type) {
+			tFilter.nTopics = 0;
+			for (const auto &item : valTopics.get_array()) {
+				const string &strTopic = item.get_str();
+				int nTopic = 0;
+				for (const auto &topic : g_arrEventTopics) {
+					if (strTopic == topic.pszName) {
+						nTopic = topic.nTopic;
+					}
+				}
+				if (0 == nTopic) {
+					strError = "unknown topic " + strTopic;
+					return false;
+				}
+				tFilter.nTopics |= nTopic;
+			}
+		}
+		const Value &valApps = find_value(objRequest, "apps");
+		if (valApps.type() != null_type) {
+			tFilter.setAppIds.clear();
+			for (const auto &item : valApps.get_array()) {
+				if (!CRegID::IsRegIdStr(item.get_str())) {
+					strError = "invalid app regid " + item.get_str();
+					return false;
+				}
+				tFilter.setAppIds.insert(CRegID(item.get_str()).GetVec6());
+			}
+		}
+		const Value &valFormat = find_value(objRequest, "format");
+		if (valFormat.type() != null_type) {
+			if (valFormat.get_str() != "json" && valFormat.get_str() != "binary") {
+				strError = "format must be json or binary";
+				return false;
+			}
+			tFilter.bBinary = valFormat.get_str() == "binary";
+		}
+	} catch (std::exception &e) {
+		strError = strprintf("bad subscription request, %s", e.what());
+		return false;
+	}
+	*this = tFilter;
+	return true;
+}
+
+Object ST_EventFilter::ToJson() const {
+	Array arrTopics;
+	for (const auto &topic : g_arrEventTopics) {
+		if (nTopics & topic.nTopic) {
+			arrTopics.push_back(topic.pszName);
+		}
+	}
+	Array arrApps;
+	for (const auto &item : setAppIds) {
+		arrApps.push_back(CRegID(item).ToString());
+	}
+	Object obj;
+	obj.push_back(Pair("topics", arrTopics));
+	obj.push_back(Pair("apps", arrApps));
+	obj.push_back(Pair("format", bBinary ? "binary" : "json"));
+	return obj;
+}
+
+class CEventServer::CSession {
+ public:
+	CSession(boost::asio::io_service &ioService, int nId, const ST_EventFilter &tFilter) :
+			m_Socket(ioService), m_nId(nId), m_tFilter(tFilter), m_bWriting(false), m_bClosed(false), m_ullSent(0),
+			m_ullDropped(0), m_ReadBuf(MAX_EVENT_REQUEST) {
+	}
+
+	tcp::socket m_Socket;
+	int m_nId;
+	string m_strPeer;
+	ST_EventFilter m_tFilter;
+	deque<FramePtr> m_dFrames; 				// the front one is being written
+	bool m_bWriting;
+	bool m_bClosed;
+	uint64_t m_ullSent;
+	uint64_t m_ullDropped;
+	boost::asio::streambuf m_ReadBuf;
+};
+
+CEventServer::CEventServer() :
+		m_bInitialized(false), m_unMaxQueue(DEFAULT_EVENT_QUEUE), m_nNextId(0), m_ullNextSeq(0), m_bStop(true),
+		m_ullNextDeliver(0) {
+}
+
+CEventServer::~CEventServer() {
+	Stop();
+}
+
+bool CEventServer::Start(unsigned short usPort, int nThreads, size_t unMaxQueue) {
+	m_unMaxQueue = max<size_t>(1, unMaxQueue);
+	// without a subscription request, clients get what the single connection UI push sent them
+	m_tDefaultFilter = ST_EventFilter();
+	std::shared_ptr<vector<string> > pAppIds = SysCfg().GetMultiArgsMap("-appid");
+	for (const auto &strAppId : *pAppIds) {
+		if (CRegID::IsRegIdStr(strAppId)) {
+			m_tDefaultFilter.setAppIds.insert(CRegID(strAppId).GetVec6());
+		}
+	}
+	if (m_tDefaultFilter.setAppIds.empty()) {
+		m_tDefaultFilter.nTopics &= ~EM_TOPIC_APP_TX;
+	}
+
+	try {
+		m_pAcceptor.reset(new tcp::acceptor(m_IoService, tcp::endpoint(boost::asio::ip::address_v4::loopback(), usPort)));
+	} catch (const boost::system::system_error &e) {
+		return ERRORMSG("CEventServer::Start : cannot listen on port %u, %s", usPort, e.what());
+	}
+	{
+		boost::unique_lock<boost::mutex> lock(m_Mutex);
+		m_bStop = false;
+	}
+	Accept();
+	m_Threads.create_thread([this]() {
+		RenameThread("dacrs-eventio");
+		m_IoService.run();
+	});
+	for (int i = 0; i < max(1, min(nThreads, MAX_EVENT_THREADS)); ++i) {
+		m_Threads.create_thread(boost::bind(&CEventServer::ThreadWorker, this));
+	}
+	LogPrint("INFO", "event server listening on port %u\n", usPort);
+	return true;
+}
+
+void CEventServer::Stop() {
+	{
+		boost::unique_lock<boost::mutex> lock(m_Mutex);
+		if (m_bStop) {
+			return;
+		}
+		m_bStop = true;
+		m_dEvents.clear();
+	}
+	m_Cond.notify_all();
+	m_IoService.stop();
+	m_Threads.interrupt_all();
+	m_Threads.join_all();
+
+	LOCK(m_cs);
+	m_mapSessions.clear();
+	m_pAcceptor.reset();
+}
+
+bool CEventServer::IsSubscribed(emEventType emType, const vector<unsigned char> &vchAppId) const {
+	LOCK(m_cs);
+	for (const auto &item : m_mapSessions) {
+		if (item.second->m_tFilter.Matches(emType, vchAppId)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void CEventServer::Publish(ST_Event &&tEvent) {
+	std::shared_ptr<ST_Event> pEvent = std::make_shared<ST_Event>(std::move(tEvent));
+	{
+		boost::unique_lock<boost::mutex> lock(m_Mutex);
+		if (m_bStop) {
+			return;
+		}
+		if (m_dEvents.size() < m_unMaxQueue) {
+			m_dEvents.push_back(make_pair(m_ullNextSeq++, pEvent));
+			pEvent.reset();
+		}
+	}
+	if (!pEvent) {
+		m_Cond.notify_one();
+		return;
+	}
+	// the workers are behind, every subscriber of the event loses it
+	LOCK(m_cs);
+	for (const auto &item : m_mapSessions) {
+		if (item.second->m_tFilter.Matches(pEvent->emType, pEvent->vchAppId)) {
+			++item.second->m_ullDropped;
+		}
+	}
+}
+
+vector<ST_EventSubscriberStats> CEventServer::GetStats() const {
+	vector<ST_EventSubscriberStats> vStats;
+	LOCK(m_cs);
+	for (const auto &item : m_mapSessions) {
+		const CSession &cSession = *item.second;
+		ST_EventSubscriberStats tStats;
+		tStats.nId = cSession.m_nId;
+		tStats.strPeer = cSession.m_strPeer;
+		tStats.tFilter = cSession.m_tFilter;
+		tStats.ullSent = cSession.m_ullSent;
+		tStats.ullDropped = cSession.m_ullDropped;
+		tStats.unQueued = cSession.m_dFrames.size();
+		vStats.push_back(tStats);
+	}
+	return vStats;
+}
+
+static Object TxToJson(const ST_Event &tEvent, bool bDetail) {
+	// the snapshot may lag the tip by a few blocks, addresses of accounts registered since read empty
+	std::shared_ptr<CChainStateSnapshot> pSnapshot = GetChainStateSnapshot();
+	CAccountView cNullView;
+	CAccountViewCache cAccView(pSnapshot ? pSnapshot->GetAccountView() : cNullView, true);
+	Object objTx = tEvent.pTx->ToJSON(cAccView);
+	if (!tEvent.cBlockHash.IsNull()) {
+		objTx.push_back(Pair("blockhash", tEvent.cBlockHash.GetHex()));
+		objTx.push_back(Pair("confirmHeight", tEvent.nHeight));
+		objTx.push_back(Pair("confirmedtime", (int) tEvent.llTime));
+	}
+	if (bDetail) {
+		vector<CVmOperate> vcOutput;
+		if (pSnapshot && EM_CONTRACT_TX == tEvent.pTx->m_chTxType) {
+			CScriptDBViewCache cScriptDBView(pSnapshot->GetScriptDBView(), true);
+			if (cScriptDBView.ReadTxOutPut(tEvent.pTx->GetHash(), vcOutput)) {
+				Array outputArray;
+				for (auto &item : vcOutput) {
+					outputArray.push_back(item.ToJson());
+				}
+				objTx.push_back(Pair("listOutput", outputArray));
+			}
+		}
+		CDataStream cDs(SER_DISK, g_sClientVersion);
+		cDs << tEvent.pTx;
+		objTx.push_back(Pair("rawtx", HexStr(cDs.begin(), cDs.end())));
+	}
+	return objTx;
+}
+
+string CEventServer::ToJson(const ST_Event &tEvent) {
+	Object obj;
+	switch (tEvent.emType) {
+	case EM_EVENT_BLOCK:
+		obj.push_back(Pair("type", "blockchanged"));
+		obj.push_back(Pair("tips", tEvent.nTips));
+		obj.push_back(Pair("high", tEvent.nHeight));
+		obj.push_back(Pair("time", (int) tEvent.llTime));
+		obj.push_back(Pair("hash", tEvent.cHash.ToString()));
+		obj.push_back(Pair("connections", tEvent.nConnections));
+		obj.push_back(Pair("fuelrate", tEvent.nFuelRate));
+		break;
+	case EM_EVENT_WALLET_TX:
+		obj.push_back(Pair("type", "revtransaction"));
+		obj.push_back(Pair("transation", TxToJson(tEvent, true)));
+		break;
+	case EM_EVENT_SYNC_HEIGHT: {
+		Object objStartHeight;
+		objStartHeight.push_back(Pair("syncheight", tEvent.nHeight));
+		obj.push_back(Pair("type", "SyncTxHight"));
+		obj.push_back(Pair("msg", objStartHeight));
+		break;
+	}
+	case EM_EVENT_SYNC_TX:
+		obj.push_back(Pair("type", "SyncTx"));
+		obj.push_back(Pair("msg", TxToJson(tEvent, false)));
+		break;
+	case EM_EVENT_APP_TX:
+		obj.push_back(Pair("type", "rev_app_transaction"));
+		obj.push_back(Pair("transation", TxToJson(tEvent, false)));
+		break;
+	case EM_EVENT_MEMPOOL_ADD:
+		obj.push_back(Pair("type", "addtx"));
+		obj.push_back(Pair("transation", TxToJson(tEvent, false)));
+		break;
+	case EM_EVENT_MEMPOOL_REMOVE:
+		obj.push_back(Pair("type", "rmtx"));
+		obj.push_back(Pair("hash", tEvent.cHash.ToString()));
+		break;
+	case EM_EVENT_MEMPOOL_RELEASE:
+		obj.push_back(Pair("type", "releasetx"));
+		obj.push_back(Pair("hash", tEvent.cHash.ToString()));
+		break;
+	case EM_EVENT_MESSAGE:
+		obj.push_back(Pair("type", tEvent.strType));
+		if ("MessageBox" == tEvent.strType) {
+			obj.push_back(Pair("BoxType", tEvent.strMsg));
+			obj.push_back(Pair("BoxType", tEvent.strDetail));
+		} else {
+			obj.push_back(Pair("msg", tEvent.strMsg));
+		}
+		break;
+	}
+	return write_string(Value(std::move(obj)), true);
+}
+
+string CEventServer::ToBinary(const ST_Event &tEvent) {
+	CDataStream cDs(SER_DISK, g_sClientVersion);
+	cDs << (unsigned char) tEvent.emType;
+	switch (tEvent.emType) {
+	case EM_EVENT_BLOCK:
+		cDs << tEvent.cHash << tEvent.nHeight << tEvent.llTime << tEvent.nTips << tEvent.nConnections
+				<< tEvent.nFuelRate;
+		break;
+	case EM_EVENT_SYNC_HEIGHT:
+		cDs << tEvent.nHeight;
+		break;
+	case EM_EVENT_WALLET_TX:
+	case EM_EVENT_SYNC_TX:
+	case EM_EVENT_APP_TX:
+	case EM_EVENT_MEMPOOL_ADD:
+		cDs << tEvent.cBlockHash << tEvent.nHeight << tEvent.llTime << tEvent.vchAppId << tEvent.pTx;
+		break;
+	case EM_EVENT_MEMPOOL_REMOVE:
+	case EM_EVENT_MEMPOOL_RELEASE:
+		cDs << tEvent.cHash;
+		break;
+	case EM_EVENT_MESSAGE:
+		cDs << tEvent.strType << tEvent.strMsg << tEvent.strDetail;
+		break;
+	}
+	return string(cDs.begin(), cDs.end());
+}
+
+bool CEventServer::Frame(string &strData, bool bBinary) {
+	string strFrame;
+	if (bBinary) {
+		uint32_t unLen = strData.size();
+		strFrame.reserve(strData.size() + 5);
+		strFrame.push_back('B');
+		for (int i = 0; i < 4; ++i) {
+			strFrame.push_back((char) ((unLen >> (8 * i)) & 0xff));
+		}
+		strFrame += strData;
+	} else {
+		if (strData.empty() || strData.size() > 0xffff) {
+			return false;
+		}
+		unsigned short usLen = strData.size();
+		strFrame.reserve(strData.size() + 4);
+		strFrame.push_back('<');
+		strFrame.append((const char *) &usLen, 2);
+		strFrame += strData;
+		strFrame.push_back('>');
+	}
+	strData.swap(strFrame);
+	return true;
+}
+
+void CEventServer::ThreadWorker() {
+	RenameThread("dacrs-event");
+	while (true) {
+		pair<uint64_t, std::shared_ptr<ST_Event> > item;
+		{
+			boost::unique_lock<boost::mutex> lock(m_Mutex);
+			while (!m_bStop && m_dEvents.empty()) {
+				m_Cond.wait(lock);
+			}
+			if (m_bStop) {
+				return;
+			}
+			item = m_dEvents.front();
+			m_dEvents.pop_front();
+		}
+		const ST_Event &tEvent = *item.second;
+		bool bJson = false;
+		bool bBinary = false;
+		{
+			LOCK(m_cs);
+			for (const auto &session : m_mapSessions) {
+				const ST_EventFilter &tFilter = session.second->m_tFilter;
+				if (tFilter.Matches(tEvent.emType, tEvent.vchAppId)) {
+					(tFilter.bBinary ? bBinary : bJson) = true;
+				}
+			}
+		}
+		ST_Serialized tSerialized;
+		tSerialized.pEvent = item.second;
+		try {
+			if (bJson) {
+				string strData = ToJson(tEvent);
+				if (Frame(strData, false)) {
+					tSerialized.pJson = std::make_shared<const string>(std::move(strData));
+				} else {
+					LogPrint("event", "event %d of %u bytes is too large for a JSON frame\n", tEvent.emType,
+							strData.size());
+				}
+			}
+			if (bBinary) {
+				string strData = ToBinary(tEvent);
+				Frame(strData, true);
+				tSerialized.pBinary = std::make_shared<const string>(std::move(strData));
+			}
+		} catch (std::exception &e) {
+			LogPrint("event", "event %d not serialized, %s\n", tEvent.emType, e.what());
+		}
+		Deliver(item.first, std::move(tSerialized));
+	}
+}
+
+void CEventServer::Deliver(uint64_t ullSeq, ST_Serialized &&tSerialized) {
+	LOCK(m_csDeliver);
+	m_mapReady.insert(make_pair(ullSeq, std::move(tSerialized)));
+	auto it = m_mapReady.begin();
+	for (; it != m_mapReady.end() && it->first == m_ullNextDeliver; ++it, ++m_ullNextDeliver) {
+		const ST_Serialized &tReady = it->second;
+		LOCK(m_cs);
+		for (const auto &session : m_mapSessions) {
+			const ST_EventFilter &tFilter = session.second->m_tFilter;
+			if (tFilter.Matches(tReady.pEvent->emType, tReady.pEvent->vchAppId)) {
+				const FramePtr &pFrame = tFilter.bBinary ? tReady.pBinary : tReady.pJson;
+				if (pFrame) {
+					Enqueue(session.second, pFrame);
+				}
+			}
+		}
+	}
+	m_mapReady.erase(m_mapReady.begin(), it);
+}
+
+void CEventServer::Enqueue(const SessionPtr &pSession, const FramePtr &pFrame) {
+	LOCK(m_cs);
+	if (pSession->m_bClosed) {
+		return;
+	}
+	if (pSession->m_dFrames.size() >= m_unMaxQueue) {
+		if (0 == pSession->m_ullDropped++ % 1000) {
+			LogPrint("event", "event subscriber %d (%s) is not reading, %u events dropped\n", pSession->m_nId,
+					pSession->m_strPeer, pSession->m_ullDropped);
+		}
+		return;
+	}
+	pSession->m_dFrames.push_back(pFrame);
+	if (!pSession->m_bWriting) {
+		pSession->m_bWriting = true;
+		m_IoService.post(boost::bind(&CEventServer::Write, this, pSession));
+	}
+}
+
+static std::shared_ptr<const string> MakeControlFrame(const string &strType, const Value &valMsg) {
+	Object obj;
+	obj.push_back(Pair("type", strType));
+	obj.push_back(Pair("msg", valMsg));
+	string strData = write_string(Value(std::move(obj)), true);
+	CEventServer::Frame(strData, false);
+	return std::make_shared<const string>(std::move(strData));
+}
+
+void CEventServer::Accept() {
+	SessionPtr pSession;
+	{
+		LOCK(m_cs);
+		pSession = std::make_shared<CSession>(m_IoService, ++m_nNextId, m_tDefaultFilter);
+	}
+	m_pAcceptor->async_accept(pSession->m_Socket,
+			boost::bind(&CEventServer::HandleAccept, this, pSession, boost::asio::placeholders::error));
+}
+
+void CEventServer::HandleAccept(const SessionPtr &pSession, const boost::system::error_code &ec) {
+	if (boost::asio::error::operation_aborted == ec) {
+		return;
+	}
+	if (!ec) {
+		boost::system::error_code ecPeer;
+		tcp::endpoint cPeer = pSession->m_Socket.remote_endpoint(ecPeer);
+		pSession->m_strPeer = ecPeer ? "unknown" : strprintf("%s:%d", cPeer.address().to_string(), cPeer.port());
+		LogPrint("event", "event subscriber %d connected from %s\n", pSession->m_nId, pSession->m_strPeer);
+		{
+			LOCK(m_cs);
+			m_mapSessions[pSession->m_nId] = pSession;
+		}
+		if (m_bInitialized) {
+			Enqueue(pSession, MakeControlFrame("init", "initialize end"));
+		} else {
+			Enqueue(pSession, MakeControlFrame("hello", "hello asio"));
+		}
+		Read(pSession);
+	} else {
+		LogPrint("event", "event server accept failed, %s\n", ec.message());
+	}
+	Accept();
+}
+
+void CEventServer::Read(const SessionPtr &pSession) {
+	boost::asio::async_read_until(pSession->m_Socket, pSession->m_ReadBuf, '\n',
+			boost::bind(&CEventServer::HandleRead, this, pSession, boost::asio::placeholders::error,
+					boost::asio::placeholders::bytes_transferred));
+}
+
+void CEventServer::HandleRead(const SessionPtr &pSession, const boost::system::error_code &ec, size_t unBytes) {
+	if (ec) {
+		// also when a request line exceeds MAX_EVENT_REQUEST
+		Close(pSession);
+		return;
+	}
+	string strRequest(unBytes, '\0');
+	pSession->m_ReadBuf.sgetn(&strRequest[0], unBytes);
+
+	// replies to subscription requests are JSON frames whatever the format asked for
+	string strError;
+	FramePtr pReply;
+	{
+		LOCK(m_cs);
+		ST_EventFilter tFilter = pSession->m_tFilter;
+		if (tFilter.Parse(strRequest, strError)) {
+			pSession->m_tFilter = tFilter;
+			pReply = MakeControlFrame("subscribed", tFilter.ToJson());
+		} else {
+			pReply = MakeControlFrame("error", strError);
+		}
+	}
+	LogPrint("event", "event subscriber %d: %s", pSession->m_nId, strRequest);
+	Enqueue(pSession, pReply);
+	Read(pSession);
+}
+
+void CEventServer::Write(const SessionPtr &pSession) {
+	LOCK(m_cs);
+	if (pSession->m_bClosed || pSession->m_dFrames.empty()) {
+		pSession->m_bWriting = false;
+		return;
+	}
+	const FramePtr &pFrame = pSession->m_dFrames.front();
+	boost::asio::async_write(pSession->m_Socket, boost::asio::buffer(*pFrame),
+			boost::bind(&CEventServer::HandleWrite, this, pSession, boost::asio::placeholders::error));
+}
+
+void CEventServer::HandleWrite(const SessionPtr &pSession, const boost::system::error_code &ec) {
+	if (ec) {
+		Close(pSession);
+		return;
+	}
+	{
+		LOCK(m_cs);
+		if (pSession->m_bClosed) {
+			return;
+		}
+		pSession->m_dFrames.pop_front();
+		++pSession->m_ullSent;
+	}
+	Write(pSession);
+}
+
+void CEventServer::Close(const SessionPtr &pSession) {
+	LOCK(m_cs);
+	if (pSession->m_bClosed) {
+		return;
+	}
+	LogPrint("event", "event subscriber %d (%s) disconnected, %u events sent, %u dropped\n", pSession->m_nId,
+			pSession->m_strPeer, pSession->m_ullSent, pSession->m_ullDropped);
+	pSession->m_bClosed = true;
+	pSession->m_bWriting = false;
+	pSession->m_dFrames.clear();
+	m_mapSessions.erase(pSession->m_nId);
+	boost::system::error_code ecIgnored;
+	pSession->m_Socket.shutdown(tcp::socket::shutdown_both, ecIgnored);
+	pSession->m_Socket.close(ecIgnored);
+}
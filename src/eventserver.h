@@ -0,0 +1,192 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DACRS_EVENTSERVER_H_
+#define DACRS_EVENTSERVER_H_
+
+#include "sync.h"
+#include "uint256.h"
+#include "json/json_spirit_value.h"
+
+#include <stdint.h>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+
+using namespace std;
+
+class CBaseTransaction;
+
+static const unsigned int DEFAULT_EVENT_QUEUE = 1000;
+static const int DEFAULT_EVENT_THREADS = 1;
+static const int MAX_EVENT_THREADS = 8;
+
+/** What subscribers filter events on */
+enum emEventTopic {
+	EM_TOPIC_BLOCK 		= 1 << 0, 	// tip changes
+	EM_TOPIC_WALLET_TX 	= 1 << 1, 	// wallet transactions confirmed, or replayed at startup
+	EM_TOPIC_APP_TX 	= 1 << 2, 	// confirmed contract transactions, by app RegID
+	EM_TOPIC_MEMPOOL 	= 1 << 3, 	// transactions added to, removed from or put back in the mempool
+	EM_TOPIC_MESSAGE 	= 1 << 4, 	// init progress, notifications and message boxes
+	EM_TOPIC_ALL 		= (1 << 5) - 1,
+};
+
+enum emEventType {
+	EM_EVENT_BLOCK = 1,
+	EM_EVENT_WALLET_TX,
+	EM_EVENT_SYNC_HEIGHT,
+	EM_EVENT_SYNC_TX,
+	EM_EVENT_APP_TX,
+	EM_EVENT_MEMPOOL_ADD,
+	EM_EVENT_MEMPOOL_REMOVE,
+	EM_EVENT_MEMPOOL_RELEASE,
+	EM_EVENT_MESSAGE,
+};
+
+int GetEventTopic(emEventType emType);
+
+/**
+ * An event as captured by a validation callback: plain values and a reference to the immutable
+ * transaction. Its JSON or binary payload is only built later, by the event server's workers.
+ */
+struct ST_Event {
+	explicit ST_Event(emEventType emEventType) :
+			emType(emEventType), nHeight(0), llTime(0), nTips(0), nConnections(0), nFuelRate(0) {
+	}
+
+	emEventType emType;
+	uint256 cHash; 							// the block, or the transaction
+	uint256 cBlockHash; 					// block confirming the transaction, null if unconfirmed
+	int nHeight;
+	int64_t llTime;
+	int nTips;
+	int nConnections;
+	int nFuelRate;
+	vector<unsigned char> vchAppId; 		// 6-byte RegID of the app an app transaction calls
+	std::shared_ptr<CBaseTransaction> pTx;
+	string strType; 						// message events: init, notify or MessageBox
+	string strMsg;
+	string strDetail; 						// message box kind
+};
+
+/** Which events a subscriber gets, and how */
+struct ST_EventFilter {
+	ST_EventFilter() :
+			nTopics(EM_TOPIC_ALL), bBinary(false) {
+	}
+
+	int nTopics;
+	set<vector<unsigned char> > setAppIds; 	// app transactions of these apps only, of all apps if empty
+	bool bBinary;
+
+	bool Matches(emEventType emType, const vector<unsigned char> &vchAppId) const;
+	/**
+	 * Parse a subscription request such as
+	 * {"topics":["block","wallettx","apptx","mempool","message"],"apps":["11-1"],"format":"binary"}
+	 * Missing members keep their current value.
+	 */
+	bool Parse(const string &strRequest, string &strError);
+	json_spirit::Object ToJson() const;
+};
+
+struct ST_EventSubscriberStats {
+	int nId;
+	string strPeer;
+	ST_EventFilter tFilter;
+	uint64_t ullSent;
+	uint64_t ullDropped; 					// events dropped because the subscriber's queue was full
+	size_t unQueued;
+};
+
+/**
+ * Publish/subscribe server for local clients such as the UI.
+ *
+ * Every client connecting to -uiport gets the events its filter selects. Until it sends a
+ * subscription request (one JSON object per line, see ST_EventFilter::Parse) that is what the
+ * old UI push sent: everything but app transactions other than the -appid ones, as JSON framed
+ * by '<' + 2 byte length + '>'. Binary payloads are framed by 'B' + 4 byte length.
+ *
+ * Publish only queues the event, worker threads serialize it once per format and hand the frames
+ * to the subscribers in publishing order. A subscriber whose queue holds -eventqueue frames loses
+ * the next ones, which are counted.
+ */
+class CEventServer {
+ public:
+	CEventServer();
+	~CEventServer();
+
+	bool Start(unsigned short usPort, int nThreads, size_t unMaxQueue);
+	void Stop();
+
+	/** Whether any subscriber wants the event, checked before capturing it */
+	bool IsSubscribed(emEventType emType, const vector<unsigned char> &vchAppId = vector<unsigned char>()) const;
+	void Publish(ST_Event &&tEvent);
+
+	void SetInitialized() {
+		m_bInitialized = true;
+	}
+	vector<ST_EventSubscriberStats> GetStats() const;
+
+	static string ToJson(const ST_Event &tEvent);
+	static string ToBinary(const ST_Event &tEvent);
+	/** Frame a payload for the wire, false if it is too large for its framing */
+	static bool Frame(string &strData, bool bBinary);
+
+ private:
+	class CSession;
+	typedef std::shared_ptr<CSession> SessionPtr;
+	typedef std::shared_ptr<const string> FramePtr;
+
+	struct ST_Serialized {
+		std::shared_ptr<ST_Event> pEvent;
+		FramePtr pJson;
+		FramePtr pBinary;
+	};
+
+	CEventServer(const CEventServer&);
+	void operator=(const CEventServer&);
+
+	void ThreadWorker();
+	void Deliver(uint64_t ullSeq, ST_Serialized &&tSerialized);
+	void Enqueue(const SessionPtr &pSession, const FramePtr &pFrame);
+	void Accept();
+	void HandleAccept(const SessionPtr &pSession, const boost::system::error_code &ec);
+	void Read(const SessionPtr &pSession);
+	void HandleRead(const SessionPtr &pSession, const boost::system::error_code &ec, size_t unBytes);
+	void Write(const SessionPtr &pSession);
+	void HandleWrite(const SessionPtr &pSession, const boost::system::error_code &ec);
+	void Close(const SessionPtr &pSession);
+
+	boost::asio::io_service m_IoService;
+	std::unique_ptr<boost::asio::ip::tcp::acceptor> m_pAcceptor;
+	boost::thread_group m_Threads;
+	std::atomic<bool> m_bInitialized;
+	size_t m_unMaxQueue;
+	ST_EventFilter m_tDefaultFilter;
+
+	mutable CCriticalSection m_cs; 			// sessions, their filters, queues and counters
+	map<int, SessionPtr> m_mapSessions;
+	int m_nNextId;
+
+	boost::mutex m_Mutex; 					// events waiting for a worker
+	boost::condition_variable m_Cond;
+	deque<pair<uint64_t, std::shared_ptr<ST_Event> > > m_dEvents;
+	uint64_t m_ullNextSeq;
+	bool m_bStop;
+
+	CCriticalSection m_csDeliver; 			// serialized events waiting for the ones published before them
+	map<uint64_t, ST_Serialized> m_mapReady;
+	uint64_t m_ullNextDeliver;
+};
+
+extern CEventServer g_cEventServer;
+
+#endif // DACRS_EVENTSERVER_H_
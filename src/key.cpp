@@ -4,6 +4,9 @@
 
 #include "key.h"
 #include "hash.h"
+#include "crypto/secp256k1.h"
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
 #include <openssl/bn.h>
 #include <openssl/ecdsa.h>
 #include <openssl/obj_mac.h>
@@ -487,10 +490,95 @@ uint256 CPubKey::GetHash() const {
 	return Hash(vch, vch + size());
 }
 
+namespace {
+
+#ifdef USE_NATIVE_SECP256K1
+bool g_bNativeSigVerify = true;
+
+/** Public keys already decompressed and checked to be on the curve, the sqrt dominates parsing */
+class CPubKeyPointCache {
+ public:
+	CPubKeyPointCache() : m_unMaxSize(50000) {
+	}
+
+	bool Get(const CPubKey &cPubKey, secp256k1::CPoint &cPoint) {
+		{
+			boost::shared_lock<boost::shared_mutex> lock(m_cs_PointCache);
+			map<CPubKey, secp256k1::CPoint>::const_iterator it = m_mapPoint.find(cPubKey);
+			if (it != m_mapPoint.end()) {
+				cPoint = it->second;
+				return true;
+			}
+		}
+		if (!secp256k1::ParsePubKey(cPubKey.begin(), cPubKey.size(), cPoint)) {
+			return false;
+		}
+		boost::unique_lock<boost::shared_mutex> lock(m_cs_PointCache);
+		if (m_unMaxSize == 0) {
+			return true;
+		}
+		while (m_mapPoint.size() >= m_unMaxSize) {
+			// Evict a random entry, same reasoning as the signature cache
+			vector<unsigned char> vchRandom(33, 0x02);
+			uint256 cRandomHash = GetRandHash();
+			memcpy(&vchRandom[1], cRandomHash.begin(), 32);
+			map<CPubKey, secp256k1::CPoint>::iterator it = m_mapPoint.lower_bound(CPubKey(vchRandom));
+			if (it == m_mapPoint.end()) {
+				it = m_mapPoint.begin();
+			}
+			m_mapPoint.erase(it);
+		}
+		m_mapPoint.insert(make_pair(cPubKey, cPoint));
+		return true;
+	}
+
+	void SetMaxSize(unsigned int unMaxSize) {
+		boost::unique_lock<boost::shared_mutex> lock(m_cs_PointCache);
+		m_unMaxSize = unMaxSize;
+		m_mapPoint.clear();
+	}
+
+ private:
+	unsigned int m_unMaxSize;
+	map<CPubKey, secp256k1::CPoint> m_mapPoint;
+	boost::shared_mutex m_cs_PointCache;
+};
+
+CPubKeyPointCache g_cPubKeyPointCache;
+#else
+const bool g_bNativeSigVerify = false;
+#endif
+
+}
+
+void SetNativeSigVerify(bool bNative, unsigned int unMaxPubKeyCacheSize) {
+#ifdef USE_NATIVE_SECP256K1
+	g_bNativeSigVerify = bNative;
+	g_cPubKeyPointCache.SetMaxSize(unMaxPubKeyCacheSize);
+	if (bNative) {
+		secp256k1::InitContext();
+	}
+#endif
+}
+
+bool IsNativeSigVerify() {
+	return g_bNativeSigVerify;
+}
+
 bool CPubKey::Verify(const uint256 &cHash, const vector<unsigned char>& vchSig) const {
 	if (!IsValid()) {
 		return false;
 	}
+#ifdef USE_NATIVE_SECP256K1
+	if (g_bNativeSigVerify && !vchSig.empty()) {
+		secp256k1::CPoint cPoint;
+		secp256k1::CSignature cSig;
+		if (secp256k1::ParseSignatureDER(&vchSig[0], vchSig.size(), cSig) && g_cPubKeyPointCache.Get(*this, cPoint)) {
+			return secp256k1::Verify((const unsigned char *) &cHash, cSig, cPoint);
+		}
+		// lax DER and invalid keys fall through, OpenSSL keeps the final say on what parses
+	}
+#endif
 	CECKey cKey;
 	if (!cKey.SetPubKey(*this)) {
 		return false;
@@ -226,6 +226,8 @@ public:
 
 	// Verify a DER signature (~72 bytes).
 	// If this public key is not fully valid, the return value will be false.
+	// Strict DER signatures go through the native secp256k1 verifier unless it is
+	// disabled with SetNativeSigVerify(), anything else is handed to OpenSSL.
 	bool Verify(const uint256 &hash, const vector<unsigned char>& vchSig) const;
 
 	// Verify a compact signature (~65 bytes).
@@ -242,6 +244,11 @@ public:
 	bool Derive(CPubKey& pubkeyChild, unsigned char ccChild[32], unsigned int nChild, const unsigned char cc[32]) const;
 };
 
+// Select the verifier used by CPubKey::Verify and bound the cache of parsed public keys,
+// bNative has no effect when the native verifier is not compiled in (see crypto/secp256k1.h)
+void SetNativeSigVerify(bool bNative, unsigned int unMaxPubKeyCacheSize);
+bool IsNativeSigVerify();
+
 // secure_allocator is defined in allocators.h
 // CPrivKey is a serialized private key, with all parameters included (279 bytes)
 typedef vector<unsigned char, secure_allocator<unsigned char> > CPrivKey;
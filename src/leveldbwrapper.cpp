@@ -30,23 +30,38 @@ void HandleError(const leveldb::Status &status) throw(leveldb_error) {
     throw leveldb_error("Unknown database error");
 }
 
-static leveldb::Options GetOptions(size_t nCacheSize) {
+static leveldb::Options GetOptions(const ST_LevelDBTuning &tTuning) {
     leveldb::Options tOptions;
-    tOptions.block_cache 		= leveldb::NewLRUCache(nCacheSize / 2);
-    tOptions.write_buffer_size 	= nCacheSize / 4; // up to two write buffers may be held in memory simultaneously
-    tOptions.filter_policy 		= leveldb::NewBloomFilterPolicy(10);
-    tOptions.compression 		= leveldb::kNoCompression;
-    tOptions.max_open_files 	= 64;
+    tOptions.block_cache 		= leveldb::NewLRUCache(tTuning.unBlockCacheSize);
+    tOptions.write_buffer_size 	= tTuning.unWriteBufferSize;
+    tOptions.filter_policy 		= tTuning.nBloomBits > 0 ? leveldb::NewBloomFilterPolicy(tTuning.nBloomBits) : NULL;
+    tOptions.compression 		= tTuning.bCompress ? leveldb::kSnappyCompression : leveldb::kNoCompression;
+    tOptions.max_open_files 	= tTuning.nMaxOpenFiles;
     return tOptions;
 }
 
 CLevelDBWrapper::CLevelDBWrapper(const boost::filesystem::path &path, size_t unCacheSize, bool bMemory, bool bWipe) {
+    ST_LevelDBTuning tTuning;
+    tTuning.unBlockCacheSize 	= unCacheSize / 2;
+    tTuning.unWriteBufferSize 	= unCacheSize / 4;
+    Open(path, tTuning, bMemory, bWipe);
+}
+
+CLevelDBWrapper::CLevelDBWrapper(const boost::filesystem::path &path, const ST_LevelDBTuning &tTuning, bool bMemory,
+		bool bWipe) {
+    Open(path, tTuning, bMemory, bWipe);
+}
+
+void CLevelDBWrapper::Open(const boost::filesystem::path &path, const ST_LevelDBTuning &tTuning, bool bMemory,
+		bool bWipe) {
     m_pEnv 							= NULL;
+    m_pSnapshot 					= NULL;
+    m_ullWriteSeq 					= 0;
     m_tReadoptions.verify_checksums = true;
     m_tIteroptions.verify_checksums = true;
     m_tIteroptions.fill_cache 		= false;
     m_tSyncoptions.sync 			= true;
-    m_tOptions 						= GetOptions(unCacheSize);
+    m_tOptions 						= GetOptions(tTuning);
     m_tOptions.create_if_missing 	= true;
     if (bMemory) {
         m_pEnv = leveldb::NewMemEnv(leveldb::Env::Default());
@@ -64,7 +79,29 @@ CLevelDBWrapper::CLevelDBWrapper(const boost::filesystem::path &path, size_t unC
     LogPrint("INFO","Opened LevelDB successfully\n");
 }
 
+CLevelDBWrapper::CLevelDBWrapper(CLevelDBWrapper *pBase) {
+    m_pEnv 							= NULL;
+    m_pDb 							= pBase->m_pDb;
+    m_pSnapshot 					= m_pDb->GetSnapshot();
+    m_ullWriteSeq 					= 0;
+    m_tReadoptions 					= pBase->m_tReadoptions;
+    m_tIteroptions 					= pBase->m_tIteroptions;
+    m_tReadoptions.snapshot 		= m_pSnapshot;
+    m_tIteroptions.snapshot 		= m_pSnapshot;
+}
+
 CLevelDBWrapper::~CLevelDBWrapper() {
+    for (auto &item : m_vIterPool) {
+        delete item.first;
+    }
+    m_vIterPool.clear();
+    if (m_pSnapshot) {
+        // the database belongs to the wrapper this snapshot was taken from
+        m_pDb->ReleaseSnapshot(m_pSnapshot);
+        m_pSnapshot = NULL;
+        m_pDb = NULL;
+        return;
+    }
     delete m_pDb;
     m_pDb = NULL;
     delete m_tOptions.filter_policy;
@@ -76,11 +113,63 @@ CLevelDBWrapper::~CLevelDBWrapper() {
 }
 
 bool CLevelDBWrapper::WriteBatch(CLevelDBBatch &cBatch, bool bSync) throw (leveldb_error) {
+	if (m_pSnapshot) {
+		throw leveldb_error("Database snapshot is read-only");
+	}
 	leveldb::Status status = m_pDb->Write(bSync ? m_tSyncoptions : m_tWriteoptions, &cBatch.m_Batch);
+	// only once the batch is visible, so an iterator predating it can never pass for current
+	++m_ullWriteSeq;
+	{
+		// idle iterators would pin the memtables and files they were created on
+		LOCK(m_csIterPool);
+		for (auto &item : m_vIterPool) {
+			delete item.first;
+		}
+		m_vIterPool.clear();
+	}
 	HandleError(status);
 	return true;
 }
 
+static const size_t MAX_POOLED_ITERATORS = 8;
+
+std::unique_ptr<CLevelDBIterator> CLevelDBWrapper::NewIterator(const string &strPrefix) {
+	uint64_t ullWriteSeq = m_ullWriteSeq;
+	leveldb::Iterator *pIter = NULL;
+	{
+		LOCK(m_csIterPool);
+		while (!m_vIterPool.empty() && pIter == NULL) {
+			pair<leveldb::Iterator*, uint64_t> item = m_vIterPool.back();
+			m_vIterPool.pop_back();
+			if (item.second == ullWriteSeq) {
+				pIter = item.first;
+				ullWriteSeq = item.second;
+			} else {
+				delete item.first;
+			}
+		}
+	}
+	if (pIter == NULL) {
+		pIter = m_pDb->NewIterator(m_tIteroptions);
+	}
+	return std::unique_ptr<CLevelDBIterator>(new CLevelDBIterator(this, pIter, ullWriteSeq, strPrefix));
+}
+
+void CLevelDBWrapper::ReleaseIterator(leveldb::Iterator *pIter, uint64_t ullWriteSeq) {
+	if (ullWriteSeq == m_ullWriteSeq && pIter->status().ok()) {
+		LOCK(m_csIterPool);
+		if (m_vIterPool.size() < MAX_POOLED_ITERATORS) {
+			m_vIterPool.push_back(make_pair(pIter, ullWriteSeq));
+			return;
+		}
+	}
+	delete pIter;
+}
+
+CLevelDBIterator::~CLevelDBIterator() {
+	m_pParent->ReleaseIterator(m_pIter, m_ullWriteSeq);
+}
+
 int64_t CLevelDBWrapper::GetDbCount() {
 	leveldb::Iterator *pCursor = NewIterator();
 	int64_t llRet = 0;
@@ -106,3 +195,19 @@ int64_t CLevelDBWrapper::GetDbCount() {
 	delete pCursor;
 	return llRet;
 }
+
+string CLevelDBWrapper::GetProperty(const string &strName) {
+	string strValue;
+	if (!m_pDb->GetProperty(strName, &strValue)) {
+		return "";
+	}
+	return strValue;
+}
+
+uint64_t CLevelDBWrapper::GetApproximateSize() {
+	// all keys start with an ASCII record tag
+	leveldb::Range tRange("", "\xff");
+	uint64_t ullSize = 0;
+	m_pDb->GetApproximateSizes(&tRange, 1, &ullSize);
+	return ullSize;
+}
@@ -6,9 +6,12 @@
 #define DACRS_LEVELDBWRAPPER_H_
 
 #include "serialize.h"
+#include "sync.h"
 #include "util.h"
 #include "version.h"
 
+#include <atomic>
+#include <memory>
 #include <boost/filesystem/path.hpp>
 #include <leveldb/db.h>
 #include <leveldb/write_batch.h>
@@ -24,6 +27,135 @@ class leveldb_error: public runtime_error {
 
 void HandleError(const leveldb::Status &status) throw(leveldb_error);
 
+// How one LevelDB instance is tuned
+struct ST_LevelDBTuning {
+	ST_LevelDBTuning() :
+			unBlockCacheSize(0), unWriteBufferSize(0), nBloomBits(10), bCompress(false), nMaxOpenFiles(64) {
+	}
+
+	size_t unBlockCacheSize;
+	size_t unWriteBufferSize; 		// up to two write buffers may be held in memory simultaneously
+	int nBloomBits; 				// bits per key of the bloom filter, 0 for none
+	bool bCompress; 				// snappy compression of table blocks, if LevelDB was built with it
+	int nMaxOpenFiles;
+};
+
+// Deserializes straight out of a LevelDB slice, without copying it into a CDataStream first
+class CSliceReader {
+ public:
+	explicit CSliceReader(const leveldb::Slice &slData, int nTypeIn = SER_DISK, int nVersionIn = g_sClientVersion) :
+			nType(nTypeIn), nVersion(nVersionIn), m_pCur(slData.data()), m_pEnd(slData.data() + slData.size()) {
+	}
+
+	CSliceReader &read(char *pch, size_t unSize) {
+		if (unSize > size()) {
+			throw ios_base::failure("CSliceReader::read() : end of data");
+		}
+		memcpy(pch, m_pCur, unSize);
+		m_pCur += unSize;
+		return *this;
+	}
+
+	void ignore(size_t unSize) {
+		if (unSize > size()) {
+			throw ios_base::failure("CSliceReader::ignore() : end of data");
+		}
+		m_pCur += unSize;
+	}
+
+	size_t size() const {
+		return m_pEnd - m_pCur;
+	}
+
+	bool empty() const {
+		return m_pCur == m_pEnd;
+	}
+
+	// what has not been read yet
+	leveldb::Slice Rest() const {
+		return leveldb::Slice(m_pCur, size());
+	}
+
+	template<typename T> CSliceReader &operator>>(T &obj) {
+		::Unserialize(*this, obj, nType, nVersion);
+		return *this;
+	}
+
+	int nType;
+	int nVersion;
+
+ private:
+	const char *m_pCur;
+	const char *m_pEnd;
+};
+
+class CLevelDBWrapper;
+
+/**
+ * Iterator over the keys of a CLevelDBWrapper which start with a prefix. It sees the database as
+ * of its creation, or the snapshot of the wrapper, and hands its LevelDB iterator back to the
+ * wrapper for reuse when destroyed. Keys and values are slices into LevelDB's own buffers.
+ */
+class CLevelDBIterator {
+ public:
+	~CLevelDBIterator();
+
+	// first key at or after prefix + strStart
+	void Seek(const string &strStart = "") {
+		m_pIter->Seek(m_strPrefix + strStart);
+	}
+
+	bool Valid() const {
+		return m_pIter->Valid() && m_pIter->key().starts_with(m_strPrefix);
+	}
+
+	void Next() {
+		m_pIter->Next();
+	}
+
+	leveldb::Slice Key() const {
+		return m_pIter->key();
+	}
+
+	// the key without the prefix
+	leveldb::Slice KeySuffix() const {
+		leveldb::Slice slKey = m_pIter->key();
+		slKey.remove_prefix(m_strPrefix.size());
+		return slKey;
+	}
+
+	leveldb::Slice Value() const {
+		return m_pIter->value();
+	}
+
+	template<typename V> bool GetValue(V &value) const {
+		try {
+			CSliceReader cReader(m_pIter->value());
+			cReader >> value;
+		} catch (std::exception &e) {
+			return false;
+		}
+		return true;
+	}
+
+	leveldb::Status Status() const {
+		return m_pIter->status();
+	}
+
+ private:
+	friend class CLevelDBWrapper;
+	CLevelDBIterator(CLevelDBWrapper *pParent, leveldb::Iterator *pIter, uint64_t ullWriteSeq, const string &strPrefix) :
+			m_pParent(pParent), m_pIter(pIter), m_ullWriteSeq(ullWriteSeq), m_strPrefix(strPrefix) {
+	}
+	CLevelDBIterator(const CLevelDBIterator&);
+	void operator=(const CLevelDBIterator&);
+
+	CLevelDBWrapper *m_pParent;
+	leveldb::Iterator *m_pIter;
+	uint64_t m_ullWriteSeq; 		// writes to the parent before m_pIter was created
+	string m_strPrefix;
+};
+
 // Batch of changes queued to be written to a CLevelDBWrapper
 class CLevelDBBatch {
  public:
@@ -70,6 +202,11 @@ class CLevelDBBatch {
 
 		m_Batch.Delete(cSliceKey);
 	}
+
+	// already encoded key and value, such as records copied from another database
+	void Put(const leveldb::Slice &slKey, const leveldb::Slice &slValue) {
+		m_Batch.Put(slKey, slValue);
+	}
 	friend class CLevelDBWrapper;
 
  private:
@@ -79,6 +216,10 @@ class CLevelDBBatch {
 class CLevelDBWrapper {
  public:
     CLevelDBWrapper(const boost::filesystem::path &path, size_t unCacheSize, bool bMemory = false, bool bWipe = false);
+    CLevelDBWrapper(const boost::filesystem::path &path, const ST_LevelDBTuning &tTuning, bool bMemory = false,
+    		bool bWipe = false);
+    // Read-only view of pBase frozen at the time of construction. pBase must outlive it.
+    explicit CLevelDBWrapper(CLevelDBWrapper *pBase);
     ~CLevelDBWrapper();
 
     template<typename K, typename V> bool Read(const K& key, V& value) throw(leveldb_error) {
@@ -174,7 +315,18 @@ class CLevelDBWrapper {
         return m_pDb->NewIterator(m_tIteroptions);
     }
 
+    // iterator over the keys starting with strPrefix, reusing a pooled LevelDB iterator if nothing was written since
+    std::unique_ptr<CLevelDBIterator> NewIterator(const string &strPrefix);
+
+    bool IsSnapshot() const {
+        return m_pSnapshot != NULL;
+    }
+
     int64_t GetDbCount();
+    // LevelDB property such as "leveldb.stats", empty if unknown
+    string GetProperty(const string &strName);
+    // approximate bytes the whole key range takes on disk
+    uint64_t GetApproximateSize();
    // Object ToJosnObj();
 
  private:
@@ -198,6 +350,23 @@ class CLevelDBWrapper {
 
      // the database itself
      leveldb::DB *m_pDb;
+
+     void Open(const boost::filesystem::path &path, const ST_LevelDBTuning &tTuning, bool bMemory, bool bWipe);
+
+     // set when this wrapper is a read-only snapshot of a database owned by another wrapper
+     const leveldb::Snapshot *m_pSnapshot;
+
+     friend class CLevelDBIterator;
+     void ReleaseIterator(leveldb::Iterator *pIter, uint64_t ullWriteSeq);
+
+     // batches written, iterators created before the last one are stale
+     std::atomic<uint64_t> m_ullWriteSeq;
+     // idle iterators and the write sequence they were created at
+     CCriticalSection m_csIterPool;
+     vector<pair<leveldb::Iterator*, uint64_t> > m_vIterPool;
+
+     CLevelDBWrapper(const CLevelDBWrapper&);
+     void operator=(const CLevelDBWrapper&);
 };
 
 #endif // DACRS_LEVELDBWRAPPER_H_
@@ -10,6 +10,7 @@
 #include "chainparams.h"
 #include "checkpoints.h"
 #include "checkqueue.h"
+#include "compress.h"
 #include "init.h"
 #include "net.h"
 #include "txdb.h"
@@ -55,6 +56,11 @@ map<uint256, std::tuple<std::shared_ptr<CAccountViewCache>, std::shared_ptr<CTra
 
 CSignatureCache g_cSignatureCache;
 
+ST_BlockPhaseStats g_arrtBlockPhaseStats[EM_BLOCK_PHASE_MAX];
+
+uint64_t g_ullPruneTarget = 0;			// Override with -prune
+bool g_bHavePruned = false;
+
 /** Fees smaller than this (in satoshi) are considered zero fee (for transaction creation) */
 uint64_t CBaseTransaction::m_sMinTxFee = 10000;			// Override with -mintxfee
 /** Fees smaller than this (in satoshi) are considered zero fee (for relaying and mining) */
@@ -134,6 +140,11 @@ CCriticalSection g_cs_LastBlockFile;
 CBlockFileInfo g_InfoLastBlockFile;
 int g_nLastBlockFile = 0;
 
+// Set when the blk or rev files grow, to look for files to prune at the next chain state flush
+bool g_bCheckForPruning = false;
+// Block files deleted by -prune. Protected by g_cs_LastBlockFile.
+set<int> g_setPrunedBlockFiles;
+
 // Every received block is assigned a unique and increasing identifier, so we
 // know which one to give priority in case of a fork.
 CCriticalSection g_cs_nBlockSequenceId;
@@ -175,6 +186,8 @@ struct CMainSignals {
 	boost::signals2::signal<void(const uint256 &)> Inventory;
 	// Tells listeners to broadcast their data.
 	boost::signals2::signal<void()> Broadcast;
+	// Notifies listeners that the mempool view has been rebuilt.
+	boost::signals2::signal<void()> UpdatedMemPool;
 } g_signals;
 }
 
@@ -249,9 +262,11 @@ void RegisterWallet(CWalletInterface* pWalletIn) {
     g_signals.UpdatedTransaction.connect(boost::bind(&CWalletInterface::UpdatedTransaction, pWalletIn, _1));
     g_signals.SetBestChain.connect(boost::bind(&CWalletInterface::SetBestChain, pWalletIn, _1));
     g_signals.Broadcast.connect(boost::bind(&CWalletInterface::ResendWalletTransactions, pWalletIn));
+    g_signals.UpdatedMemPool.connect(boost::bind(&CWalletInterface::UpdatedMemPool, pWalletIn));
 }
 
 void UnregisterWallet(CWalletInterface* pWalletIn) {
+    g_signals.UpdatedMemPool.disconnect(boost::bind(&CWalletInterface::UpdatedMemPool, pWalletIn));
     g_signals.Broadcast.disconnect(boost::bind(&CWalletInterface::ResendWalletTransactions, pWalletIn));
     g_signals.SetBestChain.disconnect(boost::bind(&CWalletInterface::SetBestChain, pWalletIn, _1));
     g_signals.UpdatedTransaction.disconnect(boost::bind(&CWalletInterface::UpdatedTransaction, pWalletIn, _1));
@@ -260,6 +275,7 @@ void UnregisterWallet(CWalletInterface* pWalletIn) {
 }
 
 void UnregisterAllWallets() {
+    g_signals.UpdatedMemPool.disconnect_all_slots();
     g_signals.Broadcast.disconnect_all_slots();
     g_signals.Inventory.disconnect_all_slots();
     g_signals.SetBestChain.disconnect_all_slots();
@@ -276,6 +292,10 @@ void EraseTransaction(const uint256 &cHash) {
 	g_signals.EraseTransaction(cHash);
 }
 
+void SyncMemPoolWithWallets() {
+	g_signals.UpdatedMemPool();
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // Registration of network node signals.
 
@@ -518,6 +538,55 @@ CTransactionDBCache *g_pTxCacheTip = NULL;
 CScriptDB *g_pScriptDB = NULL;
 CScriptDBViewCache *g_pScriptDBTip = NULL;
 
+static CCriticalSection g_cs_ChainStateSnapshot;
+static std::shared_ptr<CChainStateSnapshot> g_pChainStateSnapshot;
+// active chain as seen by the snapshots, only ever appended to while shared
+static std::shared_ptr<vector<CBlockIndex*> > g_pSnapshotChain;
+
+void PublishChainStateSnapshot() {
+	AssertLockHeld(g_cs_main);
+	int nHeight = g_cChainActive.Height();
+	if (nHeight < 0 || g_pAccountViewDB == NULL || g_pScriptDB == NULL) {
+		return;
+	}
+	// Reuse the shared chain while the new tip builds on it and it has room; readers of
+	// older snapshots never look past their own height, so appending in place is safe.
+	// Anything that would overwrite an existing entry gets a fresh copy instead.
+	bool bReuse = false;
+	if (g_pSnapshotChain && !g_pSnapshotChain->empty()) {
+		int nCommon = min(nHeight, (int) g_pSnapshotChain->size() - 1);
+		bReuse = (*g_pSnapshotChain)[nCommon] == g_cChainActive[nCommon]
+				&& g_pSnapshotChain->capacity() > (size_t) nHeight;
+	}
+	if (bReuse) {
+		for (int i = g_pSnapshotChain->size(); i <= nHeight; ++i) {
+			g_pSnapshotChain->push_back(g_cChainActive[i]);
+		}
+	} else {
+		std::shared_ptr<vector<CBlockIndex*> > pChain = std::make_shared<vector<CBlockIndex*> >();
+		pChain->reserve((nHeight + 1) * 2);
+		for (int i = 0; i <= nHeight; ++i) {
+			pChain->push_back(g_cChainActive[i]);
+		}
+		g_pSnapshotChain = pChain;
+	}
+	std::shared_ptr<CChainStateSnapshot> pSnapshot = std::make_shared<CChainStateSnapshot>(g_pSnapshotChain, nHeight,
+			g_pAccountViewDB, g_pScriptDB);
+	LOCK(g_cs_ChainStateSnapshot);
+	g_pChainStateSnapshot = pSnapshot;
+}
+
+void ReleaseChainStateSnapshot() {
+	LOCK(g_cs_ChainStateSnapshot);
+	g_pChainStateSnapshot.reset();
+	g_pSnapshotChain.reset();
+}
+
+std::shared_ptr<CChainStateSnapshot> GetChainStateSnapshot() {
+	LOCK(g_cs_ChainStateSnapshot);
+	return g_pChainStateSnapshot;
+}
+
 unsigned int LimitOrphanTxSize(unsigned int nMaxOrphans) {
 	unsigned int unEvicted = 0;
 	while (g_mapOrphanTransactions.size() > nMaxOrphans) {
@@ -609,8 +678,73 @@ bool CheckSignScript(const uint256 & cSigHash, const std::vector<unsigned char>
 	return true;
 }
 
+namespace {
+// -assumevalid as resolved by InitAssumeValid(), and the checkpoint height of that block if it is one
+uint256 g_cAssumeValidHash;
+int g_nAssumeValidCheckpointHeight = -1;
+// ancestors of the assume-valid block, filled in once that block is indexed
+CChain g_cAssumeValidChain;
+}
+
+void InitAssumeValid() {
+	g_cAssumeValidHash = uint256();
+	g_nAssumeValidCheckpointHeight = -1;
+	g_cAssumeValidChain.SetTip(NULL);
+
+	string strAssumeValid = SysCfg().GetArg("-assumevalid", "");
+	map<int, uint256> mapCheckPoints;
+	if (Checkpoints::g_bEnabled) {
+		Checkpoints::GetCheckpointMap(mapCheckPoints);
+	}
+	if (!strAssumeValid.empty()) {
+		g_cAssumeValidHash = uint256S(strAssumeValid);
+	} else if (!mapCheckPoints.empty()) {
+		g_cAssumeValidHash = mapCheckPoints.rbegin()->second;
+	}
+	if (g_cAssumeValidHash.IsNull()) {
+		return;
+	}
+	for (const auto &item : mapCheckPoints) {
+		if (item.second == g_cAssumeValidHash) {
+			g_nAssumeValidCheckpointHeight = item.first;
+		}
+	}
+}
+
+uint256 GetAssumeValidBlock(int &nHeight) {
+	nHeight = -1;
+	if (g_cAssumeValidHash.IsNull()) {
+		return g_cAssumeValidHash;
+	}
+	map<uint256, CBlockIndex*>::iterator iterIndex = g_mapBlockIndex.find(g_cAssumeValidHash);
+	if (iterIndex != g_mapBlockIndex.end()) {
+		nHeight = iterIndex->second->m_nHeight;
+	} else {
+		nHeight = g_nAssumeValidCheckpointHeight;
+	}
+	return g_cAssumeValidHash;
+}
+
+bool IsAssumedValid(const CBlockIndex *pBlockIndex) {
+	AssertLockHeld(g_cs_main);
+	if (pBlockIndex == NULL || g_cAssumeValidHash.IsNull()) {
+		return false;
+	}
+	// Only a block that is indexed can vouch for its ancestors, before that even a
+	// side fork below a checkpoint height would be connected without signature checks
+	map<uint256, CBlockIndex*>::iterator iterIndex = g_mapBlockIndex.find(g_cAssumeValidHash);
+	if (iterIndex == g_mapBlockIndex.end()) {
+		return false;
+	}
+	if (g_cAssumeValidChain.Tip() != iterIndex->second) {
+		g_cAssumeValidChain.SetTip(iterIndex->second);
+	}
+	// the chain holds the ancestor of the assume-valid block at every height below it
+	return g_cAssumeValidChain[pBlockIndex->m_nHeight] == pBlockIndex;
+}
+
 bool CheckTransaction(CBaseTransaction *pBaseTx, CValidationState &cValidationState,
-		CAccountViewCache &cAccountViewCache, CScriptDBViewCache &cScriptDBViewCache) {
+		CAccountViewCache &cAccountViewCache, CScriptDBViewCache &cScriptDBViewCache, bool bCheckSig) {
 	if (EM_REWARD_TX == pBaseTx->m_chTxType) {
 		return true;
 	}
@@ -628,7 +762,7 @@ bool CheckTransaction(CBaseTransaction *pBaseTx, CValidationState &cValidationSt
 		return cValidationState.DoS(100, ERRORMSG("CheckTransaction() : size limits failed"), REJECT_INVALID,
 						"bad-txns-oversize");
 	}
-	if (!pBaseTx->CheckTransction(cValidationState, cAccountViewCache, cScriptDBViewCache)) {
+	if (!pBaseTx->CheckTransction(cValidationState, cAccountViewCache, cScriptDBViewCache, bCheckSig)) {
 		return false;
 	}
 
@@ -667,7 +801,7 @@ int64_t GetMinFee(const CBaseTransaction *pBaseTx, unsigned int unBytes, bool bA
 }
 
 bool AcceptToMemoryPool(CTxMemPool& cTxMemPool, CValidationState &cValidationState, CBaseTransaction *pBaseTx,
-		bool bLimitFree, bool bRejectInsaneFee) {
+		bool bLimitFree, bool bRejectInsaneFee, int64_t llEntryTime) {
 	AssertLockHeld(g_cs_main);
 
 	// is it already in the memory pool?
@@ -693,7 +827,7 @@ bool AcceptToMemoryPool(CTxMemPool& cTxMemPool, CValidationState &cValidationSta
 				REJECT_INVALID, "tx-invalid-height");
 	}
 	// CAccountViewCache view(*pAccountViewTip, true);
-	if (!CheckTransaction(pBaseTx, cValidationState, *cTxMemPool.m_pAccountViewCache, *cTxMemPool.m_pScriptDBViewCache)) {
+	if (!CheckTransaction(pBaseTx, cValidationState, *cTxMemPool.m_pAccountViewCache, *cTxMemPool.m_pScriptDBViewCache, true)) {
 		return ERRORMSG("AcceptToMemoryPool: : CheckTransaction failed");
 	}
 	// Rather not work on nonstandard transactions (unless -testnet/-regtest)
@@ -707,7 +841,8 @@ bool AcceptToMemoryPool(CTxMemPool& cTxMemPool, CValidationState &cValidationSta
 		double dPriority = pBaseTx->GetPriority();
 		int64_t llFees = pBaseTx->GetFee();
 
-		CTxMemPoolEntry cEntry(pBaseTx, llFees, GetTime(), dPriority, g_cChainActive.Height());
+		CTxMemPoolEntry cEntry(pBaseTx, llFees, llEntryTime > 0 ? llEntryTime : GetTime(), dPriority,
+				g_cChainActive.Height());
 		unsigned int unSize = cEntry.GetTxSize();
 
 		if (pBaseTx->m_chTxType == EM_COMMON_TX) {
@@ -754,16 +889,184 @@ bool AcceptToMemoryPool(CTxMemPool& cTxMemPool, CValidationState &cValidationSta
 			return ERRORMSG("AcceptToMemoryPool: : insane fees %s, %d > %d", cHash.ToString(), llFees,
 								SysCfg().GetMaxFee());
 		}
+		// A full pool only takes transactions paying more than its cheapest one, fuel can only lower the fee
+		double dMinFeePerKb = cTxMemPool.GetMinFeePerKb(unSize);
+		if (dMinFeePerKb > 0 && cEntry.GetFeePerKb() <= dMinFeePerKb) {
+			return cValidationState.DoS(0,
+					ERRORMSG("AcceptToMemoryPool : mempool full, %s fee per KB %f <= %f", cHash.ToString(),
+							cEntry.GetFeePerKb(), dMinFeePerKb), REJECT_INSUFFICIENTFEE, "mempool full");
+		}
 		// Store transaction in memory
 		if (!cTxMemPool.addUnchecked(cHash, cEntry, cValidationState)) {
 			return ERRORMSG("AcceptToMemoryPool: : addUnchecked failed cHash:%s \r\n", cHash.ToString());
 		}
+		// Evicted transactions leave together with the ones that used what they wrote
+		vector<uint256> vcEvicted;
+		if (cTxMemPool.TrimToSize(vcEvicted)) {
+			if (!cTxMemPool.exists(cHash)) {
+				return cValidationState.DoS(0, ERRORMSG("AcceptToMemoryPool : mempool full, %s evicted", cHash.ToString()),
+						REJECT_INSUFFICIENTFEE, "mempool full");
+			}
+		}
 	}
+	g_cUIInterface.AcceptTransaction(cHash);
 	g_signals.SyncTransaction(cHash, pBaseTx, NULL);
 
 	return true;
 }
 
+static const uint64_t MEMPOOL_DUMP_VERSION = 1;
+// set by LoadMempool, until then the pool holds only part of mempool.dat and must not overwrite it
+static bool g_bMempoolLoaded = false;
+
+struct ST_MempoolDumpEntry {
+	std::shared_ptr<CBaseTransaction> pTx;
+	int64_t llFee;
+	int64_t llTime;
+	unsigned int unHeight;
+};
+
+bool DumpMempool() {
+	int64_t llStart = GetTimeMillis();
+	// network magic, version, entries oldest first so loading executes them in the pool's order, checksum
+	CDataStream cDSMempool(SER_DISK, g_sClientVersion);
+	uint64_t ullCount = 0;
+	{
+		LOCK(g_cTxMemPool.m_cs);
+		if (!g_bMempoolLoaded) {
+			return false;
+		}
+		const IndexedTxSet::index<ST_EntryTimeTag>::type &cByTime = g_cTxMemPool.m_mapTx.get<ST_EntryTimeTag>();
+		ullCount = cByTime.size();
+		cDSMempool << FLATDATA(SysCfg().MessageStart());
+		cDSMempool << MEMPOOL_DUMP_VERSION;
+		cDSMempool << ullCount;
+		for (const auto &cEntry : cByTime) {
+			cDSMempool << cEntry.GetTx();
+			cDSMempool << cEntry.GetFee();
+			cDSMempool << cEntry.GetTime();
+			cDSMempool << cEntry.GetHeight();
+		}
+	}
+	uint256 cHash = Hash(cDSMempool.begin(), cDSMempool.end());
+	cDSMempool << cHash;
+
+	boost::filesystem::path cPathMempool = GetDataDir() / "mempool.dat";
+	boost::filesystem::path cPathTemp = GetDataDir() / "mempool.dat.new";
+	FILE *pFile = fopen(cPathTemp.string().c_str(), "wb");
+	CAutoFile cAutoFileout = CAutoFile(pFile, SER_DISK, g_sClientVersion);
+	if (!cAutoFileout) {
+		return ERRORMSG("%s : Failed to open file %s", __func__, cPathTemp.string());
+	}
+	try {
+		cAutoFileout << cDSMempool;
+	} catch (std::exception &e) {
+		return ERRORMSG("%s : Serialize or I/O error - %s", __func__, e.what());
+	}
+	FileCommit(cAutoFileout);
+	cAutoFileout.fclose();
+	if (!RenameOver(cPathTemp, cPathMempool)) {
+		return ERRORMSG("%s : Rename-into-place failed", __func__);
+	}
+	LogPrint("INFO", "DumpMempool : saved %u transactions in %dms\n", ullCount, GetTimeMillis() - llStart);
+
+	return true;
+}
+
+static bool ReadMempoolFile(const boost::filesystem::path &cPathMempool, vector<ST_MempoolDumpEntry> &vtEntries) {
+	FILE *pFile = fopen(cPathMempool.string().c_str(), "rb");
+	CAutoFile cAutoFilein = CAutoFile(pFile, SER_DISK, g_sClientVersion);
+	if (!cAutoFilein) {
+		return ERRORMSG("%s : Failed to open file %s", __func__, cPathMempool.string());
+	}
+	uint64_t ullFileSize = boost::filesystem::file_size(cPathMempool);
+	if (ullFileSize < sizeof(uint256)) {
+		return ERRORMSG("%s : File %s too short, %u bytes", __func__, cPathMempool.string(), ullFileSize);
+	}
+	vector<unsigned char> vchData(ullFileSize - sizeof(uint256));
+	uint256 cHashIn;
+	try {
+		if (!vchData.empty()) {
+			cAutoFilein.read((char *) &vchData[0], vchData.size());
+		}
+		cAutoFilein >> cHashIn;
+	} catch (std::exception &e) {
+		return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+	}
+	cAutoFilein.fclose();
+
+	CDataStream cDSMempool(vchData, SER_DISK, g_sClientVersion);
+	if (cHashIn != Hash(cDSMempool.begin(), cDSMempool.end())) {
+		return ERRORMSG("%s : Checksum mismatch, data corrupted", __func__);
+	}
+	unsigned char pchMsgTmp[4];
+	uint64_t ullVersion = 0;
+	uint64_t ullCount = 0;
+	try {
+		cDSMempool >> FLATDATA(pchMsgTmp);
+		if (memcmp(pchMsgTmp, SysCfg().MessageStart(), sizeof(pchMsgTmp))) {
+			return ERRORMSG("%s : Invalid network magic number", __func__);
+		}
+		cDSMempool >> ullVersion;
+		if (ullVersion != MEMPOOL_DUMP_VERSION) {
+			return ERRORMSG("%s : Unknown version %u", __func__, ullVersion);
+		}
+		cDSMempool >> ullCount;
+		for (uint64_t i = 0; i < ullCount; ++i) {
+			ST_MempoolDumpEntry tEntry;
+			cDSMempool >> tEntry.pTx;
+			cDSMempool >> tEntry.llFee;
+			cDSMempool >> tEntry.llTime;
+			cDSMempool >> tEntry.unHeight;
+			vtEntries.push_back(tEntry);
+		}
+	} catch (std::exception &e) {
+		return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+	}
+
+	return true;
+}
+
+bool LoadMempool() {
+	int64_t llStart = GetTimeMillis();
+	boost::filesystem::path cPathMempool = GetDataDir() / "mempool.dat";
+	vector<ST_MempoolDumpEntry> vtEntries;
+	bool bRead = boost::filesystem::exists(cPathMempool) && ReadMempoolFile(cPathMempool, vtEntries);
+
+	// Re-validate against the current tip in batches so block processing is not held off for the whole file
+	unsigned int unAccepted = 0;
+	unsigned int unFailed = 0;
+	unsigned int unAlreadyThere = 0;
+	for (size_t i = 0; i < vtEntries.size(); i += MEMPOOL_LOAD_BATCH_SIZE) {
+		boost::this_thread::interruption_point();
+		LOCK(g_cs_main);
+		size_t unEnd = min(vtEntries.size(), i + MEMPOOL_LOAD_BATCH_SIZE);
+		for (size_t j = i; j < unEnd; ++j) {
+			const ST_MempoolDumpEntry &tEntry = vtEntries[j];
+			if (g_cTxMemPool.exists(tEntry.pTx->GetHash())) {
+				++unAlreadyThere;
+				continue;
+			}
+			CValidationState cValidationState;
+			if (AcceptToMemoryPool(g_cTxMemPool, cValidationState, tEntry.pTx.get(), false, false, tEntry.llTime)) {
+				++unAccepted;
+			} else {
+				LogPrint("mempool", "LoadMempool : dropped %s, fee %d, entered at height %u\n",
+						tEntry.pTx->GetHash().GetHex(), tEntry.llFee, tEntry.unHeight);
+				++unFailed;
+			}
+		}
+	}
+	{
+		LOCK(g_cTxMemPool.m_cs);
+		g_bMempoolLoaded = true;
+	}
+	LogPrint("INFO", "LoadMempool : %u accepted, %u failed, %u already there of %u in %dms\n", unAccepted, unFailed,
+			unAlreadyThere, vtEntries.size(), GetTimeMillis() - llStart);
+
+	return bRead;
+}
+
 int CMerkleTx::GetDepthInMainChainINTERNAL(CBlockIndex* &pBlockIndexRet) const {
 	if (m_cHashBlock.IsNull() || m_nIndex == -1) {
 		return 0;
@@ -818,12 +1121,8 @@ int GetTxComfirmHigh(const uint256 &cHash, CScriptDBViewCache &cScriptDBCache) {
 	if (SysCfg().IsTxIndex()) {
 		ST_DiskTxPos tPostx;
 		if (cScriptDBCache.ReadTxIndex(cHash, tPostx)) {
-			CAutoFile cFile(OpenBlockFile(tPostx, true), SER_DISK, g_sClientVersion);
 			CBlockHeader cBlockHeader;
-			try {
-				cFile >> cBlockHeader;
-			} catch (std::exception &e) {
-				ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+			if (!ReadTxFromDisk(tPostx, cBlockHeader)) {
 				return -1;
 			}
 			return cBlockHeader.GetHeight();
@@ -850,16 +1149,8 @@ bool GetTransaction(std::shared_ptr<CBaseTransaction> &pBaseTx, const uint256 &c
 		if (SysCfg().IsTxIndex()) {
 			ST_DiskTxPos tPostx;
 			if (cScriptDBCache.ReadTxIndex(cHash, tPostx)) {
-				CAutoFile cFile(OpenBlockFile(tPostx, true), SER_DISK, g_sClientVersion);
 				CBlockHeader cBlockHeader;
-				try {
-					cFile >> cBlockHeader;
-					fseek(cFile, tPostx.m_unTxOffset, SEEK_CUR);
-					cFile >> pBaseTx;
-				} catch (std::exception &e) {
-					return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
-				}
-				return true;
+				return ReadTxFromDisk(tPostx, cBlockHeader, &pBaseTx);
 			}
 		}
 	}
@@ -870,25 +1161,124 @@ bool GetTransaction(std::shared_ptr<CBaseTransaction> &pBaseTx, const uint256 &c
 //////////////////////////////////////////////////////////////////////////////
 // CBlock and CBlockIndex
 
-bool WriteBlockToDisk(CBlock& cBlock, ST_DiskBlockPos& tDiskBlockPos) {
+void CDiskRecord::PackData(const CDataStream &ssData, bool bCompress) {
+	if (bCompress && !ssData.empty()) {
+		CBlockPhaseTimer cTimer(EM_BLOCK_PHASE_COMPRESS);
+		vector<unsigned char> vchCompressed;
+		CompressLZ4((const unsigned char *) &ssData.begin()[0], ssData.size(), vchCompressed);
+		if (sizeof(unsigned int) + vchCompressed.size() < ssData.size()) {
+			CDataStream ssPacked(SER_DISK, g_sClientVersion);
+			ssPacked << (unsigned int) ssData.size();
+			ssPacked.write((const char *) &vchCompressed[0], vchCompressed.size());
+			m_vchData.assign(ssPacked.begin(), ssPacked.end());
+			m_unSize = m_vchData.size() | DISK_RECORD_COMPRESSED;
+			return;
+		}
+	}
+	m_vchData.assign(ssData.begin(), ssData.end());
+	m_unSize = m_vchData.size();
+}
+
+bool CDiskRecord::Write(CAutoFile &cFileout, unsigned int &unPos) const {
+	cFileout << FLATDATA(SysCfg().MessageStart()) << m_unSize;
+	long lFileOutPos = ftell(cFileout);
+	if (lFileOutPos < 0) {
+		return ERRORMSG("CDiskRecord::Write : ftell failed");
+	}
+	unPos = (unsigned int) lFileOutPos;
+	if (!m_vchData.empty()) {
+		cFileout.write(&m_vchData[0], m_vchData.size());
+	}
+	return true;
+}
+
+// Read the size field of the record starting at the file's position, leaving the position unchanged
+static bool ReadDiskRecordSize(CAutoFile &cFilein, unsigned int &unSize) {
+	if (fseek(cFilein, -(long) sizeof(unSize), SEEK_CUR)) {
+		return ERRORMSG("ReadDiskRecordSize : fseek failed");
+	}
+	try {
+		cFilein >> unSize;
+	} catch (std::exception &e) {
+		return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+	}
+	return true;
+}
+
+// Whether the record starting at the position pFile was opened at is compressed, taking the file
+static bool IsDiskRecordCompressed(FILE *pFile) {
+	CAutoFile cFilein(pFile, SER_DISK, g_sClientVersion);
+	unsigned int unSize = 0;
+	return cFilein && ReadDiskRecordSize(cFilein, unSize) && (unSize & DISK_RECORD_COMPRESSED);
+}
+
+// Bytes a record written before takes in its file, its data starting at the position pFile was opened at
+static bool GetDiskRecordSize(FILE *pFile, unsigned int &unDiskSize) {
+	CAutoFile cFilein(pFile, SER_DISK, g_sClientVersion);
+	unsigned int unSize = 0;
+	if (!cFilein || !ReadDiskRecordSize(cFilein, unSize)) {
+		return false;
+	}
+	unDiskSize = MESSAGE_START_SIZE + sizeof(unSize) + (unSize & ~DISK_RECORD_COMPRESSED);
+	return true;
+}
+
+bool ReadDiskRecord(CAutoFile &cFilein, CDataStream &ssData) {
+	unsigned int unSize = 0;
+	if (!ReadDiskRecordSize(cFilein, unSize)) {
+		return false;
+	}
+	unsigned int unDataSize = unSize & ~DISK_RECORD_COMPRESSED;
+	if (unDataSize > g_sMaxSize) {
+		return ERRORMSG("ReadDiskRecord : bad record size %u", unDataSize);
+	}
+	ssData.clear();
+	ssData.resize(unDataSize);
+	try {
+		if (unDataSize > 0) {
+			cFilein.read(&ssData[0], unDataSize);
+		}
+	} catch (std::exception &e) {
+		return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+	}
+	return UnpackDiskRecord(unSize, ssData);
+}
+
+bool UnpackDiskRecord(unsigned int unSize, CDataStream &ssData, size_t unPrefix) {
+	if (!(unSize & DISK_RECORD_COMPRESSED)) {
+		return true;
+	}
+	CBlockPhaseTimer cTimer(EM_BLOCK_PHASE_DECOMPRESS);
+	unsigned int unRawSize = 0;
+	try {
+		ssData >> unRawSize;
+	} catch (std::exception &e) {
+		return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+	}
+	if (unRawSize > g_sMaxSize) {
+		return ERRORMSG("UnpackDiskRecord : bad uncompressed size %u", unRawSize);
+	}
+	bool bPrefix = unPrefix > 0 && unPrefix < unRawSize;
+	CSerializeData vchRaw(bPrefix ? unPrefix : unRawSize);
+	if (!vchRaw.empty() && !DecompressLZ4((const unsigned char *) &ssData.begin()[0], ssData.size(),
+			(unsigned char *) &vchRaw[0], vchRaw.size(), bPrefix)) {
+		return ERRORMSG("UnpackDiskRecord : corrupt compressed record");
+	}
+	ssData = CDataStream(vchRaw, ssData.GetType(), ssData.GetVersion());
+	return true;
+}
+
+bool WriteBlockToDisk(const CDiskRecord &cRecord, ST_DiskBlockPos& tDiskBlockPos) {
 	// Open history file to append
 	CAutoFile cFileout = CAutoFile(OpenBlockFile(tDiskBlockPos), SER_DISK, g_sClientVersion);
 	if (!cFileout) {
 		return ERRORMSG("WriteBlockToDisk : OpenBlockFile failed");
 	}
-	// Write index header
-	unsigned int unSize = cFileout.GetSerializeSize(cBlock);
-	cFileout << FLATDATA(SysCfg().MessageStart()) << unSize;
-
-	// Write block
-	long lFileOutPos = ftell(cFileout);
-	if (lFileOutPos < 0) {
-		return ERRORMSG("WriteBlockToDisk : ftell failed");
+	// Write index header and block
+	if (!cRecord.Write(cFileout, tDiskBlockPos.unPos)) {
+		return false;
 	}
 
-	tDiskBlockPos.unPos = (unsigned int) lFileOutPos;
-	cFileout << cBlock;
-
 	// Flush stdio buffers and commit to disk before returning
 	fflush(cFileout);
 	if (!IsInitialBlockDownload()) {
@@ -907,8 +1297,12 @@ bool ReadBlockFromDisk(CBlock& cBlock, const ST_DiskBlockPos& tDiskBlockPos) {
 		return ERRORMSG("ReadBlockFromDisk : OpenBlockFile failed");
 	}
 	// Read block
+	CDataStream ssBlock(SER_DISK, g_sClientVersion);
+	if (!ReadDiskRecord(cFilein, ssBlock)) {
+		return ERRORMSG("ReadBlockFromDisk : ReadDiskRecord failed");
+	}
 	try {
-		cFilein >> cBlock;
+		ssBlock >> cBlock;
 	} catch (std::exception &e) {
 		return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
 	}
@@ -931,6 +1325,80 @@ bool ReadBlockFromDisk(CBlock& cBlock, const CBlockIndex* pBlockIndex) {
 	return true;
 }
 
+// Find the active chain block stored at tPos in a pruned file. A block is written after its parent,
+// so the positions of the active chain grow with the height and can be searched by bisection.
+static CBlockIndex *FindPrunedBlock(const ST_DiskBlockPos &tPos) {
+	// the published chain is readable from any thread, and pruned blocks are deep in it
+	std::shared_ptr<CChainStateSnapshot> pSnapshot = GetChainStateSnapshot();
+	if (!pSnapshot) {
+		return NULL;
+	}
+	int nLow = 0;
+	int nHigh = pSnapshot->Height();
+	while (nLow <= nHigh) {
+		int nMid = nLow + (nHigh - nLow) / 2;
+		CBlockIndex *pIndex = (*pSnapshot)[nMid];
+		if (pIndex->m_nFile == tPos.nFile && pIndex->m_nDataPos == tPos.unPos) {
+			return (pIndex->m_unStatus & BLOCK_PRUNED) ? pIndex : NULL;
+		}
+		if (make_pair(pIndex->m_nFile, pIndex->m_nDataPos) < make_pair(tPos.nFile, tPos.unPos)) {
+			nLow = nMid + 1;
+		} else {
+			nHigh = nMid - 1;
+		}
+	}
+	return NULL;
+}
+
+bool ReadTxFromDisk(const ST_DiskTxPos &tPosTx, CBlockHeader &cHeader, std::shared_ptr<CBaseTransaction> *pBaseTx) {
+	bool bPruned = false;
+	{
+		LOCK(g_cs_LastBlockFile);
+		bPruned = g_setPrunedBlockFiles.count(tPosTx.nFile) > 0;
+	}
+	if (bPruned) {
+		// the header is still in the block index, the transaction is gone
+		CBlockIndex *pIndex = FindPrunedBlock(tPosTx);
+		if (pIndex == NULL || pBaseTx != NULL) {
+			return ERRORMSG("ReadTxFromDisk : block file %d has been pruned", tPosTx.nFile);
+		}
+		cHeader = pIndex->GetBlockHeader();
+		return true;
+	}
+	CAutoFile cFilein = CAutoFile(OpenBlockFile(tPosTx, true), SER_DISK, g_sClientVersion);
+	if (!cFilein) {
+		return ERRORMSG("ReadTxFromDisk : OpenBlockFile failed");
+	}
+	unsigned int unSize = 0;
+	if (!ReadDiskRecordSize(cFilein, unSize)) {
+		return false;
+	}
+	try {
+		// m_unTxOffset counts from the end of the header in the serialized block
+		if (!(unSize & DISK_RECORD_COMPRESSED)) {
+			cFilein >> cHeader;
+			if (pBaseTx != NULL) {
+				fseek(cFilein, tPosTx.m_unTxOffset, SEEK_CUR);
+				cFilein >> *pBaseTx;
+			}
+			return true;
+		}
+		CDataStream ssBlock(SER_DISK, g_sClientVersion);
+		if (!ReadDiskRecord(cFilein, ssBlock)) {
+			return false;
+		}
+		ssBlock >> cHeader;
+		if (pBaseTx != NULL) {
+			ssBlock.ignore(tPosTx.m_unTxOffset);
+			ssBlock >> *pBaseTx;
+		}
+	} catch (std::exception &e) {
+		return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+	}
+
+	return true;
+}
+
 uint256 static GetOrphanRoot(const uint256& cHash) {
 	map<uint256, ST_OrphanBlock*>::iterator it = g_mapOrphanBlocks.find(cHash);
 	if (it == g_mapOrphanBlocks.end()) {
@@ -1448,12 +1916,259 @@ void static FlushBlockFile(bool bFinalize = false) {
 
 bool FindUndoPos(CValidationState &cValidationState, int nFile, ST_DiskBlockPos &tDiskBlockPos, unsigned int nAddSize);
 
-//static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
+/**
+ * Outcome of executing one block transaction on private caches: what it read from the state
+ * below and what it changed. The changes stand as long as no earlier transaction of the block
+ * wrote anything it read.
+ */
+struct ST_TxSpeculation {
+	bool m_bExecuted;
+	bool m_bUntracked;		// read a range, the read set is incomplete
+	CTxUndo m_cTxUndo;
+	set<CKeyID> m_setReadAccounts;
+	set<vector<unsigned char> > m_setReadKeyIds;
+	set<vector<unsigned char> > m_setReadKeys;
+	set<vector<unsigned char> > m_setReadPrefixes;
+	map<CKeyID, CAccount> m_mapAccounts;
+	map<vector<unsigned char>, CKeyID> m_mapKeyIds;
+	map<vector<unsigned char>, vector<unsigned char> > m_mapDatas;
+
+	ST_TxSpeculation() :
+			m_bExecuted(false), m_bUntracked(false) {
+	}
+};
+
+static bool ExecuteTxTracked(CBaseTransaction *pBaseTx, int nIndex, CAccountView &cAccountView,
+		CScriptDBView &cScriptDBView, CCriticalSection &cs, CValidationState &cValidationState, int nHeight,
+		CTransactionDBCache &cTxCache, ST_TxSpeculation &tSpeculation) {
+	CReadTrackingAccountView cTrackingAccountView(cAccountView, cs);
+	CReadTrackingScriptDBView cTrackingScriptDBView(cScriptDBView, cs);
+	CAccountViewCache cAccountCache(cTrackingAccountView, true);
+	CScriptDBViewCache cScriptCache(cTrackingScriptDBView, true);
+
+	tSpeculation = ST_TxSpeculation();
+	CBlockPhaseTimer cTimer(GetExecutePhase(pBaseTx->m_chTxType));
+	tSpeculation.m_bExecuted = pBaseTx->ExecuteTx(nIndex, cAccountCache, cValidationState, tSpeculation.m_cTxUndo,
+			nHeight, cTxCache, cScriptCache);
+	tSpeculation.m_bUntracked = cTrackingAccountView.m_bUntracked || cTrackingScriptDBView.m_bUntracked;
+	tSpeculation.m_setReadAccounts.swap(cTrackingAccountView.m_setReadAccounts);
+	tSpeculation.m_setReadKeyIds.swap(cTrackingAccountView.m_setReadKeyIds);
+	tSpeculation.m_setReadKeys.swap(cTrackingScriptDBView.m_setReadKeys);
+	tSpeculation.m_setReadPrefixes.swap(cTrackingScriptDBView.m_setReadPrefixes);
+	cTrackingAccountView.GetWrites(cAccountCache, tSpeculation.m_mapAccounts, tSpeculation.m_mapKeyIds);
+	cTrackingScriptDBView.GetWrites(cScriptCache, tSpeculation.m_mapDatas);
+
+	return tSpeculation.m_bExecuted;
+}
+
+// Speculative execution of one block transaction on the block's starting state
+class CTxExecCheck {
+ public:
+	CTxExecCheck() :
+			m_pBaseTx(NULL), m_nIndex(0), m_pAccountView(NULL), m_pScriptDBView(NULL), m_pCs(NULL), m_nHeight(0),
+			m_pTxCache(NULL), m_pSpeculation(NULL) {
+	}
+	CTxExecCheck(CBaseTransaction *pBaseTx, int nIndex, CAccountView *pAccountView, CScriptDBView *pScriptDBView,
+			CCriticalSection *pCs, int nHeight, CTransactionDBCache *pTxCache, ST_TxSpeculation *pSpeculation) :
+			m_pBaseTx(pBaseTx), m_nIndex(nIndex), m_pAccountView(pAccountView), m_pScriptDBView(pScriptDBView),
+			m_pCs(pCs), m_nHeight(nHeight), m_pTxCache(pTxCache), m_pSpeculation(pSpeculation) {
+	}
+
+	bool operator()() {
+		CValidationState cValidationState;
+		try {
+			ExecuteTxTracked(m_pBaseTx, m_nIndex, *m_pAccountView, *m_pScriptDBView, *m_pCs, cValidationState,
+					m_nHeight, *m_pTxCache, *m_pSpeculation);
+		} catch (std::exception &e) {
+			m_pSpeculation->m_bExecuted = false;
+		}
+		// a failed speculation is settled when the transaction is executed again in block order
+		return true;
+	}
+
+	void swap(CTxExecCheck &cCheck) {
+		std::swap(m_pBaseTx, cCheck.m_pBaseTx);
+		std::swap(m_nIndex, cCheck.m_nIndex);
+		std::swap(m_pAccountView, cCheck.m_pAccountView);
+		std::swap(m_pScriptDBView, cCheck.m_pScriptDBView);
+		std::swap(m_pCs, cCheck.m_pCs);
+		std::swap(m_nHeight, cCheck.m_nHeight);
+		std::swap(m_pTxCache, cCheck.m_pTxCache);
+		std::swap(m_pSpeculation, cCheck.m_pSpeculation);
+	}
+
+ private:
+	CBaseTransaction *m_pBaseTx;
+	int m_nIndex;
+	CAccountView *m_pAccountView;
+	CScriptDBView *m_pScriptDBView;
+	CCriticalSection *m_pCs;
+	int m_nHeight;
+	CTransactionDBCache *m_pTxCache;
+	ST_TxSpeculation *m_pSpeculation;
+};
+
+static CCheckQueue<CTxExecCheck> g_sTxExecCheckQueue(4);
+
+void ThreadScriptCheck() {
+	RenameThread("dacrs-txexec");
+	g_sTxExecCheckQueue.Thread();
+}
+
+/**
+ * Runs the transactions of a block after its reward transaction on the -par threads, each one on
+ * private caches over the block's starting state. ConnectBlock commits the runs in block order and
+ * executes again any transaction that read something an earlier one wrote, so state, undo data and
+ * run steps come out the same as executing the transactions one by one.
+ */
+static void SpeculateBlockTxs(CBlock& cBlock, CAccountViewCache &cAccountViewCache, int nHeight,
+		CTransactionDBCache &cTxCache, CScriptDBViewCache &cScriptCache, CCriticalSection &cs,
+		vector<ST_TxSpeculation> &vSpeculation) {
+	vSpeculation.resize(cBlock.vptx.size());
+	vector<CTxExecCheck> vChecks;
+	vChecks.reserve(cBlock.vptx.size() - 1);
+	for (unsigned int i = 1; i < cBlock.vptx.size(); i++) {
+		cBlock.vptx[i]->m_nFuelRate = cBlock.GetFuelRate();
+		vChecks.push_back(CTxExecCheck(cBlock.vptx[i].get(), i, &cAccountViewCache, &cScriptCache, &cs, nHeight,
+				&cTxCache, &vSpeculation[i]));
+	}
+	CCheckQueueControl<CTxExecCheck> cControl(&g_sTxExecCheckQueue);
+	cControl.Add(vChecks);
+	cControl.Wait();
+}
+
+/**
+ * Second pass of the tx index once the block's undo data has its position: the entries are written
+ * again with the position of each transaction's CTxUndo record. The undo data keeps the operation
+ * log of the first pass, so disconnecting the block still restores the entries from before it.
+ */
+static bool WriteTxUndoIndex(CScriptDBViewCache &cScriptCache, const CBlockUndo &cUndoBlock,
+		const ST_DiskBlockPos &tUndoPos, vector<pair<uint256, ST_DiskTxPos> > &vPos) {
+	map<uint256, unsigned int> mapUndoPos;
+	unsigned int unPos = tUndoPos.unPos + GetSizeOfCompactSize(cUndoBlock.m_vcTxUndo.size());
+	for (const auto &cTxUndo : cUndoBlock.m_vcTxUndo) {
+		mapUndoPos.insert(make_pair(cTxUndo.m_cTxHash, unPos));
+		unPos += ::GetSerializeSize(cTxUndo, SER_DISK, g_sClientVersion);
+	}
+	for (auto &item : vPos) {
+		map<uint256, unsigned int>::const_iterator it = mapUndoPos.find(item.first);
+		if (it != mapUndoPos.end()) {
+			item.second.m_unUndoPos = it->second;
+		}
+	}
+	vector<CScriptDBOperLog> vcTxIndexOperDB;
+
+	return cScriptCache.WriteTxIndex(vPos, vcTxIndexOperDB);
+}
+
+/**
+ * Executes the transactions of a block after its reward transaction on the block's caches and
+ * leaves one undo record per transaction in vcTxUndo. With bParallel they are first run
+ * speculatively on the -par threads and merged in block order, otherwise one by one; both ways
+ * end in the same state.
+ */
+bool ExecuteBlockTxs(CBlock& cBlock, CValidationState& cValidationState, CAccountViewCache &cAccountViewCache,
+		CTransactionDBCache &cTxCache, CScriptDBViewCache &cScriptCache, int nHeight, bool bParallel,
+		vector<CTxUndo> &vcTxUndo, int64_t &llTotalFuel) {
+	uint64_t ullTotalRunStep(0);
+	llTotalFuel = 0;
+	vcTxUndo.clear();
+	vcTxUndo.reserve(cBlock.vptx.size());
+	// serializes the speculative runs' reads of the caches, which fill themselves on reads
+	CCriticalSection csBaseView;
+	vector<ST_TxSpeculation> vSpeculation;
+	if (bParallel) {
+		SpeculateBlockTxs(cBlock, cAccountViewCache, nHeight, cTxCache, cScriptCache, csBaseView, vSpeculation);
+	}
+	// keys written by the transactions committed so far
+	set<CKeyID> setWrittenAccounts;
+	set<vector<unsigned char> > setWrittenKeyIds;
+	set<vector<unsigned char> > setWrittenKeys;
+	for (unsigned int i = 1; i < cBlock.vptx.size(); i++) {
+		std::shared_ptr<CBaseTransaction> pBaseTx = cBlock.vptx[i];
+		if (uint256() != cTxCache.IsContainTx((pBaseTx->GetHash()))) {
+			return cValidationState.DoS(100,
+					ERRORMSG("ConnectBlock() : the TxHash %s the confirm duplicate", pBaseTx->GetHash().GetHex()),
+					REJECT_INVALID, "bad-cb-amount");
+		}
+		assert(g_mapBlockIndex.count(cAccountViewCache.GetBestBlock()));
+		if (!pBaseTx->IsValidHeight(g_mapBlockIndex[cAccountViewCache.GetBestBlock()]->m_nHeight,
+				SysCfg().GetTxCacheHeight())) {
+			return cValidationState.DoS(100,
+					ERRORMSG("ConnectBlock() : txhash=%s beyond the scope of valid height",
+							pBaseTx->GetHash().GetHex()), REJECT_INVALID, "tx-invalid-height");
+		}
+		if (EM_CONTRACT_TX == pBaseTx->m_chTxType) {
+			LogPrint("vm", "tx hash=%s ConnectBlock run contract\n", pBaseTx->GetHash().GetHex());
+		}
+		LogPrint("op_account", "tx index:%d tx hash:%s\n", i, pBaseTx->GetHash().GetHex());
+		CTxUndo cUndoTx;
+		if (bParallel) {
+			ST_TxSpeculation &tSpeculation = vSpeculation[i];
+			if (!tSpeculation.m_bExecuted || tSpeculation.m_bUntracked
+					|| IntersectsKeys(tSpeculation.m_setReadAccounts, setWrittenAccounts)
+					|| IntersectsKeys(tSpeculation.m_setReadKeyIds, setWrittenKeyIds)
+					|| IntersectsKeys(tSpeculation.m_setReadKeys, setWrittenKeys)
+					|| IntersectsPrefixes(tSpeculation.m_setReadPrefixes, setWrittenKeys)) {
+				LogPrint("txexec", "tx index:%d tx hash:%s executed again in block order\n", i,
+						pBaseTx->GetHash().GetHex());
+				if (!ExecuteTxTracked(pBaseTx.get(), i, cAccountViewCache, cScriptCache, csBaseView,
+						cValidationState, nHeight, cTxCache, tSpeculation)) {
+					return false;
+				}
+			}
+			for (const auto &item : tSpeculation.m_mapAccounts) {
+				cAccountViewCache.SetCacheAccount(item.first, item.second);
+				setWrittenAccounts.insert(item.first);
+			}
+			for (const auto &item : tSpeculation.m_mapKeyIds) {
+				cAccountViewCache.SetCacheKeyId(item.first, item.second);
+				setWrittenKeyIds.insert(item.first);
+			}
+			for (const auto &item : tSpeculation.m_mapDatas) {
+				cScriptCache.SetCacheData(item.first, item.second);
+				setWrittenKeys.insert(item.first);
+			}
+			cUndoTx = tSpeculation.m_cTxUndo;
+		} else {
+			pBaseTx->m_nFuelRate = cBlock.GetFuelRate();
+			CBlockPhaseTimer cTimer(GetExecutePhase(pBaseTx->m_chTxType));
+			if (!pBaseTx->ExecuteTx(i, cAccountViewCache, cValidationState, cUndoTx, nHeight, cTxCache,
+					cScriptCache)) {
+				return false;
+			}
+		}
+		ullTotalRunStep += pBaseTx->m_ullRunStep;
+		if (ullTotalRunStep > MAX_BLOCK_RUN_STEP) {
+			return cValidationState.DoS(100,
+					ERRORMSG("block hash=%s total run steps exceed max run step", cBlock.GetHash().GetHex()),
+					REJECT_INVALID, "exeed-max_step");
+		}
+		uint64_t llFuel = ceil(pBaseTx->m_ullRunStep / 100.f) * cBlock.GetFuelRate();
+		if (EM_REG_APP_TX == pBaseTx->m_chTxType) {
+			if (g_cChainActive.Tip()->m_nHeight > g_sRegAppFuel2FeeForkHeight) {
+				llFuel = 0;
+			} else {
+				if (llFuel < 1 * COIN) {
+					llFuel = 1 * COIN;
+				}
+			}
+		}
+		llTotalFuel += llFuel;
+		LogPrint("fuel", "connect block total fuel:%d, tx fuel:%d runStep:%d fuelRate:%d txhash:%s \n", llTotalFuel,
+				llFuel, pBaseTx->m_ullRunStep, cBlock.GetFuelRate(), pBaseTx->GetHash().GetHex());
+		vcTxUndo.push_back(cUndoTx);
+	}
+	return true;
+}
+
 bool ConnectBlock(CBlock& cBlock, CValidationState& cValidationState, CAccountViewCache &cAccountViewCache,
 		CBlockIndex* pBlockIndex, CTransactionDBCache &cTxCache, CScriptDBViewCache &cScriptCache, bool bJustCheck) {
 	AssertLockHeld(g_cs_main);
+	// Below the assume-valid block transactions are still executed, only their signatures are trusted
+	bool bCheckSig = bJustCheck || !IsAssumedValid(pBlockIndex);
 	// Check it again in case a previous version let a bad block in
-	if (!CheckBlock(cBlock, cValidationState, cAccountViewCache, cScriptCache, !bJustCheck, !bJustCheck)) {
+	if (!CheckBlock(cBlock, cValidationState, cAccountViewCache, cScriptCache, !bJustCheck, !bJustCheck, bCheckSig)) {
 		return false;
 	}
 	if (!bJustCheck) {
@@ -1496,62 +2211,26 @@ bool ConnectBlock(CBlock& cBlock, CValidationState& cValidationState, CAccountVi
 	tDiskTxPos.m_unTxOffset += ::GetSerializeSize(cBlock.vptx[0], SER_DISK, g_sClientVersion);
 
 	LogPrint("op_account", "block height:%d block hash:%s\n", cBlock.GetHeight(), cBlock.GetHash().GetHex());
-	uint64_t ullTotalRunStep(0);
-	int64_t llTotalFuel(0);
 	if (cBlock.vptx.size() > 1) {
+		CBlockPhaseTimer cExecuteTimer(EM_BLOCK_PHASE_EXECUTETX);
+		bool bParallel = SysCfg().GetScriptCheckThreads() > 0 && cBlock.vptx.size() > 2;
+		vector<CTxUndo> vcTxUndo;
+		int64_t llTotalFuel(0);
+		if (!ExecuteBlockTxs(cBlock, cValidationState, cAccountViewCache, cTxCache, cScriptCache, pBlockIndex->m_nHeight,
+				bParallel, vcTxUndo, llTotalFuel)) {
+			return false;
+		}
 		for (unsigned int i = 1; i < cBlock.vptx.size(); i++) {
-			std::shared_ptr<CBaseTransaction> pBaseTx = cBlock.vptx[i];
-			if (uint256() != cTxCache.IsContainTx((pBaseTx->GetHash()))) {
-				return cValidationState.DoS(100,
-						ERRORMSG("ConnectBlock() : the TxHash %s the confirm duplicate", pBaseTx->GetHash().GetHex()),
-						REJECT_INVALID, "bad-cb-amount");
-			}
-			assert(g_mapBlockIndex.count(cAccountViewCache.GetBestBlock()));
-			if (!pBaseTx->IsValidHeight(g_mapBlockIndex[cAccountViewCache.GetBestBlock()]->m_nHeight,
-					SysCfg().GetTxCacheHeight())) {
-				return cValidationState.DoS(100,
-						ERRORMSG("ConnectBlock() : txhash=%s beyond the scope of valid height",
-								pBaseTx->GetHash().GetHex()), REJECT_INVALID, "tx-invalid-height");
-			}
-			if (EM_CONTRACT_TX == pBaseTx->m_chTxType) {
-				LogPrint("vm", "tx hash=%s ConnectBlock run contract\n", pBaseTx->GetHash().GetHex());
-			}
-			LogPrint("op_account", "tx index:%d tx hash:%s\n", i, pBaseTx->GetHash().GetHex());
-			CTxUndo cUndoTx;
-			pBaseTx->m_nFuelRate = cBlock.GetFuelRate();
-			if (!pBaseTx->ExecuteTx(i, cAccountViewCache, cValidationState, cUndoTx, pBlockIndex->m_nHeight, cTxCache,
-					cScriptCache)) {
-				return false;
-			}
-			ullTotalRunStep += pBaseTx->m_ullRunStep;
-			if (ullTotalRunStep > MAX_BLOCK_RUN_STEP) {
-				return cValidationState.DoS(100,
-						ERRORMSG("block hash=%s total run steps exceed max run step", cBlock.GetHash().GetHex()),
-						REJECT_INVALID, "exeed-max_step");
-			}
-			uint64_t llFuel = ceil(pBaseTx->m_ullRunStep / 100.f) * cBlock.GetFuelRate();
-			if (EM_REG_APP_TX == pBaseTx->m_chTxType) {
-				if (g_cChainActive.Tip()->m_nHeight > g_sRegAppFuel2FeeForkHeight) {
-					llFuel = 0;
-				} else {
-					if (llFuel < 1 * COIN) {
-						llFuel = 1 * COIN;
-					}
-				}
-			}
-			llTotalFuel += llFuel;
-			LogPrint("fuel", "connect block total fuel:%d, tx fuel:%d runStep:%d fuelRate:%d txhash:%s \n", llTotalFuel,
-					llFuel, pBaseTx->m_ullRunStep, cBlock.GetFuelRate(), pBaseTx->GetHash().GetHex());
 			vPos.push_back(make_pair(cBlock.GetTxHash(i), tDiskTxPos));
-			tDiskTxPos.m_unTxOffset += ::GetSerializeSize(pBaseTx, SER_DISK, g_sClientVersion);
-			cUndoBlock.m_vcTxUndo.push_back(cUndoTx);
+			tDiskTxPos.m_unTxOffset += ::GetSerializeSize(cBlock.vptx[i], SER_DISK, g_sClientVersion);
+			cUndoBlock.m_vcTxUndo.push_back(vcTxUndo[i - 1]);
 		}
 		if (llTotalFuel != cBlock.GetFuel()) {
 			return ERRORMSG("fuel value at block header calculate error(actual fuel:%ld vs block fuel:%ld)", llTotalFuel,
 					cBlock.GetFuel());
 		}
 	}
-	if (!VerifyPosTx(cAccountViewCache, &cBlock, cTxCache, cScriptCache, false)) {
+	if (!VerifyPosTx(cAccountViewCache, &cBlock, cTxCache, cScriptCache, false, bCheckSig)) {
 		return cValidationState.DoS(100,
 				ERRORMSG("ConnectBlock() : the block Hash=%s check tDiskTxPos tx error", cBlock.GetHash().GetHex()),
 				REJECT_INVALID, "bad-tDiskTxPos-tx");
@@ -1579,8 +2258,13 @@ bool ConnectBlock(CBlock& cBlock, CValidationState& cValidationState, CAccountVi
 	//deal reward tx
 	LogPrint("op_account", "tx index:%d tx hash:%s\n", 0, cBlock.vptx[0]->GetHash().GetHex());
 	CTxUndo txundo;
-	if (!cBlock.vptx[0]->ExecuteTx(0, cAccountViewCache, cValidationState, txundo, pBlockIndex->m_nHeight, cTxCache,
-			cScriptCache))
+	bool bRewardExecuted = false;
+	{
+		CBlockPhaseTimer cTimer(EM_BLOCK_PHASE_EXECUTE_REWARD);
+		bRewardExecuted = cBlock.vptx[0]->ExecuteTx(0, cAccountViewCache, cValidationState, txundo,
+				pBlockIndex->m_nHeight, cTxCache, cScriptCache);
+	}
+	if (!bRewardExecuted)
 		return ERRORMSG("ConnectBlock() : execure reward tx error!");
 	cUndoBlock.m_vcTxUndo.push_back(txundo);
 	if (pBlockIndex->m_nHeight - COINBASE_MATURITY > 0) {
@@ -1620,16 +2304,22 @@ bool ConnectBlock(CBlock& cBlock, CValidationState& cValidationState, CAccountVi
 				vcTxIndexOperDB.end());
 	}
 	// Write undo information to disk
+	bool bUndoWritten = false;
+	bool bUndoCompressed = false;
 	if (pBlockIndex->GetUndoPos().IsNull() || (pBlockIndex->m_unStatus & BLOCK_VALID_MASK) < BLOCK_VALID_SCRIPTS) {
 		if (pBlockIndex->GetUndoPos().IsNull()) {
+			CBlockPhaseTimer cTimer(EM_BLOCK_PHASE_UNDOWRITE);
+			CDiskRecord cRecord;
+			cRecord.Pack(cUndoBlock, SysCfg().IsBlockCompression());
 			ST_DiskBlockPos pos;
-			if (!FindUndoPos(cValidationState, pBlockIndex->m_nFile, pos,
-					::GetSerializeSize(cUndoBlock, SER_DISK, g_sClientVersion) + 40)) {
+			if (!FindUndoPos(cValidationState, pBlockIndex->m_nFile, pos, cRecord.GetDiskSize() + sizeof(uint256))) {
 				return ERRORMSG("ConnectBlock() : FindUndoPos failed");
 			}
-			if (!cUndoBlock.WriteToDisk(pos, pBlockIndex->m_pPrevBlockIndex->GetBlockHash())) {
+			if (!cUndoBlock.WriteToDisk(cRecord, pos, pBlockIndex->m_pPrevBlockIndex->GetBlockHash())) {
 				return cValidationState.Abort(_("Failed to write undo data"));
 			}
+			bUndoWritten = true;
+			bUndoCompressed = cRecord.IsCompressed();
 			// update nUndoPos in block index
 			pBlockIndex->m_nUndoPos = pos.unPos;
 			pBlockIndex->m_unStatus |= BLOCK_HAVE_UNDO;
@@ -1641,6 +2331,15 @@ bool ConnectBlock(CBlock& cBlock, CValidationState& cValidationState, CAccountVi
 			return cValidationState.Abort(_("Failed to write block index"));
 		}
 	}
+	if (SysCfg().IsTxIndex()) {
+		// the CTxUndo entries of a compressed record have no file position, they are found by reading it all
+		if (!bUndoWritten) {
+			bUndoCompressed = IsDiskRecordCompressed(OpenUndoFile(pBlockIndex->GetUndoPos(), true));
+		}
+		if (!bUndoCompressed && !WriteTxUndoIndex(cScriptCache, cUndoBlock, pBlockIndex->GetUndoPos(), vPos)) {
+			return cValidationState.Abort(_("Failed to write transaction index"));
+		}
+	}
 
 	if (!cTxCache.AddBlockToCache(cBlock)) {
 		return cValidationState.Abort(_("Connect tip block failed add block tx to txcache"));
@@ -1663,12 +2362,110 @@ bool ConnectBlock(CBlock& cBlock, CValidationState& cValidationState, CAccountVi
 	return true;
 }
 
-// Update the on-disk chain state.
-bool static WriteChainState(CValidationState &cValidationState) {
+int GetPruneKeepDepth() {
+	// ConnectBlock reads back the blocks COINBASE_MATURITY and GetTxCacheHeight() below the new tip,
+	// and a fork up to GetIntervalPos() deep is disconnected with the undo data of the blocks it replaces
+	return max(COINBASE_MATURITY, SysCfg().GetTxCacheHeight()) + max(SysCfg().GetIntervalPos(), MIN_BLOCKS_TO_KEEP);
+}
+
+void SelectFilesToPrune(const vector<CBlockFileInfo> &vcFileInfo, uint64_t ullTarget, int nPruneHeight,
+		set<int> &setFiles) {
+	uint64_t ullUsage = 0;
+	for (const auto &cFileInfo : vcFileInfo) {
+		ullUsage += cFileInfo.m_unSize + cFileInfo.m_unUndoSize;
+	}
+	// leave room for the chunks the next blocks allocate
+	uint64_t ullBuffer = BLOCKFILE_CHUNK_SIZE + UNDOFILE_CHUNK_SIZE;
+	for (int nFile = 0; nFile + 1 < (int) vcFileInfo.size() && ullUsage + ullBuffer >= ullTarget; ++nFile) {
+		const CBlockFileInfo &cFileInfo = vcFileInfo[nFile];
+		if (cFileInfo.m_unSize == 0 && cFileInfo.m_unUndoSize == 0) {
+			continue;
+		}
+		if ((int) cFileInfo.m_unHeightLast >= nPruneHeight) {
+			continue;
+		}
+		ullUsage -= cFileInfo.m_unSize + cFileInfo.m_unUndoSize;
+		setFiles.insert(nFile);
+	}
+}
+
+// Delete old blk and rev files until those left fit in the -prune target. The block tree stops
+// pointing at the files before they are removed, a crash in between only leaves files behind.
+bool static PruneBlockFiles(CValidationState &cValidationState) {
+	AssertLockHeld(g_cs_main);
+	g_bCheckForPruning = false;
+	int nPruneHeight = g_cChainActive.Height() - GetPruneKeepDepth();
+	if (nPruneHeight <= 0) {
+		return true;
+	}
+	vector<CBlockFileInfo> vcFileInfo;
+	{
+		LOCK(g_cs_LastBlockFile);
+		vcFileInfo.resize(g_nLastBlockFile + 1);
+		for (int nFile = 0; nFile < g_nLastBlockFile; ++nFile) {
+			g_pblocktree->ReadBlockFileInfo(nFile, vcFileInfo[nFile]);
+		}
+		vcFileInfo[g_nLastBlockFile] = g_InfoLastBlockFile;
+	}
+	set<int> setFiles;
+	SelectFilesToPrune(vcFileInfo, g_ullPruneTarget, nPruneHeight, setFiles);
+	if (setFiles.empty()) {
+		return true;
+	}
+
+	vector<CDiskBlockIndex> vcBlockIndex;
+	for (const auto &item : g_mapBlockIndex) {
+		CBlockIndex *pIndex = item.second;
+		if ((pIndex->m_unStatus & BLOCK_HAVE_MASK) && setFiles.count(pIndex->m_nFile)) {
+			// the data position stays, to find the header of the transactions indexed in the block
+			if (pIndex->m_unStatus & BLOCK_HAVE_DATA) {
+				pIndex->m_unStatus |= BLOCK_PRUNED;
+			}
+			pIndex->m_unStatus &= ~BLOCK_HAVE_MASK;
+			pIndex->m_nUndoPos = 0;
+			vcBlockIndex.push_back(CDiskBlockIndex(pIndex));
+		}
+	}
+	if (!g_pblocktree->WriteBlockIndex(vcBlockIndex)) {
+		return cValidationState.Abort(_("Failed to write block index"));
+	}
+	for (auto nFile : setFiles) {
+		LogPrint("INFO", "Pruning block file %i: %s\n", nFile, vcFileInfo[nFile].ToString());
+		vcFileInfo[nFile].m_unSize = 0;
+		vcFileInfo[nFile].m_unUndoSize = 0;
+		if (!g_pblocktree->WriteBlockFileInfo(nFile, vcFileInfo[nFile])) {
+			return cValidationState.Abort(_("Failed to write file info"));
+		}
+	}
+	if (!g_pblocktree->WriteFlag("prunedblockfiles", true)) {
+		return cValidationState.Abort(_("Failed to write to block index database"));
+	}
+	g_pblocktree->Sync();
+	{
+		LOCK(g_cs_LastBlockFile);
+		g_setPrunedBlockFiles.insert(setFiles.begin(), setFiles.end());
+	}
+	g_bHavePruned = true;
+
+	for (auto nFile : setFiles) {
+		boost::system::error_code ec;
+		filesystem::remove(GetDataDir() / "blocks" / strprintf("blk%05u.dat", nFile), ec);
+		filesystem::remove(GetDataDir() / "blocks" / strprintf("rev%05u.dat", nFile), ec);
+	}
+	LogPrint("INFO", "Pruned %u block files below height %d, %u blocks marked\n", setFiles.size(), nPruneHeight,
+			vcBlockIndex.size());
+
+	return true;
+}
+
+// Update the on-disk chain state, bFlushed tells whether the databases now match the tip.
+bool static WriteChainState(CValidationState &cValidationState, bool &bFlushed) {
 	static int64_t llLastWrite 	= 0;
-	unsigned int unCachesize 	= g_pAccountViewTip->GetCacheSize() + g_pScriptDBTip->GetCacheSize();
+	bFlushed = false;
+	size_t unCachesize 			= g_pAccountViewTip->GetCacheSize() + g_pScriptDBTip->GetCacheSize();
 	if (!IsInitialBlockDownload() || unCachesize > SysCfg().GetViewCacheSize()
 			|| GetTimeMicros() > llLastWrite + 600 * 1000000) {
+		CBlockPhaseTimer cTimer(EM_BLOCK_PHASE_FLUSH);
 		// Typical CCoins structures on disk are around 100 bytes in size.
 		// Pushing a new one to the database can cause it to be written
 		// twice (once in the log, and once in the tables). This is already
@@ -1690,6 +2487,10 @@ bool static WriteChainState(CValidationState &cValidationState) {
 		}
 		g_mapCache.clear();
 		llLastWrite = GetTimeMicros();
+		bFlushed = true;
+		if (g_bCheckForPruning && !PruneBlockFiles(cValidationState)) {
+			return false;
+		}
 	}
 
 	return true;
@@ -1698,7 +2499,10 @@ bool static WriteChainState(CValidationState &cValidationState) {
 // Update chainActive and related internal data structures.
 void static UpdateTip(CBlockIndex *pNewIndex, const CBlock &cBlock) {
 	g_cChainActive.SetTip(pNewIndex);
-	SyncWithWallets(uint256(), NULL, &cBlock);
+	{
+		CBlockPhaseTimer cTimer(EM_BLOCK_PHASE_WALLETSYNC);
+		SyncWithWallets(uint256(), NULL, &cBlock);
+	}
 	// Update best block in wallet (so we can detect restored wallets)
 	bool bIsInitialDownload = IsInitialBlockDownload();
 
@@ -1770,7 +2574,8 @@ bool static DisconnectTip(CValidationState &cValidationState) {
 		LogPrint("INFO", "- Disconnect: %.2fms\n", (GetTimeMicros() - llStart) * 0.001);
 	}
 	// Write the chain state to disk, if necessary.
-	if (!WriteChainState(cValidationState)) {
+	bool bFlushed = false;
+	if (!WriteChainState(cValidationState, bFlushed)) {
 		return false;
 	}
 
@@ -1790,6 +2595,9 @@ bool static DisconnectTip(CValidationState &cValidationState) {
 
 	// Update chainActive and related variables.
 	UpdateTip(pDeleteIndex->m_pPrevBlockIndex, cBlock);
+	if (bFlushed) {
+		PublishChainStateSnapshot();
+	}
 	// Resurrect mempool transactions from the disconnected block.
 	for (const auto &ptx : cBlock.vptx) {
 		list<std::shared_ptr<CBaseTransaction> > removed;
@@ -1877,12 +2685,17 @@ bool static ConnectTip(CValidationState &cValidationState, CBlockIndex *pNewInde
 		LogPrint("INFO", "- Connect: %.2fms\n", (GetTimeMicros() - llStart) * 0.001);
 	}
 	// Write the chain state to disk, if necessary.
-	if (!WriteChainState(cValidationState)) {
+	bool bFlushed = false;
+	if (!WriteChainState(cValidationState, bFlushed)) {
 		return false;
 	}
 
 	// Update chainActive & related variables.
 	UpdateTip(pNewIndex, cBlock);
+	if (bFlushed) {
+		PublishChainStateSnapshot();
+	}
+	g_cUIInterface.NotifyBlockConnected(cBlock);
 
 	// Write new cBlock info to log, if necessary.
 	if (SysCfg().GetArg("-blocklog", 0) != 0) {
@@ -1900,9 +2713,7 @@ bool static ConnectTip(CValidationState &cValidationState, CBlockIndex *pNewInde
 		}
 	}
 
-	for (auto &pTxItem : cBlock.vptx) {
-		g_cTxMemPool.m_mapTx.erase(pTxItem->GetHash());
-	}
+	g_cTxMemPool.removeForBlock(cBlock.vptx);
 
 	return true;
 }
@@ -2116,6 +2927,9 @@ bool FindBlockPos(CValidationState &cValidationState, ST_DiskBlockPos &tDiskBloc
 		unsigned int unOldChunks = (tDiskBlockPos.unPos + BLOCKFILE_CHUNK_SIZE - 1) / BLOCKFILE_CHUNK_SIZE;
 		unsigned int unNewChunks = (g_InfoLastBlockFile.m_unSize + BLOCKFILE_CHUNK_SIZE - 1) / BLOCKFILE_CHUNK_SIZE;
 		if (unNewChunks > unOldChunks) {
+			if (g_ullPruneTarget) {
+				g_bCheckForPruning = true;
+			}
 			if (CheckDiskSpace(unNewChunks * BLOCKFILE_CHUNK_SIZE - tDiskBlockPos.unPos)) {
 				FILE *pFile = OpenBlockFile(tDiskBlockPos);
 				if (pFile) {
@@ -2168,6 +2982,9 @@ bool FindUndoPos(CValidationState &cValidationState, int nFile, ST_DiskBlockPos
 	unsigned int unOldChunks = (tDiskBlockPos.unPos + UNDOFILE_CHUNK_SIZE - 1) / UNDOFILE_CHUNK_SIZE;
 	unsigned int unNewChunks = (unNewSize + UNDOFILE_CHUNK_SIZE - 1) / UNDOFILE_CHUNK_SIZE;
 	if (unNewChunks > unOldChunks) {
+		if (g_ullPruneTarget) {
+			g_bCheckForPruning = true;
+		}
 		if (CheckDiskSpace(unNewChunks * UNDOFILE_CHUNK_SIZE - tDiskBlockPos.unPos)) {
 			FILE *pFile = OpenUndoFile(tDiskBlockPos);
 			if (pFile) {
@@ -2187,26 +3004,28 @@ bool FindUndoPos(CValidationState &cValidationState, int nFile, ST_DiskBlockPos
 
 bool CheckBlockProofWorkWithCoinDay(const CBlock& cBlock, CBlockIndex *pPreBlockIndex,
 		CValidationState& cValidationState) {
+	CBlockPhaseTimer cTimer(EM_BLOCK_PHASE_CHECKPROOF);
 	std::shared_ptr<CAccountViewCache> pForkAcctViewCache;
 	std::shared_ptr<CTransactionDBCache> pForkTxCache;
 	std::shared_ptr<CScriptDBViewCache> pForkScriptDBCache;
 
 	std::shared_ptr<CAccountViewCache> pAcctViewCache 	= std::make_shared<CAccountViewCache>(*g_pAccountViewDB, true);
-	pAcctViewCache->m_mapCacheAccounts 					= g_pAccountViewTip->m_mapCacheAccounts;
-	pAcctViewCache->m_mapCacheKeyIds					= g_pAccountViewTip->m_mapCacheKeyIds;
+	pAcctViewCache->SetCacheMap(g_pAccountViewTip->m_mapCacheAccounts, g_pAccountViewTip->m_mapCacheKeyIds);
 	pAcctViewCache->m_cHashBlock 						= g_pAccountViewTip->m_cHashBlock;
 
 	std::shared_ptr<CTransactionDBCache> pTxCache = std::make_shared<CTransactionDBCache>(*g_pTxCacheDB, true);
 	pTxCache->SetCacheMap(g_pTxCacheTip->GetCacheMap());
 
 	std::shared_ptr<CScriptDBViewCache> pScriptDBCache = std::make_shared<CScriptDBViewCache>(*g_pScriptDB, true);
-	pScriptDBCache->m_mapDatas = g_pScriptDBTip->m_mapDatas;
+	pScriptDBCache->SetCacheMap(g_pScriptDBTip->m_mapDatas);
 
 	uint256 cPreBlockHash;
 	bool bFindForkChainTip(false);
 	vector<CBlock> vcPreBlocks;
 	if (pPreBlockIndex->GetBlockHash() != g_cChainActive.Tip()->GetBlockHash()
 			&& pPreBlockIndex->m_cChainWork > g_cChainActive.Tip()->m_cChainWork) {
+		// an app regid may carry another script on the fork than on the active chain
+		CVmScriptCacheBypass cScriptCacheBypass;
 		while (!g_cChainActive.Contains(pPreBlockIndex)) {
 			if (g_mapCache.count(pPreBlockIndex->GetBlockHash()) > 0 && !bFindForkChainTip) {
 				cPreBlockHash = pPreBlockIndex->GetBlockHash();
@@ -2409,7 +3228,8 @@ bool CheckBlockProofWorkWithCoinDayEx(const CBlock& cBlock, CBlockIndex *pPreBlo
 }
 
 bool CheckBlock(const CBlock& cBlock, CValidationState& cValidationState, CAccountViewCache &cAccountViewCache,
-		CScriptDBViewCache &cScriptDBCache, bool bCheckTx, bool bCheckMerkleRoot) {
+		CScriptDBViewCache &cScriptDBCache, bool bCheckTx, bool bCheckMerkleRoot, bool bCheckSig) {
+	CBlockPhaseTimer cTimer(EM_BLOCK_PHASE_CHECKBLOCK);
 	// These are checks that are independent of context
 	// that can be verified before saving an orphan block.
 	unsigned int unBlockSize = ::GetSerializeSize(cBlock, SER_NETWORK, g_sProtocolVersion);
@@ -2447,7 +3267,8 @@ bool CheckBlock(const CBlock& cBlock, CValidationState& cValidationState, CAccou
 	for (unsigned int i = 0; i < cBlock.vptx.size(); i++) {
 		cUniqueTx.insert(cBlock.GetTxHash(i));
 
-		if (bCheckTx && !CheckTransaction(cBlock.vptx[i].get(), cValidationState, cAccountViewCache, cScriptDBCache)) {
+		if (bCheckTx
+				&& !CheckTransaction(cBlock.vptx[i].get(), cValidationState, cAccountViewCache, cScriptDBCache, bCheckSig)) {
 			return ERRORMSG("CheckBlock() :tx hash:%s CheckTransaction failed", cBlock.vptx[i]->GetHash().GetHex());
 		}
 		if (cBlock.GetHash() != SysCfg().HashGenesisBlock()) {
@@ -2557,16 +3378,24 @@ bool AcceptBlock(CBlock& cBlock, CValidationState& cValidationState, ST_DiskBloc
 
 	// Write block to history file
 	try {
-		unsigned int unBlockSize = ::GetSerializeSize(cBlock, SER_DISK, g_sClientVersion);
+		CDiskRecord cRecord;
+		unsigned int unDiskSize = 0;
 		ST_DiskBlockPos tBlockPos;
 		if (pDiskBlockPos != NULL) {
+			// already in a block file, as it was written then, compressed or not
 			tBlockPos = *pDiskBlockPos;
+			if (!GetDiskRecordSize(OpenBlockFile(tBlockPos, true), unDiskSize)) {
+				return ERRORMSG("AcceptBlock() : reading the block record size failed");
+			}
+		} else {
+			cRecord.Pack(cBlock, SysCfg().IsBlockCompression());
+			unDiskSize = cRecord.GetDiskSize();
 		}
-		if (!FindBlockPos(cValidationState, tBlockPos, unBlockSize + 8, nHeight, cBlock.GetTime(), pDiskBlockPos != NULL)) {
+		if (!FindBlockPos(cValidationState, tBlockPos, unDiskSize, nHeight, cBlock.GetTime(), pDiskBlockPos != NULL)) {
 			return ERRORMSG("AcceptBlock() : FindBlockPos failed");
 		}
 		if (pDiskBlockPos == NULL) {
-			if (!WriteBlockToDisk(cBlock, tBlockPos)) {
+			if (!WriteBlockToDisk(cRecord, tBlockPos)) {
 				return cValidationState.Abort(_("Failed to write block"));
 			}
 		}
@@ -2641,6 +3470,7 @@ void PushGetBlocks(CNode* pNode, CBlockIndex* pBlockIndexBegin, uint256 cHashEnd
 bool ProcessBlock(CValidationState &cValidationState, CNode* pFromNode, CBlock* pBlock,
 		ST_DiskBlockPos *pDiskBlockPos) {
 	AssertLockHeld(g_cs_main);
+	CBlockPhaseTimer cTimer(EM_BLOCK_PHASE_PROCESSBLOCK);
 	// Check for duplicate
 	uint256 cHash = pBlock->GetHash();
 	if (g_mapBlockIndex.count(cHash)) {
@@ -2731,6 +3561,7 @@ bool ProcessBlock(CValidationState &cValidationState, CNode* pFromNode, CBlock*
 		}
 		g_mapOrphanBlocksByPrev.erase(cPrevHash);
 	}
+	LogBlockPhaseStats();
 
 	return true;
 }
@@ -3141,6 +3972,21 @@ bool static LoadBlockIndexDB() {
 	if (g_pblocktree->ReadBlockFileInfo(g_nLastBlockFile, g_InfoLastBlockFile)) {
 		LogPrint("INFO", "LoadBlockIndexDB(): last block file info: %s\n", g_InfoLastBlockFile.ToString());
 	}
+	// Check whether block files have been pruned
+	bool bHavePruned = false;
+	g_pblocktree->ReadFlag("prunedblockfiles", bHavePruned);
+	if (bHavePruned) {
+		LOCK(g_cs_LastBlockFile);
+		for (int nFile = 0; nFile < g_nLastBlockFile; ++nFile) {
+			CBlockFileInfo cFileInfo;
+			if (g_pblocktree->ReadBlockFileInfo(nFile, cFileInfo) && cFileInfo.IsPruned()) {
+				g_setPrunedBlockFiles.insert(nFile);
+			}
+		}
+		LogPrint("INFO", "LoadBlockIndexDB(): %u block files pruned\n", g_setPrunedBlockFiles.size());
+	}
+	g_bHavePruned = bHavePruned;
+	g_bCheckForPruning = g_ullPruneTarget > 0;
 	// Check whether we need to continue reindexing
 	bool bReindexing = false;
 	g_pblocktree->ReadReindexing(bReindexing);
@@ -3200,6 +4046,10 @@ bool VerifyDB(int nCheckLevel, int nCheckDepth) {
 		if (pIndex->m_nHeight < g_cChainActive.Height() - nCheckDepth) {
 			break;
 		}
+		// blocks below a loaded state snapshot are indexed without their data
+		if (!(pIndex->m_unStatus & BLOCK_HAVE_DATA)) {
+			break;
+		}
 		CBlock block;
 		//       LogPrint("INFO", "block hash:%s", pindex->GetBlockHash().ToString());
 		// check level 0: read from disk
@@ -3277,6 +4127,11 @@ void UnloadBlockIndex() {
 	g_setBlockIndexValid.clear();
 	g_cChainActive.SetTip(NULL);
 	g_pIndexBestInvalid = NULL;
+	{
+		LOCK(g_cs_LastBlockFile);
+		g_setPrunedBlockFiles.clear();
+	}
+	g_bHavePruned = false;
 }
 
 bool LoadBlockIndex() {
@@ -3304,13 +4159,14 @@ bool InitBlockIndex() {
 		try {
 			CBlock &cBlock = const_cast<CBlock&>(SysCfg().GenesisBlock());
 			// Start new cBlock file
-			unsigned int unBlockSize = ::GetSerializeSize(cBlock, SER_DISK, g_sClientVersion);
+			CDiskRecord cRecord;
+			cRecord.Pack(cBlock, SysCfg().IsBlockCompression());
 			ST_DiskBlockPos tDiskBlockPos;
 			CValidationState cValidationState;
-			if (!FindBlockPos(cValidationState, tDiskBlockPos, unBlockSize + 8, 0, cBlock.GetTime())) {
+			if (!FindBlockPos(cValidationState, tDiskBlockPos, cRecord.GetDiskSize(), 0, cBlock.GetTime())) {
 				return ERRORMSG("LoadBlockIndex() : FindBlockPos failed");
 			}
-			if (!WriteBlockToDisk(cBlock, tDiskBlockPos)) {
+			if (!WriteBlockToDisk(cRecord, tDiskBlockPos)) {
 				return ERRORMSG("LoadBlockIndex() : writing genesis cBlock to disk failed");
 			}
 			if (!AddToBlockIndex(cBlock, cValidationState, tDiskBlockPos)) {
@@ -3384,6 +4240,130 @@ void PrintBlockTree() {
 	}
 }
 
+const char *GetBlockPhaseName(emBlockPhase emPhase) {
+	switch (emPhase) {
+	case EM_BLOCK_PHASE_DESERIALIZE:
+		return "deserialize";
+	case EM_BLOCK_PHASE_PROCESSBLOCK:
+		return "processblock";
+	case EM_BLOCK_PHASE_CHECKPROOF:
+		return "checkproof";
+	case EM_BLOCK_PHASE_CHECKBLOCK:
+		return "checkblock";
+	case EM_BLOCK_PHASE_EXECUTETX:
+		return "executetx";
+	case EM_BLOCK_PHASE_EXECUTE_REWARD:
+		return "execute_reward";
+	case EM_BLOCK_PHASE_EXECUTE_REGACCT:
+		return "execute_regacct";
+	case EM_BLOCK_PHASE_EXECUTE_COMMON:
+		return "execute_common";
+	case EM_BLOCK_PHASE_EXECUTE_CONTRACT:
+		return "execute_contract";
+	case EM_BLOCK_PHASE_EXECUTE_REGAPP:
+		return "execute_regapp";
+	case EM_BLOCK_PHASE_VM_8051:
+		return "vm_8051";
+	case EM_BLOCK_PHASE_VM_LUA:
+		return "vm_lua";
+	case EM_BLOCK_PHASE_VERIFYPOSTX:
+		return "verifypostx";
+	case EM_BLOCK_PHASE_UNDOWRITE:
+		return "undowrite";
+	case EM_BLOCK_PHASE_COMPRESS:
+		return "compress";
+	case EM_BLOCK_PHASE_DECOMPRESS:
+		return "decompress";
+	case EM_BLOCK_PHASE_FLUSH:
+		return "flush";
+	case EM_BLOCK_PHASE_WALLETSYNC:
+		return "walletsync";
+	default:
+		return "unknown";
+	}
+}
+
+emBlockPhase GetExecutePhase(unsigned char chTxType) {
+	switch (chTxType) {
+	case EM_REWARD_TX:
+		return EM_BLOCK_PHASE_EXECUTE_REWARD;
+	case EM_REG_ACCT_TX:
+		return EM_BLOCK_PHASE_EXECUTE_REGACCT;
+	case EM_CONTRACT_TX:
+		return EM_BLOCK_PHASE_EXECUTE_CONTRACT;
+	case EM_REG_APP_TX:
+		return EM_BLOCK_PHASE_EXECUTE_REGAPP;
+	default:
+		return EM_BLOCK_PHASE_EXECUTE_COMMON;
+	}
+}
+
+void AddBlockPhaseTime(emBlockPhase emPhase, int64_t llMicros) {
+	ST_BlockPhaseStats &tStats = g_arrtBlockPhaseStats[emPhase];
+	tStats.ullCalls.fetch_add(1, std::memory_order_relaxed);
+	tStats.llMicros.fetch_add(llMicros, std::memory_order_relaxed);
+	int64_t llMax = tStats.llMaxMicros.load(std::memory_order_relaxed);
+	while (llMicros > llMax && !tStats.llMaxMicros.compare_exchange_weak(llMax, llMicros, std::memory_order_relaxed)) {
+	}
+	int nBucket = 0;
+	while (nBucket < BLOCK_PHASE_BUCKETS - 1 && llMicros >= (1LL << nBucket)) {
+		++nBucket;
+	}
+	tStats.arrullBuckets[nBucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void ResetBlockPhaseTimes() {
+	for (auto &tStats : g_arrtBlockPhaseStats) {
+		tStats.ullCalls = 0;
+		tStats.llMicros = 0;
+		tStats.llMaxMicros = 0;
+		for (auto &ullBucket : tStats.arrullBuckets) {
+			ullBucket = 0;
+		}
+	}
+}
+
+void LogBlockPhaseStats(bool bForce) {
+	static const int64_t s_llInterval = SysCfg().GetArg("-validationstatsinterval",
+			DEFAULT_VALIDATION_STATS_INTERVAL) * 1000000;
+	static std::atomic<int64_t> s_llLastLog(GetMonotonicMicros());
+	int64_t llNow = GetMonotonicMicros();
+	int64_t llLast = s_llLastLog;
+	if (!bForce && (s_llInterval <= 0 || llNow - llLast < s_llInterval)) {
+		return;
+	}
+	if (!s_llLastLog.compare_exchange_strong(llLast, llNow)) {
+		return;
+	}
+	string strSummary;
+	for (int i = 0; i < EM_BLOCK_PHASE_MAX; ++i) {
+		const ST_BlockPhaseStats &tStats = g_arrtBlockPhaseStats[i];
+		uint64_t ullCalls = tStats.ullCalls;
+		if (ullCalls > 0) {
+			strSummary += strprintf(" %s=%u/%.1fms/max%.1fms", GetBlockPhaseName((emBlockPhase) i), ullCalls,
+					tStats.llMicros / 1000.0, tStats.llMaxMicros / 1000.0);
+		}
+	}
+	LogPrint("INFO", "validation stats (calls/total/max):%s\n", strSummary.empty() ? string(" none") : strSummary);
+}
+
+// Whether a size field found while scanning a block file can be that of a block record
+static bool IsBlockRecordSize(unsigned int unSize) {
+	unsigned int unDataSize = unSize & ~DISK_RECORD_COMPRESSED;
+	return unDataSize <= MAX_BLOCK_SIZE && (unDataSize >= 80 || (unSize & DISK_RECORD_COMPRESSED));
+}
+
+// Read unDataSize bytes of a record in a block file scan, in pieces that fit in the scan buffer
+static void ReadScannedRecord(CBufferedFile &blkdat, unsigned int unDataSize, CDataStream &ssData) {
+	ssData.clear();
+	ssData.resize(unDataSize);
+	for (unsigned int unRead = 0; unRead < unDataSize;) {
+		unsigned int unNow = min(unDataSize - unRead, 1U << 15);
+		blkdat.read(&ssData[unRead], unNow);
+		unRead += unNow;
+	}
+}
+
 bool LoadExternalBlockFile(FILE* pFileIn, ST_DiskBlockPos *pDiskBlockPos) {
 	int64_t llStart = GetTimeMillis();
 	int nLoaded = 0;
@@ -3416,7 +4396,7 @@ bool LoadExternalBlockFile(FILE* pFileIn, ST_DiskBlockPos *pDiskBlockPos) {
 				}
 				// read size
 				blkdat >> unSize;
-				if (unSize < 80 || unSize > MAX_BLOCK_SIZE) {
+				if (!IsBlockRecordSize(unSize)) {
 					continue;
 				}
 			} catch (std::exception &e) {
@@ -3426,9 +4406,22 @@ bool LoadExternalBlockFile(FILE* pFileIn, ST_DiskBlockPos *pDiskBlockPos) {
 			try {
 				// read block
 				uint64_t nBlockPos = blkdat.GetPos();
-				blkdat.SetLimit(nBlockPos + unSize);
+				unsigned int unDataSize = unSize & ~DISK_RECORD_COMPRESSED;
+				blkdat.SetLimit(nBlockPos + unDataSize);
 				CBlock block;
-				blkdat >> block;
+				{
+					CBlockPhaseTimer cTimer(EM_BLOCK_PHASE_DESERIALIZE);
+					if (unSize & DISK_RECORD_COMPRESSED) {
+						CDataStream ssBlock(SER_DISK, g_sClientVersion);
+						ReadScannedRecord(blkdat, unDataSize, ssBlock);
+						if (!UnpackDiskRecord(unSize, ssBlock)) {
+							continue;
+						}
+						ssBlock >> block;
+					} else {
+						blkdat >> block;
+					}
+				}
 				ullRewind = blkdat.GetPos();
 
 				// process block
@@ -3460,6 +4453,290 @@ bool LoadExternalBlockFile(FILE* pFileIn, ST_DiskBlockPos *pDiskBlockPos) {
 	return nLoaded > 0;
 }
 
+// blocks read ahead of validation while reindexing
+static const size_t REINDEX_PREFETCH_BLOCKS = 64;
+// bytes of a compressed block decoded to get its header while scanning
+static const unsigned int REINDEX_HEADER_BYTES = 1024;
+
+// Index the blocks of one block file, deserializing only their headers
+static void ScanBlockFileHeaders(int nFile, vector<ST_ReindexBlock> &vtBlocks) {
+	FILE *pFile = OpenBlockFile(ST_DiskBlockPos(nFile, 0), true);
+	if (!pFile) {
+		return;
+	}
+	try {
+		CBufferedFile blkdat(pFile, 1 << 20, 1 << 16, SER_DISK, g_sClientVersion);
+		uint64_t ullRewind = blkdat.GetPos();
+		while (blkdat.good() && !blkdat.eof()) {
+			boost::this_thread::interruption_point();
+			blkdat.SetPos(ullRewind);
+			ullRewind++; // start one byte further next time, in case of failure
+			blkdat.SetLimit(); // remove former limit
+			unsigned int unSize = 0;
+			try {
+				// locate a header
+				unsigned char szBuf[MESSAGE_START_SIZE];
+				blkdat.FindByte(SysCfg().MessageStart()[0]);
+				ullRewind = blkdat.GetPos() + 1;
+				blkdat >> FLATDATA(szBuf);
+				if (memcmp(szBuf, SysCfg().MessageStart(), MESSAGE_START_SIZE)) {
+					continue;
+				}
+				// read size
+				blkdat >> unSize;
+				if (!IsBlockRecordSize(unSize)) {
+					continue;
+				}
+			} catch (std::exception &e) {
+				// no valid block header found; don't complain
+				break;
+			}
+			try {
+				uint64_t ullBlockPos = blkdat.GetPos();
+				unsigned int unDataSize = unSize & ~DISK_RECORD_COMPRESSED;
+				blkdat.SetLimit(ullBlockPos + unDataSize);
+				CBlockHeader cHeader;
+				if (unSize & DISK_RECORD_COMPRESSED) {
+					// a long run of literals may come first, so all of the stored data is read
+					CDataStream ssPrefix(SER_DISK, g_sClientVersion);
+					ReadScannedRecord(blkdat, unDataSize, ssPrefix);
+					if (!UnpackDiskRecord(unSize, ssPrefix, REINDEX_HEADER_BYTES)) {
+						continue;
+					}
+					ssPrefix >> cHeader;
+				} else {
+					blkdat >> cHeader;
+				}
+				if (!CheckProofOfWork(cHeader.GetHash(), cHeader.GetBits())) {
+					continue;
+				}
+				ST_ReindexBlock tBlock;
+				tBlock.cHash 		= cHeader.GetHash();
+				tBlock.cPrevHash 	= cHeader.GetHashPrevBlock();
+				tBlock.tPos 		= ST_DiskBlockPos(nFile, ullBlockPos);
+				vtBlocks.push_back(tBlock);
+
+				// skip the transactions, within the buffer if they are in it already
+				blkdat.SetLimit();
+				if (!blkdat.SetPos(ullBlockPos + unDataSize)) {
+					blkdat.Seek(ullBlockPos + unDataSize);
+				}
+				ullRewind = blkdat.GetPos();
+			} catch (std::exception &e) {
+				LogPrint("INFO", "%s : Deserialize or I/O error - %s\n", __func__, e.what());
+			}
+		}
+	} catch (runtime_error &e) {
+		LogPrint("INFO", "%s : blk%05u.dat - %s\n", __func__, nFile, e.what());
+	}
+	fclose(pFile);
+}
+
+/** Reads the blocks to reindex in order on its own thread, a bounded number ahead of the validation */
+class CReindexPrefetcher {
+ public:
+	CReindexPrefetcher(const vector<ST_ReindexBlock> &vtBlocks) :
+			m_vtBlocks(vtBlocks), m_bStop(false), m_bDone(false) {
+		m_Thread = boost::thread(&CReindexPrefetcher::ThreadRead, this);
+	}
+
+	~CReindexPrefetcher() {
+		boost::this_thread::disable_interruption tDisable;
+		{
+			boost::lock_guard<boost::mutex> lock(m_Mutex);
+			m_bStop = true;
+		}
+		m_Cond.notify_all();
+		m_Thread.join();
+	}
+
+	// next block in order, null if it could not be read
+	std::shared_ptr<CBlock> Next() {
+		boost::unique_lock<boost::mutex> lock(m_Mutex);
+		while (m_dBlocks.empty() && !m_bDone) {
+			m_Cond.wait(lock);
+		}
+		if (m_dBlocks.empty()) {
+			return std::shared_ptr<CBlock>();
+		}
+		std::shared_ptr<CBlock> pBlock = m_dBlocks.front();
+		m_dBlocks.pop_front();
+		m_Cond.notify_all();
+		return pBlock;
+	}
+
+ private:
+	void ThreadRead() {
+		RenameThread("Dacrs-reindexread");
+		CAutoFile cFile(NULL, SER_DISK, g_sClientVersion);
+		int nFile = -1;
+		for (const auto &tBlockPos : m_vtBlocks) {
+			std::shared_ptr<CBlock> pBlock = std::make_shared<CBlock>();
+			if (nFile != tBlockPos.tPos.nFile) {
+				cFile.fclose();
+				cFile = OpenBlockFile(ST_DiskBlockPos(tBlockPos.tPos.nFile, 0), true);
+				nFile = tBlockPos.tPos.nFile;
+			}
+			try {
+				if (!cFile || fseek(cFile, tBlockPos.tPos.unPos, SEEK_SET)) {
+					throw runtime_error("cannot open or seek");
+				}
+				CBlockPhaseTimer cTimer(EM_BLOCK_PHASE_DESERIALIZE);
+				CDataStream ssBlock(SER_DISK, g_sClientVersion);
+				if (!ReadDiskRecord(cFile, ssBlock)) {
+					throw runtime_error("cannot read the block record");
+				}
+				ssBlock >> *pBlock;
+			} catch (std::exception &e) {
+				LogPrint("INFO", "%s : block %s in blk%05u.dat - %s\n", __func__, tBlockPos.cHash.GetHex(),
+						tBlockPos.tPos.nFile, e.what());
+				pBlock.reset();
+				// the error state of the stream sticks, start over on the next block
+				cFile.fclose();
+				nFile = -1;
+			}
+			boost::unique_lock<boost::mutex> lock(m_Mutex);
+			while (m_dBlocks.size() >= REINDEX_PREFETCH_BLOCKS && !m_bStop) {
+				m_Cond.wait(lock);
+			}
+			if (m_bStop) {
+				return;
+			}
+			m_dBlocks.push_back(pBlock);
+			m_Cond.notify_all();
+		}
+		boost::lock_guard<boost::mutex> lock(m_Mutex);
+		m_bDone = true;
+		m_Cond.notify_all();
+	}
+
+	const vector<ST_ReindexBlock> &m_vtBlocks;
+	boost::thread m_Thread;
+	boost::mutex m_Mutex;
+	boost::condition_variable m_Cond;
+	deque<std::shared_ptr<CBlock> > m_dBlocks;
+	bool m_bStop;
+	bool m_bDone;
+};
+
+bool OrderBlockFiles(const vector<int> &vnFiles, vector<ST_ReindexBlock> &vtOrdered) {
+	int64_t llStart = GetTimeMillis();
+	int nFiles = vnFiles.size();
+	vtOrdered.clear();
+
+	// index the headers of all block files, several files at a time
+	vector<vector<ST_ReindexBlock> > vvtFileBlocks(nFiles);
+	std::atomic<int> nNext(0);
+	int nThreads = max(1, min(nFiles, (int) boost::thread::hardware_concurrency()));
+	LogPrint("INFO", "Reindex: indexing %d block files with %d threads\n", nFiles, nThreads);
+	{
+		boost::thread_group cThreads;
+		for (int i = 0; i < nThreads; ++i) {
+			cThreads.create_thread([&]() {
+				RenameThread("Dacrs-reindexscan");
+				for (int n = nNext++; n < nFiles; n = nNext++) {
+					ScanBlockFileHeaders(vnFiles[n], vvtFileBlocks[n]);
+				}
+			});
+		}
+		try {
+			cThreads.join_all();
+		} catch (boost::thread_interrupted &) {
+			cThreads.interrupt_all();
+			cThreads.join_all();
+			throw;
+		}
+	}
+
+	// order the blocks by height, following the links from the genesis block
+	map<uint256, const ST_ReindexBlock*> mapBlocks;
+	multimap<uint256, const ST_ReindexBlock*> mapChildren;
+	size_t unFound = 0;
+	for (const auto &vtBlocks : vvtFileBlocks) {
+		for (const auto &tBlock : vtBlocks) {
+			++unFound;
+			if (mapBlocks.insert(make_pair(tBlock.cHash, &tBlock)).second) {
+				mapChildren.insert(make_pair(tBlock.cPrevHash, &tBlock));
+			}
+		}
+	}
+	map<uint256, const ST_ReindexBlock*>::iterator itGenesis = mapBlocks.find(SysCfg().HashGenesisBlock());
+	if (itGenesis == mapBlocks.end()) {
+		return ERRORMSG("%s : genesis block not found in %d block files", __func__, nFiles);
+	}
+	vtOrdered.push_back(*itGenesis->second);
+	for (size_t i = 0; i < vtOrdered.size(); ++i) {
+		auto range = mapChildren.equal_range(vtOrdered[i].cHash);
+		for (auto it = range.first; it != range.second; ++it) {
+			vtOrdered.push_back(*it->second);
+		}
+	}
+	LogPrint("INFO", "Reindex: %u blocks in %d files, %u duplicates, %u not linked to the genesis block, in %dms\n",
+			unFound, nFiles, unFound - mapBlocks.size(), mapBlocks.size() - vtOrdered.size(),
+			GetTimeMillis() - llStart);
+	return true;
+}
+
+bool ReindexBlockFiles() {
+	int64_t llStart = GetTimeMillis();
+	vector<int> vnFiles;
+	while (boost::filesystem::exists(GetDataDir() / "blocks" / strprintf("blk%05u.dat", vnFiles.size()))) {
+		vnFiles.push_back(vnFiles.size());
+	}
+	if (vnFiles.empty()) {
+		return true;
+	}
+	g_cUIInterface.InitMessage(_("Indexing block files..."));
+	vector<ST_ReindexBlock> vtOrdered;
+	if (!OrderBlockFiles(vnFiles, vtOrdered)) {
+		return false;
+	}
+	{
+		// blocks connected by an earlier, interrupted reindex
+		LOCK(g_cs_main);
+		vtOrdered.erase(remove_if(vtOrdered.begin(), vtOrdered.end(), [](const ST_ReindexBlock &tBlock) {
+			return g_mapBlockIndex.count(tBlock.cHash) > 0;
+		}), vtOrdered.end());
+	}
+
+	// connect them in order while the next ones are read
+	int64_t llConnectStart = GetTimeMillis();
+	int64_t llLastLog = llConnectStart;
+	int nLastPercent = -1;
+	size_t unLoaded = 0;
+	CReindexPrefetcher cPrefetcher(vtOrdered);
+	for (size_t i = 0; i < vtOrdered.size(); ++i) {
+		boost::this_thread::interruption_point();
+		std::shared_ptr<CBlock> pBlock = cPrefetcher.Next();
+		if (!pBlock) {
+			continue;
+		}
+		ST_DiskBlockPos tPos = vtOrdered[i].tPos;
+		{
+			LOCK(g_cs_main);
+			CValidationState cValidationState;
+			if (ProcessBlock(cValidationState, NULL, pBlock.get(), &tPos)) {
+				++unLoaded;
+			}
+			if (cValidationState.IsError()) {
+				return ERRORMSG("%s : stopped at block %s", __func__, vtOrdered[i].cHash.GetHex());
+			}
+		}
+		int nPercent = (i + 1) * 100 / vtOrdered.size();
+		if (nPercent != nLastPercent) {
+			g_cUIInterface.InitMessage(strprintf(_("Reindexing blocks... (%d%%)"), nPercent));
+			nLastPercent = nPercent;
+		}
+		if (GetTimeMillis() - llLastLog >= 10000 || i + 1 == vtOrdered.size()) {
+			llLastLog = GetTimeMillis();
+			LogPrint("INFO", "Reindex: %u/%u blocks (%d%%), height %d, %.1f blocks/s\n", i + 1, vtOrdered.size(),
+					nPercent, pBlock->GetHeight(), (i + 1) * 1000.0 / max<int64_t>(1, llLastLog - llConnectStart));
+		}
+	}
+	LogPrint("INFO", "Reindex: connected %u blocks in %dms\n", unLoaded, GetTimeMillis() - llStart);
+	return true;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // CAlert
 
@@ -3566,6 +4843,13 @@ void static ProcessGetData(CNode* pFromNode) {
 						bSend = true;
 					}
 				}
+				if (bSend && !(mi->second->m_unStatus & BLOCK_HAVE_DATA)) {
+					// pruned, or known from a state snapshot only
+					LogPrint("net", "ProcessGetData(): block %s is not on disk, not sending it to peer=%d\n",
+							cInv.m_cHash.ToString(), pFromNode->GetId());
+					vNotFound.push_back(cInv);
+					bSend = false;
+				}
 				if (bSend) {
 					// Send block from disk
 					CBlock block;
@@ -3932,6 +5216,11 @@ bool static ProcessMessage(CNode* pFromNode, string strCommand, CDataStream& vRe
 		LogPrint("net", "getblocks %d to %s limit %d\n", (pBlockIndex ? pBlockIndex->m_nHeight : -1), cHashStop.ToString(),
 				nLimit);
 		for (; pBlockIndex; pBlockIndex = g_cChainActive.Next(pBlockIndex)) {
+			// announcing blocks that are not on disk would only bring getdata we refuse
+			if (!(pBlockIndex->m_unStatus & BLOCK_HAVE_DATA)) {
+				LogPrint("net", "  getblocks stopping at %d, block not on disk\n", pBlockIndex->m_nHeight);
+				break;
+			}
 			pFromNode->PushInventory(CInv(MSG_BLOCK, pBlockIndex->GetBlockHash()));
 			if (pBlockIndex->GetBlockHash() == cHashStop) {
 				LogPrint("net", "  getblocks stopping at %d %s\n", pBlockIndex->m_nHeight,
@@ -4657,16 +5946,34 @@ bool DisconnectBlockFromTip(CValidationState &cValidationState) {
 	return DisconnectTip(cValidationState);
 }
 
+static bool ReadTxUndoFromDisk(const ST_DiskBlockPos &tUndoPos, const uint256 &cTxHash, CTxUndo &cTxUndo) {
+	CAutoFile cFilein = CAutoFile(OpenUndoFile(tUndoPos, true), SER_DISK, g_sClientVersion);
+	if (!cFilein) {
+		return ERRORMSG("ReadTxUndoFromDisk : OpenUndoFile failed");
+	}
+	try {
+		cFilein >> cTxUndo;
+	} catch (std::exception &e) {
+		return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+	}
+
+	return cTxUndo.m_cTxHash == cTxHash;
+}
+
 bool GetTxOperLog(const uint256 &cTxHash, vector<CAccountLog> &vcAccountLog) {
 	if (SysCfg().IsTxIndex()) {
 		ST_DiskTxPos tPosTx;
 		if (g_pScriptDBTip->ReadTxIndex(cTxHash, tPosTx)) {
-			CAutoFile cAutoFile(OpenBlockFile(tPosTx, true), SER_DISK, g_sClientVersion);
+			CTxUndo cTxUndo;
+			if (tPosTx.m_unUndoPos != 0
+					&& ReadTxUndoFromDisk(ST_DiskBlockPos(tPosTx.nFile, tPosTx.m_unUndoPos), cTxHash, cTxUndo)) {
+				vcAccountLog = cTxUndo.m_vcAccountLog;
+				return true;
+			}
+			// indexed without its undo record, scan the undo data of the block
 			CBlockHeader cBlockHeader;
-			try {
-				cAutoFile >> cBlockHeader;
-			} catch (std::exception &e) {
-				return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+			if (!ReadTxFromDisk(tPosTx, cBlockHeader)) {
+				return false;
 			}
 			uint256 cBlockHash = cBlockHeader.GetHash();
 			if (g_mapBlockIndex.count(cBlockHash) > 0) {
@@ -4693,6 +6000,58 @@ bool GetTxOperLog(const uint256 &cTxHash, vector<CAccountLog> &vcAccountLog) {
 	return false;
 }
 
+void GetTxOperLogs(const vector<uint256> &vcTxHash, map<uint256, vector<CAccountLog> > &mapAccountLog) {
+	if (!SysCfg().IsTxIndex()) {
+		return;
+	}
+	vector<pair<ST_DiskBlockPos, uint256> > vUndoPos;
+	vector<uint256> vcScanBlock;
+	for (const auto &cTxHash : vcTxHash) {
+		ST_DiskTxPos tPosTx;
+		if (!g_pScriptDBTip->ReadTxIndex(cTxHash, tPosTx)) {
+			continue;
+		}
+		if (tPosTx.m_unUndoPos != 0) {
+			vUndoPos.push_back(make_pair(ST_DiskBlockPos(tPosTx.nFile, tPosTx.m_unUndoPos), cTxHash));
+		} else {
+			vcScanBlock.push_back(cTxHash);
+		}
+	}
+	// one pass over each undo file, seeking forward from record to record
+	sort(vUndoPos.begin(), vUndoPos.end(),
+			[](const pair<ST_DiskBlockPos, uint256> &a, const pair<ST_DiskBlockPos, uint256> &b) {
+				return a.first.nFile < b.first.nFile || (a.first.nFile == b.first.nFile && a.first.unPos < b.first.unPos);
+			});
+	for (size_t i = 0; i < vUndoPos.size();) {
+		int nFile = vUndoPos[i].first.nFile;
+		CAutoFile cFilein = CAutoFile(OpenUndoFile(ST_DiskBlockPos(nFile, 0), true), SER_DISK, g_sClientVersion);
+		for (; i < vUndoPos.size() && vUndoPos[i].first.nFile == nFile; ++i) {
+			const uint256 &cTxHash = vUndoPos[i].second;
+			CTxUndo cTxUndo;
+			bool bRead = false;
+			if (cFilein && fseek(cFilein, vUndoPos[i].first.unPos, SEEK_SET) == 0) {
+				try {
+					cFilein >> cTxUndo;
+					bRead = cTxUndo.m_cTxHash == cTxHash;
+				} catch (std::exception &e) {
+					ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+				}
+			}
+			if (bRead) {
+				mapAccountLog[cTxHash] = cTxUndo.m_vcAccountLog;
+			} else {
+				vcScanBlock.push_back(cTxHash);
+			}
+		}
+	}
+	for (const auto &cTxHash : vcScanBlock) {
+		vector<CAccountLog> vcAccountLog;
+		if (GetTxOperLog(cTxHash, vcAccountLog)) {
+			mapAccountLog[cTxHash] = vcAccountLog;
+		}
+	}
+}
+
 Value ListSetBlockIndexValid() {
 	Object result;
 	std::set<CBlockIndex*, CBlockIndexWorkComparator>::reverse_iterator it = g_setBlockIndexValid.rbegin();
@@ -21,6 +21,7 @@
 #include "arith_uint256.h"
 
 #include <algorithm>
+#include <atomic>
 #include <exception>
 #include <map>
 #include <set>
@@ -58,18 +59,32 @@ static const unsigned int MAX_BLOCKFILE_SIZE = 0x8000000; // 128 MiB
 static const unsigned int BLOCKFILE_CHUNK_SIZE = 0x1000000; // 16 MiB
 /** The pre-allocation chunk size for rev?????.dat files (since 0.8) */
 static const unsigned int UNDOFILE_CHUNK_SIZE = 0x100000; // 1 MiB
+/** Set in the size field of a blk or rev file record whose data is compressed, see CDiskRecord */
+static const unsigned int DISK_RECORD_COMPRESSED = 0x80000000;
+/** Blocks below the tip -prune keeps on top of those ConnectBlock reads back, see GetPruneKeepDepth */
+static const int MIN_BLOCKS_TO_KEEP = 288;
+/** The smallest -prune target, in bytes of blk and rev files */
+static const uint64_t MIN_DISK_SPACE_FOR_BLOCK_FILES = 550 * 1024 * 1024;
 /** Coinbase transaction outputs can only be spent after this number of new blocks (network rule) */
 static const int COINBASE_MATURITY = 100;
 /** Threshold for nLockTime: below this value it is interpreted as block number, otherwise as UNIX timestamp. */
 static const unsigned int LOCKTIME_THRESHOLD = 500000000; // Tue Nov  5 00:53:20 1985 UTC
 /** Maximum number of script-checking threads allowed */
 static const int MAX_SCRIPTCHECK_THREADS = 16;
-/** -par default (number of script-checking threads, 0 = auto) */
-static const int DEFAULT_SCRIPTCHECK_THREADS = 0;
+/** -par default (threads executing block transactions, 0 = auto, 1 = serial execution) */
+static const int DEFAULT_SCRIPTCHECK_THREADS = 1;
 /** Number of blocks that can be requested at any given time from a single peer. */
 static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER = 128;
 /** Timeout in seconds before considering a block download peer unresponsive. */
 static const unsigned int BLOCK_DOWNLOAD_TIMEOUT = 60;
+/** -persistmempool default (save the memory pool to mempool.dat and load it at startup) */
+static const bool DEFAULT_PERSIST_MEMPOOL = true;
+/** -validationstatsinterval default, seconds between two logged summaries of the validation phases */
+static const int DEFAULT_VALIDATION_STATS_INTERVAL = 3600;
+/** Seconds between two saves of the memory pool while running */
+static const unsigned int MEMPOOL_DUMP_INTERVAL = 900;
+/** Transactions re-validated per g_cs_main acquisition when loading mempool.dat */
+static const unsigned int MEMPOOL_LOAD_BATCH_SIZE = 100;
 static const long MAX_BLOCK_RUN_STEP = 12000000;
 static const int64_t POS_REWARD = 10 * COIN;
 static const int64_t INIT_FUEL_RATES = 100;   //100 unit / 100 step
@@ -98,7 +113,13 @@ extern CTxMemPool g_cTxMemPool;
 extern map<uint256, CBlockIndex*> g_mapBlockIndex;
 extern uint64_t g_ullLastBlockTx;
 extern uint64_t g_ullLastBlockSize;
+extern int64_t g_llLastTemplateMicros;
+extern uint64_t g_ullLastTemplateExecuted;
 extern const string g_strMessageMagic;
+/** -prune target in bytes of blk and rev files, 0 when pruning is off */
+extern uint64_t g_ullPruneTarget;
+/** Whether block files have been deleted, from this run or a previous one */
+extern bool g_bHavePruned;
 
 // Minimum disk space required - used in CheckDiskSpace()
 static const uint64_t g_sMinDiskSpace 			= 52428800;
@@ -117,7 +138,9 @@ static const int g_sBlockRemainCoinDayHeight 	= 731400;  		//
 
 class CCoinsDB;
 class CBlockTreeDB;
+class CBlockFileInfo;
 struct ST_DiskBlockPos;
+struct ST_ReindexBlock;
 class CTxUndo;
 class CValidationState;
 class CWalletInterface;
@@ -125,6 +148,7 @@ struct ST_NodeStateStats;
 class CAccountViewDB;
 class CTransactionDB;
 class CScriptDB;
+class CChainStateSnapshot;
 struct ST_BlockTemplate;
 
 /** Register a wallet to receive updates from core */
@@ -137,6 +161,8 @@ void UnregisterAllWallets();
 void SyncWithWallets(const uint256 &cHash, CBaseTransaction *pBaseTx, const CBlock* pBlock = NULL);
 /** Erase Tx from wallets **/
 void EraseTransaction(const uint256 &cHash);
+/** Notify wallets that the mempool has been rescanned against a new tip */
+void SyncMemPoolWithWallets();
 /** Register with a network node to receive its signals */
 void RegisterNodeSignals(ST_NodeSignals& tNodeSignals);
 /** Unregister a network node */
@@ -152,6 +178,22 @@ FILE* OpenBlockFile(const ST_DiskBlockPos &cDiskBlockPos, bool bReadOnly = false
 FILE* OpenUndoFile(const ST_DiskBlockPos &cDiskBlockPos, bool bReadOnly = false);
 /** Import blocks from an external file */
 bool LoadExternalBlockFile(FILE* pFileIn, ST_DiskBlockPos *pDiskBlockPos = NULL);
+/**
+ * Index the headers of the given blk files in parallel and list their blocks linked to the genesis
+ * block, each after its parent: in height order
+ */
+bool OrderBlockFiles(const vector<int> &vnFiles, vector<ST_ReindexBlock> &vtOrdered);
+/** Rebuild the block index from the blk files: index their headers in parallel, then connect them in height order */
+bool ReindexBlockFiles();
+/** Number of blocks below the tip whose block and undo files are never pruned */
+int GetPruneKeepDepth();
+/**
+ * Choose the block files to prune so the rest fits in ullTarget bytes, given the info of every
+ * file, the last one being written to: the oldest first, only files whose blocks are all below
+ * nPruneHeight, never the last one
+ */
+void SelectFilesToPrune(const vector<CBlockFileInfo> &vcFileInfo, uint64_t ullTarget, int nPruneHeight,
+		set<int> &setFiles);
 /** Initialize a new block tree database + block data on disk */
 bool InitBlockIndex();
 /** Load the block tree and coins database from disk */
@@ -200,9 +242,19 @@ bool GetNodeStateStats(NodeId nNodeId, ST_NodeStateStats &NodeStateStats);
 /** Increase a node's misbehavior score. */
 void Misbehaving(NodeId nNodeId, int nHowMuch);
 bool CheckSignScript(const uint256 & cSigHash, const std::vector<unsigned char> vchSignature, const CPubKey cPubKey);
-/** (try to) add transaction to memory pool **/
+/** Resolve -assumevalid against the checkpoints, called once at startup */
+void InitAssumeValid();
+/** The -assumevalid block (the last checkpoint by default, null if disabled) and its height, -1 if unknown */
+uint256 GetAssumeValidBlock(int &nHeight);
+/** Whether the block is an indexed ancestor of the assume-valid block, connected without signature checks */
+bool IsAssumedValid(const CBlockIndex *pBlockIndex);
+/** (try to) add transaction to memory pool, entering it at llEntryTime if given instead of now **/
 bool AcceptToMemoryPool(CTxMemPool& cTxMemPool, CValidationState &cValidationState, CBaseTransaction *pBaseTx,
-		  bool bLimitFree, bool bRejectInsaneFee = false);
+		  bool bLimitFree, bool bRejectInsaneFee = false, int64_t llEntryTime = 0);
+/** Save the memory pool to mempool.dat, skipped until LoadMempool has finished **/
+bool DumpMempool();
+/** Re-validate the transactions of mempool.dat into the memory pool **/
+bool LoadMempool();
 /** get transaction relate keyid **/
 std::shared_ptr<CBaseTransaction> CreateNewEmptyTransaction(unsigned char uchType);
 
@@ -245,10 +297,11 @@ struct ST_DiskTxPos: public ST_DiskBlockPos {
 	IMPLEMENT_SERIALIZE(
 			READWRITE(*(ST_DiskBlockPos*)this);
 			READWRITE(VARINT(m_unTxOffset));
+			READWRITE(VARINT(m_unUndoPos));
 	)
 
 	ST_DiskTxPos(const ST_DiskBlockPos &tBlockIn, unsigned int unTxOffsetIn) :
-			ST_DiskBlockPos(tBlockIn.nFile, tBlockIn.unPos), m_unTxOffset(unTxOffsetIn) {
+			ST_DiskBlockPos(tBlockIn.nFile, tBlockIn.unPos), m_unTxOffset(unTxOffsetIn), m_unUndoPos(0) {
 	}
 	ST_DiskTxPos() {
 		SetNull();
@@ -256,9 +309,18 @@ struct ST_DiskTxPos: public ST_DiskBlockPos {
 	void SetNull() {
 		ST_DiskBlockPos::SetNull();
 		m_unTxOffset = 0;
+		m_unUndoPos = 0;
 	}
 
 	unsigned int m_unTxOffset; // after header
+	unsigned int m_unUndoPos;  // of the tx's CTxUndo in rev file nFile, 0 if not indexed
+};
+
+/** A block found while scanning the block files for -reindex */
+struct ST_ReindexBlock {
+	uint256 cHash;
+	uint256 cPrevHash;
+	ST_DiskBlockPos tPos; 			// of the block itself, past its message start and size
 };
 
 enum GetMinFee_mode {
@@ -281,13 +343,57 @@ inline bool AllowFree(double dPriority) {
 }
 
 // Context-independent validity checks
-bool CheckTransaction(CBaseTransaction *pBaseTx, CValidationState& cValidationState, CAccountViewCache &cAccountViewCache);
+bool CheckTransaction(CBaseTransaction *pBaseTx, CValidationState& cValidationState, CAccountViewCache &cAccountViewCache,
+		CScriptDBViewCache &cScriptDBViewCache, bool bCheckSig = true);
 /** Check for standard transaction types
     @return True if all outputs (scriptPubKeys) use only standard transaction forms
 */
 bool IsStandardTx(CBaseTransaction *pBaseTx, string& strReason);
 bool IsFinalTx(CBaseTransaction *pBaseTx, int nBlockHeight = 0, int64_t llBlockTime = 0);
 
+/**
+ * A block or undo record as it is written to a blk or rev file: the message start, a size field
+ * and the serialized data. With -blockcompression the data is compressed when that saves space,
+ * it is then the uncompressed size followed by the LZ4 data, and the size field is flagged with
+ * DISK_RECORD_COMPRESSED so that records of both kinds are read back from the same files.
+ */
+class CDiskRecord {
+ public:
+	CDiskRecord() :
+			m_unSize(0) {
+	}
+
+	template<typename T>
+	void Pack(const T &obj, bool bCompress) {
+		CDataStream ssData(SER_DISK, g_sClientVersion);
+		ssData << obj;
+		PackData(ssData, bCompress);
+	}
+	/** Bytes the record takes in the file, message start and size field included */
+	unsigned int GetDiskSize() const {
+		return MESSAGE_START_SIZE + sizeof(m_unSize) + m_vchData.size();
+	}
+	bool IsCompressed() const {
+		return (m_unSize & DISK_RECORD_COMPRESSED) != 0;
+	}
+	/** Write the record at the file's position, unPos is set to where its data starts */
+	bool Write(CAutoFile &cFileout, unsigned int &unPos) const;
+
+ private:
+	void PackData(const CDataStream &ssData, bool bCompress);
+
+	unsigned int m_unSize; 			// the size field: length of m_vchData, flagged if it is compressed
+	vector<char> m_vchData;
+};
+
+/** Read the data of the record starting at the file's position, decompressed */
+bool ReadDiskRecord(CAutoFile &cFilein, CDataStream &ssData);
+/**
+ * Turn the data of a record with size field unSize, as stored, into the serialized data. With
+ * unPrefix only that many bytes at most are decoded, from stored data that may be cut short.
+ */
+bool UnpackDiskRecord(unsigned int unSize, CDataStream &ssData, size_t unPrefix = 0);
+
 /** Undo information for a CBlock */
 class CBlockUndo {
  public:
@@ -295,22 +401,17 @@ class CBlockUndo {
 			READWRITE(m_vcTxUndo);
 	)
 
-	bool WriteToDisk(ST_DiskBlockPos &tDiskBlockPos, const uint256 &cHashBlock) {
+	// cRecord is this undo data packed, it takes cRecord.GetDiskSize() bytes and the checksum
+	bool WriteToDisk(const CDiskRecord &cRecord, ST_DiskBlockPos &tDiskBlockPos, const uint256 &cHashBlock) {
 		// Open history file to append
 		CAutoFile cFileout = CAutoFile(OpenUndoFile(tDiskBlockPos), SER_DISK, g_sClientVersion);
 		if (!cFileout) {
 			return ERRORMSG("CBlockUndo::WriteToDisk : OpenUndoFile failed");
 		}
-		// Write index header
-		unsigned int unSize = cFileout.GetSerializeSize(*this);
-		cFileout << FLATDATA(SysCfg().MessageStart()) << unSize;
-		// Write undo data
-		long lFileOutPos = ftell(cFileout);
-		if (lFileOutPos < 0) {
-			return ERRORMSG("CBlockUndo::WriteToDisk : ftell failed");
+		// Write index header and undo data
+		if (!cRecord.Write(cFileout, tDiskBlockPos.unPos)) {
+			return false;
 		}
-		tDiskBlockPos.unPos = (unsigned int) lFileOutPos;
-		cFileout << *this;
 		// calculate & write checksum
 		CHashWriter cHashWriter(SER_GETHASH, g_sProtocolVersion);
 		cHashWriter << cHashBlock;
@@ -334,7 +435,11 @@ class CBlockUndo {
 		// Read block
 		uint256 cHashChecksum;
 		try {
-			cFilein >> *this;
+			CDataStream ssUndo(SER_DISK, g_sClientVersion);
+			if (!ReadDiskRecord(cFilein, ssUndo)) {
+				return false;
+			}
+			ssUndo >> *this;
 			cFilein >> cHashChecksum;
 		} catch (std::exception &e) {
 			return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
@@ -505,9 +610,11 @@ class CPartialMerkleTree {
 };
 
 /** Functions for disk access for blocks */
-bool WriteBlockToDisk(CBlock& cBlock, ST_DiskBlockPos& tDiskBlockPos);
+bool WriteBlockToDisk(const CDiskRecord &cRecord, ST_DiskBlockPos& tDiskBlockPos);
 bool ReadBlockFromDisk(CBlock& cBlock, const ST_DiskBlockPos& tDiskBlockPos);
 bool ReadBlockFromDisk(CBlock& cBlock, const CBlockIndex* pBlockIndex);
+/** Read the header of the block holding an indexed transaction, and the transaction unless pBaseTx is null */
+bool ReadTxFromDisk(const ST_DiskTxPos &tPosTx, CBlockHeader &cHeader, std::shared_ptr<CBaseTransaction> *pBaseTx = NULL);
 
 /** Functions for validating blocks and updating the block tree */
 
@@ -522,11 +629,15 @@ bool DisconnectBlock(CBlock& cBlock, CValidationState& cValidationState, CAccoun
 // Apply the effects of this block (with given index) on the UTXO set represented by coins
 bool ConnectBlock(CBlock& cBlock, CValidationState& cValidationState, CAccountViewCache &cAccountViewCache,
 		CBlockIndex* pBlockIndex, CTransactionDBCache &cTxCache, CScriptDBViewCache &cScriptCache, bool bJustCheck = false);
+// Execute a block's transactions after the reward one, speculatively in parallel when bParallel
+bool ExecuteBlockTxs(CBlock& cBlock, CValidationState& cValidationState, CAccountViewCache &cAccountViewCache,
+		CTransactionDBCache &cTxCache, CScriptDBViewCache &cScriptCache, int nHeight, bool bParallel,
+		vector<CTxUndo> &vcTxUndo, int64_t &llTotalFuel);
 // Add this block to the block index, and if necessary, switch the active block chain to this
 bool AddToBlockIndex(CBlock& cBlock, CValidationState& cValidationState, const ST_DiskBlockPos& tDiskBlockPos);
 // Context-independent validity checks
 bool CheckBlock(const CBlock& cBlock, CValidationState& cValidationState, CAccountViewCache &cAccountViewCache,
-		CScriptDBViewCache &cScriptDBCache, bool bCheckTx = true, bool bCheckMerkleRoot = true);
+		CScriptDBViewCache &cScriptDBCache, bool bCheckTx = true, bool bCheckMerkleRoot = true, bool bCheckSig = true);
 bool CheckBlockProofWorkWithCoinDay(const CBlock& cBlock, CValidationState& cValidationState);
 // Store block on disk
 // if dbp is provided, the file is known to already reside on disk
@@ -535,6 +646,8 @@ bool AcceptBlock(CBlock& cBlock, CValidationState& cValidationState, ST_DiskBloc
 bool DisconnectBlockFromTip(CValidationState &cValidationState);
 //get tx operate account log
 bool GetTxOperLog(const uint256 &cTxHash, vector<CAccountLog> &vcAccountLog);
+//get operate account logs of many txs in undo file order, txs without one are left out of mapAccountLog
+void GetTxOperLogs(const vector<uint256> &vcTxHash, map<uint256, vector<CAccountLog> > &mapAccountLog);
 //get setBlockIndexValid
 Value ListSetBlockIndexValid();
 
@@ -564,6 +677,11 @@ class CBlockFileInfo {
 		SetNull();
 	}
 
+	// deleted by -prune: the sizes are zeroed, the block count and heights are kept
+	bool IsPruned() const {
+		return m_unBlocks > 0 && m_unSize == 0;
+	}
+
 	string ToString() const {
 		return strprintf("CBlockFileInfo(blocks=%u, size=%u, heights=%u...%u, time=%s...%s)", m_unBlocks, m_unSize, m_unHeightFirst, m_unHeightLast, DateTimeStrFormat("%Y-%m-%d", m_ullTimeFirst).c_str(), DateTimeStrFormat("%Y-%m-%d", m_ullTimeLast).c_str());
 	}
@@ -609,7 +727,9 @@ enum BlockStatus {
 
     BLOCK_FAILED_VALID       =   32, // stage after last reached validness failed  0010 0000
     BLOCK_FAILED_CHILD       =   64, // descends from failed block                 0100 0000
-    BLOCK_FAILED_MASK        =   96  //                                            0110 0000
+    BLOCK_FAILED_MASK        =   96, //                                            0110 0000
+
+    BLOCK_PRUNED             =  128  // blk*.dat deleted by -prune, position kept  1000 0000
 };
 
 /** The block chain is a tree shaped structure starting with the
@@ -706,6 +826,8 @@ class CBlockIndex {
 		cBlock.SetBits(m_unBits);
 		cBlock.SetNonce(m_unNonce);
 		cBlock.SetHeight(m_nHeight);
+		cBlock.SetFuel(m_llFuel);
+		cBlock.SetFuelRate(m_nFuelRate);
 		cBlock.SetSignature(m_vchSignature);
 		return cBlock;
 	}
@@ -834,9 +956,9 @@ class CDiskBlockIndex: public CBlockIndex {
 		READWRITE(VARINT(m_nHeight));
 		READWRITE(VARINT(m_unStatus));
 		READWRITE(VARINT(m_unTx));
-		if (m_unStatus & (BLOCK_HAVE_DATA | BLOCK_HAVE_UNDO))
+		if (m_unStatus & (BLOCK_HAVE_DATA | BLOCK_HAVE_UNDO | BLOCK_PRUNED))
 		READWRITE(VARINT(m_nFile));
-		if (m_unStatus & BLOCK_HAVE_DATA)
+		if (m_unStatus & (BLOCK_HAVE_DATA | BLOCK_PRUNED))
 		READWRITE(VARINT(m_nDataPos));
 		if (m_unStatus & BLOCK_HAVE_UNDO)
 		READWRITE(VARINT(m_nUndoPos));
@@ -1054,6 +1176,13 @@ extern CTransactionDBCache *g_pTxCacheTip;
 /** contract script db cache */
 extern CScriptDBViewCache *g_pScriptDBTip;
 
+/** Publish a snapshot of the current tip, the tip caches must have been flushed to disk */
+void PublishChainStateSnapshot();
+/** Drop the published snapshot, before the databases it reads from are closed */
+void ReleaseChainStateSnapshot();
+/** Latest published chain state, usable without g_cs_main. NULL until the chain is loaded */
+std::shared_ptr<CChainStateSnapshot> GetChainStateSnapshot();
+
 /** nSyncTipHight  */
 extern int g_nSyncTipHeight;
 
@@ -1070,6 +1199,63 @@ struct ST_BlockTemplate {
 	vector<int64_t> vTxSigOps;
 };
 
+/** Phases of block validation whose wall time is accumulated, see CBlockPhaseTimer */
+enum emBlockPhase {
+	EM_BLOCK_PHASE_DESERIALIZE, 	// reading a block from an external blk file
+	EM_BLOCK_PHASE_PROCESSBLOCK, 	// everything below for blocks arriving through ProcessBlock
+	EM_BLOCK_PHASE_CHECKPROOF, 		// CheckBlockProofWorkWithCoinDay
+	EM_BLOCK_PHASE_CHECKBLOCK,
+	EM_BLOCK_PHASE_EXECUTETX, 		// the ConnectBlock transaction loop, VM time included
+	EM_BLOCK_PHASE_EXECUTE_REWARD, 	// ExecuteTx of a block transaction, by type
+	EM_BLOCK_PHASE_EXECUTE_REGACCT,
+	EM_BLOCK_PHASE_EXECUTE_COMMON,
+	EM_BLOCK_PHASE_EXECUTE_CONTRACT,
+	EM_BLOCK_PHASE_EXECUTE_REGAPP,
+	EM_BLOCK_PHASE_VM_8051, 		// contract runs, mempool acceptance included
+	EM_BLOCK_PHASE_VM_LUA,
+	EM_BLOCK_PHASE_VERIFYPOSTX,
+	EM_BLOCK_PHASE_UNDOWRITE,
+	EM_BLOCK_PHASE_COMPRESS, 		// -blockcompression of block and undo records
+	EM_BLOCK_PHASE_DECOMPRESS, 		// compressed records read back
+	EM_BLOCK_PHASE_FLUSH, 			// chain state writes to the databases
+	EM_BLOCK_PHASE_WALLETSYNC,
+	EM_BLOCK_PHASE_MAX,
+};
+
+/** Histogram buckets: bucket i counts durations below 2^i microseconds, the last one the rest */
+static const int BLOCK_PHASE_BUCKETS = 24;
+
+struct ST_BlockPhaseStats {
+	std::atomic<uint64_t> ullCalls;
+	std::atomic<int64_t> llMicros;
+	std::atomic<int64_t> llMaxMicros;
+	std::atomic<uint64_t> arrullBuckets[BLOCK_PHASE_BUCKETS];
+};
+
+extern ST_BlockPhaseStats g_arrtBlockPhaseStats[EM_BLOCK_PHASE_MAX];
+
+const char *GetBlockPhaseName(emBlockPhase emPhase);
+emBlockPhase GetExecutePhase(unsigned char chTxType);
+void AddBlockPhaseTime(emBlockPhase emPhase, int64_t llMicros);
+void ResetBlockPhaseTimes();
+/** Logs a one-line summary of the phases every -validationstatsinterval seconds */
+void LogBlockPhaseStats(bool bForce = false);
+
+/** Adds the time until it goes out of scope to the phase's stats */
+class CBlockPhaseTimer {
+ public:
+	explicit CBlockPhaseTimer(emBlockPhase emPhase) :
+			m_emPhase(emPhase), m_llStart(GetMonotonicMicros()) {
+	}
+	~CBlockPhaseTimer() {
+		AddBlockPhaseTime(m_emPhase, GetMonotonicMicros() - m_llStart);
+	}
+
+ private:
+	emBlockPhase m_emPhase;
+	int64_t m_llStart;
+};
+
 bool EraseBlockIndexFromSet(CBlockIndex *pIndex);
 
 /** Used to relay blocks as header + vector<merkle branch>
@@ -1106,6 +1292,7 @@ class CWalletInterface {
     virtual void SetBestChain(const ST_BlockLocator &tLocator) =0;
     virtual void UpdatedTransaction(const uint256 &cHash) =0;
     virtual void ResendWalletTransactions() =0;
+    virtual void UpdatedMemPool() =0;
     friend void ::RegisterWallet(CWalletInterface*);
     friend void ::UnregisterWallet(CWalletInterface*);
     friend void ::UnregisterAllWallets();
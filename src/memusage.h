@@ -0,0 +1,47 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DACRS_MEMUSAGE_H_
+#define DACRS_MEMUSAGE_H_
+
+#include <stddef.h>
+#include <map>
+#include <vector>
+
+/** Estimates of the heap memory held by containers, as allocated by glibc malloc */
+namespace memusage {
+
+/** Bytes malloc actually reserves for an allocation of unAlloc bytes */
+static inline size_t MallocUsage(size_t unAlloc) {
+	if (unAlloc == 0) {
+		return 0;
+	} else if (sizeof(void*) == 8) {
+		return ((unAlloc + 31) >> 4) << 4;
+	} else {
+		return ((unAlloc + 15) >> 3) << 3;
+	}
+}
+
+/** Header of a std::map node: color, parent, left and right */
+struct ST_MapNodeHeader {
+	int nColor;
+	void *pParent;
+	void *pLeft;
+	void *pRight;
+};
+
+template<typename X>
+static inline size_t DynamicUsage(const std::vector<X> &v) {
+	return MallocUsage(v.capacity() * sizeof(X));
+}
+
+/** Heap bytes of one map entry, not counting what the key and value themselves point to */
+template<typename K, typename V>
+static inline size_t MapEntryUsage() {
+	return MallocUsage(sizeof(ST_MapNodeHeader) + sizeof(std::pair<const K, V>));
+}
+
+}
+
+#endif // DACRS_MEMUSAGE_H_
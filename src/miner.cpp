@@ -74,6 +74,8 @@ class COrphan {
 };
 
 uint64_t g_ullLastBlockTx 	= 0;    // н׵ܱ,coinbase
+int64_t g_llLastTemplateMicros = 0;		// time taken by the last CreateNewBlock
+uint64_t g_ullLastTemplateExecuted = 0;	// transactions it had to execute
 uint64_t g_ullLastBlockSize = 0;  	//Ŀ ߴ
 
 //base on the last 50 blocks
@@ -173,15 +175,15 @@ int GetElementForBurn(CBlockIndex* pBlockIndex) {
 void GetPriorityTx(vector<TxPriority> &vPriority, int nFuelRate) {
 	vPriority.reserve(g_cTxMemPool.m_mapTx.size());
 	// Priority order to process transactions
-	list<COrphan> vOrphan; // list memory doesn't move
 	double dPriority = 0;
-	for (map<uint256, CTxMemPoolEntry>::iterator mi = g_cTxMemPool.m_mapTx.begin(); mi != g_cTxMemPool.m_mapTx.end(); ++mi) {
-		CBaseTransaction *pBaseTx = mi->second.GetTx().get();
-		if (uint256() == std::move(g_pTxCacheTip->IsContainTx(std::move(pBaseTx->GetHash())))) {
-			unsigned int unTxSize = ::GetSerializeSize(*pBaseTx, SER_NETWORK, g_sProtocolVersion);
-			double dFeePerKb = double(pBaseTx->GetFee() - pBaseTx->GetFuel(nFuelRate))/ (double(unTxSize) / 1000.0);
-			dPriority = 1000.0 / double(unTxSize);
-			vPriority.push_back(TxPriority(dPriority, dFeePerKb, mi->second.GetTx()));
+	// size and fee per KB are cached in the entries, walked from the highest fee per KB down
+	const IndexedTxSet::index<ST_FeeRateTag>::type &cByFeeRate = g_cTxMemPool.m_mapTx.get<ST_FeeRateTag>();
+	for (IndexedTxSet::index<ST_FeeRateTag>::type::const_reverse_iterator mi = cByFeeRate.rbegin();
+			mi != cByFeeRate.rend(); ++mi) {
+		if (uint256() == g_pTxCacheTip->IsContainTx(mi->GetHash())) {
+			double dFeePerKb = mi->GetFeePerKb(nFuelRate);
+			dPriority = 1000.0 / double(mi->GetTxSize());
+			vPriority.push_back(TxPriority(dPriority, dFeePerKb, mi->GetTx()));
 		}
 	}
 }
@@ -384,7 +386,8 @@ bool CreatePosTx(const CBlockIndex *pPrevIndex, CBlock *pBlock, set<CKeyID>&setC
 }
 
 bool VerifyPosTx(CAccountViewCache &cAccountViewCache, const CBlock *pBlock, CTransactionDBCache &cTxDBCache,
-		CScriptDBViewCache &cScriptDBViewCache, bool bNeedRunTx) {
+		CScriptDBViewCache &cScriptDBViewCache, bool bNeedRunTx, bool bCheckSig) {
+	CBlockPhaseTimer cTimer(EM_BLOCK_PHASE_VERIFYPOSTX);
 //	LogPrint("INFO", "VerifyPoxTx begin\n");
 	uint64_t ullMaxNonce = SysCfg().GetBlockMaxNonce(); //cacul times
 
@@ -405,7 +408,7 @@ bool VerifyPosTx(CAccountViewCache &cAccountViewCache, const CBlock *pBlock, CTr
 			return ERRORMSG("Black Account mining\n");
 		}
 		*/
-		if(!CheckSignScript(pBlock->SignatureHash(), pBlock->GetSignature(), cAccount.m_cPublicKey)) {
+		if (bCheckSig && !CheckSignScript(pBlock->SignatureHash(), pBlock->GetSignature(), cAccount.m_cPublicKey)) {
 			if (!CheckSignScript(pBlock->SignatureHash(), pBlock->GetSignature(), cAccount.m_cMinerPKey)) {
 				return ERRORMSG("Verify miner publickey signature error");
 			}
@@ -506,6 +509,136 @@ bool VerifyPosTx(CAccountViewCache &cAccountViewCache, const CBlock *pBlock, CTr
 	return true;
 }
 
+void CBlockTemplateBuilder::Reset(CBlockIndex *pIndexPrev) {
+	m_cTipHash = pIndexPrev->GetBlockHash();
+	m_nFuelRate = GetElementForBurn(pIndexPrev);
+	m_pAccountViewCache = std::make_shared<CAccountViewCache>(*g_pAccountViewTip, true);
+	m_pScriptDBViewCache = std::make_shared<CScriptDBViewCache>(*g_pScriptDBTip, true);
+	m_pTxCache = std::make_shared<CTransactionDBCache>(*g_pTxCacheTip, true);
+	m_vcTx.clear();
+	m_setSeen.clear();
+	CBlock cBlock;
+	cBlock.vptx.push_back(std::make_shared<CRewardTransaction>());
+	m_ullBlockSize = ::GetSerializeSize(cBlock, SER_NETWORK, g_sProtocolVersion);
+	m_ullTotalRunStep = 0;
+	m_llTotalFuel = 0;
+	m_llFees = 0;
+}
+
+uint64_t CBlockTemplateBuilder::Update() {
+	AssertLockHeld(g_cs_main);
+	CBlockIndex* pIndexPrev = g_cChainActive.Tip();
+	unsigned int unTransactionsUpdated = g_cTxMemPool.GetTransactionsUpdated();
+	bool bReset = !m_pAccountViewCache || m_cTipHash != pIndexPrev->GetBlockHash();
+	if (!bReset && unTransactionsUpdated == m_unTransactionsUpdated) {
+		return 0;
+	}
+	for (unsigned int i = 0; !bReset && i < m_vcTx.size(); ++i) {
+		bReset = !g_cTxMemPool.m_mapTx.count(m_vcTx[i]->GetHash());
+	}
+	if (bReset) {
+		Reset(pIndexPrev);
+	}
+	m_unTransactionsUpdated = unTransactionsUpdated;
+
+	// Largest block you're willing to create:
+	unsigned int unBlockMaxSize = SysCfg().GetArg("-blockmaxsize", DEFAULT_BLOCK_MAX_SIZE);
+	// Limit to betweeen 1K and MAX_BLOCK_SIZE-1K for sanity:
+	unBlockMaxSize = max((unsigned int) 1000, min((unsigned int) (MAX_BLOCK_SIZE - 1000), unBlockMaxSize));
+	// Minimum block size you want to create; block will be filled with free transactions
+	// until there are no more or the block reaches this size:
+	unsigned int unBlockMinSize = SysCfg().GetArg("-blockminsize", DEFAULT_BLOCK_MIN_SIZE);
+	unBlockMinSize = min(unBlockMaxSize, unBlockMinSize);
+
+	// Transactions not tried yet, highest fee per KB first
+	vector<TxPriority> vecPriority;
+	const IndexedTxSet::index<ST_FeeRateTag>::type &cByFeeRate = g_cTxMemPool.m_mapTx.get<ST_FeeRateTag>();
+	for (IndexedTxSet::index<ST_FeeRateTag>::type::const_reverse_iterator mi = cByFeeRate.rbegin();
+			mi != cByFeeRate.rend(); ++mi) {
+		if (!m_setSeen.count(mi->GetHash())) {
+			vecPriority.push_back(
+					TxPriority(1000.0 / double(mi->GetTxSize()), mi->GetFeePerKb(m_nFuelRate), mi->GetTx()));
+		}
+	}
+	TxPriorityCompare cTxPriorityComparer(true);
+	stable_sort(vecPriority.begin(), vecPriority.end(), [&](const TxPriority &cA, const TxPriority &cB) {
+		return cTxPriorityComparer(cB, cA);
+	});
+
+	uint64_t ullExecuted = 0;
+	for (const auto &item : vecPriority) {
+		double dFeePerKb = item.get<1>();
+		shared_ptr<CBaseTransaction> stx = item.get<2>();
+		CBaseTransaction *pBaseTx = stx.get();
+		// whatever is left out now stays out until the list starts over, the block only fills up
+		m_setSeen.insert(pBaseTx->GetHash());
+
+		// Size limits
+		unsigned int nTxSize = ::GetSerializeSize(*pBaseTx, SER_NETWORK, g_sProtocolVersion);
+		if (m_ullBlockSize + nTxSize >= unBlockMaxSize) {
+			continue;
+		}
+		// Skip free transactions if we're past the minimum block size:
+		if ((dFeePerKb < CTransaction::m_sMinRelayTxFee) && (m_ullBlockSize + nTxSize >= unBlockMinSize)) {
+			continue;
+		}
+		if (uint256() != m_pTxCache->IsContainTx(pBaseTx->GetHash())) {
+			LogPrint("INFO", "CreatePosTx duplicate tx\n");
+			continue;
+		}
+		CTxUndo cTxUndo;
+		CValidationState cState;
+		if (pBaseTx->IsCoinBase()) {
+			ERRORMSG("TX type is coin base tx error......");
+		}
+		if (EM_CONTRACT_TX == pBaseTx->m_chTxType) {
+			LogPrint("vm", "tx hash=%s CreateNewBlock run contract\n", pBaseTx->GetHash().GetHex());
+		}
+		CAccountViewCache cViewTemp(*m_pAccountViewCache, true);
+		CScriptDBViewCache scriptCacheTemp(*m_pScriptDBViewCache, true);
+		pBaseTx->m_nFuelRate = m_nFuelRate;
+		++ullExecuted;
+		if (!pBaseTx->ExecuteTx(m_vcTx.size() + 1, cViewTemp, cState, cTxUndo, pIndexPrev->m_nHeight + 1, *m_pTxCache,
+				scriptCacheTemp)) {
+			continue;
+		}
+		// Run step limits
+		if (m_ullTotalRunStep + pBaseTx->m_ullRunStep >= MAX_BLOCK_RUN_STEP) {
+			continue;
+		}
+
+		assert(cViewTemp.Flush());
+		assert(scriptCacheTemp.Flush());
+		m_llFees += pBaseTx->GetFee();
+		m_ullBlockSize += stx->GetSerializeSize(SER_NETWORK, g_sProtocolVersion);
+		m_ullTotalRunStep += pBaseTx->m_ullRunStep;
+		m_llTotalFuel += pBaseTx->GetFuel(m_nFuelRate);
+		m_vcTx.push_back(stx);
+		LogPrint("fuel", "miner total fuel:%d, tx fuel:%d runStep:%d fuelRate:%d txhash:%s\n", m_llTotalFuel,
+				pBaseTx->GetFuel(m_nFuelRate), pBaseTx->m_ullRunStep, m_nFuelRate, pBaseTx->GetHash().GetHex());
+	}
+
+	return ullExecuted;
+}
+
+void CBlockTemplateBuilder::Fill(CBlock *pBlock, CAccountViewCache &cAccountViewCache,
+		CScriptDBViewCache &cScriptCache) const {
+	pBlock->SetFuelRate(m_nFuelRate);
+	pBlock->vptx.insert(pBlock->vptx.end(), m_vcTx.begin(), m_vcTx.end());
+	for (const auto &item : m_pAccountViewCache->m_mapCacheAccounts) {
+		cAccountViewCache.SetCacheAccount(item.first, item.second);
+	}
+	for (const auto &item : m_pAccountViewCache->m_mapCacheKeyIds) {
+		cAccountViewCache.SetCacheKeyId(item.first, item.second);
+	}
+	for (const auto &item : m_pScriptDBViewCache->m_mapDatas) {
+		cScriptCache.SetCacheData(item.first, item.second);
+	}
+}
+
+// guarded by g_cs_main
+static CBlockTemplateBuilder g_cBlockTemplateBuilder;
+
 ST_BlockTemplate* CreateNewBlock(CAccountViewCache &cAccViewCache, CTransactionDBCache &cTxCache,
 		CScriptDBViewCache &cScriptCache) {
 	// Create new block
@@ -523,106 +656,18 @@ ST_BlockTemplate* CreateNewBlock(CAccountViewCache &cAccViewCache, CTransactionD
 	pblocktemplate->vTxFees.push_back(-1); // updated at end
 	pblocktemplate->vTxSigOps.push_back(-1); // updated at end
 
-	// Largest block you're willing to create:
-	unsigned int unBlockMaxSize = SysCfg().GetArg("-blockmaxsize", DEFAULT_BLOCK_MAX_SIZE);
-	// Limit to betweeen 1K and MAX_BLOCK_SIZE-1K for sanity:
-	unBlockMaxSize = max((unsigned int) 1000, min((unsigned int) (MAX_BLOCK_SIZE - 1000), unBlockMaxSize));
-
-	// How much of the block should be dedicated to high-priority transactions,
-	// included regardless of the fees they pay
-	unsigned int unBlockPrioritySize = SysCfg().GetArg("-blockprioritysize", DEFAULT_BLOCK_PRIORITY_SIZE);
-	unBlockPrioritySize = min(unBlockMaxSize, unBlockPrioritySize);
-
-	// Minimum block size you want to create; block will be filled with free transactions
-	// until there are no more or the block reaches this size:
-	unsigned int unBlockMinSize = SysCfg().GetArg("-blockminsize", DEFAULT_BLOCK_MIN_SIZE);
-	unBlockMinSize = min(unBlockMaxSize, unBlockMinSize);
-
 	// Collect memory pool transactions into the block
-	int64_t llFees = 0;
 	{
 		LOCK2(g_cs_main, g_cTxMemPool.m_cs);
+		int64_t llStart = GetTimeMicros();
 		CBlockIndex* pIndexPrev = g_cChainActive.Tip();
-		pBlock->SetFuelRate(GetElementForBurn(pIndexPrev));
-
-		// This vector will be sorted into a priority queue:
-		vector<TxPriority> vecPriority;
-		GetPriorityTx(vecPriority, pBlock->GetFuelRate());
+		uint64_t ullExecuted = g_cBlockTemplateBuilder.Update();
+		g_cBlockTemplateBuilder.Fill(pBlock, cAccViewCache, cScriptCache);
+		int64_t llFees = g_cBlockTemplateBuilder.GetFees();
+		int64_t llTotalFuel = g_cBlockTemplateBuilder.GetTotalFuel();
+		uint64_t ullBlockSize = g_cBlockTemplateBuilder.GetBlockSize();
 
-		// Collect transactions into block
-		uint64_t ullBlockSize = ::GetSerializeSize(*pBlock, SER_NETWORK, g_sProtocolVersion);
-		uint64_t ullBlockTx(0);
-		bool bSortedByFee(true);
-		uint64_t ullTotalRunStep(0);
-		int64_t llTotalFuel(0);
-		TxPriorityCompare cTxPriorityComparer(bSortedByFee);
-		make_heap(vecPriority.begin(), vecPriority.end(), cTxPriorityComparer);
-
-		while (!vecPriority.empty()) {
-			// Take highest priority transaction off the priority queue:
-			double dPriority = vecPriority.front().get<0>();
-			double dFeePerKb = vecPriority.front().get<1>();
-			shared_ptr<CBaseTransaction> stx = vecPriority.front().get<2>();
-			CBaseTransaction *pBaseTx = stx.get();
-			//const CTransaction& tx = *(vecPriority.front().get<2>());
-
-			pop_heap(vecPriority.begin(), vecPriority.end(), cTxPriorityComparer);
-			vecPriority.pop_back();
-
-			// Size limits
-			unsigned int nTxSize = ::GetSerializeSize(*pBaseTx, SER_NETWORK, g_sProtocolVersion);
-			if (ullBlockSize + nTxSize >= unBlockMaxSize) {
-				continue;
-			}
-			// Skip free transactions if we're past the minimum block size:
-			if (bSortedByFee && (dFeePerKb < CTransaction::m_sMinRelayTxFee) && (ullBlockSize + nTxSize >= unBlockMinSize)) {
-				continue;
-			}
-			// Prioritize by fee once past the priority size or we run out of high-priority
-			// transactions:
-			if (!bSortedByFee && ((ullBlockSize + nTxSize >= unBlockPrioritySize) || !AllowFree(dPriority))) {
-				bSortedByFee = true;
-				cTxPriorityComparer = TxPriorityCompare(bSortedByFee);
-				make_heap(vecPriority.begin(), vecPriority.end(), cTxPriorityComparer);
-			}
-			if (uint256() != std::move(cTxCache.IsContainTx(std::move(pBaseTx->GetHash())))) {
-				LogPrint("INFO", "CreatePosTx duplicate tx\n");
-				continue;
-			}
-			CTxUndo cTxUndo;
-			CValidationState cState;
-			if (pBaseTx->IsCoinBase()) {
-				ERRORMSG("TX type is coin base tx error......");
-			}
-			if (EM_CONTRACT_TX == pBaseTx->m_chTxType) {
-				LogPrint("vm", "tx hash=%s CreateNewBlock run contract\n", pBaseTx->GetHash().GetHex());
-			}
-			CAccountViewCache cViewTemp(cAccViewCache, true);
-			CScriptDBViewCache scriptCacheTemp(cScriptCache, true);
-			pBaseTx->m_nFuelRate = pBlock->GetFuelRate();
-			if (!pBaseTx->ExecuteTx(ullBlockTx + 1, cViewTemp, cState, cTxUndo, pIndexPrev->m_nHeight + 1, cTxCache,
-					scriptCacheTemp)) {
-				continue;
-			}
-			// Run step limits
-			if (ullTotalRunStep + pBaseTx->m_ullRunStep >= MAX_BLOCK_RUN_STEP) {
-				continue;
-			}
-
-			assert(cViewTemp.Flush());
-			assert(scriptCacheTemp.Flush());
-			llFees += pBaseTx->GetFee();
-			ullBlockSize += stx->GetSerializeSize(SER_NETWORK, g_sProtocolVersion);
-			ullTotalRunStep += pBaseTx->m_ullRunStep;
-			llTotalFuel += pBaseTx->GetFuel(pBlock->GetFuelRate());
-			ullBlockTx++;
-			pBlock->vptx.push_back(stx);
-			LogPrint("fuel", "miner total fuel:%d, tx fuel:%d runStep:%d fuelRate:%d txhash:%s\n", llTotalFuel,
-					pBaseTx->GetFuel(pBlock->GetFuelRate()), pBaseTx->m_ullRunStep, pBlock->GetFuelRate(),
-					pBaseTx->GetHash().GetHex());
-		}
-
-		g_ullLastBlockTx = ullBlockTx;
+		g_ullLastBlockTx = g_cBlockTemplateBuilder.GetTxCount();
 		g_ullLastBlockSize = ullBlockSize;
 		LogPrint("INFO", "CreateNewBlock(): total size %u\n", ullBlockSize);
 
@@ -636,6 +681,11 @@ ST_BlockTemplate* CreateNewBlock(CAccountViewCache &cAccViewCache, CTransactionD
 		pBlock->SetNonce(0);
 		pBlock->SetHeight(pIndexPrev->m_nHeight + 1);
 		pBlock->SetFuel(llTotalFuel);
+
+		g_llLastTemplateMicros = GetTimeMicros() - llStart;
+		g_ullLastTemplateExecuted = ullExecuted;
+		LogPrint("MINER", "CreateNewBlock(): %u tx, %u executed, %d us\n", g_ullLastBlockTx, ullExecuted,
+				g_llLastTemplateMicros);
 	}
 
 	return pblocktemplate.release();
@@ -51,6 +51,65 @@ class TxPriorityCompare {
 	bool m_bByFee;
 };
 
+/**
+ * Transactions of the next block executed ahead of time, in the order they get mined, on caches
+ * over the tip. The list follows the tip and the memory pool: a new tip or a listed transaction
+ * leaving the pool starts it over from the pool's fee order, transactions entering the pool are
+ * executed and appended on top of the state already built. A template is then a copy of the list
+ * and of the state it left behind.
+ */
+class CBlockTemplateBuilder {
+ public:
+	CBlockTemplateBuilder() :
+			m_unTransactionsUpdated(0), m_nFuelRate(0), m_ullBlockSize(0), m_ullTotalRunStep(0), m_llTotalFuel(0),
+			m_llFees(0) {
+	}
+
+	/**
+	 * @brief Bring the list up to date, g_cs_main and g_cTxMemPool.m_cs must be held
+	 * @return number of transactions executed
+	 */
+	uint64_t Update();
+
+	/**
+	 * @brief Append the listed transactions to pBlock and copy their state
+	 * @param cAccountViewCache, cScriptCache empty caches directly over the tip views
+	 */
+	void Fill(CBlock *pBlock, CAccountViewCache &cAccountViewCache, CScriptDBViewCache &cScriptCache) const;
+
+	int GetFuelRate() const {
+		return m_nFuelRate;
+	}
+	uint64_t GetBlockSize() const {
+		return m_ullBlockSize;
+	}
+	int64_t GetTotalFuel() const {
+		return m_llTotalFuel;
+	}
+	int64_t GetFees() const {
+		return m_llFees;
+	}
+	uint64_t GetTxCount() const {
+		return m_vcTx.size();
+	}
+
+ private:
+	void Reset(CBlockIndex *pIndexPrev);
+
+	uint256 m_cTipHash;
+	unsigned int m_unTransactionsUpdated;
+	int m_nFuelRate;
+	std::shared_ptr<CAccountViewCache> m_pAccountViewCache;
+	std::shared_ptr<CScriptDBViewCache> m_pScriptDBViewCache;
+	std::shared_ptr<CTransactionDBCache> m_pTxCache;
+	std::vector<std::shared_ptr<CBaseTransaction> > m_vcTx;
+	std::set<uint256> m_setSeen;			// listed, or left out on the state built so far
+	uint64_t m_ullBlockSize;
+	uint64_t m_ullTotalRunStep;
+	int64_t m_llTotalFuel;
+	int64_t m_llFees;
+};
+
 /** Run the miner threads */
 void GenerateDacrsBlock(bool bGenerate, CWallet* pWallet, int nThreads);
 
@@ -69,7 +128,7 @@ bool CreatePosTx(const CBlockIndex *pPrevIndex, CBlock *pBlock, set<CKeyID>&setC
 		CTransactionDBCache &cTxCache, CScriptDBViewCache &cScriptCache);
 
 bool VerifyPosTx(CAccountViewCache &cAccountViewCache, const CBlock *pBlock, CTransactionDBCache &cTxDBCache,
-		CScriptDBViewCache &cScriptDBViewCache, bool bNeedRunTx = false);
+		CScriptDBViewCache &cScriptDBViewCache, bool bNeedRunTx = false, bool bCheckSig = true);
 
 /** Check mined block */
 bool CheckWork(CBlock* pBlock, CWallet& cWallet);
@@ -6,6 +6,5 @@
 #define DACRS_NOUI_H_
 
 extern void noui_connect();
-extern void ThreadSendMessageToUI();
 
 #endif
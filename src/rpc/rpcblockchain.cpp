@@ -7,6 +7,9 @@
 #include "main.h"
 #include "sync.h"
 #include "checkpoints.h"
+#include "txdb.h"
+#include "snapshot.h"
+#include "vm/vmprofiler.h"
 #include <stdint.h>
 
 #include "json/json_spirit_value.h"
@@ -41,12 +44,31 @@ double GetDifficulty(const CBlockIndex* pcBlockIndex) {
 	return dDiff;
 }
 
-Object blockToJSON(const CBlock& cBlock, const CBlockIndex* cBlockIndex) {
+std::shared_ptr<CChainStateSnapshot> EnsureChainStateSnapshot() {
+	std::shared_ptr<CChainStateSnapshot> pSnapshot = GetChainStateSnapshot();
+	if (!pSnapshot) {
+		throw JSONRPCError(RPC_DATABASE_ERROR, "Chain state is not loaded yet");
+	}
+	return pSnapshot;
+}
+
+Object blockToJSON(const CBlock& cBlock, const CBlockIndex* cBlockIndex, const CChainStateSnapshot &cSnapshot) {
 	Object result;
 	result.push_back(Pair("hash", cBlock.GetHash().GetHex()));
-	CMerkleTx cTxGen(cBlock.vptx[0]);
-	cTxGen.SetMerkleBranch(&cBlock);
-	result.push_back(Pair("confirmations", (int) cTxGen.GetDepthInMainChain()));
+	int nConfirmations = -1;
+	const CBlockIndex *pNextBlock = NULL;
+	if (cSnapshot.Contains(cBlockIndex)) {
+		nConfirmations = cSnapshot.Height() - cBlockIndex->m_nHeight + 1;
+		pNextBlock = cSnapshot.Next(cBlockIndex);
+	} else {
+		// side chain or past the snapshot's tip, ask the live chain
+		LOCK(g_cs_main);
+		if (g_cChainActive.Contains(cBlockIndex)) {
+			nConfirmations = g_cChainActive.Height() - cBlockIndex->m_nHeight + 1;
+			pNextBlock = g_cChainActive.Next(cBlockIndex);
+		}
+	}
+	result.push_back(Pair("confirmations", nConfirmations));
 	result.push_back(Pair("size", (int) ::GetSerializeSize(cBlock, SER_NETWORK, g_sProtocolVersion)));
 	result.push_back(Pair("height", cBlockIndex->m_nHeight));
 	result.push_back(Pair("version", cBlock.GetVersion()));
@@ -67,7 +89,6 @@ Object blockToJSON(const CBlock& cBlock, const CBlockIndex* cBlockIndex) {
 	if (cBlockIndex->m_pPrevBlockIndex) {
 		result.push_back(Pair("previousblockhash", cBlockIndex->m_pPrevBlockIndex->GetBlockHash().GetHex()));
 	}
-	CBlockIndex *pNextBlock = g_cChainActive.Next(cBlockIndex);
 	if (pNextBlock) {
 		result.push_back(Pair("nextblockhash", pNextBlock->GetBlockHash().GetHex()));
 	}
@@ -150,7 +171,8 @@ Value getrawmempool(const Array& params, bool bHelp) {
 						"    \"height\" : n,           (numeric) block height when transaction entered pool\n"
 						"    \"startingpriority\" : n, (numeric) priority when transaction entered pool\n"
 						"    \"currentpriority\" : n,  (numeric) transaction priority now\n"
-						"    \"depends\" : [           (array) unconfirmed transactions used as inputs for this transaction\n"
+						"    \"feeperkb\" : n,         (numeric) fee net of fuel per KB at the next block's fuel rate\n"
+						"    \"depends\" : [           (array) earlier unconfirmed transactions paid by the same account\n"
 						"        \"transactionid\",    (string) parent transaction id\n"
 						"       ... ]\n"
 						"  }, ...\n"
@@ -167,9 +189,9 @@ Value getrawmempool(const Array& params, bool bHelp) {
 	if (bFVerbose) {
 		LOCK(g_cTxMemPool.m_cs);
 		Object obj;
-		for (const auto& entry : g_cTxMemPool.m_mapTx) {
-			const uint256& cHash = entry.first;
-			const CTxMemPoolEntry& cTxMemPoolEntry = entry.second;
+		const IndexedTxSet::index<ST_SourceTag>::type &cBySource = g_cTxMemPool.m_mapTx.get<ST_SourceTag>();
+		for (const auto& cTxMemPoolEntry : g_cTxMemPool.m_mapTx) {
+			const uint256 cHash = cTxMemPoolEntry.GetHash();
 			Object info;
 			info.push_back(Pair("size", (int) cTxMemPoolEntry.GetTxSize()));
 			info.push_back(Pair("fee", ValueFromAmount(cTxMemPoolEntry.GetFee())));
@@ -177,13 +199,17 @@ Value getrawmempool(const Array& params, bool bHelp) {
 			info.push_back(Pair("height", (int) cTxMemPoolEntry.GetHeight()));
 			info.push_back(Pair("startingpriority", cTxMemPoolEntry.GetPriority(cTxMemPoolEntry.GetHeight())));
 			info.push_back(Pair("currentpriority", cTxMemPoolEntry.GetPriority(g_cChainActive.Height())));
-			// const CTransaction& tx = e.GetTx();
+			info.push_back(Pair("feeperkb", ValueFromAmount((int64_t) cTxMemPoolEntry.GetFeePerKb())));
+			// transactions from the same account entered before this one were executed ahead of it
 			set<string> setDepends;
-			// BOOST_FOREACH(const CTxIn& txin, tx.vin)
-			// {
-			//     if (g_cTxMemPool.exists(txin.prevout.hash))
-			//     setDepends.insert(txin.prevout.hash.ToString());
-			// }
+			if (!cTxMemPoolEntry.GetSourceKeyId().IsNull()) {
+				auto range = cBySource.equal_range(cTxMemPoolEntry.GetSourceKeyId());
+				for (auto iterSource = range.first; iterSource != range.second; ++iterSource) {
+					if (iterSource->GetTime() < cTxMemPoolEntry.GetTime()) {
+						setDepends.insert(iterSource->GetHash().ToString());
+					}
+				}
+			}
 			Array depends(setDepends.begin(), setDepends.end());
 			info.push_back(Pair("depends", depends));
 			obj.push_back(Pair(cHash.ToString(), info));
@@ -269,31 +295,50 @@ Value getblock(const Array& params, bool bHelp) {
 						+ HelpExampleRpc("getblock",
 								"\"00000000c937983704a73af28acdec37b049d214adbda81d7e2a3dd146f6ed09\""));
 
-	std::string strHash;
+	std::shared_ptr<CChainStateSnapshot> pSnapshot = EnsureChainStateSnapshot();
+	CBlockIndex* pcBlockIndex = NULL;
 	if (int_type == params[0].type()) {
 		int nHeight = params[0].get_int();
-		if (nHeight < 0 || nHeight > g_cChainActive.Height()) {
+		if (nHeight <= pSnapshot->Height()) {
+			pcBlockIndex = (*pSnapshot)[nHeight];
+		} else {
+			// the snapshot trails the tip while the chain state is not flushed every block
+			LOCK(g_cs_main);
+			pcBlockIndex = g_cChainActive[nHeight];
+		}
+		if (pcBlockIndex == NULL) {
 			throw runtime_error("Block number out of range.");
 		}
-
-		CBlockIndex* pcBlockIndex = g_cChainActive[nHeight];
-		strHash = pcBlockIndex->GetBlockHash().GetHex();
 	} else {
-		strHash = params[0].get_str();
+		uint256 cHash(uint256S(params[0].get_str()));
+		// blocks on the snapshot's chain are found through the block tree db, which is safe to read concurrently
+		CDiskBlockIndex cDiskBlockIndex;
+		if (g_pblocktree->ReadBlockIndex(cHash, cDiskBlockIndex)) {
+			CBlockIndex* pIndex = (*pSnapshot)[cDiskBlockIndex.m_nHeight];
+			if (pIndex && pIndex->GetBlockHash() == cHash) {
+				pcBlockIndex = pIndex;
+			}
+		}
+		if (pcBlockIndex == NULL) {
+			// side chains and blocks newer than the snapshot
+			LOCK(g_cs_main);
+			map<uint256, CBlockIndex*>::iterator it = g_mapBlockIndex.find(cHash);
+			if (it == g_mapBlockIndex.end()) {
+				throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+			}
+			pcBlockIndex = it->second;
+		}
 	}
-	uint256 cHash(uint256S(strHash));
 
 	bool bFVerbose = true;
 	if (params.size() > 1) {
 		bFVerbose = params[1].get_bool();
 	}
-	if (g_mapBlockIndex.count(cHash) == 0) {
-		throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
-	}
 
 	CBlock cBlock;
-	CBlockIndex* pcBlockIndex = g_mapBlockIndex[cHash];
-	ReadBlockFromDisk(cBlock, pcBlockIndex);
+	if (!ReadBlockFromDisk(cBlock, pcBlockIndex)) {
+		throw JSONRPCError(RPC_DATABASE_ERROR, "Can't read block from disk");
+	}
 
 	if (!bFVerbose) {
 		CDataStream cBlock(SER_NETWORK, g_sProtocolVersion);
@@ -302,7 +347,7 @@ Value getblock(const Array& params, bool bHelp) {
 		return strHex;
 	}
 
-	return blockToJSON(cBlock, pcBlockIndex);
+	return blockToJSON(cBlock, pcBlockIndex, *pSnapshot);
 }
 /**
  * ֤ݿ
@@ -352,7 +397,12 @@ Value getblockchaininfo(const Array& params, bool bHelp) {
 				"  \"bestblockhash\": \"...\", (string) the hash of the currently best block\n"
 				"  \"difficulty\": xxxxxx,     (numeric) the current difficulty\n"
 				"  \"verificationprogress\": xxxx, (numeric) estimate of verification progress [0..1]\n"
-				"  \"chainwork\": \"xxxx\"     (string) total amount of work in active chain, in hexadecimal\n"
+				"  \"chainwork\": \"xxxx\",    (string) total amount of work in active chain, in hexadecimal\n"
+				"  \"assumevalid\": \"...\",   (string) block whose ancestors are connected without signature checks, empty if none\n"
+				"  \"assumevalidheight\": n,  (numeric) its height, -1 while neither indexed nor a checkpoint\n"
+				"  \"assumevalidactive\": true|false, (boolean) whether the tip was connected without signature checks\n"
+				"  \"pruned\": true|false,    (boolean) whether old block files have been deleted by -prune\n"
+				"  \"prunetarget\": n,        (numeric) the -prune target in MiB, 0 when pruning is off\n"
 				"}\n"
 				"\nExamples:\n" + HelpExampleCli("getblockchaininfo", "") + HelpExampleRpc("getblockchaininfo", ""));
 	}
@@ -371,6 +421,246 @@ Value getblockchaininfo(const Array& params, bool bHelp) {
 	obj.push_back(Pair("difficulty", (double) GetDifficulty()));
 	obj.push_back(Pair("verificationprogress", Checkpoints::GuessVerificationProgress(g_cChainActive.Tip())));
 	obj.push_back(Pair("chainwork", g_cChainActive.Tip()->m_cChainWork.GetHex()));
+	{
+		LOCK(g_cs_main);
+		int nAssumeValidHeight = -1;
+		uint256 cAssumeValid = GetAssumeValidBlock(nAssumeValidHeight);
+		obj.push_back(Pair("assumevalid", cAssumeValid.IsNull() ? string("") : cAssumeValid.GetHex()));
+		obj.push_back(Pair("assumevalidheight", nAssumeValidHeight));
+		obj.push_back(Pair("assumevalidactive", IsAssumedValid(g_cChainActive.Tip())));
+		obj.push_back(Pair("pruned", g_bHavePruned));
+		obj.push_back(Pair("prunetarget", (int64_t) (g_ullPruneTarget / 1024 / 1024)));
+	}
+	return obj;
+}
+
+Value getvalidationstats(const Array& params, bool bHelp) {
+	if (bHelp || params.size() > 1) {
+		throw runtime_error("getvalidationstats ( reset )\n"
+				"Returns the time spent in each phase of block validation since startup or the last reset.\n"
+				"\nArguments:\n"
+				"1. reset    (boolean, optional, default=false) clear the counters after reading them\n"
+				"\nResult:\n"
+				"{\n"
+				"  \"phase\": {           (json object) one per phase, e.g. checkblock, execute_contract, vm_lua, flush\n"
+				"    \"calls\": n,        (numeric) times the phase ran\n"
+				"    \"total_ms\": n,     (numeric) total time\n"
+				"    \"avg_us\": n,       (numeric) mean time per call\n"
+				"    \"max_us\": n,       (numeric) longest call\n"
+				"    \"histogram\": {     (json object) calls by duration, only non-empty buckets\n"
+				"      \"<1024us\": n,    (numeric) calls shorter than 1024 microseconds and not in a smaller bucket\n"
+				"      ...\n"
+				"    }\n"
+				"  },\n"
+				"  ...\n"
+				"}\n"
+				"\nExamples:\n" + HelpExampleCli("getvalidationstats", "") + HelpExampleCli("getvalidationstats", "true")
+				+ HelpExampleRpc("getvalidationstats", ""));
+	}
+
+	Object obj;
+	for (int i = 0; i < EM_BLOCK_PHASE_MAX; ++i) {
+		const ST_BlockPhaseStats &tStats = g_arrtBlockPhaseStats[i];
+		uint64_t ullCalls = tStats.ullCalls;
+		int64_t llMicros = tStats.llMicros;
+		Object objHistogram;
+		for (int j = 0; j < BLOCK_PHASE_BUCKETS; ++j) {
+			uint64_t ullCount = tStats.arrullBuckets[j];
+			if (ullCount == 0) {
+				continue;
+			}
+			string strBucket = j < BLOCK_PHASE_BUCKETS - 1 ? strprintf("<%dus", 1LL << j)
+					: strprintf(">=%dus", 1LL << (j - 1));
+			objHistogram.push_back(Pair(strBucket, (int64_t) ullCount));
+		}
+		Object objPhase;
+		objPhase.push_back(Pair("calls", (int64_t) ullCalls));
+		objPhase.push_back(Pair("total_ms", llMicros / 1000.0));
+		objPhase.push_back(Pair("avg_us", ullCalls > 0 ? (double) llMicros / ullCalls : 0.0));
+		objPhase.push_back(Pair("max_us", (int64_t) tStats.llMaxMicros));
+		objPhase.push_back(Pair("histogram", objHistogram));
+		obj.push_back(Pair(GetBlockPhaseName((emBlockPhase) i), objPhase));
+	}
+	if (params.size() > 0 && params[0].get_bool()) {
+		ResetBlockPhaseTimes();
+	}
+	return obj;
+}
+
+static Object HostCallStatsToJson(const ST_VmHostCallStats &tStats) {
+	Object obj;
+	obj.push_back(Pair("calls", (int64_t) tStats.ullCalls));
+	obj.push_back(Pair("total_us", tStats.llMicros));
+	obj.push_back(Pair("avg_us", tStats.ullCalls > 0 ? (double) tStats.llMicros / tStats.ullCalls : 0.0));
+	obj.push_back(Pair("max_us", tStats.llMaxMicros));
+	return obj;
+}
+
+Value getcontractprofile(const Array& params, bool bHelp) {
+	if (bHelp || params.size() > 2) {
+		throw runtime_error("getcontractprofile ( \"appregid\" reset )\n"
+				"Returns what the 8051 and Lua apps cost since startup or the last reset, most time consuming first.\n"
+				"Only collected with -contractprofile; runs for mempool acceptance are counted as well as block runs.\n"
+				"\nArguments:\n"
+				"1. \"appregid\"  (string, optional) only this app, all apps if empty\n"
+				"2. reset       (boolean, optional, default=false) clear the profiles of all apps after reading them\n"
+				"\nResult:\n"
+				"[\n"
+				"  {\n"
+				"    \"appregid\": \"xxx\",    (string) the app\n"
+				"    \"vm\": \"8051|lua\",     (string) the app's VM\n"
+				"    \"runs\": n,            (numeric) contract calls run\n"
+				"    \"failed\": n,          (numeric) runs that failed or exceeded their steps\n"
+				"    \"steps\": n,           (numeric) steps of the successful runs\n"
+				"    \"max_steps\": n,       (numeric) most steps of one run\n"
+				"    \"total_us\": n,        (numeric) wall time in the VM\n"
+				"    \"max_us\": n,          (numeric) longest run\n"
+				"    \"db_reads\": n,        (numeric) host calls reading script data or app accounts\n"
+				"    \"db_writes\": n,       (numeric) host calls writing or erasing script data\n"
+				"    \"hostcalls\": {        (json object) by method name\n"
+				"      \"name\": { \"calls\": n, \"total_us\": n, \"avg_us\": n, \"max_us\": n }, ...\n"
+				"    }\n"
+				"  }, ...\n"
+				"]\n"
+				"\nExamples:\n" + HelpExampleCli("getcontractprofile", "") + HelpExampleCli("getcontractprofile", "\"1826-1\"")
+				+ HelpExampleCli("getcontractprofile", "\"\" true") + HelpExampleRpc("getcontractprofile", "\"1826-1\""));
+	}
+	vector<unsigned char> vchFilter;
+	if (params.size() > 0 && !params[0].get_str().empty()) {
+		if (!CRegID::IsRegIdStr(params[0].get_str())) {
+			throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid app regid");
+		}
+		vchFilter = CRegID(params[0].get_str()).GetVec6();
+	}
+
+	map<vector<unsigned char>, ST_VmScriptProfile> mapProfiles = g_cVmProfiler.GetProfiles();
+	vector<pair<int64_t, vector<unsigned char> > > vOrder;
+	for (const auto &item : mapProfiles) {
+		if (vchFilter.empty() || vchFilter == item.first) {
+			vOrder.push_back(make_pair(item.second.llMicros, item.first));
+		}
+	}
+	sort(vOrder.rbegin(), vOrder.rend());
+
+	Array arrRet;
+	for (const auto &item : vOrder) {
+		const ST_VmScriptProfile &tProfile = mapProfiles[item.second];
+		Object objHostCalls;
+		for (const auto &call : tProfile.mapHostCalls) {
+			objHostCalls.push_back(Pair(call.first, HostCallStatsToJson(call.second)));
+		}
+		Object obj;
+		obj.push_back(Pair("appregid", CRegID(item.second).ToString()));
+		obj.push_back(Pair("vm", 0 == tProfile.nScriptType ? "8051" : "lua"));
+		obj.push_back(Pair("runs", (int64_t) tProfile.ullRuns));
+		obj.push_back(Pair("failed", (int64_t) tProfile.ullFailed));
+		obj.push_back(Pair("steps", (int64_t) tProfile.ullSteps));
+		obj.push_back(Pair("max_steps", (int64_t) tProfile.ullMaxSteps));
+		obj.push_back(Pair("total_us", tProfile.llMicros));
+		obj.push_back(Pair("max_us", tProfile.llMaxMicros));
+		obj.push_back(Pair("db_reads", (int64_t) tProfile.ullDbReads));
+		obj.push_back(Pair("db_writes", (int64_t) tProfile.ullDbWrites));
+		obj.push_back(Pair("hostcalls", objHostCalls));
+		arrRet.push_back(obj);
+	}
+	if (params.size() > 1 && params[1].get_bool()) {
+		g_cVmProfiler.Reset();
+	}
+	return arrRet;
+}
+
+Value getscriptdbstats(const Array& params, bool bHelp) {
+	if (bHelp || params.size() != 0) {
+		throw runtime_error("getscriptdbstats\n"
+				"Returns the tuning and activity of each store of the script database since startup.\n"
+				"\nResult:\n"
+				"[\n"
+				"  {\n"
+				"    \"store\": \"name\",      (string) code, state, index or output\n"
+				"    \"block_cache_kb\": n,  (numeric) LevelDB block cache\n"
+				"    \"write_buffer_kb\": n, (numeric) LevelDB write buffer\n"
+				"    \"bloom_bits\": n,      (numeric) bloom filter bits per key, 0 for none\n"
+				"    \"compression\": b,     (boolean) whether table blocks are compressed\n"
+				"    \"reads\": n,           (numeric) point reads\n"
+				"    \"read_misses\": n,     (numeric) point reads of missing keys\n"
+				"    \"writes\": n,          (numeric) records written\n"
+				"    \"erases\": n,          (numeric) records erased\n"
+				"    \"scans\": n,           (numeric) iterators opened\n"
+				"    \"disk_bytes\": n,      (numeric) approximate size on disk\n"
+				"    \"files\": n,           (numeric) table files\n"
+				"    \"level0_files\": n     (numeric) table files waiting for compaction into level 1\n"
+				"  },\n"
+				"  ...\n"
+				"]\n"
+				"\nExamples:\n" + HelpExampleCli("getscriptdbstats", "") + HelpExampleRpc("getscriptdbstats", ""));
+	}
+
+	LOCK(g_cs_main);
+	Array arrRet;
+	for (const auto &tStats : g_pScriptDB->GetStats()) {
+		Object obj;
+		obj.push_back(Pair("store", tStats.strName));
+		obj.push_back(Pair("block_cache_kb", (int64_t) (tStats.tTuning.unBlockCacheSize >> 10)));
+		obj.push_back(Pair("write_buffer_kb", (int64_t) (tStats.tTuning.unWriteBufferSize >> 10)));
+		obj.push_back(Pair("bloom_bits", tStats.tTuning.nBloomBits));
+		obj.push_back(Pair("compression", tStats.tTuning.bCompress));
+		obj.push_back(Pair("reads", (int64_t) tStats.ullReads));
+		obj.push_back(Pair("read_misses", (int64_t) tStats.ullReadMisses));
+		obj.push_back(Pair("writes", (int64_t) tStats.ullWrites));
+		obj.push_back(Pair("erases", (int64_t) tStats.ullErases));
+		obj.push_back(Pair("scans", (int64_t) tStats.ullScans));
+		obj.push_back(Pair("disk_bytes", (int64_t) tStats.ullDiskBytes));
+		obj.push_back(Pair("files", tStats.nFiles));
+		obj.push_back(Pair("level0_files", tStats.nLevel0Files));
+		arrRet.push_back(obj);
+	}
+	return arrRet;
+}
+
+Value dumpsnapshot(const Array& params, bool bHelp) {
+	if (bHelp || params.size() != 1) {
+		throw runtime_error("dumpsnapshot \"file\"\n"
+				"Writes the block index, account, script and tx cache databases as of the tip to a state snapshot,\n"
+				"which a new node starts from with -loadsnapshot=<file> -snapshothash=<root>.\n"
+				"\nArguments:\n"
+				"1. \"file\"   (string, required) destination, relative to the data directory unless absolute\n"
+				"\nResult:\n"
+				"{\n"
+				"  \"blockhash\": \"hash\", (string) block the state is taken at\n"
+				"  \"height\": n,         (numeric) its height\n"
+				"  \"root\": \"hash\",      (string) snapshot hash, to pin with -snapshothash\n"
+				"  \"chunks\": n,         (numeric) hashed chunks written\n"
+				"  \"bytes\": n,          (numeric) file size\n"
+				"  \"records\": {         (json object) records by section: blockindex, account, script and txcache\n"
+				"    \"section\": n,\n"
+				"    ...\n"
+				"  }\n"
+				"}\n"
+				"\nExamples:\n" + HelpExampleCli("dumpsnapshot", "\"state.snapshot\"")
+				+ HelpExampleRpc("dumpsnapshot", "\"state.snapshot\""));
+	}
+
+	boost::filesystem::path path(params[0].get_str());
+	if (!path.is_complete()) {
+		path = GetDataDir() / path;
+	}
+	ST_SnapshotInfo tInfo;
+	string strError;
+	if (!ExportStateSnapshot(path, tInfo, strError)) {
+		throw JSONRPCError(RPC_MISC_ERROR, strError);
+	}
+
+	Object obj;
+	obj.push_back(Pair("blockhash", tInfo.cBlockHash.GetHex()));
+	obj.push_back(Pair("height", tInfo.nHeight));
+	obj.push_back(Pair("root", tInfo.cRoot.GetHex()));
+	obj.push_back(Pair("chunks", (int64_t) tInfo.ullChunks));
+	obj.push_back(Pair("bytes", (int64_t) tInfo.ullBytes));
+	Object objRecords;
+	for (int i = 0; i < EM_SNAPSHOT_END; ++i) {
+		objRecords.push_back(Pair(GetSnapshotSectionName((emSnapshotSection) i), (int64_t) tInfo.arrullRecords[i]));
+	}
+	obj.push_back(Pair("records", objRecords));
 	return obj;
 }
 /**
@@ -187,6 +187,9 @@ Array RPCConvertValues(const string &strMethod, const vector<string> &strParams)
     if (strMethod == "verifychain"            && n > 1) ConvertTo<int64_t>(params[1]);
     if (strMethod == "keypoolrefill"          && n > 0) ConvertTo<int64_t>(params[0]);
     if (strMethod == "getrawmempool"          && n > 0) ConvertTo<bool>(params[0]);
+    if (strMethod == "getvalidationstats"     && n > 0) ConvertTo<bool>(params[0]);
+    if (strMethod == "getcontractprofile"     && n > 1) ConvertTo<bool>(params[1]);
+    if (strMethod == "gettxoperationlogs"     && n > 0) ConvertTo<Array>(params[0]);
     if (strMethod == "getalltxinfo"          && n > 0) ConvertTo<int>(params[0]);
     if (strMethod == "getnewaddress"       && n > 0) ConvertTo<bool>(params[0]);
     if (strMethod == "registaccounttx"          && n > 1) ConvertTo<int64_t>(params[1]);
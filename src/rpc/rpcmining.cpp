@@ -211,6 +211,8 @@ Value getmininginfo(const Array& params, bool bHelp) {
 						"  \"genproclimit\": n          (numeric) The processor limit for generation. -1 if no generation. (see getgenerate or setgenerate calls)\n"
 						"  \"hashespersec\": n          (numeric) The hashes per second of the generation, or 0 if no generation.\n"
 						"  \"pooledtx\": n              (numeric) The size of the mem pool\n"
+						"  \"templatelatency\": n       (numeric) Microseconds taken to create the last block template\n"
+						"  \"templateexecuted\": n      (numeric) Transactions executed for the last block template, the rest were reused\n"
 						"  \"testnet\": true|false      (boolean) If using testnet or not\n"
 						"}\n"
 						"\nExamples:\n" + HelpExampleCli("getmininginfo", "") + HelpExampleRpc("getmininginfo", ""));
@@ -224,6 +226,8 @@ Value getmininginfo(const Array& params, bool bHelp) {
 	obj.push_back(Pair("genproclimit", 1));
 	obj.push_back(Pair("networkhashps", getnetworkhashps(params, false)));
 	obj.push_back(Pair("pooledtx", (uint64_t) g_cTxMemPool.size()));
+	obj.push_back(Pair("templatelatency", g_llLastTemplateMicros));
+	obj.push_back(Pair("templateexecuted", g_ullLastTemplateExecuted));
 	static const string name[] = { "MAIN", "TESTNET", "REGTEST" };
 	obj.push_back(Pair("nettype", name[SysCfg().NetworkID()]));
 	obj.push_back(Pair("posmaxnonce", SysCfg().GetBlockMaxNonce()));
@@ -66,12 +66,8 @@ Value getbalance(const Array& params, bool bHelp) {
 				throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid  address");
 			}
 			if (g_pwalletMain->HaveKey(ckeyid)) {
-				CAccount cAccount;
-				CAccountViewCache cAccView(*g_pAccountViewTip, true);
-				if (cAccView.GetAccount(CUserID(ckeyid), cAccount)) {
-					obj.push_back(Pair("balance", ValueFromAmount(cAccount.GetRawBalance())));
-					return std::move(obj);
-				}
+				obj.push_back(Pair("balance", ValueFromAmount(g_pwalletMain->GetRawBalance(ckeyid))));
+				return std::move(obj);
 			} else {
 				throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "address not inwallet");
 			}
@@ -85,6 +81,7 @@ Value getbalance(const Array& params, bool bHelp) {
 		}
 		if (strAddr == "*") {
 			if (0 != nConf) {
+				LOCK2(g_cs_main, g_pwalletMain->m_cs_wallet);
 				CBlockIndex *pBlockIndex = g_cChainActive.Tip();
 				int64_t llValue(0);
 				while (nConf) {
@@ -119,6 +116,7 @@ Value getbalance(const Array& params, bool bHelp) {
 			}
 			if (g_pwalletMain->HaveKey(cKeyID)) {
 				if (0 != nConf) {
+					LOCK2(g_cs_main, g_pwalletMain->m_cs_wallet);
 					CBlockIndex *pBlockIndex = g_cChainActive.Tip();
 					int64_t llValue(0);
 					while (nConf) {
@@ -142,7 +140,7 @@ Value getbalance(const Array& params, bool bHelp) {
 					obj.push_back(Pair("balance", ValueFromAmount(g_pAccountViewTip->GetRawBalance(cKeyID) - llValue)));
 					return std::move(obj);
 				} else {
-					obj.push_back(Pair("balance", ValueFromAmount(g_cTxMemPool.m_pAccountViewCache->GetRawBalance(cKeyID))));
+					obj.push_back(Pair("balance", ValueFromAmount(g_pwalletMain->GetRawBalance(cKeyID, false))));
 					return std::move(obj);
 				}
 			} else {
@@ -188,6 +186,8 @@ Value getinfo(const Array& params, bool bHelp) {
         	"  \"fuel\": xxxxx,              (numeric) the  fuel of the tip block in g_cChainActive\n"
         	"  \"data directory\": xxxxx,    (string) the data directory\n"
 			"  \"tip block hash\": xxxxx,    (string) the tip block hash\n"
+            "  \"accountcachebytes\": xxxx,  (numeric) memory held by account changes not yet flushed to disk\n"
+            "  \"scriptcachebytes\": xxxx,   (numeric) memory held by script db changes not yet flushed to disk\n"
             "  \"errors\": \"...\"           (string) any error messages\n"
             "}\n"
             "\nExamples:\n"
@@ -229,6 +229,11 @@ Value getinfo(const Array& params, bool bHelp) {
 	obj.push_back(Pair("data directory", GetDataDir().string().c_str()));
 	//    obj.push_back(Pair("block high",    g_cChainActive.Tip()->nHeight));
 	obj.push_back(Pair("tip block hash", g_cChainActive.Tip()->GetBlockHash().ToString()));
+	{
+		LOCK(g_cs_main);
+		obj.push_back(Pair("accountcachebytes", (uint64_t) g_pAccountViewTip->GetCacheSize()));
+		obj.push_back(Pair("scriptcachebytes", (uint64_t) g_pScriptDBTip->GetCacheSize()));
+	}
 	obj.push_back(Pair("errors", GetWarnings("statusbar")));
 	return obj;
 }
@@ -4,6 +4,7 @@
 
 #include "rpcserver.h"
 
+#include "eventserver.h"
 #include "main.h"
 #include "net.h"
 #include "netbase.h"
@@ -152,6 +153,43 @@ Value getpeerinfo(const Array& params, bool bHelp) {
 
 	return ret;
 }
+
+Value geteventsubscribers(const Array& params, bool bHelp) {
+	if (bHelp || params.size() != 0) {
+		throw runtime_error("geteventsubscribers\n"
+				"\nReturns the clients subscribed to the event server on -uiport.\n"
+				"\nResult:\n"
+				"[\n"
+				"  {\n"
+				"    \"id\": n,                 (numeric) subscriber id\n"
+				"    \"addr\": \"host:port\",     (string) the client's address\n"
+				"    \"topics\": [\"block\",...], (array) block, wallettx, apptx, mempool and/or message\n"
+				"    \"apps\": [\"regid\",...],   (array) app transactions of these apps only, all apps if empty\n"
+				"    \"format\": \"json|binary\", (string) payload format\n"
+				"    \"sent\": n,               (numeric) frames written to the client\n"
+				"    \"dropped\": n,            (numeric) events dropped because the client did not keep up\n"
+				"    \"queued\": n              (numeric) frames waiting to be written\n"
+				"  }\n"
+				"  ,...\n"
+				"]\n"
+				"\nExamples:\n" + HelpExampleCli("geteventsubscribers", "") + HelpExampleRpc("geteventsubscribers", ""));
+	}
+
+	Array ret;
+	for (const auto &tStats : g_cEventServer.GetStats()) {
+		Object obj;
+		obj.push_back(Pair("id", tStats.nId));
+		obj.push_back(Pair("addr", tStats.strPeer));
+		for (const auto &item : tStats.tFilter.ToJson()) {
+			obj.push_back(item);
+		}
+		obj.push_back(Pair("sent", (int64_t) tStats.ullSent));
+		obj.push_back(Pair("dropped", (int64_t) tStats.ullDropped));
+		obj.push_back(Pair("queued", (int64_t) tStats.unQueued));
+		ret.push_back(obj);
+	}
+	return ret;
+}
 /**
  * ӽڵ
  * @param params 
@@ -77,6 +77,7 @@ string HTTPReply(int nStatus, const string& strMsg, bool bKeepalive) {
 	else if (nStatus == HTTP_FORBIDDEN) cStatus = "Forbidden";
 	else if (nStatus == HTTP_NOT_FOUND) cStatus = "Not Found";
 	else if (nStatus == HTTP_INTERNAL_SERVER_ERROR) cStatus = "Internal Server Error";
+	else if (nStatus == HTTP_SERVICE_UNAVAILABLE) cStatus = "Service Unavailable";
 	else cStatus = "";
     return strprintf(
             "HTTP/1.1 %d %s\r\n"
@@ -96,6 +97,72 @@ string HTTPReply(int nStatus, const string& strMsg, bool bKeepalive) {
         strMsg);
 }
 
+CHTTPReplyWriter::CHTTPReplyWriter(ostream &out, int nStatus, bool bKeepalive, bool bAllowChunked) :
+		m_Out(out), m_nStatus(nStatus), m_bKeepalive(bKeepalive), m_bAllowChunked(bAllowChunked), m_bChunked(false),
+		m_vchBuffer(g_sRpcChunkSize) {
+	setp(&m_vchBuffer[0], &m_vchBuffer[0] + m_vchBuffer.size());
+}
+
+int CHTTPReplyWriter::overflow(int nChar) {
+	Drain();
+	if (nChar != traits_type::eof()) {
+		*pptr() = traits_type::to_char_type(nChar);
+		pbump(1);
+	}
+	return traits_type::not_eof(nChar);
+}
+
+int CHTTPReplyWriter::sync() {
+	Drain();
+	return 0;
+}
+
+void CHTTPReplyWriter::Drain() {
+	size_t unSize = pptr() - pbase();
+	if (m_bChunked) {
+		WriteChunk(pbase(), unSize);
+	} else {
+		m_strBody.append(pbase(), unSize);
+		if (m_bAllowChunked && m_strBody.size() > g_sRpcChunkThreshold) {
+			m_Out << strprintf("HTTP/1.1 %d %s\r\n"
+					"Date: %s\r\n"
+					"Connection: %s\r\n"
+					"Transfer-Encoding: chunked\r\n"
+					"Content-Type: application/json\r\n"
+					"Server: Dacrs-json-rpc/%s\r\n"
+					"\r\n",
+				m_nStatus,
+				m_nStatus == HTTP_OK ? "OK" : "",
+				rfc1123Time(),
+				m_bKeepalive ? "keep-alive" : "close",
+				FormatFullVersion());
+			m_bChunked = true;
+			WriteChunk(m_strBody.data(), m_strBody.size());
+			string().swap(m_strBody);
+		}
+	}
+	setp(&m_vchBuffer[0], &m_vchBuffer[0] + m_vchBuffer.size());
+}
+
+void CHTTPReplyWriter::WriteChunk(const char *pData, size_t unSize) {
+	if (unSize == 0) {
+		return;
+	}
+	m_Out << strprintf("%x\r\n", unSize);
+	m_Out.write(pData, unSize);
+	m_Out << "\r\n";
+}
+
+void CHTTPReplyWriter::Finish() {
+	Drain();
+	if (m_bChunked) {
+		m_Out << "0\r\n\r\n";
+	} else {
+		m_Out << HTTPReply(m_nStatus, m_strBody, m_bKeepalive);
+	}
+	m_Out << flush;
+}
+
 bool ReadHTTPRequestLine(basic_istream<char>& stream, int &nProto, string& strHttpMethod, string& strHttpUri) {
     string str;
     getline(stream, str);
@@ -179,7 +246,27 @@ int ReadHTTPMessage(basic_istream<char>& stream, map<string, string>& mapHeaders
 		return HTTP_INTERNAL_SERVER_ERROR;
 	}
 	// Read message
-	if (nLen > 0) {
+	map<string, string>::const_iterator iterEncoding = mapHeadersRet.find("transfer-encoding");
+	if (iterEncoding != mapHeadersRet.end() && iterEncoding->second == "chunked") {
+		while (true) {
+			string str;
+			getline(stream, str);
+			int nChunk = strtol(str.c_str(), NULL, 16);
+			if (!stream || nChunk < 0 || strMessageRet.size() + nChunk > g_sMaxSize) {
+				return HTTP_INTERNAL_SERVER_ERROR;
+			}
+			if (nChunk == 0) {
+				// skip trailers up to the terminating empty line
+				map<string, string> mapTrailers;
+				ReadHTTPHeaders(stream, mapTrailers);
+				break;
+			}
+			size_t unOffset = strMessageRet.size();
+			strMessageRet.resize(unOffset + nChunk);
+			stream.read(&strMessageRet[unOffset], nChunk);
+			getline(stream, str);
+		}
+	} else if (nLen > 0) {
 		vector<char> vch(nLen);
 		stream.read(&vch[0], nLen);
 		strMessageRet = string(vch.begin(), vch.end());
@@ -233,6 +320,20 @@ string JSONRPCReply(const Value& result, const Value& error, const Value& id) {
 	return write_string(Value(reply), false) + "\n";
 }
 
+void JSONRPCWriteReply(ostream& stream, const Value& result, const Value& error, const Value& id) {
+	stream << "{\"result\":";
+	if (error.type() != null_type) {
+		stream << "null";
+	} else {
+		write_stream(result, stream, false);
+	}
+	stream << ",\"error\":";
+	write_stream(error, stream, false);
+	stream << ",\"id\":";
+	write_stream(id, stream, false);
+	stream << "}";
+}
+
 Object JSONRPCError(int nCode, const string& strMessage) {
 	Object error;
 	error.push_back(Pair("code", nCode));
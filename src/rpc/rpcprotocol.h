@@ -27,8 +27,14 @@ enum HTTPStatusCode {
     HTTP_FORBIDDEN             = 403,
     HTTP_NOT_FOUND             = 404,
     HTTP_INTERNAL_SERVER_ERROR = 500,
+    HTTP_SERVICE_UNAVAILABLE   = 503,
 };
 
+// replies larger than this are sent with chunked transfer encoding to HTTP/1.1 clients
+static const unsigned int g_sRpcChunkThreshold = 1 << 20;
+// size of each chunk written by CHTTPReplyWriter
+static const unsigned int g_sRpcChunkSize = 1 << 16;
+
 // Dacrs RPC error codes
 enum RPCErrorCode {
     // Standard JSON-RPC 2.0 errors
@@ -127,6 +133,35 @@ class SSLIOStreamDevice : public boost::iostreams::device<boost::iostreams::bidi
     boost::asio::ssl::stream<typename Protocol::socket>& m_stream;
 };
 
+/**
+ * Output buffer for one HTTP reply. Small bodies are collected and sent with a Content-Length
+ * header; once the body outgrows g_sRpcChunkThreshold and the client speaks HTTP/1.1 the
+ * headers are sent and the rest of the body is streamed as it is written, one chunk at a time,
+ * so a large result never has to be held in memory as a single string.
+ */
+class CHTTPReplyWriter: public std::streambuf {
+ public:
+	CHTTPReplyWriter(ostream &out, int nStatus, bool bKeepalive, bool bAllowChunked);
+	// send whatever is left of the reply, must be called exactly once
+	void Finish();
+
+ protected:
+	int overflow(int nChar);
+	int sync();
+
+ private:
+	void Drain();
+	void WriteChunk(const char *pData, size_t unSize);
+
+	ostream &m_Out;
+	int m_nStatus;
+	bool m_bKeepalive;
+	bool m_bAllowChunked;
+	bool m_bChunked;
+	vector<char> m_vchBuffer;
+	string m_strBody;
+};
+
 string HTTPPost(const string& strMsg, const map<string,string>& mapRequestHeaders);
 string HTTPReply(int nStatus, const string& strMsg, bool bKeepalive);
 bool ReadHTTPRequestLine(basic_istream<char>& stream, int &nProto,string& strHttpMethod, string& strHttpUri);
@@ -136,6 +171,8 @@ int ReadHTTPMessage(basic_istream<char>& stream, map<string, string>& mapHeaders
 string JSONRPCRequest(const string& strMethod, const json_spirit::Array& params, const json_spirit::Value& id);
 json_spirit::Object JSONRPCReplyObj(const json_spirit::Value& result, const json_spirit::Value& error, const json_spirit::Value& id);
 string JSONRPCReply(const json_spirit::Value& result, const json_spirit::Value& error, const json_spirit::Value& id);
+// Same output as JSONRPCReply without copying result into a reply object first
+void JSONRPCWriteReply(ostream& stream, const json_spirit::Value& result, const json_spirit::Value& error, const json_spirit::Value& id);
 json_spirit::Object JSONRPCError(int nCode, const string& strMessage);
 
 #endif
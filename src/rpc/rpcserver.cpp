@@ -20,7 +20,10 @@
 #include <boost/foreach.hpp>
 #include <boost/iostreams/concepts.hpp>
 #include <boost/iostreams/stream.hpp>
+#include <boost/thread.hpp>
+#include <deque>
 #include <memory>
+#include <set>
 #include "json/json_spirit_writer_template.h"
 #include "../wallet/wallet.h"
 using namespace std;
@@ -30,6 +33,75 @@ using namespace json_spirit;
 
 static string g_sstrRpcUserColonPass;
 
+/**
+ * Bounded FIFO of tasks served by a fixed set of threads. Tasks still queued when the queue is
+ * destroyed are dropped, tasks already running are waited for.
+ */
+class CRPCWorkQueue {
+ public:
+	CRPCWorkQueue(const string &strName, int nThreads, size_t unMaxDepth) :
+			m_strName(strName), m_unMaxDepth(unMaxDepth), m_bRunning(true) {
+		for (int i = 0; i < nThreads; i++) {
+			m_Threads.create_thread(boost::bind(&CRPCWorkQueue::ThreadMain, this));
+		}
+	}
+
+	~CRPCWorkQueue() {
+		{
+			boost::unique_lock<boost::mutex> lock(m_Mutex);
+			m_bRunning = false;
+			m_queTasks.clear();
+		}
+		m_Cond.notify_all();
+		m_Threads.join_all();
+	}
+
+	// returns false without queueing when the queue is already full
+	bool TryPush(const boost::function<void(void)> &func) {
+		{
+			boost::unique_lock<boost::mutex> lock(m_Mutex);
+			if (!m_bRunning || m_queTasks.size() >= m_unMaxDepth) {
+				return false;
+			}
+			m_queTasks.push_back(func);
+		}
+		m_Cond.notify_one();
+		return true;
+	}
+
+ private:
+	void ThreadMain() {
+		RenameThread(("dacrs-" + m_strName).c_str());
+		while (true) {
+			boost::function<void(void)> func;
+			{
+				boost::unique_lock<boost::mutex> lock(m_Mutex);
+				while (m_bRunning && m_queTasks.empty()) {
+					m_Cond.wait(lock);
+				}
+				if (!m_bRunning) {
+					return;
+				}
+				func = m_queTasks.front();
+				m_queTasks.pop_front();
+			}
+			try {
+				func();
+			} catch (std::exception& e) {
+				LogPrint("INFO", "%s: %s task threw %s\n", __func__, m_strName, e.what());
+			}
+		}
+	}
+
+	string m_strName;
+	size_t m_unMaxDepth;
+	bool m_bRunning;
+	deque<boost::function<void(void)> > m_queTasks;
+	boost::mutex m_Mutex;
+	boost::condition_variable m_Cond;
+	boost::thread_group m_Threads;
+};
+
 // These are created by StartRPCThreads, destroyed in StopRPCThreads
 static asio::io_service* g_pRpcIoService = NULL;
 static map<string, std::shared_ptr<deadline_timer> > g_DeadlineTimers;
@@ -37,6 +109,11 @@ static ssl::context* g_RpcSslContext = NULL;
 static boost::thread_group* g_RpcWorkerGroup = NULL;
 static boost::asio::io_service::work *g_RpcDummyWork = NULL;
 static vector< std::shared_ptr<ip::tcp::acceptor> > g_RpcAcceptors;
+// accepted connections wait here for a worker which then serves them until they close
+static CRPCWorkQueue* g_pRpcWorkQueue = NULL;
+// runs the thread safe calls of batch requests in parallel
+static CRPCWorkQueue* g_pRpcBatchQueue = NULL;
+static deadline_timer* g_pRpcIdleTimer = NULL;
 
 void RPCTypeCheck(const Array& params, const list<Value_type>& typesExpected, bool bAllowNull) {
 	unsigned int i = 0;
@@ -211,6 +288,7 @@ Value stop(const Array& params, bool bHelp) {
 //
 extern Value resetclient(const Array& params, bool bHelp);
 extern Value gettxoperationlog(const Array& params, bool bHelp);
+extern Value gettxoperationlogs(const Array& params, bool bHelp);
 extern Value dropprivkey(const Array& params, bool bHelp);
 
 static const CRPCCommand cRpcCommands[] =
@@ -232,6 +310,7 @@ static const CRPCCommand cRpcCommands[] =
     { "getconnectioncount",     &getconnectioncount,     true,      false,      false },
     { "getnettotals",           &getnettotals,           true,      true,       false },
     { "getpeerinfo",            &getpeerinfo,            true,      false,      false },
+    { "geteventsubscribers",    &geteventsubscribers,    true,      true,       false },
     { "ping",                   &ping,                   true,      false,      false },
     { "getdacrsstate",          &getdacrsstate,          false,      false,      false }, //true
 
@@ -239,7 +318,7 @@ static const CRPCCommand cRpcCommands[] =
     { "getblockchaininfo",      &getblockchaininfo,      true,      false,      false },
     { "getbestblockhash",       &getbestblockhash,       true,      false,      false },
     { "getblockcount",          &getblockcount,          true,      false,      false },
-    { "getblock",               &getblock,               false,     false,      false },
+    { "getblock",               &getblock,               false,     true,       false },
     { "getblockhash",           &getblockhash,           false,     false,      false },
     { "getdifficulty",          &getdifficulty,          true,      false,      false },
     { "getrawmempool",          &getrawmempool,          true,      false,      false },
@@ -248,6 +327,10 @@ static const CRPCCommand cRpcCommands[] =
     { "verifymessage",          &verifymessage,          false,     false,      false },
     { "gettotalcoin",           &gettotalcoin,           false,     false,      false },
     { "gettotalassets",         &gettotalassets,         false,     false,      false },
+    { "getvalidationstats",     &getvalidationstats,     true,      true,       false },
+    { "getcontractprofile",     &getcontractprofile,     true,      true,       false },
+    { "getscriptdbstats",       &getscriptdbstats,       true,      false,      false },
+    { "dumpsnapshot",           &dumpsnapshot,           true,      true,       false },
 
     /* Mining */
     { "getmininginfo",          &getmininginfo,          true,      false,      false },
@@ -266,11 +349,11 @@ static const CRPCCommand cRpcCommands[] =
     { "dumpprivkey",            &dumpprivkey,            true,      false,      true },
     { "dumpwallet",             &dumpwallet,             true,      false,      true },
     { "encryptwallet",          &encryptwallet,          false,     false,      true },
-    { "getaccountinfo",         &getaccountinfo,         true,      false,      true },
+    { "getaccountinfo",         &getaccountinfo,         true,      true,       true },
     { "getnewaddress",          &getnewaddress,          true,      false,      true },
-    { "gettxdetail",            &gettxdetail,       	 true,      false,      true },
+    { "gettxdetail",            &gettxdetail,       	 true,      true,       true },
     { "listunconfirmedtx",      &listunconfirmedtx,      true,      false,      true },
-    { "getwalletinfo",          &getwalletinfo,          true,      false,      true },
+    { "getwalletinfo",          &getwalletinfo,          true,      true,       true },
     { "importprivkey",          &importprivkey,          false,     false,      true },
     { "dropprivkey",   			&dropprivkey,   		 false,     false,      true },
 
@@ -287,16 +370,16 @@ static const CRPCCommand cRpcCommands[] =
 	{ "walletpassphrasechange", &walletpassphrasechange, false,     false,      true },
 	{ "walletpassphrase",       &walletpassphrase,       true,      false,      true },
 	{ "setgenerate",            &setgenerate,            true,      true,       false},
-	{ "listapp",                &listapp,                true,      false,      true },
-	{ "getappinfo",             &getappinfo,             true,      false,      true },
+	{ "listapp",                &listapp,                true,      true,       true },
+	{ "getappinfo",             &getappinfo,             true,      true,       true },
 	{ "generateblock",          &generateblock, 		 true,      true,       true },
 	{ "listtxcache",            &listtxcache,            true,      false,      true },
-	{ "getscriptdata",          &getscriptdata,          true,      false,      true },
+	{ "getscriptdata",          &getscriptdata,          true,      true,       true },
 	{ "getscriptvalidedata",    &getscriptvalidedata,    true,      false,      true },
 	{ "signmessage",            &signmessage,            false,     false,      true },
 	{ "sendtoaddress",          &sendtoaddress,          false,     false,      true },
 	{ "sendtoaddresswithfee",   &sendtoaddresswithfee,   false,     false,      true },
-    { "getbalance",             &getbalance,             false,     false,      true },
+    { "getbalance",             &getbalance,             false,     true,       true },
     { "notionalpoolingbalance", &notionalpoolingbalance, false,     false,      true },
     { "dispersebalance", 		&dispersebalance, 		 false,     false,      true },
     { "notionalpoolingasset", 	&notionalpoolingasset, 	 false,     false,      true },
@@ -310,6 +393,7 @@ static const CRPCCommand cRpcCommands[] =
 
 //for test code
 	{ "gettxoperationlog",      &gettxoperationlog,      false,     false,      false },
+	{ "gettxoperationlogs",     &gettxoperationlogs,     false,     false,      false },
     { "disconnectblock",        &disconnectblock,        true,      false,      true },
     { "resetclient",            &resetclient,            true,      false,      false },
     { "reloadtxcache",          &reloadtxcache,          true,      false,      true },
@@ -354,11 +438,11 @@ bool HTTPAuthorized(map<string, string>& mapHeaders) {
 	return TimingResistantEqual(strUserPass, g_sstrRpcUserColonPass);
 }
 
-void ErrorReply(ostream& stream, const Object& objError, const Value& id) {
+void ErrorReply(ostream& stream, const Object& objError, const Value& id, bool bKeepalive) {
 	// Send error reply from json-rpc error object
 	int nStatus = HTTP_OK;
 	string strReply = JSONRPCReply(Value::null, objError, id);
-	stream << HTTPReply(nStatus, strReply, false) << flush;
+	stream << HTTPReply(nStatus, strReply, bKeepalive) << flush;
 }
 
 bool ClientAllowed(const boost::asio::ip::address& address) {
@@ -384,11 +468,20 @@ bool ClientAllowed(const boost::asio::ip::address& address) {
 
 class AcceptedConnection {
  public:
+	AcceptedConnection() :
+			m_llIdleSince(0) {
+	}
 	virtual ~AcceptedConnection() {
 	}
 	virtual iostream& stream() = 0;
 	virtual string PeerAddressToString() const = 0;
 	virtual void close() = 0;
+	// unblocks a worker waiting on this connection, safe to call from another thread
+	virtual void shutdown() = 0;
+
+	// time the connection started waiting for its next request, 0 while a request is served.
+	// Guarded by g_csRpcConnections
+	int64_t m_llIdleSince;
 };
 
 template <typename Protocol>
@@ -410,6 +503,11 @@ class AcceptedConnectionImpl : public AcceptedConnection {
 		_stream.close();
 	}
 
+	virtual void shutdown() {
+		boost::system::error_code ec;
+		sslStream.lowest_layer().shutdown(socket_base::shutdown_both, ec);
+	}
+
 	typename Protocol::endpoint peer;
 	asio::ssl::stream<typename Protocol::socket> sslStream;
 
@@ -420,6 +518,54 @@ class AcceptedConnectionImpl : public AcceptedConnection {
 
 void ServiceConnection(AcceptedConnection *cServiceConn);
 
+// connections currently held by a worker, so idle ones can be closed from the io thread
+static boost::mutex g_csRpcConnections;
+static set<AcceptedConnection*> g_setRpcConnections;
+static bool g_bRpcStopping = false;
+
+static void SetConnectionIdle(AcceptedConnection *cConn, bool bIdle) {
+	boost::unique_lock<boost::mutex> lock(g_csRpcConnections);
+	cConn->m_llIdleSince = bIdle ? GetTime() : 0;
+}
+
+static void ServiceConnectionTask(std::shared_ptr<AcceptedConnection> conn) {
+	{
+		boost::unique_lock<boost::mutex> lock(g_csRpcConnections);
+		if (g_bRpcStopping) {
+			conn->close();
+			return;
+		}
+		g_setRpcConnections.insert(conn.get());
+	}
+	ServiceConnection(conn.get());
+	{
+		boost::unique_lock<boost::mutex> lock(g_csRpcConnections);
+		g_setRpcConnections.erase(conn.get());
+	}
+	conn->close();
+}
+
+// Close keep-alive connections which did not send a request within -rpckeepalivetimeout,
+// so idle clients cannot hold on to all workers
+static void RPCIdleSweep(const boost::system::error_code& err) {
+	if (err) {
+		return;
+	}
+	int64_t llCutoff = GetTime() - SysCfg().GetArg("-rpckeepalivetimeout", 30);
+	{
+		boost::unique_lock<boost::mutex> lock(g_csRpcConnections);
+		for (auto pConn : g_setRpcConnections) {
+			if (pConn->m_llIdleSince != 0 && pConn->m_llIdleSince < llCutoff) {
+				LogPrint("rpc", "%s: closing idle connection from %s\n", __func__, pConn->PeerAddressToString());
+				pConn->m_llIdleSince = 0;
+				pConn->shutdown();
+			}
+		}
+	}
+	g_pRpcIdleTimer->expires_from_now(posix_time::seconds(1));
+	g_pRpcIdleTimer->async_wait(boost::bind(&RPCIdleSweep, _1));
+}
+
 // Forward declaration required for RPCListen
 template <typename Protocol, typename SocketAcceptorService>
 static void RPCAcceptHandler(std::shared_ptr< basic_socket_acceptor<Protocol, SocketAcceptorService> > acceptor,
@@ -469,8 +615,11 @@ static void RPCAcceptHandler(std::shared_ptr<basic_socket_acceptor<Protocol, Soc
 			conn->stream() << HTTPReply(HTTP_FORBIDDEN, "", false) << flush;
 		}
 		conn->close();
-	} else {
-		ServiceConnection(conn.get());
+	} else if (!g_pRpcWorkQueue->TryPush(boost::bind(&ServiceConnectionTask, conn))) {
+		LogPrint("rpc", "%s: work queue full, rejecting %s\n", __func__, conn->PeerAddressToString());
+		if (!bUseSSL) {
+			conn->stream() << HTTPReply(HTTP_SERVICE_UNAVAILABLE, "", false) << flush;
+		}
 		conn->close();
 	}
 }
@@ -594,11 +743,24 @@ void StartRPCThreads() {
 		return;
 	}
 
-	g_RpcWorkerGroup = new boost::thread_group();
-	int nTotal = SysCfg().GetArg("-rpcthreads", 4);
-	for (int i = 0; i < nTotal; i++) {
-		g_RpcWorkerGroup->create_thread(boost::bind(&asio::io_service::run, g_pRpcIoService));
+	{
+		boost::unique_lock<boost::mutex> lock(g_csRpcConnections);
+		g_bRpcStopping = false;
+	}
+	int nWorkers = max((int) SysCfg().GetArg("-rpcthreads", 4), 1);
+	int nWorkQueue = max((int) SysCfg().GetArg("-rpcworkqueue", 16), 1);
+	g_pRpcWorkQueue = new CRPCWorkQueue("rpcwork", nWorkers, nWorkQueue);
+	int nBatchThreads = SysCfg().GetArg("-rpcbatchthreads", 4);
+	if (nBatchThreads > 0) {
+		g_pRpcBatchQueue = new CRPCWorkQueue("rpcbatch", nBatchThreads, nBatchThreads);
 	}
+	g_pRpcIdleTimer = new deadline_timer(*g_pRpcIoService);
+	g_pRpcIdleTimer->expires_from_now(posix_time::seconds(1));
+	g_pRpcIdleTimer->async_wait(boost::bind(&RPCIdleSweep, _1));
+
+	// the io thread only accepts connections and runs timers, requests are served by the workers
+	g_RpcWorkerGroup = new boost::thread_group();
+	g_RpcWorkerGroup->create_thread(boost::bind(&asio::io_service::run, g_pRpcIoService));
 }
 
 void StartDummyRPCThread() {
@@ -635,6 +797,22 @@ void StopRPCThreads() {
 		}
 	}
 	g_DeadlineTimers.clear();
+	if (g_pRpcIdleTimer != NULL) {
+		g_pRpcIdleTimer->cancel(ec);
+	}
+
+	// Wake workers blocked on keep-alive connections and wait for the calls in flight
+	{
+		boost::unique_lock<boost::mutex> lock(g_csRpcConnections);
+		g_bRpcStopping = true;
+		for (auto pConn : g_setRpcConnections) {
+			pConn->shutdown();
+		}
+	}
+	delete g_pRpcWorkQueue;
+	g_pRpcWorkQueue = NULL;
+	delete g_pRpcBatchQueue;
+	g_pRpcBatchQueue = NULL;
 
 	g_pRpcIoService->stop();
 	if (g_RpcWorkerGroup != NULL) {
@@ -644,6 +822,8 @@ void StopRPCThreads() {
 	g_RpcDummyWork = NULL;
 	delete g_RpcWorkerGroup;
 	g_RpcWorkerGroup = NULL;
+	delete g_pRpcIdleTimer;
+	g_pRpcIdleTimer = NULL;
 	delete g_RpcSslContext;
 	g_RpcSslContext = NULL;
 	delete g_pRpcIoService;
@@ -713,29 +893,115 @@ void JSONRequest::parse(const Value& valRequest)
 	}
 }
 
-static Object JSONRPCExecOne(const Value& req) {
-	Object rpc_result;
+// One call of a batch request and its outcome
+struct ST_BatchItem {
+	JSONRequest m_cRequest;
+	Value m_Result;
+	Value m_Error;
+	bool m_bParallel;
+
+	ST_BatchItem() :
+			m_bParallel(false) {
+	}
+};
 
-	JSONRequest jreq;
+static void JSONRPCExecOne(ST_BatchItem &tItem) {
 	try {
-		jreq.parse(req);
-		Value result = g_TableRPC.execute(jreq.m_strMethod, jreq.m_Params);
-		rpc_result = JSONRPCReplyObj(result, Value::null, jreq.m_ID);
+		tItem.m_Result = g_TableRPC.execute(tItem.m_cRequest.m_strMethod, tItem.m_cRequest.m_Params);
 	} catch (Object& objError) {
-		rpc_result = JSONRPCReplyObj(Value::null, objError, jreq.m_ID);
+		tItem.m_Error = objError;
 	} catch (std::exception& e) {
-		rpc_result = JSONRPCReplyObj(Value::null, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.m_ID);
+		tItem.m_Error = JSONRPCError(RPC_PARSE_ERROR, e.what());
 	}
-
-	return rpc_result;
 }
 
-static string JSONRPCExecBatch(const Array& vReq) {
-	Array ret;
+/**
+ * The thread safe calls of one batch. The requesting worker and any batch threads that pick up
+ * a Run task claim calls one at a time until none are left, so the batch completes even when
+ * no batch thread is free.
+ */
+class CBatchRun {
+ public:
+	CBatchRun(vector<ST_BatchItem> &vItems, const vector<unsigned int> &vunIndexes) :
+			m_vItems(vItems), m_vunIndexes(vunIndexes), m_unNext(0), m_unDone(0) {
+	}
+
+	void Run() {
+		while (true) {
+			unsigned int unIndex;
+			{
+				boost::unique_lock<boost::mutex> lock(m_Mutex);
+				if (m_unNext == m_vunIndexes.size()) {
+					return;
+				}
+				unIndex = m_vunIndexes[m_unNext++];
+			}
+			JSONRPCExecOne(m_vItems[unIndex]);
+			{
+				boost::unique_lock<boost::mutex> lock(m_Mutex);
+				if (++m_unDone == m_vunIndexes.size()) {
+					m_Cond.notify_all();
+				}
+			}
+		}
+	}
+
+	void Wait() {
+		boost::unique_lock<boost::mutex> lock(m_Mutex);
+		while (m_unDone < m_vunIndexes.size()) {
+			m_Cond.wait(lock);
+		}
+	}
+
+ private:
+	// only touched for claimed indexes, and the owner waits for all of them before going away
+	vector<ST_BatchItem> &m_vItems;
+	const vector<unsigned int> m_vunIndexes;
+	unsigned int m_unNext;
+	unsigned int m_unDone;
+	boost::mutex m_Mutex;
+	boost::condition_variable m_Cond;
+};
+
+static void JSONRPCExecBatch(const Array& vReq, vector<ST_BatchItem> &vItems) {
+	vItems.resize(vReq.size());
+	vector<unsigned int> vunParallel;
 	for (unsigned int unReqIdx = 0; unReqIdx < vReq.size(); unReqIdx++) {
-		ret.push_back(JSONRPCExecOne(vReq[unReqIdx]));
+		ST_BatchItem &tItem = vItems[unReqIdx];
+		try {
+			tItem.m_cRequest.parse(vReq[unReqIdx]);
+		} catch (Object& objError) {
+			tItem.m_Error = objError;
+			continue;
+		} catch (std::exception& e) {
+			tItem.m_Error = JSONRPCError(RPC_PARSE_ERROR, e.what());
+			continue;
+		}
+		const CRPCCommand *pCmd = g_TableRPC[tItem.m_cRequest.m_strMethod];
+		if (pCmd && pCmd->m_bThreadSafe) {
+			vunParallel.push_back(unReqIdx);
+		}
+	}
+
+	if (g_pRpcBatchQueue && vunParallel.size() > 1) {
+		for (auto unIndex : vunParallel) {
+			vItems[unIndex].m_bParallel = true;
+		}
+		std::shared_ptr<CBatchRun> pRun(new CBatchRun(vItems, vunParallel));
+		for (unsigned int i = 1; i < vunParallel.size(); i++) {
+			if (!g_pRpcBatchQueue->TryPush(boost::bind(&CBatchRun::Run, pRun))) {
+				break;
+			}
+		}
+		pRun->Run();
+		pRun->Wait();
+	}
+	// calls that need g_cs_main run one after another in request order
+	for (auto &tItem : vItems) {
+		if (!tItem.m_bParallel && tItem.m_Error.type() == null_type) {
+			JSONRPCExecOne(tItem);
+		}
 	}
-	return write_string(Value(ret), false) + "\n";
 }
 
 void ServiceConnection(AcceptedConnection *cServiceConn) {
@@ -746,7 +1012,10 @@ void ServiceConnection(AcceptedConnection *cServiceConn) {
 		string strRequest, strMethod, strURI;
 
 		// Read HTTP request line
-		if (!ReadHTTPRequestLine(cServiceConn->stream(), nProto, strMethod, strURI)) {
+		SetConnectionIdle(cServiceConn, true);
+		bool bReadOk = ReadHTTPRequestLine(cServiceConn->stream(), nProto, strMethod, strURI);
+		SetConnectionIdle(cServiceConn, false);
+		if (!bReadOk) {
 			break;
 		}
 		// Read HTTP message headers and body
@@ -767,26 +1036,40 @@ void ServiceConnection(AcceptedConnection *cServiceConn) {
 			if (!read_string(strRequest, valRequest)) {
 				throw JSONRPCError(RPC_PARSE_ERROR, "Parse error");
 			}
-			string strReply;
 
 			// singleton request
 			if (valRequest.type() == obj_type) {
 				jreq.parse(valRequest);
 				Value result = g_TableRPC.execute(jreq.m_strMethod, jreq.m_Params);
-				// Send reply
-				strReply = JSONRPCReply(result, Value::null, jreq.m_ID);
+				// Send reply, large results are streamed straight from the value tree
+				CHTTPReplyWriter cWriter(cServiceConn->stream(), HTTP_OK, bRun, nProto >= 1);
+				ostream os(&cWriter);
+				JSONRPCWriteReply(os, result, Value::null, jreq.m_ID);
+				os << "\n";
+				cWriter.Finish();
 				// array of requests
 			} else if (valRequest.type() == array_type) {
-				strReply = JSONRPCExecBatch(valRequest.get_array());
+				vector<ST_BatchItem> vItems;
+				JSONRPCExecBatch(valRequest.get_array(), vItems);
+				CHTTPReplyWriter cWriter(cServiceConn->stream(), HTTP_OK, bRun, nProto >= 1);
+				ostream os(&cWriter);
+				os << "[";
+				for (unsigned int i = 0; i < vItems.size(); i++) {
+					if (i > 0) {
+						os << ",";
+					}
+					JSONRPCWriteReply(os, vItems[i].m_Result, vItems[i].m_Error, vItems[i].m_cRequest.m_ID);
+				}
+				os << "]\n";
+				cWriter.Finish();
 			} else {
 				throw JSONRPCError(RPC_PARSE_ERROR, "Top-level object parse error");
 			}
-			cServiceConn->stream() << HTTPReply(HTTP_OK, strReply, bRun) << flush;
 		} catch (Object& objError) {
-			ErrorReply(cServiceConn->stream(), objError, jreq.m_ID);
-			break;
+			// a failed call does not spoil the connection
+			ErrorReply(cServiceConn->stream(), objError, jreq.m_ID, bRun);
 		} catch (std::exception& e) {
-			ErrorReply(cServiceConn->stream(), JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.m_ID);
+			ErrorReply(cServiceConn->stream(), JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.m_ID, false);
 			break;
 		}
 	}
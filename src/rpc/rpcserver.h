@@ -11,6 +11,7 @@
 
 #include <list>
 #include <map>
+#include <memory>
 #include <stdint.h>
 #include <string>
 
@@ -19,6 +20,7 @@
 #include "json/json_spirit_writer_template.h"
 using namespace std;
 class CBlockIndex;
+class CChainStateSnapshot;
 
 /* Start RPC threads */
 void StartRPCThreads();
@@ -107,9 +109,11 @@ extern string HelpExampleCli(string strMethodName, string args);
 extern string HelpExampleRpc(string strMethodName, string args);
 
 extern void EnsureWalletIsUnlocked();
+extern std::shared_ptr<CChainStateSnapshot> EnsureChainStateSnapshot();
 
 extern json_spirit::Value getconnectioncount(const json_spirit::Array& params, bool bHelp); // in rpcnet.cpp
 extern json_spirit::Value getpeerinfo(const json_spirit::Array& params, bool bHelp);
+extern json_spirit::Value geteventsubscribers(const json_spirit::Array& params, bool bHelp);
 extern json_spirit::Value ping(const json_spirit::Array& params, bool bHelp);
 extern json_spirit::Value addnode(const json_spirit::Array& params, bool bHelp);
 extern json_spirit::Value getaddednodeinfo(const json_spirit::Array& params, bool bHelp);
@@ -146,6 +150,10 @@ extern json_spirit::Value encryptwallet(const json_spirit::Array& params, bool b
 extern json_spirit::Value getinfo(const json_spirit::Array& params, bool bHelp);
 extern json_spirit::Value getwalletinfo(const json_spirit::Array& params, bool bHelp);
 extern json_spirit::Value getblockchaininfo(const json_spirit::Array& params, bool bHelp);
+extern json_spirit::Value getvalidationstats(const json_spirit::Array& params, bool bHelp);
+extern json_spirit::Value getcontractprofile(const json_spirit::Array& params, bool bHelp);
+extern json_spirit::Value getscriptdbstats(const json_spirit::Array& params, bool bHelp);
+extern json_spirit::Value dumpsnapshot(const json_spirit::Array& params, bool bHelp);
 extern json_spirit::Value getnetworkinfo(const json_spirit::Array& params, bool bHelp);
 
 extern json_spirit::Value getrawtransaction(const json_spirit::Array& params, bool bHelp); // in rcprawtransaction.cpp
@@ -59,14 +59,16 @@ Object GetTxDetailJSON(const uint256& cTxHash) {
 	Object obj;
 	std::shared_ptr<CBaseTransaction> pBaseTx;
 	{
-		LOCK(g_cs_main);
+		std::shared_ptr<CChainStateSnapshot> pSnapshot = EnsureChainStateSnapshot();
+		CAccountViewCache cAccView(pSnapshot->GetAccountView(), true);
+		CScriptDBViewCache cScriptDBView(pSnapshot->GetScriptDBView(), true);
 		CBlock cGenesisBlock;
-		CBlockIndex* pcGenesisBlockIndex = g_mapBlockIndex[SysCfg().HashGenesisBlock()];
+		CBlockIndex* pcGenesisBlockIndex = (*pSnapshot)[0];
 		ReadBlockFromDisk(cGenesisBlock, pcGenesisBlockIndex);
 		assert(cGenesisBlock.GetHashMerkleRoot() == cGenesisBlock.BuildMerkleTree());
 		for (unsigned int i = 0; i < cGenesisBlock.vptx.size(); ++i) {
 			if (cTxHash == cGenesisBlock.GetTxHash(i)) {
-				obj = cGenesisBlock.vptx[i]->ToJSON(*g_pAccountViewTip);
+				obj = cGenesisBlock.vptx[i]->ToJSON(cAccView);
 				obj.push_back(Pair("blockhash", SysCfg().HashGenesisBlock().GetHex()));
 				obj.push_back(Pair("confirmHeight", (int) 0));
 				obj.push_back(Pair("confirmedtime", (int) cGenesisBlock.GetTime()));
@@ -79,20 +81,19 @@ Object GetTxDetailJSON(const uint256& cTxHash) {
 
 		if (SysCfg().IsTxIndex()) {
 			ST_DiskTxPos tPostx;
-			if (g_pScriptDBTip->ReadTxIndex(cTxHash, tPostx)) {
-				CAutoFile cAutoFile(OpenBlockFile(tPostx, true), SER_DISK, g_sClientVersion);
+			if (cScriptDBView.ReadTxIndex(cTxHash, tPostx)) {
 				CBlockHeader cHeader;
 				try {
-					cAutoFile >> cHeader;
-					fseek(cAutoFile, tPostx.m_unTxOffset, SEEK_CUR);
-					cAutoFile >> pBaseTx;
-					obj = pBaseTx->ToJSON(*g_pAccountViewTip);
+					if (!ReadTxFromDisk(tPostx, cHeader, &pBaseTx)) {
+						throw runtime_error("cannot read the transaction from its block file");
+					}
+					obj = pBaseTx->ToJSON(cAccView);
 					obj.push_back(Pair("blockhash", cHeader.GetHash().GetHex()));
 					obj.push_back(Pair("confirmHeight", (int) cHeader.GetHeight()));
 					obj.push_back(Pair("confirmedtime", (int) cHeader.GetTime()));
 					if (pBaseTx->m_chTxType == EM_CONTRACT_TX) {
 						vector<CVmOperate> vcOutput;
-						g_pScriptDBTip->ReadTxOutPut(pBaseTx->GetHash(), vcOutput);
+						cScriptDBView.ReadTxOutPut(pBaseTx->GetHash(), vcOutput);
 						Array outputArray;
 						for (auto & item : vcOutput) {
 							outputArray.push_back(item.ToJson());
@@ -111,7 +112,7 @@ Object GetTxDetailJSON(const uint256& cTxHash) {
 		{
 			pBaseTx = g_cTxMemPool.lookup(cTxHash);
 			if (pBaseTx.get()) {
-				obj = pBaseTx->ToJSON(*g_pAccountViewTip);
+				obj = pBaseTx->ToJSON(cAccView);
 				CDataStream cDs(SER_DISK, g_sClientVersion);
 				cDs << pBaseTx;
 				obj.push_back(Pair("rawtx", HexStr(cDs.begin(), cDs.end())));
@@ -297,12 +298,11 @@ Value gettransaction(const Array& params, bool bHelp) {
 			ST_DiskTxPos postx;
 			if (g_pScriptDBTip->ReadTxIndex(cTxhash, postx)) {
 				bFindTx = true;
-				CAutoFile file(OpenBlockFile(postx, true), SER_DISK, g_sClientVersion);
 				CBlockHeader header;
 				try {
-					file >> header;
-					fseek(file, postx.m_unTxOffset, SEEK_CUR);
-					file >> pBaseTx;
+					if (!ReadTxFromDisk(postx, header, &pBaseTx)) {
+						throw runtime_error("cannot read the transaction from its block file");
+					}
 					double dAmount = static_cast<double>(pBaseTx->GetValue()) / COIN;
 					obj.push_back(Pair("amount", dAmount));
 					obj.push_back(Pair("confirmations",g_cChainActive.Tip()->m_nHeight-(int) header.GetHeight()));
@@ -912,7 +912,8 @@ Value getaccountinfo(const Array& params, bool bHelp) {
 	Object obj;
 	{
 		CAccount cAccount;
-		CAccountViewCache cAccView(*g_pAccountViewTip, true);
+		std::shared_ptr<CChainStateSnapshot> pSnapshot = EnsureChainStateSnapshot();
+		CAccountViewCache cAccView(pSnapshot->GetAccountView(), true);
 		if (cAccView.GetAccount(cUserId, cAccount)) {
 			if (!cAccount.m_cPublicKey.IsValid()) {
 				CPubKey cPk;
@@ -1094,6 +1095,20 @@ static Value AccountLogToJson(const CAccountLog &accoutLog) {
 
 	return obj;
 }
+
+static Object TxOperLogToJson(const uint256 &cTxHash, const vector<CAccountLog> &vcLog) {
+	Object retobj;
+	retobj.push_back(Pair("hash", cTxHash.GetHex()));
+	Array arrayvLog;
+	for (auto const &te : vcLog) {
+		Object obj;
+		obj.push_back(Pair("addr", te.m_cKeyID.ToAddress()));
+		arrayvLog.push_back(obj);
+	}
+	retobj.push_back(Pair("AccountOperLog", arrayvLog));
+
+	return retobj;
+}
 /**
  * õ׵ļ¼
  * @param params 
@@ -1120,24 +1135,44 @@ Value gettxoperationlog(const Array& params, bool bHelp) {
 	RPCTypeCheck(params, list_of(str_type));
 	uint256 cTxHash(uint256S(params[0].get_str()));
 	vector<CAccountLog> vcLog;
-	Object retobj;
-	retobj.push_back(Pair("hash", cTxHash.GetHex()));
 	if (!GetTxOperLog(cTxHash, vcLog)) {
 		throw JSONRPCError(RPC_INVALID_PARAMS, "error hash");
 	}
-	{
-		Array arrayvLog;
-		for (auto const &te : vcLog) {
-			Object obj;
-			obj.push_back(Pair("addr", te.m_cKeyID.ToAddress()));
-			Array array;
-			array.push_back(AccountLogToJson(te));
-			arrayvLog.push_back(obj);
-		}
-		retobj.push_back(Pair("AccountOperLog", arrayvLog));
+	return TxOperLogToJson(cTxHash, vcLog);
+}
 
+Value gettxoperationlogs(const Array& params, bool bHelp) {
+	if (bHelp || params.size() != 1) {
+		throw runtime_error(
+				"gettxoperationlogs [\"txhash\",...]\n"
+						"\nget the operation logs of many transactions at once\n"
+						"\nArguments:\n"
+						"1.[\"txhash\",...]: (array of string required) \n"
+						"\nResult:\n"
+						"[{\"hash\", \"AccountOperLog\"} as gettxoperationlog,...] in the order of the arguments, "
+						"transactions without a log are left out\n"
+						"\nExamples:\n"
+						+ HelpExampleCli("gettxoperationlogs",
+								"\"[\\\"0001a87352387b5b4d6d01299c0dc178ff044f42e016970b0dc7ea9c72c08e2e494a01020304100000\\\"]\"")
+						+ "\nAs json rpc call\n"
+						+ HelpExampleRpc("gettxoperationlogs",
+								"[\"0001a87352387b5b4d6d01299c0dc178ff044f42e016970b0dc7ea9c72c08e2e494a01020304100000\"]"));
 	}
-	return retobj;
+	RPCTypeCheck(params, list_of(array_type));
+	vector<uint256> vcTxHash;
+	for (const auto &item : params[0].get_array()) {
+		vcTxHash.push_back(uint256S(item.get_str()));
+	}
+	map<uint256, vector<CAccountLog> > mapLog;
+	GetTxOperLogs(vcTxHash, mapLog);
+	Array retArray;
+	for (const auto &cTxHash : vcTxHash) {
+		map<uint256, vector<CAccountLog> >::const_iterator it = mapLog.find(cTxHash);
+		if (it != mapLog.end()) {
+			retArray.push_back(TxOperLogToJson(cTxHash, it->second));
+		}
+	}
+	return retArray;
 }
 static Value TestDisconnectBlock(int number) {
 	CBlock cBlock;
@@ -1238,6 +1273,8 @@ Value resetclient(const Array& params, bool bHelp) {
 		CBlock cFirs = SysCfg().GenesisBlock();
 		g_pwalletMain->SyncTransaction(uint256(), NULL, &cFirs);
 		g_cTxMemPool.clear();
+		// the chain was rewound without disconnecting blocks, the wallet's balance index knows nothing of it
+		g_pwalletMain->RebuildBalanceIndex();
 	} else {
 		throw JSONRPCError(RPC_WALLET_ERROR, "restclient Error: Sign failed.");
 	}
@@ -1264,16 +1301,17 @@ Value listapp(const Array& params, bool bHelp) {
 	Object obj;
 	Array arrayScript;
 
-	//	CAccountViewCache cView(*g_pAccountViewTip, true);
-	if (g_pScriptDBTip != NULL) {
+	std::shared_ptr<CChainStateSnapshot> pSnapshot = EnsureChainStateSnapshot();
+	CScriptDBViewCache cScriptDBView(pSnapshot->GetScriptDBView(), true);
+	{
 		int nCount(0);
-		if (!g_pScriptDBTip->GetScriptCount(nCount)) {
+		if (!cScriptDBView.GetScriptCount(nCount)) {
 			throw JSONRPCError(RPC_DATABASE_ERROR, "get script error: cannot get registered count.");
 		}
 		CRegID cRegID;
 		vector<unsigned char> vuchScript;
 		Object script;
-		if (!g_pScriptDBTip->GetScript(0, cRegID, vuchScript)) {
+		if (!cScriptDBView.GetScript(0, cRegID, vuchScript)) {
 			throw JSONRPCError(RPC_DATABASE_ERROR, "get script error: cannot get registered script.");
 		}
 		script.push_back(Pair("scriptId", cRegID.ToString()));
@@ -1288,7 +1326,7 @@ Value listapp(const Array& params, bool bHelp) {
 			script.push_back(Pair("scriptContent", HexStr(cVmScript.m_vuchRom.begin(), cVmScript.m_vuchRom.end())));
 		}
 		arrayScript.push_back(script);
-		while (g_pScriptDBTip->GetScript(1, cRegID, vuchScript)) {
+		while (cScriptDBView.GetScript(1, cRegID, vuchScript)) {
 			Object obj;
 			obj.push_back(Pair("scriptId", cRegID.ToString()));
 			obj.push_back(Pair("scriptId2", HexStr(cRegID.GetVec6())));
@@ -1328,12 +1366,14 @@ Value getappinfo(const Array& params, bool bHelp) {
 		throw runtime_error("in getappinfo :scriptid size is error!\n");
 	}
 
-	if (!g_pScriptDBTip->HaveScript(cRegId)) {
+	std::shared_ptr<CChainStateSnapshot> pSnapshot = EnsureChainStateSnapshot();
+	CScriptDBViewCache cScriptDBView(pSnapshot->GetScriptDBView(), true);
+	if (!cScriptDBView.HaveScript(cRegId)) {
 		throw runtime_error("in getappinfo :scriptid  is not exist!\n");
 	}
 
 	vector<unsigned char> vuchScript;
-	if (!g_pScriptDBTip->GetScript(cRegId, vuchScript)) {
+	if (!cScriptDBView.GetScript(cRegId, vuchScript)) {
 		throw JSONRPCError(RPC_DATABASE_ERROR, "get script error: cannot get registered script.");
 	}
 
@@ -1534,7 +1574,8 @@ Value getscriptdata(const Array& params, bool bHelp) {
 						"\nExamples:\n" + HelpExampleCli("getscriptdata", "\"123456789012\"")
 						+ HelpExampleRpc("getscriptdata", "\"123456789012\""));
 	}
-	int nHeight = g_cChainActive.Height();
+	std::shared_ptr<CChainStateSnapshot> pSnapshot = EnsureChainStateSnapshot();
+	int nHeight = pSnapshot->Height();
 	//	//RPCTypeCheck(params, list_of(str_type)(int_type)(int_type));
 	//	vector<unsigned char> vscriptid = ParseHex(params[0].get_str());
 	CRegID cRegId(params[0].get_str());
@@ -1542,12 +1583,12 @@ Value getscriptdata(const Array& params, bool bHelp) {
 		throw runtime_error("in getscriptdata :vscriptid size is error!\n");
 	}
 
-	if (!g_pScriptDBTip->HaveScript(cRegId)) {
+	CScriptDBViewCache cContractScriptTemp(pSnapshot->GetScriptDBView(), true);
+	if (!cContractScriptTemp.HaveScript(cRegId)) {
 		throw runtime_error("in getscriptdata :vscriptid id is exist!\n");
 	}
 	Object script;
 
-	CScriptDBViewCache cContractScriptTemp(*g_pScriptDBTip, true);
 	if (params.size() == 2) {
 		vector<unsigned char> vchKey = ParseHex(params[1].get_str());
 		vector<unsigned char> vchValue;
@@ -2343,12 +2384,11 @@ Value getappkeyvalue(const Array& params, bool bHelp) {
 		if (SysCfg().IsTxIndex()) {
 			ST_DiskTxPos tPosTx;
 			if (g_pScriptDBTip->ReadTxIndex(cTxHash, tPosTx)) {
-				CAutoFile cFile(OpenBlockFile(tPosTx, true), SER_DISK, g_sClientVersion);
 				CBlockHeader cBlockHeader;
 				try {
-					cFile >> cBlockHeader;
-					fseek(cFile, tPosTx.m_unTxOffset, SEEK_CUR);
-					cFile >> pBaseTx;
+					if (!ReadTxFromDisk(tPosTx, cBlockHeader, &pBaseTx)) {
+						throw runtime_error("cannot read the transaction from its block file");
+					}
 					nHeight = cBlockHeader.GetHeight();
 					nTime = cBlockHeader.GetTime();
 				} catch (std::exception &e) {
@@ -2574,11 +2614,14 @@ Value gettotalassets(const Array& params, bool bHelp) {
 			map<vector<unsigned char>, vector<unsigned char>>::iterator it;
 			for (it = mapAcc.begin(); it != mapAcc.end(); ++it) {
 				CAppUserAccout cAppAccOut;
-				vector<unsigned char> vuchKey = it->first;
 				vector<unsigned char> vuchValue = it->second;
 
 				CDataStream cDs(vuchValue, SER_DISK, g_sClientVersion);
 				cDs >> cAppAccOut;
+				// the frozen funds are stored apart from the account record
+				if (!cContractScriptTemp.GetScriptAcc(cRegId, cAppAccOut.getaccUserId(), cAppAccOut)) {
+					throw runtime_error("in gettotalassets :read app account failed!\n");
+				}
 
 				ullTotalassets += cAppAccOut.getllValues();
 				ullTotalassets += cAppAccOut.GetAllFreezedValues();
@@ -1207,6 +1207,10 @@ Value getwalletinfo(const Array& params, bool bHelp) {
             "  \"Inblocktx\": xxxxxxx,       (numeric) the size of transactions in the wallet\n"
             "  \"uncomfirmedtx\": xxxxxx,    (numeric) the size of unconfirmtx transactions in the wallet\n"
             "  \"unlocked_until\": ttt,      (numeric) the timestamp in seconds since epoch (midnight Jan 1 1970 GMT) that the wallet is unlocked for transfers, or 0 if the wallet is locked\n"
+            "  \"lastblocksynctime\": xxx,   (numeric) the time in milliseconds the wallet spent syncing the last block\n"
+            "  \"avgblocksynctime\": xxx,    (numeric) the average time in milliseconds the wallet spent syncing a block\n"
+            "  \"lastblockwritetime\": xxx,  (numeric) the time in milliseconds of the last wallet db batch write\n"
+            "  \"pendingwrites\": xxx,       (numeric) the number of block sync batches waiting to be written to wallet db\n"
             "}\n"
             "\nExamples:\n"
             + HelpExampleCli("getwalletinfo", "")
@@ -1216,10 +1220,21 @@ Value getwalletinfo(const Array& params, bool bHelp) {
 	Object obj;
 	obj.push_back(Pair("walletversion", g_pwalletMain->GetVersion()));
 	obj.push_back(Pair("balance", ValueFromAmount(g_pwalletMain->GetRawBalance())));
-	obj.push_back(Pair("Inblocktx", (int) g_pwalletMain->m_mapInBlockTx.size()));
-	obj.push_back(Pair("unconfirmtx", (int) g_pwalletMain->m_mapUnConfirmTx.size()));
+	{
+		LOCK(g_pwalletMain->m_cs_wallet);
+		obj.push_back(Pair("Inblocktx", (int) g_pwalletMain->m_mapInBlockTx.size()));
+		obj.push_back(Pair("unconfirmtx", (int) g_pwalletMain->m_mapUnConfirmTx.size()));
+	}
 	if (g_pwalletMain->IsCrypted()) {
 		obj.push_back(Pair("unlocked_until", g_llWalletUnlockTime));
 	}
+	{
+		LOCK(g_pwalletMain->m_cs_wallet);
+		uint64_t ullCount = g_pwalletMain->m_ullSyncBlockCount;
+		obj.push_back(Pair("lastblocksynctime", g_pwalletMain->m_llLastBlockSyncTime / 1000.0));
+		obj.push_back(Pair("avgblocksynctime", ullCount ? g_pwalletMain->m_llTotalBlockSyncTime / 1000.0 / ullCount : 0.0));
+		obj.push_back(Pair("lastblockwritetime", g_pwalletMain->m_llLastBlockWriteTime / 1000.0));
+	}
+	obj.push_back(Pair("pendingwrites", (int) g_pwalletMain->GetPendingWriteBatchSize()));
 	return obj;
 }
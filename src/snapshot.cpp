@@ -0,0 +1,397 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "snapshot.h"
+
+#include "chainparams.h"
+#include "checkpoints.h"
+#include "hash.h"
+#include "main.h"
+#include "txdb.h"
+#include "util.h"
+
+#include <functional>
+#include <map>
+#include <memory>
+
+#include <boost/filesystem.hpp>
+
+static const unsigned int SNAPSHOT_MAGIC = 0x504e5344; 	// "DSNP"
+static const int SNAPSHOT_VERSION = 1;
+// block index entries copied per g_cs_main hold while exporting
+static const int SNAPSHOT_INDEX_BATCH = 10000;
+
+static const char *g_arrSnapshotSectionNames[EM_SNAPSHOT_END] = { "blockindex", "account", "script", "txcache" };
+
+const char *GetSnapshotSectionName(emSnapshotSection emSection) {
+	return emSection < EM_SNAPSHOT_END ? g_arrSnapshotSectionNames[emSection] : "end";
+}
+
+struct ST_SnapshotHeader {
+	ST_SnapshotHeader() :
+			unMagic(SNAPSHOT_MAGIC), nVersion(SNAPSHOT_VERSION), nHeight(-1) {
+		memcpy(pchMessageStart, SysCfg().MessageStart(), sizeof(pchMessageStart));
+	}
+
+	unsigned int unMagic;
+	int nVersion;
+	unsigned char pchMessageStart[MESSAGE_START_SIZE]; 	// network the state belongs to
+	uint256 cBlockHash;
+	int nHeight;
+
+	IMPLEMENT_SERIALIZE
+	(
+		READWRITE(unMagic);
+		READWRITE(nVersion);
+		READWRITE(FLATDATA(pchMessageStart));
+		READWRITE(cBlockHash);
+		READWRITE(nHeight);
+	)
+};
+
+template<typename T>
+static vector<unsigned char> SerializeRecord(const T &obj) {
+	CDataStream cDS(SER_DISK, g_sClientVersion);
+	cDS << obj;
+	return vector<unsigned char>(cDS.begin(), cDS.end());
+}
+
+static vector<unsigned char> HashRecordKey(const uint256 &cHash) {
+	return vector<unsigned char>(cHash.begin(), cHash.end());
+}
+
+static leveldb::Slice RecordSlice(const vector<unsigned char> &vchData) {
+	return leveldb::Slice((const char *) vchData.data(), vchData.size());
+}
+
+/** Cuts the records into chunks, writes each followed by its hash and folds the hashes into the root */
+class CSnapshotWriter {
+ public:
+	CSnapshotWriter(FILE *pFile, const ST_SnapshotHeader &tHeader, ST_SnapshotInfo &tInfo) :
+			m_cFile(pFile, SER_DISK, g_sClientVersion), m_cRoot(SER_GETHASH, 0), m_tInfo(tInfo), m_unChunkBytes(0) {
+		m_cFile << tHeader;
+		m_cRoot << tHeader;
+	}
+
+	void Add(emSnapshotSection emSection, vector<unsigned char> &&vchKey, vector<unsigned char> &&vchValue) {
+		if (m_tChunk.chSection != emSection) {
+			Flush();
+			m_tChunk.chSection = emSection;
+		}
+		m_unChunkBytes += vchKey.size() + vchValue.size();
+		m_tChunk.vRecords.push_back(make_pair(std::move(vchKey), std::move(vchValue)));
+		++m_tInfo.arrullRecords[emSection];
+		if (m_unChunkBytes >= SNAPSHOT_CHUNK_BYTES) {
+			Flush();
+		}
+	}
+
+	void Finish() {
+		Flush();
+		WriteChunk(ST_SnapshotChunk());
+		m_tInfo.cRoot = m_cRoot.GetHash();
+		m_cFile << m_tInfo.cRoot;
+		FileCommit(m_cFile);
+	}
+
+ private:
+	void Flush() {
+		if (!m_tChunk.vRecords.empty()) {
+			WriteChunk(m_tChunk);
+			m_tChunk.vRecords.clear();
+		}
+		m_unChunkBytes = 0;
+	}
+
+	void WriteChunk(const ST_SnapshotChunk &tChunk) {
+		uint256 cHash = SerializeHash(tChunk);
+		m_cFile << tChunk << cHash;
+		m_cRoot << cHash;
+		++m_tInfo.ullChunks;
+	}
+
+	CAutoFile m_cFile;
+	CHashWriter m_cRoot;
+	ST_SnapshotInfo &m_tInfo;
+	ST_SnapshotChunk m_tChunk;
+	size_t m_unChunkBytes;
+};
+
+// every record of cDB in key order, a LevelDB iterator over a snapshot wrapper sees that snapshot only
+static void ExportRecords(CSnapshotWriter &cWriter, emSnapshotSection emSection, CLevelDBWrapper &cDB,
+		bool bSkipTxPos) {
+	std::unique_ptr<leveldb::Iterator> pCursor(cDB.NewIterator());
+	for (pCursor->SeekToFirst(); pCursor->Valid(); pCursor->Next()) {
+		leveldb::Slice slKey = pCursor->key();
+		leveldb::Slice slValue = pCursor->value();
+		// tx positions point into block files the loading node does not have
+		if (bSkipTxPos && slKey.starts_with("T")) {
+			continue;
+		}
+		cWriter.Add(emSection, vector<unsigned char>(slKey.data(), slKey.data() + slKey.size()),
+				vector<unsigned char>(slValue.data(), slValue.data() + slValue.size()));
+	}
+	HandleError(pCursor->status());
+}
+
+bool ExportStateSnapshot(const boost::filesystem::path &path, ST_SnapshotInfo &tInfo, string &strError) {
+	std::shared_ptr<CChainStateSnapshot> pState;
+	map<uint256, vector<uint256> > mapTxCache;
+	{
+		LOCK(g_cs_main);
+		pState = GetChainStateSnapshot();
+		if (!pState || pState->Tip() != g_cChainActive.Tip()) {
+			strError = "the chain state is being updated, try again";
+			return false;
+		}
+		mapTxCache = g_pTxCacheTip->GetTxHashCache();
+	}
+
+	ST_SnapshotHeader tHeader;
+	tHeader.cBlockHash = pState->Tip()->GetBlockHash();
+	tHeader.nHeight = pState->Height();
+	tInfo = ST_SnapshotInfo();
+	tInfo.cBlockHash = tHeader.cBlockHash;
+	tInfo.nHeight = tHeader.nHeight;
+
+	boost::filesystem::path tmpPath(path.string() + ".tmp");
+	FILE *pFile = fopen(tmpPath.string().c_str(), "wb");
+	if (pFile == NULL) {
+		strError = strprintf("cannot open %s for writing", tmpPath.string());
+		return false;
+	}
+	LogPrint("INFO", "Exporting the state snapshot at height %d, block %s\n", tHeader.nHeight,
+			tHeader.cBlockHash.GetHex());
+	int64_t llStart = GetTimeMillis();
+	try {
+		CSnapshotWriter cWriter(pFile, tHeader, tInfo);
+		for (int nHeight = 0; nHeight <= tHeader.nHeight; nHeight += SNAPSHOT_INDEX_BATCH) {
+			vector<CDiskBlockIndex> vcBlockIndex;
+			{
+				LOCK(g_cs_main);
+				int nEnd = min(nHeight + SNAPSHOT_INDEX_BATCH, tHeader.nHeight + 1);
+				for (int i = nHeight; i < nEnd; ++i) {
+					vcBlockIndex.push_back(CDiskBlockIndex((*pState)[i]));
+				}
+			}
+			for (auto &cDiskBlockIndex : vcBlockIndex) {
+				cDiskBlockIndex.m_unStatus &= ~(BLOCK_HAVE_DATA | BLOCK_HAVE_UNDO | BLOCK_PRUNED);
+				cDiskBlockIndex.m_nFile = 0;
+				cDiskBlockIndex.m_nDataPos = 0;
+				cDiskBlockIndex.m_nUndoPos = 0;
+				cWriter.Add(EM_SNAPSHOT_BLOCK_INDEX, HashRecordKey(cDiskBlockIndex.GetBlockHash()),
+						SerializeRecord(cDiskBlockIndex));
+			}
+		}
+		ExportRecords(cWriter, EM_SNAPSHOT_ACCOUNT, pState->GetAccountViewDB().GetLevelDB(), false);
+		for (int i = 0; i < EM_SCRIPT_STORE_MAX; ++i) {
+			ExportRecords(cWriter, EM_SNAPSHOT_SCRIPT, pState->GetScriptDB().GetStoreDB((emScriptStore) i),
+					i == EM_SCRIPT_STORE_INDEX);
+		}
+		for (const auto &item : mapTxCache) {
+			if (!item.second.empty()) {
+				cWriter.Add(EM_SNAPSHOT_TX_CACHE, HashRecordKey(item.first), SerializeRecord(item.second));
+			}
+		}
+		cWriter.Finish();
+	} catch (std::exception &e) {
+		boost::filesystem::remove(tmpPath);
+		strError = strprintf("cannot write %s: %s", tmpPath.string(), e.what());
+		return false;
+	}
+	if (!RenameOver(tmpPath, path)) {
+		strError = strprintf("cannot rename %s to %s", tmpPath.string(), path.string());
+		return false;
+	}
+	tInfo.ullBytes = boost::filesystem::file_size(path);
+	LogPrint("INFO", "State snapshot %s written in %dms: %u chunks, %u bytes, root %s\n", path.string(),
+			GetTimeMillis() - llStart, tInfo.ullChunks, tInfo.ullBytes, tInfo.cRoot.GetHex());
+
+	return true;
+}
+
+typedef std::function<bool(const ST_SnapshotChunk &tChunk, string &strError)> SnapshotChunkHandler;
+
+/** Stream a snapshot through fnChunk, checking every chunk hash, the section order and the root */
+static bool ReadSnapshot(const boost::filesystem::path &path, const uint256 &cExpectedRoot, ST_SnapshotInfo &tInfo,
+		string &strError, const SnapshotChunkHandler &fnChunk) {
+	FILE *pFile = fopen(path.string().c_str(), "rb");
+	if (pFile == NULL) {
+		strError = strprintf("cannot open the state snapshot %s", path.string());
+		return false;
+	}
+	CAutoFile cFile(pFile, SER_DISK, g_sClientVersion);
+	CHashWriter cRoot(SER_GETHASH, 0);
+	tInfo = ST_SnapshotInfo();
+	try {
+		ST_SnapshotHeader tHeader;
+		cFile >> tHeader;
+		if (tHeader.unMagic != SNAPSHOT_MAGIC || tHeader.nVersion != SNAPSHOT_VERSION) {
+			strError = strprintf("%s is not a state snapshot of a supported version", path.string());
+			return false;
+		}
+		if (memcmp(tHeader.pchMessageStart, SysCfg().MessageStart(), MESSAGE_START_SIZE) != 0) {
+			strError = strprintf("%s is a state snapshot of another network", path.string());
+			return false;
+		}
+		cRoot << tHeader;
+		tInfo.cBlockHash = tHeader.cBlockHash;
+		tInfo.nHeight = tHeader.nHeight;
+
+		int nSection = EM_SNAPSHOT_BLOCK_INDEX;
+		while (true) {
+			ST_SnapshotChunk tChunk;
+			uint256 cHash;
+			cFile >> tChunk >> cHash;
+			if (SerializeHash(tChunk) != cHash) {
+				strError = strprintf("chunk %u of the state snapshot is corrupt", tInfo.ullChunks);
+				return false;
+			}
+			if (tChunk.chSection < nSection || tChunk.chSection > EM_SNAPSHOT_END) {
+				strError = strprintf("chunk %u of the state snapshot is out of order", tInfo.ullChunks);
+				return false;
+			}
+			nSection = tChunk.chSection;
+			cRoot << cHash;
+			++tInfo.ullChunks;
+			if (nSection == EM_SNAPSHOT_END) {
+				break;
+			}
+			tInfo.arrullRecords[nSection] += tChunk.vRecords.size();
+			if (!fnChunk(tChunk, strError)) {
+				return false;
+			}
+		}
+		uint256 cRootIn;
+		cFile >> cRootIn;
+		tInfo.cRoot = cRoot.GetHash();
+		if (tInfo.cRoot != cRootIn) {
+			strError = "the root commitment of the state snapshot does not match its chunks";
+			return false;
+		}
+	} catch (std::exception &e) {
+		strError = strprintf("cannot read the state snapshot %s: %s", path.string(), e.what());
+		return false;
+	}
+	if (tInfo.cRoot != cExpectedRoot) {
+		strError = strprintf("state snapshot hash %s is not the pinned %s", tInfo.cRoot.GetHex(),
+				cExpectedRoot.GetHex());
+		return false;
+	}
+	tInfo.ullBytes = boost::filesystem::file_size(path);
+
+	return true;
+}
+
+bool VerifyStateSnapshot(const boost::filesystem::path &path, const uint256 &cExpectedRoot, ST_SnapshotInfo &tInfo,
+		string &strError) {
+	// the block index must be the chain from genesis to the snapshot block, consistent with the checkpoints
+	uint256 cPrevHash;
+	int nNextHeight = 0;
+	SnapshotChunkHandler fnCheckChunk = [&](const ST_SnapshotChunk &tChunk, string &strChunkError) -> bool {
+		if (tChunk.chSection != EM_SNAPSHOT_BLOCK_INDEX) {
+			return true;
+		}
+		for (const auto &item : tChunk.vRecords) {
+			CDiskBlockIndex cDiskBlockIndex;
+			CDataStream(item.second, SER_DISK, g_sClientVersion) >> cDiskBlockIndex;
+			uint256 cHash = cDiskBlockIndex.GetBlockHash();
+			if (item.first != HashRecordKey(cHash) || cDiskBlockIndex.m_nHeight != nNextHeight
+					|| cDiskBlockIndex.m_cHashPrev != cPrevHash
+					|| (nNextHeight == 0 && cHash != SysCfg().HashGenesisBlock())
+					|| (cDiskBlockIndex.m_unStatus & (BLOCK_HAVE_DATA | BLOCK_HAVE_UNDO | BLOCK_PRUNED))
+					|| !Checkpoints::CheckBlock(nNextHeight, cHash)) {
+				strChunkError = strprintf("bad block index entry at height %d in the state snapshot", nNextHeight);
+				return false;
+			}
+			cPrevHash = cHash;
+			++nNextHeight;
+		}
+		return true;
+	};
+	if (!ReadSnapshot(path, cExpectedRoot, tInfo, strError, fnCheckChunk)) {
+		return false;
+	}
+	if (cPrevHash != tInfo.cBlockHash || nNextHeight != tInfo.nHeight + 1) {
+		strError = "the block index of the state snapshot does not end at its block";
+		return false;
+	}
+
+	return true;
+}
+
+bool LoadStateSnapshot(const boost::filesystem::path &path, const uint256 &cExpectedRoot, ST_SnapshotInfo &tInfo,
+		string &strError) {
+	int64_t llStart = GetTimeMillis();
+	LogPrint("INFO", "Verifying the state snapshot %s\n", path.string());
+	if (!VerifyStateSnapshot(path, cExpectedRoot, tInfo, strError)) {
+		return false;
+	}
+	LogPrint("INFO", "State snapshot verified in %dms, loading height %d, block %s\n", GetTimeMillis() - llStart,
+			tInfo.nHeight, tInfo.cBlockHash.GetHex());
+
+	g_pblocktree->WriteFlag("snapshotloading", true);
+	g_pblocktree->Sync();
+	SnapshotChunkHandler fnLoadChunk = [](const ST_SnapshotChunk &tChunk, string &strChunkError) -> bool {
+		switch (tChunk.chSection) {
+		case EM_SNAPSHOT_BLOCK_INDEX: {
+			vector<CDiskBlockIndex> vcBlockIndex(tChunk.vRecords.size());
+			for (size_t i = 0; i < tChunk.vRecords.size(); ++i) {
+				CDataStream(tChunk.vRecords[i].second, SER_DISK, g_sClientVersion) >> vcBlockIndex[i];
+			}
+			return g_pblocktree->WriteBlockIndex(vcBlockIndex);
+		}
+		case EM_SNAPSHOT_ACCOUNT: {
+			CLevelDBBatch cBatch;
+			for (const auto &item : tChunk.vRecords) {
+				cBatch.Put(RecordSlice(item.first), RecordSlice(item.second));
+			}
+			return g_pAccountViewDB->GetLevelDB().WriteBatch(cBatch);
+		}
+		case EM_SNAPSHOT_SCRIPT: {
+			CLevelDBBatch arrcBatches[EM_SCRIPT_STORE_MAX];
+			for (const auto &item : tChunk.vRecords) {
+				arrcBatches[CScriptDB::GetStore(item.first)].Put(RecordSlice(item.first), RecordSlice(item.second));
+			}
+			for (int i = 0; i < EM_SCRIPT_STORE_MAX; ++i) {
+				g_pScriptDB->GetStoreDB((emScriptStore) i).WriteBatch(arrcBatches[i]);
+			}
+			return true;
+		}
+		case EM_SNAPSHOT_TX_CACHE: {
+			map<uint256, vector<uint256> > mapTxCache;
+			for (const auto &item : tChunk.vRecords) {
+				if (item.first.size() != sizeof(uint256)) {
+					strChunkError = "bad tx cache entry in the state snapshot";
+					return false;
+				}
+				uint256 cBlockHash(item.first);
+				CDataStream(item.second, SER_DISK, g_sClientVersion) >> mapTxCache[cBlockHash];
+			}
+			return g_pTxCacheDB->BatchWrite(mapTxCache);
+		}
+		default:
+			strChunkError = strprintf("unknown section %d in the state snapshot", tChunk.chSection);
+			return false;
+		}
+	};
+	// the file is read again, a change since it was verified still fails the chunk or root checks
+	if (!ReadSnapshot(path, cExpectedRoot, tInfo, strError, fnLoadChunk)) {
+		return false;
+	}
+	g_pAccountViewDB->GetLevelDB().Sync();
+	for (int i = 0; i < EM_SCRIPT_STORE_MAX; ++i) {
+		g_pScriptDB->GetStoreDB((emScriptStore) i).Sync();
+	}
+	g_pblocktree->WriteFlag("txindex", SysCfg().GetBoolArg("-txindex", true));
+	g_pblocktree->WriteFlag("snapshotloading", false);
+	g_pblocktree->Sync();
+	for (int i = 0; i < EM_SNAPSHOT_END; ++i) {
+		LogPrint("INFO", "Loaded %u %s records\n", tInfo.arrullRecords[i],
+				GetSnapshotSectionName((emSnapshotSection) i));
+	}
+	LogPrint("INFO", "State snapshot loaded in %dms\n", GetTimeMillis() - llStart);
+
+	return true;
+}
@@ -0,0 +1,84 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DACRS_SNAPSHOT_H_
+#define DACRS_SNAPSHOT_H_
+
+#include "serialize.h"
+#include "uint256.h"
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+
+using namespace std;
+
+/** Record bytes of a snapshot chunk, at most this many, so chunks are streamed and hashed piecewise */
+static const size_t SNAPSHOT_CHUNK_BYTES = 4 << 20;
+
+/** What a snapshot holds, in file order */
+enum emSnapshotSection {
+	EM_SNAPSHOT_BLOCK_INDEX = 0, 	// index entries of the active chain up to the snapshot block, without block data
+	EM_SNAPSHOT_ACCOUNT, 			// account database records
+	EM_SNAPSHOT_SCRIPT, 			// script database records, but the "T" positions of transactions in block files
+	EM_SNAPSHOT_TX_CACHE, 			// tx cache: the transaction hashes of the recent blocks
+	EM_SNAPSHOT_END,
+};
+
+struct ST_SnapshotChunk {
+	ST_SnapshotChunk() :
+			chSection(EM_SNAPSHOT_END) {
+	}
+
+	unsigned char chSection;
+	vector<pair<vector<unsigned char>, vector<unsigned char> > > vRecords; 	// raw LevelDB keys and values
+
+	IMPLEMENT_SERIALIZE
+	(
+		READWRITE(chSection);
+		READWRITE(vRecords);
+	)
+};
+
+struct ST_SnapshotInfo {
+	ST_SnapshotInfo() :
+			nHeight(-1), ullChunks(0), ullBytes(0) {
+		for (int i = 0; i < EM_SNAPSHOT_END; ++i) {
+			arrullRecords[i] = 0;
+		}
+	}
+
+	uint256 cBlockHash;
+	int nHeight;
+	uint256 cRoot; 						// hash of the header and of every chunk hash, what -snapshothash pins
+	uint64_t arrullRecords[EM_SNAPSHOT_END];
+	uint64_t ullChunks;
+	uint64_t ullBytes;
+};
+
+const char *GetSnapshotSectionName(emSnapshotSection emSection);
+
+/**
+ * Write the chain state as of the published chain state snapshot: the active chain's block index,
+ * the account and script databases and the tx cache. The file is a header followed by chunks of
+ * sorted records, each chunk followed by its hash, and ends with the root commitment.
+ */
+bool ExportStateSnapshot(const boost::filesystem::path &path, ST_SnapshotInfo &tInfo, string &strError);
+
+/** Read a snapshot through, checking its chunks, block index and root against cExpectedRoot */
+bool VerifyStateSnapshot(const boost::filesystem::path &path, const uint256 &cExpectedRoot, ST_SnapshotInfo &tInfo,
+		string &strError);
+
+/**
+ * Verify the snapshot, then bulk-load it into the freshly created, empty databases. Records arrive in
+ * key order, so they go in as large sequential batches. A load interrupted halfway is detected on the
+ * next start by the "snapshotloading" flag of the block tree.
+ */
+bool LoadStateSnapshot(const boost::filesystem::path &path, const uint256 &cExpectedRoot, ST_SnapshotInfo &tInfo,
+		string &strError);
+
+#endif // DACRS_SNAPSHOT_H_
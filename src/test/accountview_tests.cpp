@@ -220,4 +220,60 @@ BOOST_FIXTURE_TEST_CASE(BatchWrite_test,CAccountViewTest) {
 	BOOST_CHECK(TestGetAccount(false));
 }
 
+BOOST_FIXTURE_TEST_CASE(read_tracking_test,CAccountViewTest) {
+	for (int i = 0; i < 3; i++) {
+		BOOST_CHECK(m_pcViewTip1->SetAccount(CUserID(m_vcRandomKeyID.at(i)), m_vcAccount.at(i)));
+		BOOST_CHECK(m_pcViewTip1->SetKeyId(m_vcRandomRegID.at(i), m_vcRandomKeyID.at(i)));
+	}
+
+	CCriticalSection cs;
+	CReadTrackingAccountView cTrackingView(*m_pcViewTip1, cs);
+	CAccountViewCache cCache(cTrackingView, true);
+	CAccount cAccount;
+	// read without change, read and change, write without read
+	BOOST_CHECK(cCache.GetAccount(CUserID(m_vcRandomRegID.at(0)), cAccount));
+	BOOST_CHECK(cCache.GetAccount(CUserID(m_vcRandomKeyID.at(1)), cAccount));
+	cAccount.m_ullValues += 1;
+	BOOST_CHECK(cCache.SetAccount(CUserID(m_vcRandomKeyID.at(1)), cAccount));
+	BOOST_CHECK(cCache.SetAccount(CUserID(m_vcRandomKeyID.at(3)), m_vcAccount.at(3)));
+	BOOST_CHECK(!cCache.GetKeyId(CUserID(m_vcRandomRegID.at(4)), cAccount.m_cKeyID));
+
+	BOOST_CHECK(cTrackingView.m_setReadAccounts.count(m_vcRandomKeyID.at(0)));
+	BOOST_CHECK(cTrackingView.m_setReadAccounts.count(m_vcRandomKeyID.at(1)));
+	BOOST_CHECK(!cTrackingView.m_setReadAccounts.count(m_vcRandomKeyID.at(2)));
+	BOOST_CHECK(cTrackingView.m_setReadKeyIds.count(m_vcRandomRegID.at(0).GetVec6()));
+	BOOST_CHECK(cTrackingView.m_setReadKeyIds.count(m_vcRandomRegID.at(4).GetVec6()));
+	BOOST_CHECK(!cTrackingView.m_bUntracked);
+
+	map<CKeyID, CAccount> mapAccounts;
+	map<vector<unsigned char>, CKeyID> mapKeyIds;
+	cTrackingView.GetWrites(cCache, mapAccounts, mapKeyIds);
+	BOOST_CHECK_EQUAL(mapAccounts.size(), 2U);
+	BOOST_CHECK(mapAccounts.count(m_vcRandomKeyID.at(1)));
+	BOOST_CHECK(mapAccounts.count(m_vcRandomKeyID.at(3)));
+	BOOST_CHECK(mapKeyIds.empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(cache_size_test,CAccountViewTest) {
+	BOOST_CHECK_EQUAL(m_pcViewTip2->GetCacheSize(), 0U);
+	BOOST_CHECK(m_pcViewTip2->SetAccount(CUserID(m_vcRandomKeyID.at(0)), m_vcAccount.at(0)));
+	size_t unAccountBytes = m_pcViewTip2->GetCacheSize();
+	BOOST_CHECK(unAccountBytes > 0);
+	// overwriting an entry doesn't grow the cache
+	BOOST_CHECK(m_pcViewTip2->SetAccount(CUserID(m_vcRandomKeyID.at(0)), m_vcAccount.at(1)));
+	BOOST_CHECK_EQUAL(m_pcViewTip2->GetCacheSize(), unAccountBytes);
+	BOOST_CHECK(m_pcViewTip2->SetAccount(CUserID(m_vcRandomKeyID.at(1)), m_vcAccount.at(1)));
+	BOOST_CHECK_EQUAL(m_pcViewTip2->GetCacheSize(), 2 * unAccountBytes);
+	BOOST_CHECK(m_pcViewTip2->SetKeyId(m_vcRandomRegID.at(0), m_vcRandomKeyID.at(0)));
+	BOOST_CHECK(m_pcViewTip2->GetCacheSize() > 2 * unAccountBytes);
+
+	CAccountViewCache cCopy(*m_pcViewTip1, true);
+	cCopy.SetCacheMap(m_pcViewTip2->m_mapCacheAccounts, m_pcViewTip2->m_mapCacheKeyIds);
+	BOOST_CHECK_EQUAL(cCopy.GetCacheSize(), m_pcViewTip2->GetCacheSize());
+
+	BOOST_CHECK(m_pcViewTip2->Flush());
+	BOOST_CHECK_EQUAL(m_pcViewTip2->GetCacheSize(), 0U);
+	BOOST_CHECK(m_pcViewTip1->GetCacheSize() >= cCopy.GetCacheSize());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -231,6 +231,61 @@ BOOST_AUTO_TEST_CASE(checkappacct_test) {
 		BOOST_CHECK(CheckAppAcct(g_arrllOpValue[j]) == bIsCheck);
 	}
 }
+
+BOOST_AUTO_TEST_CASE(freezed_fund_store) {
+	vector<unsigned char> vuchUserId = { 'u', 's', 'e', 'r' };
+	vector<unsigned char> vuchTag1 = { 't', '1' };
+	vector<unsigned char> vuchTag2 = { 't', '2' };
+	CRegID cAppId(100, 1);
+	CScriptDB cDB(size_t(1 << 20), true, false);
+
+	CAppUserAccout cAcc(vuchUserId);
+	BOOST_CHECK(cAcc.AddAppCFund(vuchTag2, 30, 300));
+	BOOST_CHECK(cAcc.AddAppCFund(vuchTag1, 10, 100));
+	BOOST_CHECK(cAcc.AddAppCFund(vuchTag2, 20, 200));
+	BOOST_CHECK_EQUAL(cAcc.getChangedFund().size(), 3U);
+	vector<CAppCFund> vcFund = cAcc.getFreezedFund();
+	BOOST_CHECK_EQUAL(vcFund.size(), 3U);
+	BOOST_CHECK_EQUAL(vcFund[0].getHeight(), 100);
+	BOOST_CHECK_EQUAL(vcFund[2].getHeight(), 300);
+	{
+		CScriptDBViewCache cView(cDB, true);
+		vector<CScriptDBOperLog> vcLog;
+		BOOST_CHECK(cView.SetScriptAcc(cAppId, cAcc, vcLog));
+		BOOST_CHECK_EQUAL(vcLog.size(), 4U);
+		BOOST_CHECK(cView.Flush());
+	}
+
+	CScriptDBViewCache cView(cDB, true);
+	CAppUserAccout cRead;
+	BOOST_CHECK(cView.GetScriptAcc(cAppId, vuchUserId, cRead));
+	BOOST_CHECK(cRead.getChangedFund().empty());
+	BOOST_CHECK_EQUAL(cRead.GetAllFreezedValues(), 60U);
+	CAppCFund cFund;
+	BOOST_CHECK(cRead.GetAppCFund(cFund, vuchTag2, 200));
+	BOOST_CHECK_EQUAL(cFund.getValue(), 20U);
+
+	// only the matured funds are rewritten, and undoing the log restores them
+	BOOST_CHECK(cRead.AutoMergeFreezeToFree(0, 200));
+	BOOST_CHECK_EQUAL(cRead.getllValues(), 30U);
+	BOOST_CHECK_EQUAL(cRead.getChangedFund().size(), 2U);
+	vector<CScriptDBOperLog> vcLog;
+	BOOST_CHECK(cView.SetScriptAcc(cAppId, cRead, vcLog));
+	BOOST_CHECK_EQUAL(vcLog.size(), 3U);
+
+	CAppUserAccout cMerged;
+	BOOST_CHECK(cView.GetScriptAcc(cAppId, vuchUserId, cMerged));
+	BOOST_CHECK_EQUAL(cMerged.getFreezedFund().size(), 1U);
+	BOOST_CHECK_EQUAL(cMerged.GetAllFreezedValues(), 30U);
+
+	for (auto it = vcLog.rbegin(); it != vcLog.rend(); ++it) {
+		BOOST_CHECK(cView.UndoScriptData(it->m_vchKey, it->m_vchValue));
+	}
+	CAppUserAccout cUndone;
+	BOOST_CHECK(cView.GetScriptAcc(cAppId, vuchUserId, cUndone));
+	BOOST_CHECK_EQUAL(cUndone.getllValues(), 0U);
+	BOOST_CHECK_EQUAL(cUndone.GetAllFreezedValues(), 60U);
+}
 BOOST_AUTO_TEST_SUITE_END()
 
 
@@ -0,0 +1,169 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "main.h"
+#include "database.h"
+#include "key.h"
+#include "tx.h"
+#include "txdb.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+namespace {
+
+const int g_kAccountHeight = 1000000;	// regids far above the test chain
+const unsigned int g_kAccountCount = 6;
+
+CKeyID ExecKeyId(unsigned int i) {
+	uint160 cId;
+	cId.SetHex(strprintf("%x", 0xbe000 + i));
+	return CKeyID(cId);
+}
+
+CRegID ExecRegId(unsigned int i) {
+	return CRegID(g_kAccountHeight, i);
+}
+
+vector<unsigned char> SerializeAccount(const CAccount &cAccount) {
+	CDataStream cDS(SER_DISK, g_sClientVersion);
+	cDS << cAccount;
+	return vector<unsigned char>(cDS.begin(), cDS.end());
+}
+
+// Executes cBlock on fresh caches over cBase, the way ConnectBlock does
+class CBlockExecution {
+ public:
+	CBlockExecution(CAccountViewCache &cBase, CScriptDBViewCache &cScriptBase, CBlock &cBlock, bool bParallel) :
+			m_cAccountCache(cBase, true), m_cScriptCache(cScriptBase, true), m_cTxCache(*g_pTxCacheTip, true),
+			m_llTotalFuel(0) {
+		m_bExecuted = ExecuteBlockTxs(cBlock, m_cValidationState, m_cAccountCache, m_cTxCache, m_cScriptCache,
+				g_cChainActive.Height() + 1, bParallel, m_vcTxUndo, m_llTotalFuel);
+	}
+
+	CAccountViewCache m_cAccountCache;
+	CScriptDBViewCache m_cScriptCache;
+	CTransactionDBCache m_cTxCache;
+	CValidationState m_cValidationState;
+	vector<CTxUndo> m_vcTxUndo;
+	int64_t m_llTotalFuel;
+	bool m_bExecuted;
+};
+
+}
+
+BOOST_AUTO_TEST_SUITE(blockexec_tests)
+
+BOOST_AUTO_TEST_CASE(parallel_matches_serial)
+{
+	LOCK(g_cs_main);
+	int nHeight = g_cChainActive.Height();
+
+	// accounts 0, 2 and 3 are funded, 1 and 4 are registered but empty, 5 has only a key id and funds
+	CAccountViewCache cBase(*g_pAccountViewTip, true);
+	CScriptDBViewCache cScriptBase(*g_pScriptDBTip, true);
+	for (unsigned int i = 0; i < g_kAccountCount - 1; ++i) {
+		CAccount cAccount;
+		cAccount.m_cKeyID = ExecKeyId(i);
+		cAccount.SetRegId(ExecRegId(i));
+		cAccount.m_ullValues = (i == 1 || i == 4) ? 0 : 100 * COIN;
+		BOOST_CHECK(cBase.SaveAccountInfo(ExecRegId(i), cAccount.m_cKeyID, cAccount));
+	}
+	CKey cNewKey;
+	cNewKey.MakeNewKey(true);
+	CPubKey cNewPubKey = cNewKey.GetPubKey();
+	CAccount cUnregistered;
+	cUnregistered.m_cKeyID = cNewPubKey.GetKeyID();
+	cUnregistered.m_ullValues = 10 * COIN;
+	BOOST_CHECK(cBase.SetAccount(CUserID(cUnregistered.m_cKeyID), cUnregistered));
+
+	CBlock cBlock;
+	cBlock.SetHeight(nHeight + 1);
+	cBlock.vptx.push_back(std::make_shared<CRewardTransaction>());
+	// 1: funds account 1
+	cBlock.vptx.push_back(std::make_shared<CTransaction>(ExecRegId(0), ExecKeyId(1), 10000, 5 * COIN, nHeight));
+	// 2: spends what 1 paid in, its speculative run fails on the empty account and runs again in order
+	cBlock.vptx.push_back(std::make_shared<CTransaction>(ExecRegId(1), ExecKeyId(4), 10000, 2 * COIN, nHeight));
+	// 3: independent of the others, its speculative run is merged as is
+	cBlock.vptx.push_back(std::make_shared<CTransaction>(ExecRegId(2), ExecKeyId(3), 10000, COIN, nHeight));
+	// 4: registers the key of account 5
+	cBlock.vptx.push_back(std::make_shared<CRegisterAccountTx>(CUserID(cNewPubKey), CUserID(CNullID()), 10000,
+			nHeight));
+	// 5: reads account 0 after 1 wrote it, a conflict that forces another run
+	cBlock.vptx.push_back(std::make_shared<CTransaction>(ExecRegId(0), ExecKeyId(3), 10000, 3 * COIN, nHeight));
+
+	CBlockExecution cSerial(cBase, cScriptBase, cBlock, false);
+	CBlockExecution cParallel(cBase, cScriptBase, cBlock, true);
+	BOOST_REQUIRE(cSerial.m_bExecuted);
+	BOOST_REQUIRE(cParallel.m_bExecuted);
+	BOOST_CHECK_EQUAL(cSerial.m_llTotalFuel, cParallel.m_llTotalFuel);
+
+	// same account state
+	for (unsigned int i = 0; i < g_kAccountCount - 1; ++i) {
+		CAccount cSerialAccount, cParallelAccount;
+		BOOST_CHECK(cSerial.m_cAccountCache.GetAccount(CUserID(ExecKeyId(i)), cSerialAccount));
+		BOOST_CHECK(cParallel.m_cAccountCache.GetAccount(CUserID(ExecKeyId(i)), cParallelAccount));
+		BOOST_CHECK(SerializeAccount(cSerialAccount) == SerializeAccount(cParallelAccount));
+	}
+	CAccount cAccount;
+	BOOST_CHECK(cSerial.m_cAccountCache.GetAccount(CUserID(ExecKeyId(1)), cAccount));
+	BOOST_CHECK_EQUAL(cAccount.m_ullValues, 3 * COIN - 10000);
+	BOOST_CHECK(cSerial.m_cAccountCache.GetAccount(CUserID(ExecKeyId(0)), cAccount));
+	BOOST_CHECK_EQUAL(cAccount.m_ullValues, 92 * COIN - 20000);
+
+	CRegID cNewRegId(nHeight + 1, 4);
+	CKeyID cSerialKeyId, cParallelKeyId;
+	BOOST_CHECK(cSerial.m_cAccountCache.GetKeyId(CUserID(cNewRegId), cSerialKeyId));
+	BOOST_CHECK(cParallel.m_cAccountCache.GetKeyId(CUserID(cNewRegId), cParallelKeyId));
+	BOOST_CHECK(cSerialKeyId == cNewPubKey.GetKeyID());
+	BOOST_CHECK(cParallelKeyId == cSerialKeyId);
+	CAccount cSerialNew, cParallelNew;
+	BOOST_CHECK(cSerial.m_cAccountCache.GetAccount(CUserID(cNewPubKey.GetKeyID()), cSerialNew));
+	BOOST_CHECK(cParallel.m_cAccountCache.GetAccount(CUserID(cNewPubKey.GetKeyID()), cParallelNew));
+	BOOST_CHECK(SerializeAccount(cSerialNew) == SerializeAccount(cParallelNew));
+
+	// same script state
+	BOOST_CHECK(cSerial.m_cScriptCache.m_mapDatas == cParallel.m_cScriptCache.m_mapDatas);
+
+	// same undo records
+	BOOST_REQUIRE_EQUAL(cSerial.m_vcTxUndo.size(), cBlock.vptx.size() - 1);
+	BOOST_REQUIRE_EQUAL(cParallel.m_vcTxUndo.size(), cSerial.m_vcTxUndo.size());
+	for (unsigned int i = 0; i < cSerial.m_vcTxUndo.size(); ++i) {
+		CDataStream cSerialDS(SER_DISK, g_sClientVersion);
+		CDataStream cParallelDS(SER_DISK, g_sClientVersion);
+		cSerialDS << cSerial.m_vcTxUndo[i];
+		cParallelDS << cParallel.m_vcTxUndo[i];
+		BOOST_CHECK(cSerialDS.str() == cParallelDS.str());
+	}
+}
+
+BOOST_AUTO_TEST_CASE(parallel_fails_like_serial)
+{
+	LOCK(g_cs_main);
+	int nHeight = g_cChainActive.Height();
+
+	CAccountViewCache cBase(*g_pAccountViewTip, true);
+	CScriptDBViewCache cScriptBase(*g_pScriptDBTip, true);
+	CAccount cAccount;
+	cAccount.m_cKeyID = ExecKeyId(0);
+	cAccount.SetRegId(ExecRegId(0));
+	cAccount.m_ullValues = COIN;
+	BOOST_CHECK(cBase.SaveAccountInfo(ExecRegId(0), cAccount.m_cKeyID, cAccount));
+
+	// the second spend only fits the starting balance, in order it runs out of funds
+	CBlock cBlock;
+	cBlock.SetHeight(nHeight + 1);
+	cBlock.vptx.push_back(std::make_shared<CRewardTransaction>());
+	cBlock.vptx.push_back(std::make_shared<CTransaction>(ExecRegId(0), ExecKeyId(1), 10000, COIN / 2, nHeight));
+	cBlock.vptx.push_back(std::make_shared<CTransaction>(ExecRegId(0), ExecKeyId(2), 10000, COIN / 2, nHeight));
+
+	CBlockExecution cSerial(cBase, cScriptBase, cBlock, false);
+	CBlockExecution cParallel(cBase, cScriptBase, cBlock, true);
+	BOOST_CHECK(!cSerial.m_bExecuted);
+	BOOST_CHECK(!cParallel.m_bExecuted);
+	BOOST_CHECK_EQUAL(cParallel.m_cValidationState.GetRejectReason(), cSerial.m_cValidationState.GetRejectReason());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -60,4 +60,58 @@ BOOST_AUTO_TEST_CASE(May15) {
 	SetMockTime(0);
 }
 
+BOOST_AUTO_TEST_CASE(assume_valid) {
+	LOCK(g_cs_main);
+	string strOldValue = SysCfg().GetArg("-assumevalid", "");
+	CBlockIndex *pGenesis = g_cChainActive.Genesis();
+	BOOST_REQUIRE(pGenesis != NULL);
+
+	int nHeight = 0;
+	SysCfg().SoftSetArgCover("-assumevalid", "0");
+	InitAssumeValid();
+	BOOST_CHECK(GetAssumeValidBlock(nHeight).IsNull());
+	BOOST_CHECK_EQUAL(nHeight, -1);
+	BOOST_CHECK(!IsAssumedValid(pGenesis));
+
+	SysCfg().SoftSetArgCover("-assumevalid", pGenesis->GetBlockHash().GetHex());
+	InitAssumeValid();
+	BOOST_CHECK(GetAssumeValidBlock(nHeight) == pGenesis->GetBlockHash());
+	BOOST_CHECK_EQUAL(nHeight, 0);
+	BOOST_CHECK(IsAssumedValid(pGenesis));
+	BOOST_CHECK(!IsAssumedValid(NULL));
+	if (g_cChainActive.Height() > 0) {
+		BOOST_CHECK(!IsAssumedValid(g_cChainActive.Tip()));
+	}
+
+	// the argument is only read by InitAssumeValid
+	SysCfg().SoftSetArgCover("-assumevalid", "0");
+	BOOST_CHECK(GetAssumeValidBlock(nHeight) == pGenesis->GetBlockHash());
+
+	// a block that is not indexed yet vouches for nothing, whatever its height
+	SysCfg().SoftSetArgCover("-assumevalid", GetRandHash().GetHex());
+	InitAssumeValid();
+	BOOST_CHECK(!GetAssumeValidBlock(nHeight).IsNull());
+	BOOST_CHECK(!IsAssumedValid(pGenesis));
+	if (g_cChainActive.Height() > 0) {
+		BOOST_CHECK(!IsAssumedValid(g_cChainActive.Tip()));
+	}
+
+	// a block at the right height that is not an ancestor is not assumed valid
+	if (g_cChainActive.Height() > 1) {
+		SysCfg().SoftSetArgCover("-assumevalid", g_cChainActive.Tip()->GetBlockHash().GetHex());
+		InitAssumeValid();
+		CBlockIndex *pParent = g_cChainActive.Tip()->m_pPrevBlockIndex;
+		BOOST_CHECK(IsAssumedValid(pParent));
+		CBlockIndex cSibling(*pParent);
+		BOOST_CHECK(!IsAssumedValid(&cSibling));
+	}
+
+	if (strOldValue.empty()) {
+		SysCfg().EraseArg("-assumevalid");
+	} else {
+		SysCfg().SoftSetArgCover("-assumevalid", strOldValue);
+	}
+	InitAssumeValid();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,131 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "compress.h"
+#include "main.h"
+#include "util.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+// Data shaped like block files: random hashes and signatures between repeated fields
+static vector<unsigned char> MakeData(size_t unSize, int nRandomPercent) {
+	vector<unsigned char> vchData(unSize);
+	const char *pszField = "dacrs block record field ";
+	for (size_t i = 0; i < unSize; ++i) {
+		vchData[i] = (int) (i % 100) < nRandomPercent ? (unsigned char) GetRand(256)
+				: (unsigned char) pszField[i % strlen(pszField)];
+	}
+	return vchData;
+}
+
+BOOST_AUTO_TEST_SUITE(compress_tests)
+
+BOOST_AUTO_TEST_CASE(lz4_roundtrip) {
+	const size_t arrunSizes[] = { 0, 1, 12, 13, 100, 4096, 70000, 1000000 };
+	const int arrnRandom[] = { 0, 30, 100 };
+	for (size_t unSize : arrunSizes) {
+		for (int nRandom : arrnRandom) {
+			vector<unsigned char> vchData = MakeData(unSize, nRandom);
+			vector<unsigned char> vchCompressed;
+			CompressLZ4(vchData.data(), vchData.size(), vchCompressed);
+			vector<unsigned char> vchOut(unSize + 1);
+			BOOST_CHECK(DecompressLZ4(vchCompressed.data(), vchCompressed.size(), vchOut.data(), unSize));
+			BOOST_CHECK(equal(vchData.begin(), vchData.end(), vchOut.begin()));
+			// the size must be exact
+			BOOST_CHECK(!DecompressLZ4(vchCompressed.data(), vchCompressed.size(), vchOut.data(), unSize + 1));
+			if (unSize > 0) {
+				BOOST_CHECK(!DecompressLZ4(vchCompressed.data(), vchCompressed.size(), vchOut.data(), unSize - 1));
+				BOOST_CHECK(!DecompressLZ4(vchCompressed.data(), vchCompressed.size() - 1, vchOut.data(), unSize));
+			}
+			if (nRandom == 0 && unSize >= 4096) {
+				BOOST_CHECK(vchCompressed.size() < unSize / 10);
+			}
+			// a prefix decodes from a cut short input
+			size_t unPrefix = unSize / 3;
+			vector<unsigned char> vchPrefix(unPrefix + 1);
+			BOOST_CHECK(DecompressLZ4(vchCompressed.data(), min(vchCompressed.size(), 2 * unPrefix + 16),
+					vchPrefix.data(), unPrefix, true));
+			BOOST_CHECK(equal(vchPrefix.begin(), vchPrefix.begin() + unPrefix, vchData.begin()));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(lz4_corrupt) {
+	vector<unsigned char> vchData = MakeData(20000, 30);
+	vector<unsigned char> vchCompressed;
+	CompressLZ4(vchData.data(), vchData.size(), vchCompressed);
+	vector<unsigned char> vchOut(vchData.size());
+	// a copy from before the start of the output
+	vector<unsigned char> vchBad = { 0x14, 'a', 0x05, 0x00 };
+	BOOST_CHECK(!DecompressLZ4(vchBad.data(), vchBad.size(), vchOut.data(), 9));
+	// flipped bits fail or decode to something else, but never read or write out of bounds
+	for (int i = 0; i < 1000; ++i) {
+		vchBad = vchCompressed;
+		vchBad[GetRand(vchBad.size())] ^= 1 << GetRand(8);
+		DecompressLZ4(vchBad.data(), vchBad.size(), vchOut.data(), vchOut.size());
+	}
+}
+
+BOOST_AUTO_TEST_CASE(disk_record) {
+	const CBlock &cGenesis = SysCfg().GenesisBlock();
+	boost::filesystem::path path = GetDataDir() / "compress_tests.dat";
+	unsigned int arrunPos[2];
+	{
+		FILE *pFile = fopen(path.string().c_str(), "wb");
+		BOOST_REQUIRE(pFile != NULL);
+		CAutoFile cFileout(pFile, SER_DISK, g_sClientVersion);
+		for (int i = 0; i < 2; ++i) {
+			CDiskRecord cRecord;
+			cRecord.Pack(cGenesis, i == 1);
+			BOOST_CHECK_EQUAL(cRecord.IsCompressed(), i == 1);
+			if (i == 0) {
+				BOOST_CHECK_EQUAL(cRecord.GetDiskSize(), ::GetSerializeSize(cGenesis, SER_DISK, g_sClientVersion) + 8);
+			}
+			BOOST_CHECK(cRecord.Write(cFileout, arrunPos[i]));
+		}
+	}
+	// both records are read back the same, from the same file
+	for (int i = 0; i < 2; ++i) {
+		FILE *pFile = fopen(path.string().c_str(), "rb");
+		BOOST_REQUIRE(pFile != NULL);
+		CAutoFile cFilein(pFile, SER_DISK, g_sClientVersion);
+		BOOST_REQUIRE(fseek(cFilein, arrunPos[i], SEEK_SET) == 0);
+		CDataStream ssBlock(SER_DISK, g_sClientVersion);
+		BOOST_REQUIRE(ReadDiskRecord(cFilein, ssBlock));
+		CBlock cBlock;
+		ssBlock >> cBlock;
+		BOOST_CHECK(cBlock.GetHash() == cGenesis.GetHash());
+	}
+	boost::filesystem::remove(path);
+
+	// data that does not compress is stored as it is
+	CDiskRecord cRecord;
+	cRecord.Pack(MakeData(1000, 100), true);
+	BOOST_CHECK(!cRecord.IsCompressed());
+}
+
+// Not a check: logs the ratio and speed of the codec on block-like data, run with --log_level=message
+BOOST_AUTO_TEST_CASE(lz4_benchmark) {
+	const int arrnRandom[] = { 10, 30, 60 };
+	for (int nRandom : arrnRandom) {
+		vector<unsigned char> vchData = MakeData(8 << 20, nRandom);
+		vector<unsigned char> vchCompressed;
+		int64_t llStart = GetTimeMicros();
+		CompressLZ4(vchData.data(), vchData.size(), vchCompressed);
+		int64_t llCompress = max(GetTimeMicros() - llStart, (int64_t) 1);
+		vector<unsigned char> vchOut(vchData.size());
+		llStart = GetTimeMicros();
+		BOOST_CHECK(DecompressLZ4(vchCompressed.data(), vchCompressed.size(), vchOut.data(), vchOut.size()));
+		int64_t llDecompress = max(GetTimeMicros() - llStart, (int64_t) 1);
+		BOOST_TEST_MESSAGE(strprintf("lz4 %d%% random: ratio %.2f, compress %.0fMB/s, decompress %.0fMB/s", nRandom,
+				(double) vchCompressed.size() / vchData.size(), (double) vchData.size() / llCompress,
+				(double) vchData.size() / llDecompress));
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,80 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "eventserver.h"
+#include "serialize.h"
+#include "tx.h"
+#include "version.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(eventserver_tests)
+
+BOOST_AUTO_TEST_CASE(eventfilter_parse) {
+	vector<unsigned char> vchApp1 = CRegID(11, 1).GetVec6();
+	vector<unsigned char> vchApp2 = CRegID(12, 1).GetVec6();
+	ST_EventFilter tFilter;
+	string strError;
+	BOOST_CHECK(tFilter.Matches(EM_EVENT_APP_TX, vchApp2));
+
+	BOOST_CHECK(tFilter.Parse("{\"topics\":[\"block\",\"apptx\"],\"apps\":[\"11-1\"]}", strError));
+	BOOST_CHECK(tFilter.Matches(EM_EVENT_BLOCK, vector<unsigned char>()));
+	BOOST_CHECK(!tFilter.Matches(EM_EVENT_MEMPOOL_REMOVE, vector<unsigned char>()));
+	BOOST_CHECK(tFilter.Matches(EM_EVENT_APP_TX, vchApp1));
+	BOOST_CHECK(!tFilter.Matches(EM_EVENT_APP_TX, vchApp2));
+	BOOST_CHECK(!tFilter.bBinary);
+
+	// members left out keep their value, a bad request changes nothing
+	BOOST_CHECK(tFilter.Parse("{\"format\":\"binary\"}", strError));
+	BOOST_CHECK(tFilter.bBinary);
+	BOOST_CHECK(tFilter.Matches(EM_EVENT_APP_TX, vchApp1));
+	BOOST_CHECK(!tFilter.Parse("{\"topics\":[\"block\",\"blocks\"]}", strError));
+	BOOST_CHECK(!tFilter.Parse("{\"apps\":[\"abc\"]}", strError));
+	BOOST_CHECK(!tFilter.Parse("[\"block\"]", strError));
+	BOOST_CHECK(tFilter.Matches(EM_EVENT_BLOCK, vector<unsigned char>()));
+	BOOST_CHECK(!tFilter.Matches(EM_EVENT_APP_TX, vchApp2));
+}
+
+BOOST_AUTO_TEST_CASE(event_frames) {
+	ST_Event tEvent(EM_EVENT_BLOCK);
+	tEvent.cHash = uint256S("0x1234");
+	tEvent.nHeight = 100;
+	tEvent.llTime = 1430000000;
+
+	string strData = CEventServer::ToBinary(tEvent);
+	CDataStream cDs(strData.data(), strData.data() + strData.size(), SER_DISK, g_sClientVersion);
+	unsigned char uchType;
+	uint256 cHash;
+	int nHeight;
+	int64_t llTime;
+	cDs >> uchType >> cHash >> nHeight >> llTime;
+	BOOST_CHECK_EQUAL(uchType, EM_EVENT_BLOCK);
+	BOOST_CHECK(cHash == tEvent.cHash);
+	BOOST_CHECK_EQUAL(nHeight, 100);
+	BOOST_CHECK_EQUAL(llTime, 1430000000);
+
+	string strFrame = strData;
+	BOOST_CHECK(CEventServer::Frame(strFrame, true));
+	BOOST_CHECK_EQUAL(strFrame.size(), strData.size() + 5);
+	BOOST_CHECK_EQUAL(strFrame[0], 'B');
+	BOOST_CHECK_EQUAL((unsigned char) strFrame[1], strData.size());
+	BOOST_CHECK(strFrame.substr(5) == strData);
+
+	ST_Event tRemove(EM_EVENT_MEMPOOL_REMOVE);
+	tRemove.cHash = uint256S("0x5678");
+	strData = CEventServer::ToJson(tRemove);
+	BOOST_CHECK(strData.find("\"rmtx\"") != string::npos);
+	BOOST_CHECK(strData.find(tRemove.cHash.ToString()) != string::npos);
+	strFrame = strData;
+	BOOST_CHECK(CEventServer::Frame(strFrame, false));
+	BOOST_CHECK_EQUAL(strFrame[0], '<');
+	BOOST_CHECK_EQUAL(strFrame[strFrame.size() - 1], '>');
+	BOOST_CHECK(strFrame.substr(3, strData.size()) == strData);
+
+	// JSON frames carry a 16 bit length
+	string strLarge(0x10000, 'x');
+	BOOST_CHECK(!CEventServer::Frame(strLarge, false));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -31,4 +31,31 @@ BOOST_AUTO_TEST_CASE(subsidy_limit_test) {
 	}
 }
 
+BOOST_AUTO_TEST_CASE(block_phase_stats_test) {
+	ResetBlockPhaseTimes();
+	AddBlockPhaseTime(EM_BLOCK_PHASE_CHECKBLOCK, 0);
+	AddBlockPhaseTime(EM_BLOCK_PHASE_CHECKBLOCK, 3);
+	AddBlockPhaseTime(EM_BLOCK_PHASE_CHECKBLOCK, 1000);
+	AddBlockPhaseTime(EM_BLOCK_PHASE_CHECKBLOCK, 1LL << 40);
+	const ST_BlockPhaseStats &tStats = g_arrtBlockPhaseStats[EM_BLOCK_PHASE_CHECKBLOCK];
+	BOOST_CHECK_EQUAL(tStats.ullCalls, 4U);
+	BOOST_CHECK_EQUAL(tStats.llMicros, 1003 + (1LL << 40));
+	BOOST_CHECK_EQUAL(tStats.llMaxMicros, 1LL << 40);
+	BOOST_CHECK_EQUAL(tStats.arrullBuckets[0], 1U); 	// < 1us
+	BOOST_CHECK_EQUAL(tStats.arrullBuckets[2], 1U); 	// < 4us
+	BOOST_CHECK_EQUAL(tStats.arrullBuckets[10], 1U); 	// < 1024us
+	BOOST_CHECK_EQUAL(tStats.arrullBuckets[BLOCK_PHASE_BUCKETS - 1], 1U);
+	BOOST_CHECK_EQUAL(g_arrtBlockPhaseStats[EM_BLOCK_PHASE_FLUSH].ullCalls, 0U);
+
+	{
+		CBlockPhaseTimer cTimer(EM_BLOCK_PHASE_FLUSH);
+	}
+	BOOST_CHECK_EQUAL(g_arrtBlockPhaseStats[EM_BLOCK_PHASE_FLUSH].ullCalls, 1U);
+	BOOST_CHECK_EQUAL(GetExecutePhase(EM_CONTRACT_TX), EM_BLOCK_PHASE_EXECUTE_CONTRACT);
+
+	ResetBlockPhaseTimes();
+	BOOST_CHECK_EQUAL(tStats.ullCalls, 0U);
+	BOOST_CHECK_EQUAL(tStats.arrullBuckets[BLOCK_PHASE_BUCKETS - 1], 0U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,154 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "main.h"
+#include "database.h"
+#include "txmempool.h"
+#include "tx.h"
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+namespace {
+
+CTxMemPoolEntry MakeEntry(uint64_t ullFee, int nValidHeight, int64_t llTime, const CKeyID &cSource) {
+	vector_unsigned_char vchContract(10 + ullFee % 7, 0x01);
+	CTransaction cTx(CRegID(100, 1), CRegID(200, 2), ullFee, 10000, nValidHeight, vchContract);
+	CTxMemPoolEntry cEntry(&cTx, ullFee, llTime, 0.0, 1);
+	cEntry.UpdateFeePerKb(1);
+	cEntry.SetSourceKeyId(cSource);
+	return cEntry;
+}
+
+CKeyID PoolKeyId(unsigned int i) {
+	uint160 cId;
+	cId.SetHex(strprintf("%x", 0xbf000 + i));
+	return CKeyID(cId);
+}
+
+CRegID PoolRegId(unsigned int i) {
+	return CRegID(1000000, i);	// far above the test chain
+}
+
+bool AddToPool(CTxMemPool &cPool, unsigned int nSrc, unsigned int nDest, uint64_t ullFee, uint64_t ullValue,
+		int64_t llTime) {
+	CTransaction cTx(PoolRegId(nSrc), PoolKeyId(nDest), ullFee, ullValue, g_cChainActive.Height());
+	CTxMemPoolEntry cEntry(&cTx, ullFee, llTime, 0.0, g_cChainActive.Height());
+	CValidationState cState;
+	return cPool.addUnchecked(cEntry.GetHash(), cEntry, cState);
+}
+
+vector<unsigned char> PoolAccount(CTxMemPool &cPool, unsigned int i) {
+	CAccount cAccount;
+	CDataStream cDS(SER_DISK, g_sClientVersion);
+	if (cPool.m_pAccountViewCache->GetAccount(CUserID(PoolKeyId(i)), cAccount)) {
+		cDS << cAccount;
+	}
+	return vector<unsigned char>(cDS.begin(), cDS.end());
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(mempool_tests)
+
+BOOST_AUTO_TEST_CASE(entry_cache)
+{
+	CTxMemPoolEntry cEntry = MakeEntry(100000, 10, 1, CKeyID());
+	BOOST_CHECK(cEntry.GetHash() == cEntry.GetTx()->GetHash());
+	BOOST_CHECK_EQUAL(cEntry.GetFuelRate(), 1);
+	double dExpected = 100000.0 / (cEntry.GetTxSize() / 1000.0);
+	BOOST_CHECK_CLOSE(cEntry.GetFeePerKb(), dExpected, 1e-9);
+	BOOST_CHECK_CLOSE(cEntry.GetFeePerKb(100), dExpected, 1e-9);
+	BOOST_CHECK_EQUAL(cEntry.GetExpiryHeight(), 10 + SysCfg().GetTxCacheHeight() / 2);
+
+	// copies own their transaction
+	CTxMemPoolEntry cCopy(cEntry);
+	BOOST_CHECK(cCopy.GetTx() != cEntry.GetTx());
+	BOOST_CHECK(cCopy.GetHash() == cEntry.GetHash());
+	BOOST_CHECK(cCopy.GetUsage() == cEntry.GetUsage());
+}
+
+BOOST_AUTO_TEST_CASE(indexes)
+{
+	CKeyID cSourceA(uint160S("01"));
+	CKeyID cSourceB(uint160S("02"));
+	IndexedTxSet cSet;
+	cSet.insert(MakeEntry(3000, 30, 2, cSourceA));
+	cSet.insert(MakeEntry(1000, 50, 3, cSourceB));
+	cSet.insert(MakeEntry(2000, 10, 1, cSourceA));
+	BOOST_CHECK_EQUAL(cSet.size(), 3U);
+
+	const IndexedTxSet::index<ST_FeeRateTag>::type &cByFeeRate = cSet.get<ST_FeeRateTag>();
+	BOOST_CHECK_EQUAL(cByFeeRate.begin()->GetFee(), 1000);
+	BOOST_CHECK_EQUAL(cByFeeRate.rbegin()->GetFee(), 3000);
+
+	const IndexedTxSet::index<ST_EntryTimeTag>::type &cByTime = cSet.get<ST_EntryTimeTag>();
+	BOOST_CHECK_EQUAL(cByTime.begin()->GetFee(), 2000);
+
+	const IndexedTxSet::index<ST_ExpiryTag>::type &cByExpiry = cSet.get<ST_ExpiryTag>();
+	BOOST_CHECK_EQUAL(cByExpiry.begin()->GetFee(), 2000);
+	BOOST_CHECK_EQUAL(cByExpiry.rbegin()->GetFee(), 1000);
+
+	BOOST_CHECK_EQUAL(cSet.get<ST_SourceTag>().count(cSourceA), 2U);
+	BOOST_CHECK_EQUAL(cSet.get<ST_SourceTag>().count(cSourceB), 1U);
+
+	// lookups by hash as with the former map
+	uint256 cHash = cByFeeRate.begin()->GetHash();
+	BOOST_CHECK(cSet.count(cHash) == 1);
+	cSet.erase(cHash);
+	BOOST_CHECK_EQUAL(cByFeeRate.begin()->GetFee(), 2000);
+}
+
+BOOST_AUTO_TEST_CASE(evict_dependents)
+{
+	LOCK(g_cs_main);
+	// accounts 0 and 3 are funded, 1 is registered but empty
+	CAccountViewCache cBase(*g_pAccountViewTip, true);
+	CScriptDBViewCache cScriptBase(*g_pScriptDBTip, true);
+	for (unsigned int i = 0; i < 4; ++i) {
+		CAccount cAccount;
+		cAccount.m_cKeyID = PoolKeyId(i);
+		cAccount.SetRegId(PoolRegId(i));
+		cAccount.m_ullValues = (i == 0 || i == 3) ? 100 * COIN : 0;
+		BOOST_CHECK(cBase.SaveAccountInfo(PoolRegId(i), cAccount.m_cKeyID, cAccount));
+	}
+
+	CTxMemPool cPool;
+	cPool.SetAccountViewDB(&cBase);
+	cPool.SetScriptDBViewDB(&cScriptBase);
+	// the cheapest one funds account 1, the second spends those funds, the third is independent
+	BOOST_REQUIRE(AddToPool(cPool, 0, 1, 10000, 5 * COIN, 1));
+	BOOST_REQUIRE(AddToPool(cPool, 1, 2, 100000, 2 * COIN, 2));
+	BOOST_REQUIRE(AddToPool(cPool, 3, 4, 100000, COIN, 3));
+	BOOST_CHECK_EQUAL(cPool.size(), 3U);
+
+	cPool.SetMaxUsage(cPool.GetUsage() - 1);
+	vector<uint256> vcRemoved;
+	BOOST_CHECK(cPool.TrimToSize(vcRemoved));
+	BOOST_CHECK_EQUAL(vcRemoved.size(), 2U);
+	BOOST_CHECK_EQUAL(cPool.size(), 1U);
+
+	// the view is the one of a pool that only ever held the independent transaction
+	CTxMemPool cExpected;
+	cExpected.SetAccountViewDB(&cBase);
+	cExpected.SetScriptDBViewDB(&cScriptBase);
+	BOOST_REQUIRE(AddToPool(cExpected, 3, 4, 100000, COIN, 3));
+	for (unsigned int i = 0; i < 5; ++i) {
+		BOOST_CHECK(PoolAccount(cPool, i) == PoolAccount(cExpected, i));
+	}
+	CAccount cAccount;
+	BOOST_CHECK(cPool.m_pAccountViewCache->GetAccount(CUserID(PoolKeyId(1)), cAccount));
+	BOOST_CHECK_EQUAL(cAccount.m_ullValues, 0U);
+	BOOST_CHECK(!cPool.m_pAccountViewCache->GetAccount(CUserID(PoolKeyId(2)), cAccount));
+
+	// nothing left to evict
+	cPool.SetMaxUsage(cPool.GetUsage());
+	vcRemoved.clear();
+	BOOST_CHECK(!cPool.TrimToSize(vcRemoved));
+	BOOST_CHECK(vcRemoved.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
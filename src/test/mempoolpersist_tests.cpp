@@ -0,0 +1,116 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <map>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include "systestbase.h"
+using namespace std;
+
+class CMempoolPersistTest : public SysTestBase {
+ public:
+	CMempoolPersistTest() {
+		ResetEnv();
+		// no saved pool to load, this only allows DumpMempool
+		boost::filesystem::remove(GetMempoolPath());
+		LoadMempool();
+	}
+
+	~CMempoolPersistTest() {
+		SetMockTime(0);
+		boost::filesystem::remove(GetMempoolPath());
+		ResetEnv();
+	}
+
+	boost::filesystem::path GetMempoolPath() {
+		return GetDataDir() / "mempool.dat";
+	}
+
+	// two transfers entered an hour and half an hour ago
+	void FillMempool() {
+		int64_t llNow = GetTime();
+		string strHash;
+		SetMockTime(llNow - 3600);
+		BOOST_CHECK(GetHashFromCreatedTx(CreateNormalTx("000000000400", "dkJwhBs2P2SjbQWt5Bz6vzjqUhXTymvsGr",
+				10000000), strHash));
+		SetMockTime(llNow - 1800);
+		BOOST_CHECK(GetHashFromCreatedTx(CreateNormalTx("000000000400", "dgZjR2S98gmdvXDzwKASxKiaGr9Dw1GD8F",
+				20000000), strHash));
+		SetMockTime(0);
+		BOOST_CHECK_EQUAL(g_cTxMemPool.size(), 2U);
+	}
+
+	map<uint256, int64_t> GetEntryTimes() {
+		map<uint256, int64_t> mapTimes;
+		LOCK(g_cTxMemPool.m_cs);
+		for (const auto &cEntry : g_cTxMemPool.m_mapTx) {
+			mapTimes[cEntry.GetHash()] = cEntry.GetTime();
+		}
+		return mapTimes;
+	}
+
+	void WriteMempoolFile(const vector<unsigned char> &vchData) {
+		FILE *pFile = fopen(GetMempoolPath().string().c_str(), "wb");
+		BOOST_REQUIRE(pFile);
+		if (!vchData.empty()) {
+			BOOST_CHECK_EQUAL(fwrite(&vchData[0], 1, vchData.size(), pFile), vchData.size());
+		}
+		fclose(pFile);
+	}
+
+	vector<unsigned char> ReadMempoolFile() {
+		vector<unsigned char> vchData(boost::filesystem::file_size(GetMempoolPath()));
+		FILE *pFile = fopen(GetMempoolPath().string().c_str(), "rb");
+		BOOST_REQUIRE(pFile);
+		BOOST_CHECK_EQUAL(fread(&vchData[0], 1, vchData.size(), pFile), vchData.size());
+		fclose(pFile);
+		return vchData;
+	}
+};
+
+BOOST_FIXTURE_TEST_SUITE(mempoolpersist_tests, CMempoolPersistTest)
+
+BOOST_FIXTURE_TEST_CASE(round_trip, CMempoolPersistTest) {
+	FillMempool();
+	map<uint256, int64_t> mapTimes = GetEntryTimes();
+	BOOST_CHECK(DumpMempool());
+
+	g_cTxMemPool.clear();
+	BOOST_CHECK_EQUAL(g_cTxMemPool.size(), 0U);
+	BOOST_CHECK(LoadMempool());
+
+	// the same transactions at the times they first entered the pool
+	BOOST_CHECK(GetEntryTimes() == mapTimes);
+}
+
+BOOST_FIXTURE_TEST_CASE(corrupted_checksum, CMempoolPersistTest) {
+	FillMempool();
+	BOOST_CHECK(DumpMempool());
+	vector<unsigned char> vchData = ReadMempoolFile();
+	BOOST_REQUIRE(vchData.size() > 64);
+	vchData[vchData.size() / 2] ^= 0x01;
+	WriteMempoolFile(vchData);
+
+	g_cTxMemPool.clear();
+	BOOST_CHECK(!LoadMempool());
+	BOOST_CHECK_EQUAL(g_cTxMemPool.size(), 0U);
+}
+
+BOOST_FIXTURE_TEST_CASE(short_file, CMempoolPersistTest) {
+	g_cTxMemPool.clear();
+	// no room for the checksum, down to an empty file
+	WriteMempoolFile(vector<unsigned char>(31, 0x5a));
+	BOOST_CHECK(!LoadMempool());
+	WriteMempoolFile(vector<unsigned char>());
+	BOOST_CHECK(!LoadMempool());
+
+	// only the checksum of no data at all, which matches but has no header
+	vector<unsigned char> vchEmpty;
+	uint256 cHash = Hash(vchEmpty.begin(), vchEmpty.end());
+	WriteMempoolFile(vector<unsigned char>(cHash.begin(), cHash.end()));
+	BOOST_CHECK(!LoadMempool());
+	BOOST_CHECK_EQUAL(g_cTxMemPool.size(), 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
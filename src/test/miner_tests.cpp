@@ -0,0 +1,137 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <boost/test/unit_test.hpp>
+#include "systestbase.h"
+#include "miner.h"
+using namespace std;
+
+class CTemplateTest : public SysTestBase {
+ public:
+	CTemplateTest() {
+		ResetEnv();
+	}
+
+	~CTemplateTest() {
+		ResetEnv();
+	}
+
+	bool SendTo(const char *pchDest, uint64_t ullMoney) {
+		string strHash;
+		return GetHashFromCreatedTx(CreateNormalTx("000000000400", pchDest, ullMoney), strHash);
+	}
+
+	// accounts, key ids and script data the two pairs of caches show, at least for every key either holds
+	void CheckSameState(CAccountViewCache &cAccountA, CScriptDBViewCache &cScriptA, CAccountViewCache &cAccountB,
+			CScriptDBViewCache &cScriptB) {
+		CAccountView &cViewA = cAccountA;
+		CAccountView &cViewB = cAccountB;
+		set<CKeyID> setKeyId;
+		set<vector<unsigned char> > setAccountId;
+		for (auto pCache : { &cAccountA, &cAccountB }) {
+			for (const auto &item : pCache->m_mapCacheAccounts) {
+				setKeyId.insert(item.first);
+			}
+			for (const auto &item : pCache->m_mapCacheKeyIds) {
+				setAccountId.insert(item.first);
+			}
+		}
+		for (const auto &keyId : setKeyId) {
+			CAccount cA, cB;
+			bool bA = cViewA.GetAccount(keyId, cA);
+			BOOST_CHECK_EQUAL(bA, cViewB.GetAccount(keyId, cB));
+			if (bA) {
+				CDataStream cDSA(SER_DISK, g_sClientVersion);
+				CDataStream cDSB(SER_DISK, g_sClientVersion);
+				cDSA << cA;
+				cDSB << cB;
+				BOOST_CHECK(cDSA.str() == cDSB.str());
+			}
+		}
+		for (const auto &vchAccountId : setAccountId) {
+			CKeyID cA, cB;
+			bool bA = cViewA.GetKeyId(vchAccountId, cA);
+			BOOST_CHECK_EQUAL(bA, cViewB.GetKeyId(vchAccountId, cB));
+			BOOST_CHECK(!bA || cA == cB);
+		}
+
+		CScriptDBView &cDataA = cScriptA;
+		CScriptDBView &cDataB = cScriptB;
+		set<vector<unsigned char> > setKeys;
+		for (auto pCache : { &cScriptA, &cScriptB }) {
+			for (const auto &item : pCache->m_mapDatas) {
+				setKeys.insert(item.first);
+			}
+		}
+		for (const auto &vchKey : setKeys) {
+			vector<unsigned char> vchA, vchB;
+			bool bA = cDataA.GetData(vchKey, vchA);
+			BOOST_CHECK_EQUAL(bA, cDataB.GetData(vchKey, vchB));
+			BOOST_CHECK(vchA == vchB);
+		}
+	}
+
+	/**
+	 * Template of the node's builder, kept up to date since the last call, against one a new builder
+	 * makes from the whole pool
+	 * @return transactions the node's builder executed for it
+	 */
+	uint64_t CheckTemplate() {
+		LOCK2(g_cs_main, g_cTxMemPool.m_cs);
+		CAccountViewCache cAccountCache(*g_pAccountViewTip, true);
+		CTransactionDBCache cTxCache(*g_pTxCacheTip, true);
+		CScriptDBViewCache cScriptCache(*g_pScriptDBTip, true);
+		std::shared_ptr<ST_BlockTemplate> pTemplate(CreateNewBlock(cAccountCache, cTxCache, cScriptCache));
+		BOOST_REQUIRE(pTemplate);
+		uint64_t ullExecuted = g_ullLastTemplateExecuted;
+
+		CBlockTemplateBuilder cBuilder;
+		cBuilder.Update();
+		CBlock cBlock;
+		cBlock.vptx.push_back(std::make_shared<CRewardTransaction>());
+		CAccountViewCache cScratchAccountCache(*g_pAccountViewTip, true);
+		CScriptDBViewCache cScratchScriptCache(*g_pScriptDBTip, true);
+		cBuilder.Fill(&cBlock, cScratchAccountCache, cScratchScriptCache);
+
+		const CBlock &cTemplate = pTemplate->cBlock;
+		BOOST_REQUIRE_EQUAL(cTemplate.vptx.size(), cBlock.vptx.size());
+		for (unsigned int i = 1; i < cBlock.vptx.size(); ++i) {
+			BOOST_CHECK(cTemplate.vptx[i]->GetHash() == cBlock.vptx[i]->GetHash());
+		}
+		BOOST_CHECK_EQUAL(cTemplate.GetFuelRate(), cBuilder.GetFuelRate());
+		BOOST_CHECK_EQUAL((int64_t) cTemplate.GetFuel(), cBuilder.GetTotalFuel());
+		BOOST_CHECK_EQUAL(cTemplate.GetHeight(), g_cChainActive.Height() + 1);
+		CheckSameState(cAccountCache, cScriptCache, cScratchAccountCache, cScratchScriptCache);
+
+		return ullExecuted;
+	}
+};
+
+BOOST_FIXTURE_TEST_SUITE(miner_tests, CTemplateTest)
+
+BOOST_FIXTURE_TEST_CASE(incremental_template, CTemplateTest) {
+	BOOST_REQUIRE(SendTo("dkJwhBs2P2SjbQWt5Bz6vzjqUhXTymvsGr", 10000000));
+	BOOST_REQUIRE(SendTo("dgZjR2S98gmdvXDzwKASxKiaGr9Dw1GD8F", 20000000));
+	CheckTemplate();
+
+	// a transaction entering the pool is executed on top of the listed ones
+	BOOST_REQUIRE(SendTo("dkJwhBs2P2SjbQWt5Bz6vzjqUhXTymvsGr", 30000000));
+	BOOST_CHECK_EQUAL(CheckTemplate(), 1U);
+	// nothing changed since
+	BOOST_CHECK_EQUAL(CheckTemplate(), 0U);
+
+	// a new tip starts the list over
+	BOOST_REQUIRE(GenerateOneBlock());
+	BOOST_REQUIRE(SendTo("dgZjR2S98gmdvXDzwKASxKiaGr9Dw1GD8F", 40000000));
+	CheckTemplate();
+
+	// and so does going back, with the transactions of the disconnected block in the pool again
+	BOOST_REQUIRE(DisConnectBlock(1));
+	BOOST_CHECK(g_cTxMemPool.size() > 1);
+	CheckTemplate();
+	BOOST_REQUIRE(SendTo("dkJwhBs2P2SjbQWt5Bz6vzjqUhXTymvsGr", 50000000));
+	CheckTemplate();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
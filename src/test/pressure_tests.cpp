@@ -107,7 +107,7 @@ class PressureTest : public SysTestBase {
 		string strTxHash = result.get_str();
 		g_vstrTransactionHash.push_back(strTxHash);
 		if (g_cTxMemPool.m_mapTx.count(uint256(uint256S(strTxHash))) > 0) {
-			std::shared_ptr<CBaseTransaction> cTx = g_cTxMemPool.m_mapTx[uint256(uint256S(strTxHash))].GetTx();
+			std::shared_ptr<CBaseTransaction> cTx = g_cTxMemPool.lookup(uint256(uint256S(strTxHash)));
 			g_vcTransactions.push_back(cTx);
 		}
 		g_vSendFee.push_back(make_pair(strTxHash, nFee));
@@ -144,7 +144,7 @@ class PressureTest : public SysTestBase {
 
 		g_vstrTransactionHash.push_back(strTxHash);
 		if (g_cTxMemPool.m_mapTx.count(uint256(uint256S(strTxHash))) > 0) {
-			std::shared_ptr<CBaseTransaction> tx = g_cTxMemPool.m_mapTx[uint256(uint256S(strTxHash))].GetTx();
+			std::shared_ptr<CBaseTransaction> tx = g_cTxMemPool.lookup(uint256(uint256S(strTxHash)));
 			g_vcTransactions.push_back(tx);
 		}
 		g_vSendFee.push_back(make_pair(strTxHash, nFee));
@@ -172,7 +172,7 @@ class PressureTest : public SysTestBase {
 
 		g_vstrTransactionHash.push_back(strTxHash);
 		if (g_cTxMemPool.m_mapTx.count(uint256(uint256S(strTxHash))) > 0) {
-			std::shared_ptr<CBaseTransaction> tx = g_cTxMemPool.m_mapTx[uint256(uint256S(strTxHash))].GetTx();
+			std::shared_ptr<CBaseTransaction> tx = g_cTxMemPool.lookup(uint256(uint256S(strTxHash)));
 			g_vcTransactions.push_back(tx);
 		}
 		g_vSendFee.push_back(make_pair(strTxHash, nFee));
@@ -191,7 +191,7 @@ class PressureTest : public SysTestBase {
 		if (bFlag) {
 			g_vstrTransactionHash.push_back(strHash);
 			if (g_cTxMemPool.m_mapTx.count(uint256(uint256S(strHash))) > 0) {
-				std::shared_ptr<CBaseTransaction> tx = g_cTxMemPool.m_mapTx[uint256(uint256S(strHash))].GetTx();
+				std::shared_ptr<CBaseTransaction> tx = g_cTxMemPool.lookup(uint256(uint256S(strHash)));
 				g_vcTransactions.push_back(tx);
 			}
 			g_vSendFee.push_back(make_pair(strHash, ullFee));
@@ -0,0 +1,80 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "main.h"
+#include "serialize.h"
+
+#include <boost/test/unit_test.hpp>
+
+// A full file of 100 blocks per 100 heights, from nHeight on
+static CBlockFileInfo MakeFileInfo(unsigned int nHeight) {
+	CBlockFileInfo cFileInfo;
+	for (unsigned int i = 0; i < 100; ++i) {
+		cFileInfo.AddBlock(nHeight + i, 1400000000 + nHeight + i);
+	}
+	cFileInfo.m_unSize = MAX_BLOCKFILE_SIZE - 1;
+	cFileInfo.m_unUndoSize = 8 * UNDOFILE_CHUNK_SIZE;
+	return cFileInfo;
+}
+
+BOOST_AUTO_TEST_SUITE(prune_tests)
+
+BOOST_AUTO_TEST_CASE(select_files) {
+	vector<CBlockFileInfo> vcFileInfo;
+	for (unsigned int i = 0; i < 10; ++i) {
+		vcFileInfo.push_back(MakeFileInfo(i * 100));
+	}
+	uint64_t ullFile = vcFileInfo[0].m_unSize + vcFileInfo[0].m_unUndoSize;
+
+	// under the target nothing goes
+	set<int> setFiles;
+	SelectFilesToPrune(vcFileInfo, 20 * ullFile, 10000, setFiles);
+	BOOST_CHECK(setFiles.empty());
+
+	// the oldest files go first, down to the target with room for the next chunks
+	SelectFilesToPrune(vcFileInfo, 6 * ullFile, 10000, setFiles);
+	BOOST_CHECK_EQUAL(setFiles.size(), 5U);
+	BOOST_CHECK(setFiles.count(0) && setFiles.count(4) && !setFiles.count(5));
+
+	// files holding blocks at or above the prune height are kept
+	setFiles.clear();
+	SelectFilesToPrune(vcFileInfo, 6 * ullFile, 250, setFiles);
+	BOOST_CHECK_EQUAL(setFiles.size(), 2U);
+	BOOST_CHECK(setFiles.count(0) && setFiles.count(1));
+
+	// so is the file being written to, and files already pruned are skipped
+	for (int i = 0; i < 9; ++i) {
+		vcFileInfo[i].m_unSize = 0;
+		vcFileInfo[i].m_unUndoSize = 0;
+		BOOST_CHECK(vcFileInfo[i].IsPruned());
+	}
+	setFiles.clear();
+	SelectFilesToPrune(vcFileInfo, 1, 10000, setFiles);
+	BOOST_CHECK(setFiles.empty());
+	BOOST_CHECK(!vcFileInfo[9].IsPruned());
+	BOOST_CHECK(!CBlockFileInfo().IsPruned());
+}
+
+BOOST_AUTO_TEST_CASE(pruned_index) {
+	CDiskBlockIndex cIndex;
+	cIndex.m_unStatus = BLOCK_VALID_SCRIPTS | BLOCK_PRUNED;
+	cIndex.m_nFile = 3;
+	cIndex.m_nDataPos = 12345;
+	cIndex.m_nUndoPos = 678;
+	CDataStream ssIndex(SER_DISK, g_sClientVersion);
+	ssIndex << cIndex;
+	CDiskBlockIndex cRead;
+	ssIndex >> cRead;
+	// the block position survives pruning, the undo position does not
+	BOOST_CHECK_EQUAL(cRead.m_unStatus, cIndex.m_unStatus);
+	BOOST_CHECK_EQUAL(cRead.m_nFile, 3);
+	BOOST_CHECK_EQUAL(cRead.m_nDataPos, 12345U);
+	BOOST_CHECK_EQUAL(cRead.m_nUndoPos, 0U);
+	BOOST_CHECK(cRead.GetBlockPos().IsNull());
+	BOOST_CHECK(cRead.GetBlockHash() == cIndex.GetBlockHash());
+
+	BOOST_CHECK(GetPruneKeepDepth() >= max(COINBASE_MATURITY, SysCfg().GetTxCacheHeight()) + MIN_BLOCKS_TO_KEEP);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
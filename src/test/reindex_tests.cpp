@@ -0,0 +1,98 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <map>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include "systestbase.h"
+using namespace std;
+
+// blk files far past the ones the node writes to
+static const int REINDEX_TEST_FILE = 9990;
+
+class CReindexTest : public SysTestBase {
+ public:
+	CReindexTest() {
+		ResetEnv();
+		RemoveFiles();
+	}
+
+	~CReindexTest() {
+		RemoveFiles();
+		ResetEnv();
+	}
+
+	void RemoveFiles() {
+		for (int nFile = REINDEX_TEST_FILE; nFile < REINDEX_TEST_FILE + 2; ++nFile) {
+			boost::filesystem::remove(GetDataDir() / "blocks" / strprintf("blk%05u.dat", nFile));
+		}
+	}
+
+	// the active chain from the genesis block up
+	void GetChain(vector<CBlock> &vcBlocks) {
+		LOCK(g_cs_main);
+		vcBlocks.resize(g_cChainActive.Height() + 1);
+		for (int i = 0; i <= g_cChainActive.Height(); ++i) {
+			BOOST_REQUIRE(ReadBlockFromDisk(vcBlocks[i], g_cChainActive[i]));
+		}
+	}
+
+	// append the block as a record to the end of the file, every other one compressed
+	void AppendBlock(const CBlock &cBlock, ST_DiskBlockPos &tEnd, map<uint256, ST_DiskBlockPos> &mapPos) {
+		CDiskRecord cRecord;
+		cRecord.Pack(cBlock, mapPos.size() % 2 == 1);
+		ST_DiskBlockPos tPos = tEnd;
+		BOOST_REQUIRE(WriteBlockToDisk(cRecord, tPos));
+		mapPos[cBlock.GetHash()] = tPos;
+		tEnd.unPos += cRecord.GetDiskSize();
+	}
+};
+
+BOOST_FIXTURE_TEST_SUITE(reindex_tests, CReindexTest)
+
+BOOST_FIXTURE_TEST_CASE(out_of_order_files, CReindexTest) {
+	for (int i = 0; i < 4; ++i) {
+		BOOST_REQUIRE(GenerateOneBlock());
+	}
+	vector<CBlock> vcBlocks;
+	GetChain(vcBlocks);
+	BOOST_REQUIRE_EQUAL(vcBlocks.size(), 5U);
+
+	// children before their parents, the chain split over two files
+	map<uint256, ST_DiskBlockPos> mapPos;
+	ST_DiskBlockPos tFirstEnd(REINDEX_TEST_FILE, 0);
+	ST_DiskBlockPos tSecondEnd(REINDEX_TEST_FILE + 1, 0);
+	AppendBlock(vcBlocks[3], tFirstEnd, mapPos);
+	AppendBlock(vcBlocks[4], tSecondEnd, mapPos);
+	AppendBlock(vcBlocks[0], tFirstEnd, mapPos);
+	AppendBlock(vcBlocks[2], tSecondEnd, mapPos);
+	AppendBlock(vcBlocks[1], tFirstEnd, mapPos);
+
+	vector<int> vnFiles;
+	vnFiles.push_back(REINDEX_TEST_FILE);
+	vnFiles.push_back(REINDEX_TEST_FILE + 1);
+	vector<ST_ReindexBlock> vtOrdered;
+	BOOST_REQUIRE(OrderBlockFiles(vnFiles, vtOrdered));
+
+	// found in both files and listed by height, where they were stored
+	BOOST_REQUIRE_EQUAL(vtOrdered.size(), vcBlocks.size());
+	for (unsigned int i = 0; i < vtOrdered.size(); ++i) {
+		BOOST_CHECK(vtOrdered[i].cHash == vcBlocks[i].GetHash());
+		BOOST_CHECK(vtOrdered[i].cPrevHash == vcBlocks[i].GetHashPrevBlock());
+		const ST_DiskBlockPos &tPos = mapPos[vcBlocks[i].GetHash()];
+		BOOST_CHECK_EQUAL(vtOrdered[i].tPos.nFile, tPos.nFile);
+		BOOST_CHECK_EQUAL(vtOrdered[i].tPos.unPos, tPos.unPos);
+
+		CBlock cBlock;
+		BOOST_REQUIRE(ReadBlockFromDisk(cBlock, vtOrdered[i].tPos));
+		BOOST_CHECK(cBlock.GetHash() == vcBlocks[i].GetHash());
+		BOOST_CHECK_EQUAL(cBlock.GetHeight(), i);
+	}
+
+	// without the genesis block there is nothing to start from
+	vnFiles.erase(vnFiles.begin());
+	BOOST_CHECK(!OrderBlockFiles(vnFiles, vtOrdered));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
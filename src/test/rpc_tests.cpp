@@ -0,0 +1,80 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "rpc/rpcprotocol.h"
+#include "util.h"
+
+#include <sstream>
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace json_spirit;
+
+namespace {
+
+// Write strBody through a CHTTPReplyWriter and parse the reply back the way the client does
+string RoundTrip(const string &strBody, bool bAllowChunked, map<string, string> &mapHeaders) {
+	stringstream ss;
+	CHTTPReplyWriter cWriter(ss, HTTP_OK, true, bAllowChunked);
+	ostream os(&cWriter);
+	os << strBody;
+	cWriter.Finish();
+
+	int nProto = 0;
+	BOOST_CHECK_EQUAL(ReadHTTPStatus(ss, nProto), HTTP_OK);
+	string strReply;
+	BOOST_CHECK_EQUAL(ReadHTTPMessage(ss, mapHeaders, strReply, nProto), HTTP_OK);
+	return strReply;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(rpc_tests)
+
+BOOST_AUTO_TEST_CASE(reply_writer_small)
+{
+	map<string, string> mapHeaders;
+	string strBody = "{\"result\":1,\"error\":null,\"id\":1}\n";
+	BOOST_CHECK_EQUAL(RoundTrip(strBody, true, mapHeaders), strBody);
+	BOOST_CHECK_EQUAL(mapHeaders["content-length"], strprintf("%u", strBody.size()));
+	BOOST_CHECK(mapHeaders.count("transfer-encoding") == 0);
+}
+
+BOOST_AUTO_TEST_CASE(reply_writer_chunked)
+{
+	string strBody;
+	for (unsigned int i = 0; strBody.size() <= g_sRpcChunkThreshold + g_sRpcChunkSize * 3; i++) {
+		strBody += strprintf("%08x,", i);
+	}
+	map<string, string> mapHeaders;
+	BOOST_CHECK(RoundTrip(strBody, true, mapHeaders) == strBody);
+	BOOST_CHECK_EQUAL(mapHeaders["transfer-encoding"], "chunked");
+
+	// HTTP/1.0 clients always get a Content-Length
+	mapHeaders.clear();
+	BOOST_CHECK(RoundTrip(strBody, false, mapHeaders) == strBody);
+	BOOST_CHECK(mapHeaders.count("transfer-encoding") == 0);
+}
+
+BOOST_AUTO_TEST_CASE(write_reply_matches_object)
+{
+	Object result;
+	result.push_back(Pair("height", 12));
+	result.push_back(Pair("hash", "00ff"));
+	Array id;
+	id.push_back("a");
+
+	ostringstream os;
+	JSONRPCWriteReply(os, result, Value::null, id);
+	BOOST_CHECK_EQUAL(os.str() + "\n", JSONRPCReply(result, Value::null, id));
+
+	Object error = JSONRPCError(RPC_MISC_ERROR, "failed");
+	ostringstream osError;
+	JSONRPCWriteReply(osError, result, error, 7);
+	BOOST_CHECK_EQUAL(osError.str() + "\n", JSONRPCReply(result, error, 7));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
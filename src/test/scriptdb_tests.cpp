@@ -328,4 +328,130 @@ BOOST_AUTO_TEST_CASE(test) {
 	testscriptdatadb();
 	closedb();
 }
+
+BOOST_AUTO_TEST_CASE(txindex_undo_pos) {
+	CScriptDB cDB(size_t(1 << 20), true, false);
+	CScriptDBViewCache cView(cDB, true);
+	uint256 cTxHash = uint256S("0x0102");
+	ST_DiskTxPos tPos(ST_DiskBlockPos(3, 1000), 81);
+	tPos.m_unUndoPos = 5000;
+	vector<pair<uint256, ST_DiskTxPos> > vPos;
+	vPos.push_back(make_pair(cTxHash, tPos));
+	vector<CScriptDBOperLog> vcOperLog;
+	BOOST_CHECK(cView.WriteTxIndex(vPos, vcOperLog));
+	BOOST_CHECK_EQUAL(vcOperLog.size(), 1U);
+	BOOST_CHECK(vcOperLog[0].m_vchValue.empty());
+
+	ST_DiskTxPos tRead;
+	BOOST_CHECK(cView.ReadTxIndex(cTxHash, tRead));
+	BOOST_CHECK_EQUAL(tRead.nFile, 3);
+	BOOST_CHECK_EQUAL(tRead.unPos, 1000U);
+	BOOST_CHECK_EQUAL(tRead.m_unTxOffset, 81U);
+	BOOST_CHECK_EQUAL(tRead.m_unUndoPos, 5000U);
+
+	// entries written before the undo position was indexed still read, without one
+	cTxHash = uint256S("0x0304");
+	CDataStream cDSKey(SER_DISK, g_sClientVersion);
+	cDSKey << cTxHash;
+	vector<unsigned char> vchKey = { 'T' };
+	vchKey.insert(vchKey.end(), cDSKey.begin(), cDSKey.end());
+	CDataStream cDSPos(SER_DISK, g_sClientVersion);
+	cDSPos << ST_DiskBlockPos(4, 2000) << VARINT(tPos.m_unTxOffset);
+	BOOST_CHECK(cDB.SetData(vchKey, vector<unsigned char>(cDSPos.begin(), cDSPos.end())));
+	BOOST_CHECK(cView.ReadTxIndex(cTxHash, tRead));
+	BOOST_CHECK_EQUAL(tRead.nFile, 4);
+	BOOST_CHECK_EQUAL(tRead.unPos, 2000U);
+	BOOST_CHECK_EQUAL(tRead.m_unTxOffset, 81U);
+	BOOST_CHECK_EQUAL(tRead.m_unUndoPos, 0U);
+}
+
+BOOST_AUTO_TEST_CASE(store_partition) {
+	BOOST_CHECK_EQUAL(CScriptDB::GetStore({ 'd', 'e', 'f', 1 }), EM_SCRIPT_STORE_CODE);
+	BOOST_CHECK_EQUAL(CScriptDB::GetStore({ 's', 'd', 'n', 'u', 'm', 1 }), EM_SCRIPT_STORE_STATE);
+	BOOST_CHECK_EQUAL(CScriptDB::GetStore({ 'a', 'f', 'n', 'd', 1 }), EM_SCRIPT_STORE_STATE);
+	BOOST_CHECK_EQUAL(CScriptDB::GetStore({ 'T', 1 }), EM_SCRIPT_STORE_INDEX);
+	BOOST_CHECK_EQUAL(CScriptDB::GetStore({ 't', 'x', 1 }), EM_SCRIPT_STORE_INDEX);
+	BOOST_CHECK_EQUAL(CScriptDB::GetStore({ 'o', 'u', 't', 'p', 'u', 't', 1 }), EM_SCRIPT_STORE_OUTPUT);
+	BOOST_CHECK_EQUAL(CScriptDB::GetStore({ 0x01, 0x02 }), EM_SCRIPT_STORE_STATE);
+
+	// a database in the single-store layout is migrated when opened
+	vector<unsigned char> vchCode = { 'd', 'e', 'f', 1, 0, 0, 0, 1, 0 };
+	vector<unsigned char> vchData = { 'd', 'a', 't', 'a', 1, 0, 0, 0, 1, 0, '_', 'k' };
+	vector<unsigned char> vchIndex = { 'T', 5 };
+	vector<unsigned char> vchValue = { 7, 8, 9 };
+	const boost::filesystem::path path = GetDataDir() / "blocks" / "partitiondb";
+	boost::filesystem::remove_all(path);
+	{
+		CLevelDBWrapper cLegacy(path, size_t(1 << 20));
+		BOOST_CHECK(cLegacy.Write(vchCode, vchValue));
+		BOOST_CHECK(cLegacy.Write(vchData, vchValue));
+		BOOST_CHECK(cLegacy.Write(vchIndex, vchValue));
+	}
+	{
+		CScriptDB cDB("partitiondb", size_t(1 << 20));
+		BOOST_CHECK(!boost::filesystem::exists(path / "CURRENT"));
+		BOOST_CHECK(!boost::filesystem::exists(GetDataDir() / "blocks" / "partitiondb.legacy"));
+		vector<unsigned char> vchRead;
+		BOOST_CHECK(cDB.GetData(vchCode, vchRead) && vchRead == vchValue);
+		BOOST_CHECK(cDB.GetData(vchData, vchRead) && vchRead == vchValue);
+		BOOST_CHECK(cDB.GetData(vchIndex, vchRead) && vchRead == vchValue);
+		BOOST_CHECK_EQUAL(cDB.GetDbCount(), 3);
+
+		// a prefix shorter than the record tags reads across stores
+		map<vector<unsigned char>, vector<unsigned char> > mapDatas;
+		BOOST_CHECK(cDB.GetPrefixData({ 'd' }, mapDatas));
+		BOOST_CHECK_EQUAL(mapDatas.size(), 2U);
+
+		vector<ST_ScriptStoreStats> vtStats = cDB.GetStats();
+		BOOST_CHECK_EQUAL(vtStats.size(), (size_t) EM_SCRIPT_STORE_MAX);
+		BOOST_CHECK_EQUAL(vtStats[EM_SCRIPT_STORE_CODE].ullReads, 1U);
+		BOOST_CHECK_EQUAL(vtStats[EM_SCRIPT_STORE_INDEX].ullReads, 1U);
+	}
+	boost::filesystem::remove_all(path);
+}
+
+BOOST_AUTO_TEST_CASE(prefix_iterator) {
+	CLevelDBWrapper cDB(GetDataDir() / "blocks" / "iterdb", size_t(1 << 20), true);
+	vector<unsigned char> vchValue = { 1, 2, 3 };
+	BOOST_CHECK(cDB.Write(vector<unsigned char>{ 'a', 1 }, vchValue));
+	BOOST_CHECK(cDB.Write(vector<unsigned char>{ 'b', 1 }, vchValue));
+	BOOST_CHECK(cDB.Write(vector<unsigned char>{ 'b', 2 }, vchValue));
+	BOOST_CHECK(cDB.Write(vector<unsigned char>{ 'c', 1 }, vchValue));
+
+	int nKeys = 0;
+	{
+		auto pCursor = cDB.NewIterator("b");
+		for (pCursor->Seek(); pCursor->Valid(); pCursor->Next()) {
+			vector<unsigned char> vchRead;
+			BOOST_CHECK(pCursor->GetValue(vchRead) && vchRead == vchValue);
+			BOOST_CHECK_EQUAL(pCursor->KeySuffix().size(), 1U);
+			++nKeys;
+		}
+	}
+	BOOST_CHECK_EQUAL(nKeys, 2);
+
+	// a snapshot keeps its view while the database changes, a pooled live iterator does not go stale
+	CLevelDBWrapper cSnapshot(&cDB);
+	BOOST_CHECK(cDB.Write(vector<unsigned char>{ 'b', 3 }, vchValue));
+	nKeys = 0;
+	auto pCursor = cDB.NewIterator("b");
+	for (pCursor->Seek(); pCursor->Valid(); pCursor->Next()) {
+		++nKeys;
+	}
+	BOOST_CHECK_EQUAL(nKeys, 3);
+	for (int i = 0; i < 2; ++i) {
+		nKeys = 0;
+		auto pSnapshotCursor = cSnapshot.NewIterator("b");
+		for (pSnapshotCursor->Seek(); pSnapshotCursor->Valid(); pSnapshotCursor->Next()) {
+			++nKeys;
+		}
+		BOOST_CHECK_EQUAL(nKeys, 2);
+	}
+
+	CSliceReader cReader(leveldb::Slice("\x03\x01\x02\x03", 4));
+	vector<unsigned char> vchRead;
+	cReader >> vchRead;
+	BOOST_CHECK(vchRead == vchValue && cReader.empty());
+	BOOST_CHECK_THROW(cReader >> vchRead, ios_base::failure);
+}
 BOOST_AUTO_TEST_SUITE_END()
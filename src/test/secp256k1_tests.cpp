@@ -0,0 +1,180 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "key.h"
+#include "crypto/secp256k1.h"
+#include "hash.h"
+#include "util.h"
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+#ifdef USE_NATIVE_SECP256K1
+
+namespace {
+
+// Verify with both verifiers and require them to agree
+bool VerifyBoth(const CPubKey &cPubKey, const uint256 &cHash, const vector<unsigned char> &vchSig) {
+	SetNativeSigVerify(false, 0);
+	bool bOpenSSL = cPubKey.Verify(cHash, vchSig);
+	SetNativeSigVerify(true, 100);
+	bool bNative = cPubKey.Verify(cHash, vchSig);
+	BOOST_CHECK_EQUAL(bOpenSSL, bNative);
+	return bNative;
+}
+
+// Re-encode a DER signature with R and/or S widened to 33 bytes behind a non zero leading byte
+vector<unsigned char> WidenSignature(const vector<unsigned char> &vchSig, bool bWidenR, bool bWidenS) {
+	vector<unsigned char> vchBody;
+	size_t unPos = 2;
+	for (int i = 0; i < 2; ++i) {
+		size_t unLen = vchSig[unPos + 1];
+		vector<unsigned char> vchValue(vchSig.begin() + unPos + 2, vchSig.begin() + unPos + 2 + unLen);
+		if (i == 0 ? bWidenR : bWidenS) {
+			while (vchValue.size() > 32) {
+				vchValue.erase(vchValue.begin());
+			}
+			vchValue.insert(vchValue.begin(), 32 - vchValue.size(), 0x00);
+			vchValue.insert(vchValue.begin(), i == 0 ? 0x01 : 0x7F);
+		}
+		vchBody.push_back(0x02);
+		vchBody.push_back(vchValue.size());
+		vchBody.insert(vchBody.end(), vchValue.begin(), vchValue.end());
+		unPos += 2 + unLen;
+	}
+	vector<unsigned char> vchOut;
+	vchOut.push_back(0x30);
+	vchOut.push_back(vchBody.size());
+	vchOut.insert(vchOut.end(), vchBody.begin(), vchBody.end());
+	return vchOut;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(secp256k1_tests)
+
+BOOST_AUTO_TEST_CASE(native_matches_openssl)
+{
+	for (int i = 0; i < 200; ++i) {
+		CKey cKey;
+		cKey.MakeNewKey(true);
+		CPubKey cPubKey = cKey.GetPubKey();
+		uint256 cHash = GetRandHash();
+		vector<unsigned char> vchSig;
+		BOOST_CHECK(cKey.Sign(cHash, vchSig));
+
+		BOOST_CHECK(VerifyBoth(cPubKey, cHash, vchSig));
+
+		uint256 cOtherHash = GetRandHash();
+		BOOST_CHECK(!VerifyBoth(cPubKey, cOtherHash, vchSig));
+
+		vector<unsigned char> vchBadSig(vchSig);
+		vchBadSig[vchBadSig.size() - 1 - i % 30] ^= 0x01;
+		VerifyBoth(cPubKey, cHash, vchBadSig);
+
+		CKey cOtherKey;
+		cOtherKey.MakeNewKey(true);
+		BOOST_CHECK(!VerifyBoth(cOtherKey.GetPubKey(), cHash, vchSig));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(uncompressed_pubkey)
+{
+	for (int i = 0; i < 20; ++i) {
+		CKey cKey;
+		cKey.MakeNewKey(false);
+		CPubKey cPubKey = cKey.GetPubKey();
+		BOOST_CHECK_EQUAL(cPubKey.size(), 65U);
+		uint256 cHash = GetRandHash();
+		vector<unsigned char> vchSig;
+		BOOST_CHECK(cKey.Sign(cHash, vchSig));
+
+		secp256k1::CPoint cPoint;
+		secp256k1::CSignature cSig;
+		BOOST_CHECK(secp256k1::ParsePubKey(cPubKey.begin(), cPubKey.size(), cPoint));
+		BOOST_CHECK(secp256k1::ParseSignatureDER(&vchSig[0], vchSig.size(), cSig));
+		BOOST_CHECK(secp256k1::Verify(cHash.begin(), cSig, cPoint));
+		cHash = GetRandHash();
+		BOOST_CHECK(!secp256k1::Verify(cHash.begin(), cSig, cPoint));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(strict_der)
+{
+	CKey cKey;
+	cKey.MakeNewKey(true);
+	uint256 cHash = GetRandHash();
+	vector<unsigned char> vchSig;
+	BOOST_CHECK(cKey.Sign(cHash, vchSig));
+
+	secp256k1::CSignature cSig;
+	BOOST_CHECK(secp256k1::ParseSignatureDER(&vchSig[0], vchSig.size(), cSig));
+
+	// trailing garbage
+	vector<unsigned char> vchTrailing(vchSig);
+	vchTrailing.push_back(0x00);
+	BOOST_CHECK(!secp256k1::ParseSignatureDER(&vchTrailing[0], vchTrailing.size(), cSig));
+
+	// superfluous zero padding of R, OpenSSL still accepts it after normalization
+	vector<unsigned char> vchPadded(vchSig);
+	vchPadded.insert(vchPadded.begin() + 4, 0x00);
+	vchPadded[1] += 1;
+	vchPadded[3] += 1;
+	BOOST_CHECK(!secp256k1::ParseSignatureDER(&vchPadded[0], vchPadded.size(), cSig));
+	BOOST_CHECK(VerifyBoth(cKey.GetPubKey(), cHash, vchPadded));
+
+	// R = 0
+	unsigned char chZeroR[] = { 0x30, 0x06, 0x02, 0x01, 0x00, 0x02, 0x01, 0x01 };
+	BOOST_CHECK(!secp256k1::ParseSignatureDER(chZeroR, sizeof(chZeroR), cSig));
+}
+
+BOOST_AUTO_TEST_CASE(oversized_integer)
+{
+	// a 33 byte R or S with a non zero leading byte is at least 2^256, both verifiers must reject it
+	for (int i = 0; i < 20; ++i) {
+		CKey cKey;
+		cKey.MakeNewKey(true);
+		CPubKey cPubKey = cKey.GetPubKey();
+		uint256 cHash = GetRandHash();
+		vector<unsigned char> vchSig;
+		BOOST_CHECK(cKey.Sign(cHash, vchSig));
+
+		secp256k1::CSignature cSig;
+		vector<unsigned char> vchWideR = WidenSignature(vchSig, true, false);
+		BOOST_CHECK(!secp256k1::ParseSignatureDER(&vchWideR[0], vchWideR.size(), cSig));
+		BOOST_CHECK(!VerifyBoth(cPubKey, cHash, vchWideR));
+
+		vector<unsigned char> vchWideS = WidenSignature(vchSig, false, true);
+		BOOST_CHECK(!secp256k1::ParseSignatureDER(&vchWideS[0], vchWideS.size(), cSig));
+		BOOST_CHECK(!VerifyBoth(cPubKey, cHash, vchWideS));
+
+		vector<unsigned char> vchWideBoth = WidenSignature(vchSig, true, true);
+		BOOST_CHECK(!secp256k1::ParseSignatureDER(&vchWideBoth[0], vchWideBoth.size(), cSig));
+		BOOST_CHECK(!VerifyBoth(cPubKey, cHash, vchWideBoth));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(invalid_pubkey)
+{
+	// x = 5 has no point on the curve (5^3 + 7 = 132 is not a square mod p)
+	vector<unsigned char> vchKey(33, 0x00);
+	vchKey[0] = 0x02;
+	vchKey[32] = 0x05;
+	secp256k1::CPoint cPoint;
+	BOOST_CHECK(!secp256k1::ParsePubKey(&vchKey[0], vchKey.size(), cPoint));
+
+	vector<unsigned char> vchSig;
+	CKey cKey;
+	cKey.MakeNewKey(true);
+	uint256 cHash = GetRandHash();
+	BOOST_CHECK(cKey.Sign(cHash, vchSig));
+	BOOST_CHECK(!VerifyBoth(CPubKey(vchKey), cHash, vchSig));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
@@ -0,0 +1,57 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "main.h"
+#include "snapshot.h"
+#include "util.h"
+
+#include <stdio.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(snapshot_tests)
+
+BOOST_AUTO_TEST_CASE(export_verify) {
+	boost::filesystem::path path = GetDataDir() / "snapshot_tests.snapshot";
+	ST_SnapshotInfo tExported;
+	string strError;
+	BOOST_REQUIRE_MESSAGE(ExportStateSnapshot(path, tExported, strError), strError);
+	{
+		LOCK(g_cs_main);
+		BOOST_CHECK_EQUAL(tExported.nHeight, g_cChainActive.Height());
+		BOOST_CHECK(tExported.cBlockHash == g_cChainActive.Tip()->GetBlockHash());
+	}
+	BOOST_CHECK_EQUAL(tExported.arrullRecords[EM_SNAPSHOT_BLOCK_INDEX], (uint64_t) tExported.nHeight + 1);
+	BOOST_CHECK(tExported.arrullRecords[EM_SNAPSHOT_ACCOUNT] > 0);
+
+	ST_SnapshotInfo tRead;
+	BOOST_CHECK_MESSAGE(VerifyStateSnapshot(path, tExported.cRoot, tRead, strError), strError);
+	BOOST_CHECK(tRead.cRoot == tExported.cRoot);
+	BOOST_CHECK(tRead.cBlockHash == tExported.cBlockHash);
+	BOOST_CHECK_EQUAL(tRead.ullChunks, tExported.ullChunks);
+	for (int i = 0; i < EM_SNAPSHOT_END; ++i) {
+		BOOST_CHECK_EQUAL(tRead.arrullRecords[i], tExported.arrullRecords[i]);
+	}
+
+	// any other pinned hash is refused
+	uint256 cOtherRoot = tExported.cRoot;
+	*cOtherRoot.begin() ^= 1;
+	BOOST_CHECK(!VerifyStateSnapshot(path, cOtherRoot, tRead, strError));
+
+	// so is a flipped byte past the header
+	FILE *pFile = fopen(path.string().c_str(), "r+b");
+	BOOST_REQUIRE(pFile != NULL);
+	long lPos = (long) (tExported.ullBytes / 2);
+	fseek(pFile, lPos, SEEK_SET);
+	int nByte = fgetc(pFile);
+	fseek(pFile, lPos, SEEK_SET);
+	fputc(nByte ^ 0x80, pFile);
+	fclose(pFile);
+	BOOST_CHECK(!VerifyStateSnapshot(path, tExported.cRoot, tRead, strError));
+
+	boost::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -19,7 +19,7 @@ void DetectShutdownThread(boost::thread_group* threadGroup) {
 		threadGroup->interrupt_all();
 		threadGroup->join_all();
 	}
-	CUIServer::StopServer();
+	g_cEventServer.Stop();
 }
 
 bool PrintTestNotSetPara() {
@@ -669,12 +669,7 @@ bool SysTestBase::GetKeyId(string const &strAddr, CKeyID &cKeyId) {
 }
 
 bool SysTestBase::IsTxInMemorypool(const uint256& cTxHash) {
-	for (const auto& entry : g_cTxMemPool.m_mapTx) {
-		if (entry.first == cTxHash) {
-			return true;
-		}
-	}
-	return false;
+	return g_cTxMemPool.exists(cTxHash);
 }
 
 bool SysTestBase::IsTxUnConfirmdInWallet(const uint256& cTxHash) {
@@ -0,0 +1,52 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "vm/vmprofiler.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(vmprofiler_tests)
+
+BOOST_AUTO_TEST_CASE(vmprofiler_aggregate) {
+	static const char *pszRead = "ReadData";
+	static const char *pszWrite = "WriteData";
+	vector<unsigned char> vchApp1(6, 0x01);
+	vector<unsigned char> vchApp2(6, 0x02);
+	CVmProfiler cProfiler;
+
+	ST_VmRunProfile tRun;
+	tRun.AddHostCall(pszRead, EM_HOST_CALL_DB_READ, 5);
+	tRun.AddHostCall(pszRead, EM_HOST_CALL_DB_READ, 7);
+	tRun.AddHostCall(pszWrite, EM_HOST_CALL_DB_WRITE, 20);
+	BOOST_CHECK_EQUAL(tRun.ullDbReads, 2U);
+	BOOST_CHECK_EQUAL(tRun.ullDbWrites, 1U);
+	cProfiler.AddRun(vchApp1, 1, 1000, 300, tRun);
+	cProfiler.AddRun(vchApp1, 1, 500, 100, tRun);
+	// a failed run counts no steps
+	cProfiler.AddRun(vchApp1, 1, -1, 50, ST_VmRunProfile());
+	cProfiler.AddRun(vchApp2, 0, 10, 1, ST_VmRunProfile());
+
+	map<vector<unsigned char>, ST_VmScriptProfile> mapProfiles = cProfiler.GetProfiles();
+	BOOST_CHECK_EQUAL(mapProfiles.size(), 2U);
+	const ST_VmScriptProfile &tProfile = mapProfiles[vchApp1];
+	BOOST_CHECK_EQUAL(tProfile.nScriptType, 1);
+	BOOST_CHECK_EQUAL(tProfile.ullRuns, 3U);
+	BOOST_CHECK_EQUAL(tProfile.ullFailed, 1U);
+	BOOST_CHECK_EQUAL(tProfile.ullSteps, 1500U);
+	BOOST_CHECK_EQUAL(tProfile.ullMaxSteps, 1000U);
+	BOOST_CHECK_EQUAL(tProfile.llMicros, 450);
+	BOOST_CHECK_EQUAL(tProfile.llMaxMicros, 300);
+	BOOST_CHECK_EQUAL(tProfile.ullDbReads, 4U);
+	BOOST_CHECK_EQUAL(tProfile.ullDbWrites, 2U);
+	BOOST_REQUIRE(tProfile.mapHostCalls.count("ReadData"));
+	const ST_VmHostCallStats &tRead = tProfile.mapHostCalls.find("ReadData")->second;
+	BOOST_CHECK_EQUAL(tRead.ullCalls, 4U);
+	BOOST_CHECK_EQUAL(tRead.llMicros, 24);
+	BOOST_CHECK_EQUAL(tRead.llMaxMicros, 7);
+
+	cProfiler.Reset();
+	BOOST_CHECK(cProfiler.GetProfiles().empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
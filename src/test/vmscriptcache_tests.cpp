@@ -0,0 +1,75 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "vm/script.h"
+
+#include <boost/test/unit_test.hpp>
+
+static std::shared_ptr<const CVmScript> MakeScript(unsigned char uchFill) {
+	std::shared_ptr<CVmScript> pScript = std::make_shared<CVmScript>();
+	pScript->m_vuchRom.assign(1000, uchFill);
+	return pScript;
+}
+
+BOOST_AUTO_TEST_SUITE(vmscriptcache_tests)
+
+BOOST_AUTO_TEST_CASE(vmscriptcache_lru) {
+	vector<unsigned char> vchApp1(6, 0x01);
+	vector<unsigned char> vchApp2(6, 0x02);
+	vector<unsigned char> vchApp3(6, 0x03);
+	// room for two scripts
+	CVmScriptCache cCache(2 * (1000 + sizeof(CVmScript)));
+
+	cCache.Put(vchApp1, MakeScript(1), cCache.GetGeneration());
+	cCache.Put(vchApp2, MakeScript(2), cCache.GetGeneration());
+	BOOST_CHECK_EQUAL(cCache.GetCount(), 2U);
+	BOOST_REQUIRE(cCache.Get(vchApp1));
+	BOOST_CHECK_EQUAL(cCache.Get(vchApp1)->m_vuchRom[0], 1);
+
+	// app2 is now the least recently used
+	cCache.Put(vchApp3, MakeScript(3), cCache.GetGeneration());
+	BOOST_CHECK_EQUAL(cCache.GetCount(), 2U);
+	BOOST_CHECK(cCache.Get(vchApp1));
+	BOOST_CHECK(!cCache.Get(vchApp2));
+	BOOST_CHECK(cCache.Get(vchApp3));
+
+	cCache.SetMaxBytes(0);
+	BOOST_CHECK_EQUAL(cCache.GetCount(), 0U);
+	BOOST_CHECK_EQUAL(cCache.GetBytes(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(vmscriptcache_invalidate) {
+	vector<unsigned char> vchApp1(6, 0x01);
+	CVmScriptCache cCache(1 << 20);
+
+	cCache.Put(vchApp1, MakeScript(1), cCache.GetGeneration());
+	cCache.Erase(vchApp1);
+	BOOST_CHECK(!cCache.Get(vchApp1));
+	BOOST_CHECK_EQUAL(cCache.GetBytes(), 0U);
+
+	// a script read before an erase must not be cached after it
+	uint64_t ullGeneration = cCache.GetGeneration();
+	cCache.Erase(vector<unsigned char>(6, 0x02));
+	cCache.Put(vchApp1, MakeScript(1), ullGeneration);
+	BOOST_CHECK(!cCache.Get(vchApp1));
+
+	cCache.Put(vchApp1, MakeScript(1), cCache.GetGeneration());
+	cCache.Clear();
+	BOOST_CHECK(!cCache.Get(vchApp1));
+}
+
+BOOST_AUTO_TEST_CASE(vmscriptcache_bypass) {
+	vector<unsigned char> vchApp1(6, 0x01);
+	g_cVmScriptCache.Put(vchApp1, MakeScript(1), g_cVmScriptCache.GetGeneration());
+	{
+		CVmScriptCacheBypass cBypass;
+		BOOST_CHECK(!g_cVmScriptCache.Get(vchApp1));
+		g_cVmScriptCache.Put(vector<unsigned char>(6, 0x02), MakeScript(2), g_cVmScriptCache.GetGeneration());
+	}
+	BOOST_CHECK(g_cVmScriptCache.Get(vchApp1));
+	BOOST_CHECK(!g_cVmScriptCache.Get(vector<unsigned char>(6, 0x02)));
+	g_cVmScriptCache.Clear();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
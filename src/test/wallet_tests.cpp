@@ -0,0 +1,137 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <boost/test/unit_test.hpp>
+#include "systestbase.h"
+#include "wallet/wallet.h"
+using namespace std;
+
+class CWalletSyncTest : public SysTestBase {
+ public:
+	CWalletSyncTest() :
+			m_strWalletFile("wallet_sync_test.dat") {
+		ResetEnv();
+		g_cDacrsDbEnv.RemoveDb(m_strWalletFile);
+	}
+
+	~CWalletSyncTest() {
+		g_cDacrsDbEnv.CloseDb(m_strWalletFile);
+		g_cDacrsDbEnv.RemoveDb(m_strWalletFile);
+		ResetEnv();
+	}
+
+	// a block at the tip paying from the funded account 000000000400 to two addresses
+	bool MineTransfers(CBlock &cBlock, set<uint256> &setTxHash) {
+		const char *arrchDest[] = { "dkJwhBs2P2SjbQWt5Bz6vzjqUhXTymvsGr", "dgZjR2S98gmdvXDzwKASxKiaGr9Dw1GD8F" };
+		for (auto pchDest : arrchDest) {
+			string strHash;
+			if (!GetHashFromCreatedTx(CreateNormalTx("000000000400", pchDest, 10000000), strHash)) {
+				return false;
+			}
+			setTxHash.insert(uint256S(strHash));
+		}
+		if (!GenerateOneBlock()) {
+			return false;
+		}
+		LOCK(g_cs_main);
+		return ReadBlockFromDisk(cBlock, g_cChainActive.Tip());
+	}
+
+	// the key of the paying account, taken from the node's wallet
+	bool GetPayerKey(CKey &cKey) {
+		LOCK(g_cs_main);
+		CKeyID cKeyId;
+		if (!g_pAccountViewTip->GetKeyId(CUserID(CRegID("000000000400")), cKeyId)) {
+			return false;
+		}
+		return g_pwalletMain->GetKey(cKeyId, cKey);
+	}
+
+	// the sums the balance index replaced, walking every key of the wallet
+	void WalkBalance(int64_t &llConfirmed, int64_t &llUnConfirmed) {
+		LOCK2(g_cs_main, g_pwalletMain->m_cs_wallet);
+		llConfirmed = 0;
+		llUnConfirmed = 0;
+		set<CKeyID> setKeyId;
+		g_pwalletMain->GetKeys(setKeyId);
+		for (auto &keyId : setKeyId) {
+			llConfirmed += g_pAccountViewTip->GetRawBalance(keyId);
+			llUnConfirmed += g_cTxMemPool.m_pAccountViewCache->GetRawBalance(keyId);
+			BOOST_CHECK_EQUAL(g_pwalletMain->GetRawBalance(keyId, true), g_pAccountViewTip->GetRawBalance(keyId));
+			BOOST_CHECK_EQUAL(g_pwalletMain->GetRawBalance(keyId, false),
+					g_cTxMemPool.m_pAccountViewCache->GetRawBalance(keyId));
+		}
+	}
+
+	void CheckBalanceIndex() {
+		int64_t llConfirmed, llUnConfirmed;
+		WalkBalance(llConfirmed, llUnConfirmed);
+		BOOST_CHECK_EQUAL(g_pwalletMain->GetRawBalance(true), llConfirmed);
+		BOOST_CHECK_EQUAL(g_pwalletMain->GetRawBalance(false), llUnConfirmed);
+	}
+
+	string m_strWalletFile;
+};
+
+BOOST_FIXTURE_TEST_SUITE(wallet_tests, CWalletSyncTest)
+
+BOOST_FIXTURE_TEST_CASE(block_sync_batch, CWalletSyncTest) {
+	CBlock cBlock;
+	set<uint256> setTxHash;
+	BOOST_REQUIRE(MineTransfers(cBlock, setTxHash));
+	uint256 cBlockHash = cBlock.GetHash();
+	CKey cKey;
+	BOOST_REQUIRE(GetPayerKey(cKey));
+
+	{
+		CWallet cWallet(m_strWalletFile);
+		cWallet.LoadWallet(false);
+		BOOST_CHECK(cWallet.AddKey(cKey));
+		// queue the block's changes instead of writing them, as with the writer thread
+		cWallet.SetWriteBehind(true);
+		cWallet.SyncTransaction(uint256(), NULL, &cBlock);
+		BOOST_CHECK_EQUAL(cWallet.GetPendingWriteBatchSize(), 1U);
+		BOOST_REQUIRE(cWallet.m_mapInBlockTx.count(cBlockHash));
+		for (const auto &hash : setTxHash) {
+			BOOST_CHECK(cWallet.m_mapInBlockTx[cBlockHash].m_mapAccountTx.count(hash));
+		}
+		BOOST_CHECK(cWallet.FlushWriteBatch());
+		BOOST_CHECK_EQUAL(cWallet.GetPendingWriteBatchSize(), 0U);
+		cWallet.SetWriteBehind(false);
+	}
+	g_cDacrsDbEnv.CloseDb(m_strWalletFile);
+
+	// the committed batch is what a reopened wallet reads back
+	CWallet cReopened(m_strWalletFile);
+	BOOST_CHECK(cReopened.LoadWallet(false) == EM_DB_LOAD_OK);
+	BOOST_REQUIRE(cReopened.m_mapInBlockTx.count(cBlockHash));
+	const CAccountTx &cAccountTx = cReopened.m_mapInBlockTx[cBlockHash];
+	for (const auto &hash : setTxHash) {
+		BOOST_CHECK(cAccountTx.m_mapAccountTx.count(hash));
+	}
+	CKey cLoadedKey;
+	BOOST_CHECK(cReopened.GetKey(cKey.GetPubKey().GetKeyID(), cLoadedKey));
+}
+
+BOOST_FIXTURE_TEST_CASE(balance_index, CWalletSyncTest) {
+	CheckBalanceIndex();
+	int64_t llBefore = g_pwalletMain->GetRawBalance(true);
+
+	// in the mempool only
+	string strHash;
+	BOOST_REQUIRE(GetHashFromCreatedTx(CreateNormalTx("000000000400", "dkJwhBs2P2SjbQWt5Bz6vzjqUhXTymvsGr", 10000000),
+			strHash));
+	CheckBalanceIndex();
+
+	// connected
+	BOOST_REQUIRE(GenerateOneBlock());
+	CheckBalanceIndex();
+
+	// disconnected again
+	BOOST_REQUIRE(DisConnectBlock(1));
+	CheckBalanceIndex();
+	BOOST_CHECK_EQUAL(g_pwalletMain->GetRawBalance(true), llBefore);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -301,12 +301,9 @@ int CBaseTransaction::GetFuelRate(CScriptDBViewCache &scriptDB) {
 	if (0 == m_nFuelRate) {
 		ST_DiskTxPos cPostx;
 		if (scriptDB.ReadTxIndex(GetHash(), cPostx)) {
-			CAutoFile cFile(OpenBlockFile(cPostx, true), SER_DISK, g_sClientVersion);
 			CBlockHeader cHeader;
-			try {
-				cFile >> cHeader;
-			} catch (std::exception &e) {
-				return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+			if (!ReadTxFromDisk(cPostx, cHeader)) {
+				return false;
 			}
 			m_nFuelRate = cHeader.GetFuelRate();
 		} else {
@@ -441,7 +438,7 @@ Object CRegisterAccountTx::ToJSON(const CAccountViewCache &cAccountView) const {
 }
 
 bool CRegisterAccountTx::CheckTransction(CValidationState &cValidationState, CAccountViewCache &cAccountViewCache,
-		CScriptDBViewCache &cScriptDB) {
+		CScriptDBViewCache &cScriptDB, bool bCheckSig) {
 
 	if (m_cUserId.type() != typeid(CPubKey)) {
 		return cValidationState.DoS(100, ERRORMSG("CheckTransaction() : CRegisterAppTx userId must be CPubKey"),
@@ -463,7 +460,7 @@ bool CRegisterAccountTx::CheckTransction(CValidationState &cValidationState, CAc
 
 	//check signature script
 	uint256 cSighash = SignatureHash();
-	if (!CheckSignScript(cSighash, m_vchSignature, boost::get<CPubKey>(m_cUserId))) {
+	if (bCheckSig && !CheckSignScript(cSighash, m_vchSignature, boost::get<CPubKey>(m_cUserId))) {
 		return cValidationState.DoS(100,
 				ERRORMSG("CheckTransaction() : CRegisterAccountTx CheckTransction, register tx signature error "),
 				REJECT_INVALID, "bad-regtx-signature");
@@ -728,7 +725,8 @@ Object CTransaction::ToJSON(const CAccountViewCache &cAccountView) const{
     return result;
 }
 
-bool CTransaction::CheckTransction(CValidationState &cValidationState, CAccountViewCache &cAccountViewCache, CScriptDBViewCache &cScriptDB) {
+bool CTransaction::CheckTransction(CValidationState &cValidationState, CAccountViewCache &cAccountViewCache, CScriptDBViewCache &cScriptDB,
+		bool bCheckSig) {
 
 	if(m_cSrcRegId.type() != typeid(CRegID)) {
 		return cValidationState.DoS(100, ERRORMSG("CheckTransaction() : CTransaction srcRegId must be CRegID"), REJECT_INVALID, "srcaddr-type-error");
@@ -753,7 +751,7 @@ bool CTransaction::CheckTransction(CValidationState &cValidationState, CAccountV
 	}
 
 	uint256 cSighash = SignatureHash();
-	if (!CheckSignScript(cSighash, m_vchSignature, cAcctInfo.m_cPublicKey)) {
+	if (bCheckSig && !CheckSignScript(cSighash, m_vchSignature, cAcctInfo.m_cPublicKey)) {
 		return cValidationState.DoS(100, ERRORMSG("CheckTransaction() : CTransaction CheckTransction, CheckSignScript failed"), REJECT_INVALID,
 				"bad-signscript-check");
 	}
@@ -875,7 +873,8 @@ Object CRewardTransaction::ToJSON(const CAccountViewCache &AccountView) const{
 	return std::move(result);
 }
 
-bool CRewardTransaction::CheckTransction(CValidationState &state, CAccountViewCache &view, CScriptDBViewCache &scriptDB) {
+bool CRewardTransaction::CheckTransction(CValidationState &state, CAccountViewCache &view, CScriptDBViewCache &scriptDB,
+		bool bCheckSig) {
 	return true;
 }
 
@@ -1076,7 +1075,8 @@ Object CRegisterAppTx::ToJSON(const CAccountViewCache &AccountView) const{
 	result.push_back(Pair("height", m_nValidHeight));
 	return result;
 }
-bool CRegisterAppTx::CheckTransction(CValidationState &state, CAccountViewCache &view, CScriptDBViewCache &scriptDB) {
+bool CRegisterAppTx::CheckTransction(CValidationState &state, CAccountViewCache &view, CScriptDBViewCache &scriptDB,
+		bool bCheckSig) {
 
 	if (m_cRegAcctId.type() != typeid(CRegID)) {
 		return state.DoS(100, ERRORMSG("CheckTransaction() : CRegisterAppTx regAcctId must be CRegID"), REJECT_INVALID,
@@ -1107,7 +1107,7 @@ bool CRegisterAppTx::CheckTransction(CValidationState &state, CAccountViewCache
 				"bad-no-pubkey");
 	}
 	uint256 cSignhash = SignatureHash();
-	if (!CheckSignScript(cSignhash, m_vchSignature, cAcctInfo.m_cPublicKey)) {
+	if (bCheckSig && !CheckSignScript(cSignhash, m_vchSignature, cAcctInfo.m_cPublicKey)) {
 		return state.DoS(100, ERRORMSG("CheckTransaction() : CRegisterAppTx CheckTransction, CheckSignScript failed"), REJECT_INVALID,
 				"bad-signscript-check");
 	}
@@ -233,7 +233,9 @@ class CBaseTransaction {
 	virtual bool UndoExecuteTx(int nIndex, CAccountViewCache &view, CValidationState &state, CTxUndo &txundo,
 			int nHeight, CTransactionDBCache &txCache, CScriptDBViewCache &scriptDB);
 
-	virtual bool CheckTransction(CValidationState &state, CAccountViewCache &view, CScriptDBViewCache &scriptDB) = 0;
+	/** Context checks of the transaction, bCheckSig false skips its signature for assumed valid blocks */
+	virtual bool CheckTransction(CValidationState &state, CAccountViewCache &view, CScriptDBViewCache &scriptDB,
+			bool bCheckSig) = 0;
 
 	virtual uint64_t GetFuel(int nfuelRate);
 	virtual uint64_t GetValue() const = 0;
@@ -322,7 +324,8 @@ class CRegisterAccountTx: public CBaseTransaction {
 	bool UndoExecuteTx(int nIndex, CAccountViewCache &cAccountViewCache, CValidationState &cValidationState, CTxUndo &txundo, int nHeight,
 			CTransactionDBCache &cTxCache, CScriptDBViewCache &cScriptDB);
 
-	bool CheckTransction(CValidationState &cValidationState, CAccountViewCache &cAccountViewCache, CScriptDBViewCache &cScriptDB);
+	bool CheckTransction(CValidationState &cValidationState, CAccountViewCache &cAccountViewCache, CScriptDBViewCache &cScriptDB,
+			bool bCheckSig);
 
  public:
  	mutable CUserID m_cUserId;      //pubkey
@@ -431,7 +434,8 @@ class CTransaction : public CBaseTransaction {
 	bool ExecuteTx(int nIndex, CAccountViewCache &cAccountViewCache, CValidationState &cValidationState, CTxUndo &cTxundo, int nHeight,
 			CTransactionDBCache &cTxCache, CScriptDBViewCache &cScriptDB);
 
-	bool CheckTransction(CValidationState &cValidationState, CAccountViewCache &cAccountViewCache, CScriptDBViewCache &cScriptDB);
+	bool CheckTransction(CValidationState &cValidationState, CAccountViewCache &cAccountViewCache, CScriptDBViewCache &cScriptDB,
+			bool bCheckSig);
 
  public:
  	mutable CUserID m_cSrcRegId;                   //src regid
@@ -507,7 +511,7 @@ class CRewardTransaction: public CBaseTransaction {
 	bool ExecuteTx(int nIndex, CAccountViewCache &view, CValidationState &state, CTxUndo &txundo, int nHeight,
 			CTransactionDBCache &txCache, CScriptDBViewCache &scriptDB);
 
-	bool CheckTransction(CValidationState &state, CAccountViewCache &view, CScriptDBViewCache &scriptDB);
+	bool CheckTransction(CValidationState &state, CAccountViewCache &view, CScriptDBViewCache &scriptDB, bool bCheckSig);
 
  public:
  	mutable CUserID m_cAccount;   // in genesis block are pubkey, otherwise are m_cAccount id
@@ -574,7 +578,7 @@ class CRegisterAppTx: public CBaseTransaction {
 	bool UndoExecuteTx(int nIndex, CAccountViewCache &view, CValidationState &state, CTxUndo &txundo, int nHeight,
 			CTransactionDBCache &txCache, CScriptDBViewCache &scriptDB);
 
-	bool CheckTransction(CValidationState &state, CAccountViewCache &view, CScriptDBViewCache &scriptDB);
+	bool CheckTransction(CValidationState &state, CAccountViewCache &view, CScriptDBViewCache &scriptDB, bool bCheckSig);
 
  public:
  	mutable CUserID m_cRegAcctId;         //regid
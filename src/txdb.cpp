@@ -4,6 +4,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "txdb.h"
+#include "chainparams.h"
 #include "util.h"
 #include "core.h"
 #include "uint256.h"
@@ -17,14 +18,35 @@ using namespace std;
 //	batch.Write('B', hash);
 //}
 
+// The split of CLevelDBWrapper's cache size constructor, with table compression as -dbcompress says
+static ST_LevelDBTuning GetDBTuning(size_t unCacheSize) {
+	ST_LevelDBTuning tTuning;
+	tTuning.unBlockCacheSize 	= unCacheSize / 2;
+	tTuning.unWriteBufferSize 	= unCacheSize / 4;
+	tTuning.bCompress 			= SysCfg().GetBoolArg("-dbcompress", false);
+	return tTuning;
+}
+
 CBlockTreeDB::CBlockTreeDB(size_t unCacheSize, bool bMemory, bool bWipe) :
-		CLevelDBWrapper(GetDataDir() / "blocks" / "index", unCacheSize, bMemory, bWipe) {
+		CLevelDBWrapper(GetDataDir() / "blocks" / "index", GetDBTuning(unCacheSize), bMemory, bWipe) {
 }
 
 bool CBlockTreeDB::WriteBlockIndex(const CDiskBlockIndex& cBlockindex) {
 	return Write(make_pair('b', cBlockindex.GetBlockHash()), cBlockindex);
 }
 
+bool CBlockTreeDB::WriteBlockIndex(const vector<CDiskBlockIndex> &vcBlockIndex) {
+	CLevelDBBatch cLevelDBBatch;
+	for (const auto &cBlockIndex : vcBlockIndex) {
+		cLevelDBBatch.Write(make_pair('b', cBlockIndex.GetBlockHash()), cBlockIndex);
+	}
+	return WriteBatch(cLevelDBBatch);
+}
+
+bool CBlockTreeDB::ReadBlockIndex(const uint256 &cBlockHash, CDiskBlockIndex& cBlockindex) {
+	return Read(make_pair('b', cBlockHash), cBlockindex);
+}
+
 bool CBlockTreeDB::EraseBlockIndex(const uint256 &cBlockHash) {
 	return Erase(make_pair('b', cBlockHash));
 }
@@ -90,68 +112,58 @@ bool CBlockTreeDB::ReadFlag(const string &strName, bool &bValue) {
 }
 
 bool CBlockTreeDB::LoadBlockIndexGuts() {
-	leveldb::Iterator *pcursor = NewIterator();
-
-	CDataStream ssKeySet(SER_DISK, g_sClientVersion);
-	ssKeySet << make_pair('b', uint256());
-	pcursor->Seek(ssKeySet.str());
+	std::unique_ptr<CLevelDBIterator> pCursor = NewIterator(string(1, 'b'));
 
 	// Load mapBlockIndex
-	while (pcursor->Valid()) {
+	for (pCursor->Seek(); pCursor->Valid(); pCursor->Next()) {
 		boost::this_thread::interruption_point();
 		try {
-			leveldb::Slice cSliceKey = pcursor->key();
-			CDataStream cDSKey(cSliceKey.data(), cSliceKey.data() + cSliceKey.size(), SER_DISK, g_sClientVersion);
-			char chType;
-			cDSKey >> chType;
-			if (chType == 'b') {
-				leveldb::Slice cSliceValue = pcursor->value();
-				CDataStream cDSValue(cSliceValue.data(), cSliceValue.data() + cSliceValue.size(), SER_DISK, g_sClientVersion);
-				CDiskBlockIndex cDiskBlockIndex;
-				cDSValue >> cDiskBlockIndex;
-
-				// Construct block index object
-				CBlockIndex* pIndexNew 			= InsertBlockIndex(cDiskBlockIndex.GetBlockHash());
-				pIndexNew->m_pPrevBlockIndex 				= InsertBlockIndex(cDiskBlockIndex.m_cHashPrev);
-				pIndexNew->m_nHeight 			= cDiskBlockIndex.m_nHeight;
-				pIndexNew->m_nFile 				= cDiskBlockIndex.m_nFile;
-				pIndexNew->m_nDataPos 			= cDiskBlockIndex.m_nDataPos;
-				pIndexNew->m_nUndoPos 			= cDiskBlockIndex.m_nUndoPos;
-				pIndexNew->m_nVersion 			= cDiskBlockIndex.m_nVersion;
-				pIndexNew->m_cHashMerkleRoot 	= cDiskBlockIndex.m_cHashMerkleRoot;
-				pIndexNew->m_cHashPos 			= cDiskBlockIndex.m_cHashPos;
-				pIndexNew->m_unTime 			= cDiskBlockIndex.m_unTime;
-				pIndexNew->m_unBits 			= cDiskBlockIndex.m_unBits;
-				pIndexNew->m_unNonce 			= cDiskBlockIndex.m_unNonce;
-				pIndexNew->m_unStatus 			= cDiskBlockIndex.m_unStatus;
-				pIndexNew->m_unTx 				= cDiskBlockIndex.m_unTx;
-				pIndexNew->m_llFuel 			= cDiskBlockIndex.m_llFuel;
-				pIndexNew->m_nFuelRate 			= cDiskBlockIndex.m_nFuelRate;
-				pIndexNew->m_vchSignature 		= cDiskBlockIndex.m_vchSignature;
-				pIndexNew->m_dFeePerKb 			= cDiskBlockIndex.m_dFeePerKb;
-
-				if (!pIndexNew->CheckIndex()) {
-					return ERRORMSG("LoadBlockIndex() : CheckIndex failed: %s", pIndexNew->ToString());
-				}
-				pcursor->Next();
-			} else {
-				break; 				// if shutdown requested or finished loading block index
+			CSliceReader cReader(pCursor->Value());
+			CDiskBlockIndex cDiskBlockIndex;
+			cReader >> cDiskBlockIndex;
+
+			// Construct block index object
+			CBlockIndex* pIndexNew 			= InsertBlockIndex(cDiskBlockIndex.GetBlockHash());
+			pIndexNew->m_pPrevBlockIndex 				= InsertBlockIndex(cDiskBlockIndex.m_cHashPrev);
+			pIndexNew->m_nHeight 			= cDiskBlockIndex.m_nHeight;
+			pIndexNew->m_nFile 				= cDiskBlockIndex.m_nFile;
+			pIndexNew->m_nDataPos 			= cDiskBlockIndex.m_nDataPos;
+			pIndexNew->m_nUndoPos 			= cDiskBlockIndex.m_nUndoPos;
+			pIndexNew->m_nVersion 			= cDiskBlockIndex.m_nVersion;
+			pIndexNew->m_cHashMerkleRoot 	= cDiskBlockIndex.m_cHashMerkleRoot;
+			pIndexNew->m_cHashPos 			= cDiskBlockIndex.m_cHashPos;
+			pIndexNew->m_unTime 			= cDiskBlockIndex.m_unTime;
+			pIndexNew->m_unBits 			= cDiskBlockIndex.m_unBits;
+			pIndexNew->m_unNonce 			= cDiskBlockIndex.m_unNonce;
+			pIndexNew->m_unStatus 			= cDiskBlockIndex.m_unStatus;
+			pIndexNew->m_unTx 				= cDiskBlockIndex.m_unTx;
+			pIndexNew->m_llFuel 			= cDiskBlockIndex.m_llFuel;
+			pIndexNew->m_nFuelRate 			= cDiskBlockIndex.m_nFuelRate;
+			pIndexNew->m_vchSignature 		= cDiskBlockIndex.m_vchSignature;
+			pIndexNew->m_dFeePerKb 			= cDiskBlockIndex.m_dFeePerKb;
+
+			if (!pIndexNew->CheckIndex()) {
+				return ERRORMSG("LoadBlockIndex() : CheckIndex failed: %s", pIndexNew->ToString());
 			}
 		} catch (std::exception &e) {
 			return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
 		}
 	}
-	delete pcursor;
+	HandleError(pCursor->Status());
 
 	return true;
 }
 
 CAccountViewDB::CAccountViewDB(size_t unCacheSize, bool bMemory, bool bWipe) :
-		m_cLevelDBWrapper(GetDataDir() / "blocks" / "account", unCacheSize, bMemory, bWipe) {
+		m_cLevelDBWrapper(GetDataDir() / "blocks" / "account", GetDBTuning(unCacheSize), bMemory, bWipe) {
 }
 
 CAccountViewDB::CAccountViewDB(const string& strName, size_t unCacheSize, bool bMemory, bool bWipe) :
-		m_cLevelDBWrapper(GetDataDir() / "blocks" / strName, unCacheSize, bMemory, bWipe) {
+		m_cLevelDBWrapper(GetDataDir() / "blocks" / strName, GetDBTuning(unCacheSize), bMemory, bWipe) {
+}
+
+CAccountViewDB::CAccountViewDB(CAccountViewDB *pBase) :
+		m_cLevelDBWrapper(&pBase->m_cLevelDBWrapper) {
 }
 
 bool CAccountViewDB::GetAccount(const CKeyID &cKeyId, CAccount &cSecureAccount) {
@@ -255,41 +267,25 @@ bool CAccountViewDB::SaveAccountInfo(const vector<unsigned char> &vchAccountId,
 }
 
 uint64_t CAccountViewDB::TraverseAccount() {
-	leveldb::Iterator *pCursor = m_cLevelDBWrapper.NewIterator();
+	std::unique_ptr<CLevelDBIterator> pCursor = m_cLevelDBWrapper.NewIterator(string(1, 'k'));
 
 	uint64_t ullTotalCoin(0);
-	CDataStream cDSKeySet(SER_DISK, g_sClientVersion);
-	cDSKeySet << make_pair('k', CKeyID());
-	pCursor->Seek(cDSKeySet.str());
-
-	// Load mapBlockIndex
-	while (pCursor->Valid()) {
+	for (pCursor->Seek(); pCursor->Valid(); pCursor->Next()) {
 		boost::this_thread::interruption_point();
 		try {
-			leveldb::Slice cSliceKey = pCursor->key();
-			CDataStream cDSKey(cSliceKey.data(), cSliceKey.data() + cSliceKey.size(), SER_DISK, g_sClientVersion);
-			char chType;
-			cDSKey >> chType;
-			if (chType == 'k') {
-				leveldb::Slice cSliceValue = pCursor->value();
-				CDataStream cDSValue(cSliceValue.data(), cSliceValue.data() + cSliceValue.size(), SER_DISK, g_sClientVersion);
-				CAccount cAccount;
-				cDSValue >> cAccount;
-				ullTotalCoin += cAccount.m_ullValues;
-				pCursor->Next();
-			} else {
-				break; 				// if shutdown requested or finished loading block index
-			}
+			CSliceReader cReader(pCursor->Value());
+			CAccount cAccount;
+			cReader >> cAccount;
+			ullTotalCoin += cAccount.m_ullValues;
 		} catch (std::exception &e) {
 			return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
 		}
 	}
-	delete pCursor;
 	return ullTotalCoin;
 }
 
 CTransactionDB::CTransactionDB(size_t unCacheSize, bool bMemory, bool bWipe) :
-		m_LevelDBWrapper(GetDataDir() / "blocks" / "txcache", unCacheSize, bMemory, bWipe) {
+		m_LevelDBWrapper(GetDataDir() / "blocks" / "txcache", GetDBTuning(unCacheSize), bMemory, bWipe) {
 }
 
 bool CTransactionDB::SetTxCache(const uint256 &cBlockHash, const vector<uint256> &vcHashTxSet) {
@@ -315,230 +311,366 @@ bool CTransactionDB::BatchWrite(const map<uint256, vector<uint256> > &mapTxHashB
 }
 
 bool CTransactionDB::LoadTransaction(map<uint256, vector<uint256> > &mapTxHashByBlockHash) {
-	leveldb::Iterator *pCursor = m_LevelDBWrapper.NewIterator();
-	CDataStream cDSKeySet(SER_DISK, g_sClientVersion);
-	cDSKeySet << make_pair('h', uint256());
-	pCursor->Seek(cDSKeySet.str());
-	// Load mapBlockIndex
-	while (pCursor->Valid()) {
+	std::unique_ptr<CLevelDBIterator> pCursor = m_LevelDBWrapper.NewIterator(string(1, 'h'));
+	for (pCursor->Seek(); pCursor->Valid(); pCursor->Next()) {
 		boost::this_thread::interruption_point();
 		try {
-			leveldb::Slice cSliceKey = pCursor->key();
-			CDataStream cDSKey(cSliceKey.data(), cSliceKey.data() + cSliceKey.size(), SER_DISK, g_sClientVersion);
-			char chType;
-			cDSKey >> chType;
-			if (chType == 'h') {
-				leveldb::Slice cSliceValue = pCursor->value();
-				CDataStream cDSValue(cSliceValue.data(), cSliceValue.data() + cSliceValue.size(), SER_DISK, g_sClientVersion);
-				vector<uint256> vcTxhash;
-				uint256 cBlockHash;
-				cDSValue >> vcTxhash;
-				cDSKey >> cBlockHash;
-				mapTxHashByBlockHash[cBlockHash] = vcTxhash;
-				pCursor->Next();
-			} else {
-				break; // if shutdown requested or finished loading block index
-			}
+			uint256 cBlockHash;
+			CSliceReader(pCursor->KeySuffix()) >> cBlockHash;
+			CSliceReader(pCursor->Value()) >> mapTxHashByBlockHash[cBlockHash];
 		} catch (std::exception &e) {
 			return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
 		}
 	}
-	delete pCursor;
+	HandleError(pCursor->Status());
 	return true;
 }
 
+static const struct {
+	const char *pszPrefix;
+	emScriptStore emStore;
+} s_arrtScriptPrefixes[] = {
+	{ "def", 	EM_SCRIPT_STORE_CODE },
+	{ "snum", 	EM_SCRIPT_STORE_CODE },
+	{ "data", 	EM_SCRIPT_STORE_STATE },
+	{ "sdnum", 	EM_SCRIPT_STORE_STATE },
+	{ "acct", 	EM_SCRIPT_STORE_STATE },
+	{ "afnd", 	EM_SCRIPT_STORE_STATE },
+	{ "T", 		EM_SCRIPT_STORE_INDEX },
+	{ "ADDR", 	EM_SCRIPT_STORE_INDEX },
+	{ "tx", 	EM_SCRIPT_STORE_INDEX },
+	{ "output", EM_SCRIPT_STORE_OUTPUT },
+};
+
+static const struct {
+	const char *pszName;
+	int nCachePercent; 				// share of the script database cache
+	int nBlockCachePercent; 		// of that share, the rest being split between the two write buffers
+	int nBloomBits;
+	bool bCompress;
+	int nMaxOpenFiles;
+} s_arrtScriptStoreTunings[EM_SCRIPT_STORE_MAX] = {
+	// small, read on every contract call and rarely written: mostly block cache, compressed
+	{ "code", 	20, 75, 10, true, 	16 },
+	// hot random reads and writes during execution: uncompressed, the largest share
+	{ "state", 	55, 50, 10, false, 	64 },
+	// append mostly, read by RPCs: large write buffers so index writes are batched, compressed
+	{ "index", 	15, 25, 10, true, 	32 },
+	// written once per contract tx and read when it is undone, always found: no bloom filter
+	{ "output", 10, 25, 0, 	true, 	16 },
+};
+
+static bool HasPrefix(const vector<unsigned char> &vchKey, const char *pszPrefix) {
+	size_t unLen = strlen(pszPrefix);
+	return vchKey.size() >= unLen && 0 == memcmp(&vchKey[0], pszPrefix, unLen);
+}
+
+emScriptStore CScriptDB::GetStore(const vector<unsigned char> &vchKey) {
+	for (const auto &item : s_arrtScriptPrefixes) {
+		if (HasPrefix(vchKey, item.pszPrefix)) {
+			return item.emStore;
+		}
+	}
+	return EM_SCRIPT_STORE_STATE;
+}
+
+const char *CScriptDB::GetStoreName(emScriptStore emStore) {
+	return s_arrtScriptStoreTunings[emStore].pszName;
+}
+
 CScriptDB::CScriptDB(const string& strName,size_t unCacheSize, bool bMemory, bool bWipe) :
-		m_LevelDBWrapper(GetDataDir() / "blocks" / strName, unCacheSize, bMemory, bWipe){
+		m_ptCounters(m_arrtCounters) {
+	Open(strName, unCacheSize, bMemory, bWipe);
 }
 
 CScriptDB::CScriptDB(size_t unCacheSize, bool bMemory, bool bWipe) :
-		m_LevelDBWrapper(GetDataDir() / "blocks" / "script", unCacheSize, bMemory, bWipe){
+		m_ptCounters(m_arrtCounters) {
+	Open("script", unCacheSize, bMemory, bWipe);
+}
+
+CScriptDB::CScriptDB(CScriptDB *pBase) :
+		m_ptCounters(pBase->m_ptCounters) {
+	for (int i = 0; i < EM_SCRIPT_STORE_MAX; ++i) {
+		m_arrpStores[i].reset(new CLevelDBWrapper(pBase->m_arrpStores[i].get()));
+		m_arrtTunings[i] = pBase->m_arrtTunings[i];
+	}
+}
+
+void CScriptDB::Open(const string &strName, size_t unCacheSize, bool bMemory, bool bWipe) {
+	boost::filesystem::path path = GetDataDir() / "blocks" / strName;
+	boost::filesystem::path legacyPath = GetDataDir() / "blocks" / (strName + ".legacy");
+	if (!bMemory) {
+		// a single LevelDB right in the directory is the layout before the stores were split
+		if (boost::filesystem::exists(path / "CURRENT")) {
+			LogPrint("INFO", "Moving the script database in %s aside for migration\n", path.string());
+			boost::filesystem::rename(path, legacyPath);
+		}
+		if (bWipe) {
+			boost::filesystem::remove_all(legacyPath);
+		}
+		boost::filesystem::create_directories(path);
+	}
+	// a legacy database still there means a migration did not finish, so it starts over
+	bool bMigrate = !bMemory && boost::filesystem::exists(legacyPath);
+	for (int i = 0; i < EM_SCRIPT_STORE_MAX; ++i) {
+		size_t unShare = unCacheSize * s_arrtScriptStoreTunings[i].nCachePercent / 100;
+		ST_LevelDBTuning &tTuning = m_arrtTunings[i];
+		tTuning.unBlockCacheSize 	= unShare * s_arrtScriptStoreTunings[i].nBlockCachePercent / 100;
+		tTuning.unWriteBufferSize 	= (unShare - tTuning.unBlockCacheSize) / 2;
+		tTuning.nBloomBits 			= s_arrtScriptStoreTunings[i].nBloomBits;
+		tTuning.bCompress 			= SysCfg().GetBoolArg(string("-dbcompress") + s_arrtScriptStoreTunings[i].pszName,
+				s_arrtScriptStoreTunings[i].bCompress);
+		tTuning.nMaxOpenFiles 		= s_arrtScriptStoreTunings[i].nMaxOpenFiles;
+		m_arrpStores[i].reset(new CLevelDBWrapper(path / s_arrtScriptStoreTunings[i].pszName, tTuning, bMemory,
+				bWipe || bMigrate));
+	}
+	if (bMigrate && !MigrateLegacy(legacyPath)) {
+		throw leveldb_error("Failed to migrate the script database");
+	}
+}
+
+bool CScriptDB::MigrateLegacy(const boost::filesystem::path &legacyPath) {
+	static const size_t unMaxBatchBytes = 16 << 20;
+	LogPrint("INFO", "Migrating the script database in %s into separate stores\n", legacyPath.string());
+	int64_t llStart = GetTimeMillis();
+	uint64_t arrullRecords[EM_SCRIPT_STORE_MAX] = { 0 };
+	{
+		CLevelDBWrapper cLegacy(legacyPath, size_t(8 << 20));
+		CLevelDBBatch arrcBatches[EM_SCRIPT_STORE_MAX];
+		size_t arrunBatchBytes[EM_SCRIPT_STORE_MAX] = { 0 };
+		leveldb::Iterator *pCursor = cLegacy.NewIterator();
+		for (pCursor->SeekToFirst(); pCursor->Valid(); pCursor->Next()) {
+			leveldb::Slice cSliceKey = pCursor->key();
+			leveldb::Slice cSliceValue = pCursor->value();
+			vector<unsigned char> vchKey(cSliceKey.data(), cSliceKey.data() + cSliceKey.size());
+			vector<unsigned char> vchValue;
+			try {
+				CDataStream cDSValue(cSliceValue.data(), cSliceValue.data() + cSliceValue.size(), SER_DISK,
+						g_sClientVersion);
+				cDSValue >> vchValue;
+			} catch (std::exception &e) {
+				delete pCursor;
+				return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+			}
+			emScriptStore emStore = GetStore(vchKey);
+			arrcBatches[emStore].Write(vchKey, vchValue);
+			arrunBatchBytes[emStore] += cSliceKey.size() + cSliceValue.size();
+			++arrullRecords[emStore];
+			if (arrunBatchBytes[emStore] >= unMaxBatchBytes) {
+				Store(emStore).WriteBatch(arrcBatches[emStore]);
+				arrcBatches[emStore] = CLevelDBBatch();
+				arrunBatchBytes[emStore] = 0;
+			}
+		}
+		leveldb::Status status = pCursor->status();
+		delete pCursor;
+		HandleError(status);
+		for (int i = 0; i < EM_SCRIPT_STORE_MAX; ++i) {
+			Store((emScriptStore) i).WriteBatch(arrcBatches[i], true);
+		}
+	}
+	boost::filesystem::remove_all(legacyPath);
+	for (int i = 0; i < EM_SCRIPT_STORE_MAX; ++i) {
+		LogPrint("INFO", "Migrated %u records into the %s store\n", arrullRecords[i],
+				GetStoreName((emScriptStore) i));
+	}
+	LogPrint("INFO", "Script database migrated in %dms\n", GetTimeMillis() - llStart);
+	return true;
 }
 
 bool CScriptDB::GetData(const vector<unsigned char> &vchKey, vector<unsigned char> &vchValue) {
-	return m_LevelDBWrapper.Read(vchKey, vchValue);
+	emScriptStore emStore = GetStore(vchKey);
+	++m_ptCounters[emStore].ullReads;
+	if (!Store(emStore).Read(vchKey, vchValue)) {
+		++m_ptCounters[emStore].ullReadMisses;
+		return false;
+	}
+	return true;
 }
 
 bool CScriptDB::SetData(const vector<unsigned char> &vchKey, const vector<unsigned char> &vchValue) {
-	return m_LevelDBWrapper.Write(vchKey, vchValue);
+	emScriptStore emStore = GetStore(vchKey);
+	++m_ptCounters[emStore].ullWrites;
+	return Store(emStore).Write(vchKey, vchValue);
 }
 
 bool CScriptDB::BatchWrite(const map<vector<unsigned char>, vector<unsigned char> > &mapDatas) {
-	CLevelDBBatch cBatch;
+	CLevelDBBatch arrcBatches[EM_SCRIPT_STORE_MAX];
+	bool arrbDirty[EM_SCRIPT_STORE_MAX] = { false };
 	for (auto & item : mapDatas) {
+		emScriptStore emStore = GetStore(item.first);
 		if (item.second.empty()) {
-			cBatch.Erase(item.first);
+			arrcBatches[emStore].Erase(item.first);
+			++m_ptCounters[emStore].ullErases;
 		} else {
-			cBatch.Write(item.first, item.second);
+			arrcBatches[emStore].Write(item.first, item.second);
+			++m_ptCounters[emStore].ullWrites;
 		}
+		arrbDirty[emStore] = true;
 	}
-	return m_LevelDBWrapper.WriteBatch(cBatch, true);
+	for (int i = 0; i < EM_SCRIPT_STORE_MAX; ++i) {
+		if (arrbDirty[i] && !Store((emScriptStore) i).WriteBatch(arrcBatches[i], true)) {
+			return false;
+		}
+	}
+	return true;
 }
 
 bool CScriptDB::EraseKey(const vector<unsigned char> &vchKey) {
-	return m_LevelDBWrapper.Erase(vchKey);
+	emScriptStore emStore = GetStore(vchKey);
+	++m_ptCounters[emStore].ullErases;
+	return Store(emStore).Erase(vchKey);
 }
 
 bool CScriptDB::HaveData(const vector<unsigned char> &vchKey) {
-	return m_LevelDBWrapper.Exists(vchKey);
+	emScriptStore emStore = GetStore(vchKey);
+	++m_ptCounters[emStore].ullReads;
+	if (!Store(emStore).Exists(vchKey)) {
+		++m_ptCounters[emStore].ullReadMisses;
+		return false;
+	}
+	return true;
+}
+
+int64_t CScriptDB::GetDbCount() {
+	int64_t llCount = 0;
+	for (int i = 0; i < EM_SCRIPT_STORE_MAX; ++i) {
+		llCount += m_arrpStores[i]->GetDbCount();
+	}
+	return llCount;
+}
+
+vector<ST_ScriptStoreStats> CScriptDB::GetStats() {
+	vector<ST_ScriptStoreStats> vtStats;
+	for (int i = 0; i < EM_SCRIPT_STORE_MAX; ++i) {
+		ST_ScriptStoreStats tStats;
+		tStats.strName 			= GetStoreName((emScriptStore) i);
+		tStats.tTuning 			= m_arrtTunings[i];
+		tStats.ullReads 		= m_ptCounters[i].ullReads;
+		tStats.ullReadMisses 	= m_ptCounters[i].ullReadMisses;
+		tStats.ullWrites 		= m_ptCounters[i].ullWrites;
+		tStats.ullErases 		= m_ptCounters[i].ullErases;
+		tStats.ullScans 		= m_ptCounters[i].ullScans;
+		tStats.ullDiskBytes 	= m_arrpStores[i]->GetApproximateSize();
+		tStats.nFiles 			= 0;
+		tStats.nLevel0Files 	= 0;
+		for (int nLevel = 0; nLevel < 7; ++nLevel) {
+			int nFiles = atoi(m_arrpStores[i]->GetProperty(strprintf("leveldb.num-files-at-level%d", nLevel)));
+			tStats.nFiles += nFiles;
+			if (nLevel == 0) {
+				tStats.nLevel0Files = nFiles;
+			}
+		}
+		vtStats.push_back(tStats);
+	}
+	return vtStats;
 }
 
 bool CScriptDB::GetScript(const int &nIndex, vector<unsigned char> &vchScriptId, vector<unsigned char> &vchValue) {
 	assert(nIndex >= 0 && nIndex <=1);
-	leveldb::Iterator* pCursor = m_LevelDBWrapper.NewIterator();
-	CDataStream cDSKeySet(SER_DISK, g_sClientVersion);
-	string strTempPrefix("def");
-	cDSKeySet.insert(cDSKeySet.end(), &strTempPrefix[0], &strTempPrefix[3]);
-
-	int i(0);
+	std::unique_ptr<CLevelDBIterator> pCursor = NewIterator(EM_SCRIPT_STORE_CODE, "def");
 	if (1 == nIndex) {
 		if (vchScriptId.empty()) {
 			return ERRORMSG("GetScript() : nIndex is 1, and vScriptId is empty");
 		}
-		vector<char> vchId(vchScriptId.begin(), vchScriptId.end());
-		cDSKeySet.insert(cDSKeySet.end(), vchId.begin(), vchId.end());
-		vector<unsigned char> vchKey(cDSKeySet.begin(), cDSKeySet.end());
-		if (HaveData(vchKey)) {   //жϴkey,ݿǷѾ
-			pCursor->Seek(cDSKeySet.str());
-			i = nIndex;
-		} else {
-			pCursor->Seek(cDSKeySet.str());
+		string strId(vchScriptId.begin(), vchScriptId.end());
+		pCursor->Seek(strId);
+		// the script after vchScriptId
+		if (pCursor->Valid() && pCursor->KeySuffix() == leveldb::Slice(strId)) {
+			pCursor->Next();
 		}
 	} else {
-		pCursor->Seek(cDSKeySet.str());
-	}
-	while (pCursor->Valid() && i-- >= 0) {
-		boost::this_thread::interruption_point();
-		try {
-			leveldb::Slice cSliceKey = pCursor->key();
-			string strScriptKey(cSliceKey.data(), 0, cSliceKey.size());
-//			ssKey >> strScriptKey;
-			string strPrefix = strScriptKey.substr(0, 3);
-			if (strPrefix == "def") {
-				if (-1 == i) {
-					leveldb::Slice slValue = pCursor->value();
-					CDataStream ssValue(slValue.data(), slValue.data() + slValue.size(), SER_DISK, g_sClientVersion);
-					ssValue >> vchValue;
-					vchScriptId.clear();
-					vchScriptId.insert(vchScriptId.end(), cSliceKey.data() + 3, cSliceKey.data() + cSliceKey.size());
-				}
-				pCursor->Next();
-			} else {
-				delete pCursor;
-				return false;
-			}
-		} catch (std::exception &e) {
-			return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
-		}
+		pCursor->Seek();
 	}
-	delete pCursor;
-	if(i >= 0) {
+	if (!pCursor->Valid()) {
 		return false;
 	}
+	if (!pCursor->GetValue(vchValue)) {
+		return ERRORMSG("%s : Deserialize error", __func__);
+	}
+	leveldb::Slice slScriptId = pCursor->KeySuffix();
+	vchScriptId.assign(slScriptId.data(), slScriptId.data() + slScriptId.size());
 
 	return true;
 }
 
 bool CScriptDB::GetScriptData(const int nCurBlockHeight, const vector<unsigned char> &vchScriptId, const int &nIndex,
 		vector<unsigned char> &vchScriptKey, vector<unsigned char> &vchScriptData) {
-	const int nPrefixLen 	= 4;
-	const int nScriptIdLen 	= 6;
-	const int nSpaceLen 	= 1;
 	assert(nIndex >= 0 && nIndex <=1);
-	leveldb::Iterator* pCursor = m_LevelDBWrapper.NewIterator();
-	CDataStream cDSKeySet(SER_DISK, g_sClientVersion);
+	string strPrefix("data");
+	strPrefix.append(vchScriptId.begin(), vchScriptId.end());
+	strPrefix.push_back('_');
+	std::unique_ptr<CLevelDBIterator> pCursor = NewIterator(EM_SCRIPT_STORE_STATE, strPrefix);
 
-	string strTempPrefix("data");
-	cDSKeySet.insert(cDSKeySet.end(), &strTempPrefix[0], &strTempPrefix[4]);
-	vector<char> vchId(vchScriptId.begin(), vchScriptId.end());
-	cDSKeySet.insert(cDSKeySet.end(), vchId.begin(), vchId.end());
-	cDSKeySet.insert(cDSKeySet.end(),'_');
-	
-	int i(0);
 	if (1 == nIndex) {
 		if (vchScriptKey.empty()) {
 			return ERRORMSG("GetScriptData() : nIndex is 1, and vScriptKey is empty");
 		}
-		vector<char> vchKey(vchScriptKey.begin(), vchScriptKey.end());
-		cDSKeySet.insert(cDSKeySet.end(), vchKey.begin(), vchKey.end());
-		vector<unsigned char> vKey(cDSKeySet.begin(), cDSKeySet.end());
-		if (HaveData(vKey)) {   					//жϴkey,ݿǷѾ
-			pCursor->Seek(cDSKeySet.str());
-			i = nIndex;
-		} else {
-			pCursor->Seek(cDSKeySet.str());
+		string strKey(vchScriptKey.begin(), vchScriptKey.end());
+		pCursor->Seek(strKey);
+		// the item after vchScriptKey
+		if (pCursor->Valid() && pCursor->KeySuffix() == leveldb::Slice(strKey)) {
+			pCursor->Next();
 		}
 	} else {
-		pCursor->Seek(cDSKeySet.str());
+		pCursor->Seek();
 	}
-
-	while (pCursor->Valid() && i-- >= 0) {
-		boost::this_thread::interruption_point();
-		try {
-			leveldb::Slice cSliceKey = pCursor->key();
-			CDataStream cDSKey(cSliceKey.data(), cSliceKey.data() + cSliceKey.size(), SER_DISK, g_sClientVersion);
-			if (0 == memcmp((char *) &cDSKey[0], (char *) &cDSKeySet[0], 11)) {
-				if (-1 == i) {
-					leveldb::Slice cSliceValue = pCursor->value();
-					CDataStream cDSValue(cSliceValue.data(), cSliceValue.data() + cSliceValue.size(), SER_DISK,
-							g_sClientVersion);
-					cDSValue >> vchScriptData;
-					vchScriptKey.clear();
-					vchScriptKey.insert(vchScriptKey.end(), cSliceKey.data() + nPrefixLen + nScriptIdLen + nSpaceLen,
-							cSliceKey.data() + cSliceKey.size());
-				}
-				pCursor->Next();
-			} else {
-				delete pCursor;
-				return false;
-			}
-		} catch (std::exception &e) {
-			return ERRORMSG("%s : Deserialize or I/O error - %s\n", __func__, e.what());
-		}
-	}
-	delete pCursor;
-	if(i >= 0) {
+	if (!pCursor->Valid()) {
 		return false;
 	}
+	if (!pCursor->GetValue(vchScriptData)) {
+		return ERRORMSG("%s : Deserialize error\n", __func__);
+	}
+	leveldb::Slice slScriptKey = pCursor->KeySuffix();
+	vchScriptKey.assign(slScriptKey.data(), slScriptKey.data() + slScriptKey.size());
 
 	return true;
 }
 
 bool CScriptDB::GetTxHashByAddress(const CKeyID &cKeyId, int nHeight,
 		map<vector<unsigned char>, vector<unsigned char> > &mapTxHash) {
-	leveldb::Iterator* pCursor = m_LevelDBWrapper.NewIterator();
-	CDataStream cDSKeySet(SER_DISK, g_sClientVersion);
-
-	string strTempPrefix("ADDR");
-	cDSKeySet.insert(cDSKeySet.end(), &strTempPrefix[0], &strTempPrefix[4]);
-	cDSKeySet << cKeyId;
-	cDSKeySet << nHeight;
-	pCursor->Seek(cDSKeySet.str());
+	CDataStream cDSPrefix(SER_DISK, g_sClientVersion);
+	cDSPrefix << cKeyId;
+	CDataStream cDSHeight(SER_DISK, g_sClientVersion);
+	cDSHeight << nHeight;
+	std::unique_ptr<CLevelDBIterator> pCursor = NewIterator(EM_SCRIPT_STORE_INDEX, "ADDR" + cDSPrefix.str());
 
-	while (pCursor->Valid()) {
+	for (pCursor->Seek(cDSHeight.str()); pCursor->Valid(); pCursor->Next()) {
 		boost::this_thread::interruption_point();
-		try {
-			leveldb::Slice cSliceKey = pCursor->key();
-			leveldb::Slice cSliceValue = pCursor->value();
-			CDataStream cDSKey(cSliceKey.data(), cSliceKey.data() + cSliceKey.size(), SER_DISK, g_sClientVersion);
+		vector<unsigned char> vchValue;
+		if (!pCursor->GetValue(vchValue)) {
+			return ERRORMSG("%s : Deserialize error\n", __func__);
+		}
+		leveldb::Slice cSliceKey = pCursor->Key();
+		mapTxHash.insert(make_pair(vector<unsigned char>(cSliceKey.data(), cSliceKey.data() + cSliceKey.size()), vchValue));
+	}
+	return true;
+}
 
-			if (0 == memcmp((char *) &cDSKey[0], (char *) &cDSKeySet[0], 24)) {
-				vector<unsigned char> vchValue;
-				vector<unsigned char> vchKey;
-				CDataStream ssValue(cSliceValue.data(), cSliceValue.data() + cSliceValue.size(), SER_DISK,
-						g_sClientVersion);
-				ssValue >> vchValue;
-				vchKey.insert(vchKey.end(), cSliceKey.data(), cSliceKey.data() + cSliceKey.size());
-				mapTxHash.insert(make_pair(vchKey, vchValue));
-				pCursor->Next();
-			} else {
-				break;
+bool CScriptDB::GetPrefixData(const vector<unsigned char> &vchPrefix,
+		map<vector<unsigned char>, vector<unsigned char> > &mapDatas) {
+	// a prefix shorter than the record tags may span several stores
+	bool arrbScan[EM_SCRIPT_STORE_MAX] = { false };
+	arrbScan[GetStore(vchPrefix)] = true;
+	for (const auto &item : s_arrtScriptPrefixes) {
+		if (strlen(item.pszPrefix) > vchPrefix.size() && equal(vchPrefix.begin(), vchPrefix.end(), item.pszPrefix)) {
+			arrbScan[item.emStore] = true;
+		}
+	}
+	string strPrefix(vchPrefix.begin(), vchPrefix.end());
+	for (int i = 0; i < EM_SCRIPT_STORE_MAX; ++i) {
+		if (!arrbScan[i]) {
+			continue;
+		}
+		std::unique_ptr<CLevelDBIterator> pCursor = NewIterator((emScriptStore) i, strPrefix);
+		for (pCursor->Seek(); pCursor->Valid(); pCursor->Next()) {
+			boost::this_thread::interruption_point();
+			leveldb::Slice cSliceKey = pCursor->Key();
+			if (!pCursor->GetValue(mapDatas[vector<unsigned char>(cSliceKey.data(), cSliceKey.data() + cSliceKey.size())])) {
+				return ERRORMSG("%s : Deserialize error\n", __func__);
 			}
-		} catch (std::exception &e) {
-			return ERRORMSG("%s : Deserialize or I/O error - %s\n", __func__, e.what());
 		}
 	}
-	delete pCursor;
 	return true;
 }
 
@@ -546,47 +678,30 @@ Object CScriptDB::ToJosnObj(string strPrefix) {
 	Object obj;
 	Array arrayObj;
 
-	leveldb::Iterator *pCursor = m_LevelDBWrapper.NewIterator();
-	CDataStream cDSKeySet(SER_DISK, g_sClientVersion);
-	cDSKeySet.insert(cDSKeySet.end(), &strPrefix[0], &strPrefix[strPrefix.length()]);
-	pCursor->Seek(cDSKeySet.str());
-
-	while (pCursor->Valid()) {
+	std::unique_ptr<CLevelDBIterator> pCursor = NewIterator(
+			GetStore(vector<unsigned char>(strPrefix.begin(), strPrefix.end())), strPrefix);
+	for (pCursor->Seek(); pCursor->Valid(); pCursor->Next()) {
 		boost::this_thread::interruption_point();
-		try {
-			leveldb::Slice cSliceKey = pCursor->key();
-			CDataStream cDSKey(cSliceKey.data(), cSliceKey.data() + cSliceKey.size(), SER_DISK, g_sClientVersion);
-			string strScriptKey(cSliceKey.data(), 0, cSliceKey.size());
-			string strPrefix = strScriptKey.substr(0, strPrefix.length());
-			leveldb::Slice cSliceValue = pCursor->value();
-			CDataStream cDSValue(cSliceValue.data(), cSliceValue.data() + cSliceValue.size(), SER_DISK, g_sClientVersion);
-			Object obj;
-			if (strPrefix == strPrefix) {
-				if (strPrefix == "def") {
-					obj.push_back(Pair("scriptid", HexStr(cDSKey)));
-					obj.push_back(Pair("value", HexStr(cDSValue)));
-				} else if (strPrefix == "data") {
-					obj.push_back(Pair("key", HexStr(cDSKey)));
-					obj.push_back(Pair("value", HexStr(cDSValue)));
-				} else if (strPrefix == "acct") {
-					obj.push_back(Pair("acctkey", HexStr(cDSKey)));
-					obj.push_back(Pair("acctvalue", HexStr(cDSValue)));
-				}
-
-			} else {
-				obj.push_back(Pair("unkown key", HexStr(cDSKey)));
-				obj.push_back(Pair("unkown value", HexStr(cDSValue)));
-			}
-			arrayObj.push_back(obj);
-			pCursor->Next();
-		} catch (std::exception &e) {
-			if (pCursor) {
-				delete pCursor;
-			}
-			LogPrint("ERROR", "line:%d,%s : Deserialize or I/O error - %s\n", __LINE__, __func__, e.what());
+		leveldb::Slice cSliceKey = pCursor->Key();
+		leveldb::Slice cSliceValue = pCursor->Value();
+		string strKey = HexStr(cSliceKey.data(), cSliceKey.data() + cSliceKey.size());
+		string strValue = HexStr(cSliceValue.data(), cSliceValue.data() + cSliceValue.size());
+		Object obj;
+		if (strPrefix == "def") {
+			obj.push_back(Pair("scriptid", strKey));
+			obj.push_back(Pair("value", strValue));
+		} else if (strPrefix == "data") {
+			obj.push_back(Pair("key", strKey));
+			obj.push_back(Pair("value", strValue));
+		} else if (strPrefix == "acct") {
+			obj.push_back(Pair("acctkey", strKey));
+			obj.push_back(Pair("acctvalue", strValue));
+		} else {
+			obj.push_back(Pair("unkown key", strKey));
+			obj.push_back(Pair("unkown value", strValue));
 		}
+		arrayObj.push_back(obj);
 	}
-	delete pCursor;
 	obj.push_back(Pair("scriptdb", arrayObj));
 	return obj;
 }
@@ -639,3 +754,9 @@ Object CAccountViewDB::ToJosnObj(char chPrefix) {
 	obj.push_back(Pair("scriptdb", arrayObj));
 	return obj;
 }
+
+CChainStateSnapshot::CChainStateSnapshot(const std::shared_ptr<vector<CBlockIndex*> > &pChain, int nHeight,
+		CAccountViewDB *pAccountViewDB, CScriptDB *pScriptDB) :
+		m_pChain(pChain), m_nHeight(nHeight), m_cAccountViewDB(pAccountViewDB), m_cScriptDB(pScriptDB) {
+	assert(nHeight >= 0 && nHeight < (int) pChain->size());
+}
@@ -10,7 +10,9 @@
 #include "main.h"
 #include "database.h"
 #include "arith_uint256.h"
+#include <atomic>
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -33,6 +35,8 @@ class CBlockTreeDB: public CLevelDBWrapper {
 
  public:
 	bool WriteBlockIndex(const CDiskBlockIndex& cBlockindex);
+	bool WriteBlockIndex(const vector<CDiskBlockIndex> &vcBlockIndex);
+	bool ReadBlockIndex(const uint256 &cBlockHash, CDiskBlockIndex& cBlockindex);
 	bool EraseBlockIndex(const uint256 &cBlockHash);
 	bool WriteBestInvalidWork(const uint256& cBestInvalidWork);
 	bool ReadBlockFileInfo(int nFile, CBlockFileInfo &cFileinfo);
@@ -54,6 +58,8 @@ class CAccountViewDB: public CAccountView {
  public:
 	CAccountViewDB(size_t unCacheSize, bool bMemory = false, bool bWipe = false);
 	CAccountViewDB(const string& strName, size_t unCacheSize, bool bMemory, bool bWipe);
+	// read-only snapshot of pBase at the time of construction
+	explicit CAccountViewDB(CAccountViewDB *pBase);
 
  public:
 	bool GetAccount(const CKeyID &cKeyId, CAccount &cSecureAccount);
@@ -76,6 +82,10 @@ class CAccountViewDB: public CAccountView {
 		return m_cLevelDBWrapper.GetDbCount();
 	}
 	Object ToJosnObj(char chPrefix);
+	// raw records, for state snapshots
+	CLevelDBWrapper &GetLevelDB() {
+		return m_cLevelDBWrapper;
+	}
 
  private:
 	CAccountViewDB(const CAccountViewDB&);
@@ -106,10 +116,40 @@ class CTransactionDB: public CTransactionDBView {
 	CLevelDBWrapper m_LevelDBWrapper;
 };
 
+/** Record families of the script database, each kept in its own LevelDB under blocks/<name>/ */
+enum emScriptStore {
+	EM_SCRIPT_STORE_CODE = 0, 		// "def" contract code, "snum" contract count
+	EM_SCRIPT_STORE_STATE, 			// "data" contract data, "sdnum" data counts, "acct"/"afnd" app accounts, unknown keys
+	EM_SCRIPT_STORE_INDEX, 			// "T" tx index, "ADDR" address index, "tx" accounts related to txs
+	EM_SCRIPT_STORE_OUTPUT, 		// "output" VM outputs
+	EM_SCRIPT_STORE_MAX,
+};
+
+struct ST_ScriptStoreStats {
+	string strName;
+	ST_LevelDBTuning tTuning;
+	uint64_t ullReads;
+	uint64_t ullReadMisses;
+	uint64_t ullWrites;
+	uint64_t ullErases;
+	uint64_t ullScans;
+	uint64_t ullDiskBytes;
+	int nFiles;
+	int nLevel0Files; 				// LevelDB stalls writes while too many of these wait for compaction
+};
+
+/**
+ * The script database. Contract state, the indexes and the VM outputs are written and read very
+ * differently, so each family lives in its own LevelDB with its own cache, write buffers, bloom
+ * filter and compression, and index writes or compactions no longer evict or stall contract state.
+ * A database in the old single-store layout is migrated into the stores when opened.
+ */
 class CScriptDB: public CScriptDBView {
  public:
 	CScriptDB(const string& strName, size_t unCacheSize, bool bMemory = false, bool bWipe = false);
 	CScriptDB(size_t unCacheSize, bool bMemory = false, bool bWipe = false);
+	// read-only snapshot of pBase at the time of construction
+	explicit CScriptDB(CScriptDB *pBase);
 
  public:
 	bool GetData(const vector<unsigned char> &vchKey, vector<unsigned char> &vchValue);
@@ -117,22 +157,119 @@ class CScriptDB: public CScriptDBView {
 	bool BatchWrite(const map<vector<unsigned char>, vector<unsigned char> > &mapDatas);
 	bool EraseKey(const vector<unsigned char> &vchKey);
 	bool HaveData(const vector<unsigned char> &vchKey);
+	bool GetPrefixData(const vector<unsigned char> &vchPrefix, map<vector<unsigned char>, vector<unsigned char> > &mapDatas);
 	bool GetScript(const int &nIndex, vector<unsigned char> &vchScriptId, vector<unsigned char> &vchValue);
 	bool GetScriptData(const int nCurBlockHeight, const vector<unsigned char> &vchScriptId, const int &nIndex,
 			vector<unsigned char> &vchScriptKey, vector<unsigned char> &vchScriptData);
-	int64_t GetDbCount() {
-		return m_LevelDBWrapper.GetDbCount();
-	}
+	int64_t GetDbCount();
 	bool GetTxHashByAddress(const CKeyID &cKeyId, int nHeight,
 			map<vector<unsigned char>, vector<unsigned char> > &mapTxHash);
 	Object ToJosnObj(string strPrefix);
+	vector<ST_ScriptStoreStats> GetStats();
+
+	/** Store holding the records of vchKey */
+	static emScriptStore GetStore(const vector<unsigned char> &vchKey);
+	static const char *GetStoreName(emScriptStore emStore);
+	// raw records of a store, for state snapshots
+	CLevelDBWrapper &GetStoreDB(emScriptStore emStore) {
+		return Store(emStore);
+	}
 
  private:
+	struct ST_StoreCounters {
+		ST_StoreCounters() :
+				ullReads(0), ullReadMisses(0), ullWrites(0), ullErases(0), ullScans(0) {
+		}
+		std::atomic<uint64_t> ullReads;
+		std::atomic<uint64_t> ullReadMisses;
+		std::atomic<uint64_t> ullWrites;
+		std::atomic<uint64_t> ullErases;
+		std::atomic<uint64_t> ullScans;
+	};
+
 	CScriptDB(const CScriptDB&);
 	void operator=(const CScriptDB&);
 
+	void Open(const string &strName, size_t unCacheSize, bool bMemory, bool bWipe);
+	bool MigrateLegacy(const boost::filesystem::path &legacyPath);
+	CLevelDBWrapper &Store(emScriptStore emStore) {
+		return *m_arrpStores[emStore];
+	}
+	std::unique_ptr<CLevelDBIterator> NewIterator(emScriptStore emStore, const string &strPrefix) {
+		++m_ptCounters[emStore].ullScans;
+		return m_arrpStores[emStore]->NewIterator(strPrefix);
+	}
+
  private:
-	CLevelDBWrapper m_LevelDBWrapper;
+	std::unique_ptr<CLevelDBWrapper> m_arrpStores[EM_SCRIPT_STORE_MAX];
+	ST_LevelDBTuning m_arrtTunings[EM_SCRIPT_STORE_MAX];
+	ST_StoreCounters m_arrtCounters[EM_SCRIPT_STORE_MAX];
+	ST_StoreCounters *m_ptCounters; 	// snapshots count their reads in the counters of their base
+};
+
+/**
+ * Immutable view of the chain state as of one tip: the active chain up to that tip plus
+ * LevelDB snapshots of the account and script databases. It is only published while the
+ * databases hold exactly the tip's state, so it can be read without g_cs_main. Queries go
+ * through a throwaway CAccountViewCache / CScriptDBViewCache layered on top of it.
+ */
+class CChainStateSnapshot {
+ public:
+	CChainStateSnapshot(const std::shared_ptr<vector<CBlockIndex*> > &pChain, int nHeight,
+			CAccountViewDB *pAccountViewDB, CScriptDB *pScriptDB);
+
+	CBlockIndex *Tip() const {
+		return (*m_pChain)[m_nHeight];
+	}
+
+	CBlockIndex *operator[](int nHeight) const {
+		if (nHeight < 0 || nHeight > m_nHeight) {
+			return NULL;
+		}
+		return (*m_pChain)[nHeight];
+	}
+
+	bool Contains(const CBlockIndex *pIndex) const {
+		return (*this)[pIndex->m_nHeight] == pIndex;
+	}
+
+	CBlockIndex *Next(const CBlockIndex *pIndex) const {
+		if (Contains(pIndex)) {
+			return (*this)[pIndex->m_nHeight + 1];
+		}
+		return NULL;
+	}
+
+	int Height() const {
+		return m_nHeight;
+	}
+
+	CAccountView &GetAccountView() {
+		return m_cAccountViewDB;
+	}
+
+	CScriptDBView &GetScriptDBView() {
+		return m_cScriptDB;
+	}
+
+	CAccountViewDB &GetAccountViewDB() {
+		return m_cAccountViewDB;
+	}
+
+	CScriptDB &GetScriptDB() {
+		return m_cScriptDB;
+	}
+
+ private:
+	CChainStateSnapshot(const CChainStateSnapshot&);
+	void operator=(const CChainStateSnapshot&);
+
+ private:
+	// shared with newer snapshots which may append past m_nHeight, never read beyond it
+	std::shared_ptr<vector<CBlockIndex*> > m_pChain;
+	int m_nHeight;
+	CAccountViewDB m_cAccountViewDB;
+	CScriptDB m_cScriptDB;
 };
 
 #endif // DACRS_TXDB_H_
@@ -7,32 +7,98 @@
 #include "txmempool.h"
 #include "database.h"
 #include "main.h"
+#include "miner.h"
+#include "memusage.h"
 
 using namespace std;
 
+/*
+ * What executing a pool transaction read from the pool view and the values its writes replaced
+ * there. A later transaction that read or wrote any of those keys depends on it, and restoring the
+ * replaced values takes the transaction out of the view without executing the pool again.
+ */
+class CTxMemPoolFootprint {
+ public:
+	CTxMemPoolFootprint() :
+			m_bUntracked(false) {
+	}
+	size_t GetUsage() const;
+
+	bool m_bUntracked;		// read a range, depends on every write
+	set<CKeyID> m_setReadAccounts;
+	set<vector<unsigned char> > m_setReadKeyIds;
+	set<vector<unsigned char> > m_setReadKeys;
+	set<vector<unsigned char> > m_setReadPrefixes;
+	map<CKeyID, CAccount> m_mapPrevAccounts;	// an account without key id stands for a missing one
+	map<vector<unsigned char>, CKeyID> m_mapPrevKeyIds;
+	map<vector<unsigned char>, vector<unsigned char> > m_mapPrevDatas;	// empty for a missing key
+};
+
+static size_t KeysUsage(const set<vector<unsigned char> > &setKeys) {
+	size_t unUsage = 0;
+	for (const auto &vchKey : setKeys) {
+		unUsage += memusage::MapEntryUsage<vector<unsigned char>, char>() + memusage::DynamicUsage(vchKey);
+	}
+	return unUsage;
+}
+
+size_t CTxMemPoolFootprint::GetUsage() const {
+	size_t unUsage = sizeof(CTxMemPoolFootprint) + KeysUsage(m_setReadKeyIds) + KeysUsage(m_setReadKeys)
+			+ KeysUsage(m_setReadPrefixes);
+	unUsage += m_setReadAccounts.size() * memusage::MapEntryUsage<CKeyID, char>();
+	unUsage += m_mapPrevAccounts.size() * memusage::MapEntryUsage<CKeyID, CAccount>();
+	for (const auto &item : m_mapPrevKeyIds) {
+		unUsage += memusage::MapEntryUsage<vector<unsigned char>, CKeyID>() + memusage::DynamicUsage(item.first);
+	}
+	for (const auto &item : m_mapPrevDatas) {
+		unUsage += memusage::MapEntryUsage<vector<unsigned char>, vector<unsigned char> >()
+				+ memusage::DynamicUsage(item.first) + memusage::DynamicUsage(item.second);
+	}
+	return unUsage;
+}
+
 CTxMemPoolEntry::CTxMemPoolEntry() {
 	 m_llFee 		= 0;
 	 m_unTxSize 	= 0;
 	 m_llTime 		= 0;
 	 m_dPriority 	= 0.0;
 	 m_unHeight 	= 0;
+	 m_nFuelRate 	= 0;
+	 m_dFeePerKb 	= 0.0;
+	 m_unFootprintUsage = 0;
 }
 
 CTxMemPoolEntry::CTxMemPoolEntry(CBaseTransaction *pTx, int64_t llFee, int64_t llTime, double dPriority,
 		unsigned int unHeight) :
-		m_llFee(llFee), m_llTime(llTime), m_dPriority(dPriority), m_unHeight(unHeight) {
+		m_llFee(llFee), m_llTime(llTime), m_dPriority(dPriority), m_unHeight(unHeight), m_nFuelRate(0),
+		m_unFootprintUsage(0) {
 	m_pTx = pTx->GetNewInstance();
+	m_cHash = m_pTx->GetHash();
 	m_unTxSize = ::GetSerializeSize(*m_pTx, SER_NETWORK, g_sProtocolVersion);
+	m_dFeePerKb = double(m_llFee) / (double(m_unTxSize) / 1000.0);
 }
 
 CTxMemPoolEntry::CTxMemPoolEntry(const CTxMemPoolEntry& cOther) {
-	this->m_dPriority 	= cOther.m_dPriority;
+	*this = cOther;
+}
+
+CTxMemPoolEntry& CTxMemPoolEntry::operator=(const CTxMemPoolEntry& cOther) {
+	if (this == &cOther) {
+		return *this;
+	}
 	this->m_llFee 		= cOther.m_llFee;
 	this->m_unTxSize 	= cOther.m_unTxSize;
 	this->m_llTime 		= cOther.m_llTime;
 	this->m_dPriority 	= cOther.m_dPriority;
 	this->m_unHeight 	= cOther.m_unHeight;
-	this->m_pTx 		= cOther.m_pTx->GetNewInstance();
+	this->m_cHash 		= cOther.m_cHash;
+	this->m_nFuelRate 	= cOther.m_nFuelRate;
+	this->m_dFeePerKb 	= cOther.m_dFeePerKb;
+	this->m_cSourceKeyId = cOther.m_cSourceKeyId;
+	this->m_pFootprint 	= cOther.m_pFootprint;
+	this->m_unFootprintUsage = cOther.m_unFootprintUsage;
+	this->m_pTx 		= cOther.m_pTx ? cOther.m_pTx->GetNewInstance() : std::shared_ptr<CBaseTransaction>();
+	return *this;
 }
 
 double CTxMemPoolEntry::GetPriority(unsigned int unCurrentHeight) const {
@@ -41,12 +107,203 @@ double CTxMemPoolEntry::GetPriority(unsigned int unCurrentHeight) const {
 	return dResult;
 }
 
+double CTxMemPoolEntry::GetFeePerKb(int nFuelRate) const {
+	if (nFuelRate == m_nFuelRate) {
+		return m_dFeePerKb;
+	}
+	return double(m_llFee - (int64_t) m_pTx->GetFuel(nFuelRate)) / (double(m_unTxSize) / 1000.0);
+}
+
+void CTxMemPoolEntry::UpdateFeePerKb(int nFuelRate) {
+	m_nFuelRate = nFuelRate;
+	m_dFeePerKb = double(m_llFee - (int64_t) m_pTx->GetFuel(nFuelRate)) / (double(m_unTxSize) / 1000.0);
+}
+
+int CTxMemPoolEntry::GetExpiryHeight() const {
+	if (m_pTx->IsCoinBase()) {
+		return numeric_limits<int>::max();
+	}
+	return m_pTx->m_nValidHeight + SysCfg().GetTxCacheHeight() / 2;
+}
+
+size_t CTxMemPoolEntry::GetUsage() const {
+	// the deserialized transaction is about its serialized size plus the object, every index
+	// keeps a node of three pointers and a color per entry
+	return sizeof(CTxMemPoolEntry) + m_unTxSize + 256 + 5 * 4 * sizeof(void*) + m_unFootprintUsage;
+}
+
+void CTxMemPoolEntry::SetFootprint(const std::shared_ptr<const CTxMemPoolFootprint> &pFootprint) {
+	m_pFootprint = pFootprint;
+	m_unFootprintUsage = pFootprint ? pFootprint->GetUsage() : 0;
+}
+
+// key of the account paying for the transaction, as far as the pool view knows it
+static CKeyID GetSourceKeyId(CBaseTransaction *pBaseTx, CAccountViewCache &cAccountViewCache) {
+	CUserID cUserId;
+	switch (pBaseTx->m_chTxType) {
+	case EM_REG_ACCT_TX:
+		cUserId = ((CRegisterAccountTx *) pBaseTx)->m_cUserId;
+		break;
+	case EM_COMMON_TX:
+	case EM_CONTRACT_TX:
+		cUserId = ((CTransaction *) pBaseTx)->m_cSrcRegId;
+		break;
+	case EM_REG_APP_TX:
+		cUserId = ((CRegisterAppTx *) pBaseTx)->m_cRegAcctId;
+		break;
+	default:
+		return CKeyID();
+	}
+	CKeyID cKeyId;
+	if (!cAccountViewCache.GetKeyId(cUserId, cKeyId)) {
+		return CKeyID();
+	}
+	return cKeyId;
+}
+
+struct ST_UpdateExecution {
+	ST_UpdateExecution(int nFuelRate, const std::shared_ptr<const CTxMemPoolFootprint> &pFootprint) :
+			m_nFuelRate(nFuelRate), m_pFootprint(pFootprint) {
+	}
+	void operator()(CTxMemPoolEntry &cEntry) {
+		cEntry.UpdateFeePerKb(m_nFuelRate);
+		cEntry.SetFootprint(m_pFootprint);
+	}
+
+ private:
+	int m_nFuelRate;
+	std::shared_ptr<const CTxMemPoolFootprint> m_pFootprint;
+};
+
+template<typename K, typename V>
+static bool WritesAnyKey(const map<K, V> &mapPrev, const set<K> &setWrites) {
+	for (const auto &item : mapPrev) {
+		if (setWrites.count(item.first)) {
+			return true;
+		}
+	}
+	return false;
+}
+
 CTxMemPool::CTxMemPool() {
 	// Sanity checks off by default for performance, because otherwise
 	// accepting transactions becomes O(N^2) where N is the number
 	// of transactions in the pool
 	m_bSanityCheck = false;
 	m_unTransactionsUpdated = 0;
+	m_ullUsage = 0;
+	m_ullMaxUsage = (uint64_t) DEFAULT_MAX_MEMPOOL_SIZE * 1000000;
+	m_nFuelRate = 0;
+}
+
+void CTxMemPool::EraseEntry(IndexedTxSet::iterator iterTx) {
+	m_ullUsage -= iterTx->GetUsage();
+	m_mapTx.erase(iterTx);
+}
+
+void CTxMemPool::ExpireTx(int nHeight, vector<uint256> &vcRemoved) {
+	IndexedTxSet::index<ST_ExpiryTag>::type &cByExpiry = m_mapTx.get<ST_ExpiryTag>();
+	while (!cByExpiry.empty() && cByExpiry.begin()->GetExpiryHeight() < nHeight) {
+		vcRemoved.push_back(cByExpiry.begin()->GetHash());
+		EraseEntry(m_mapTx.project<0>(cByExpiry.begin()));
+	}
+}
+
+double CTxMemPool::GetMinFeePerKb(unsigned int unTxSize) const {
+	LOCK(m_cs);
+	CTxMemPoolEntry cEntry;
+	if (m_mapTx.empty() || m_ullUsage + cEntry.GetUsage() + unTxSize <= m_ullMaxUsage) {
+		return 0.0;
+	}
+	return m_mapTx.get<ST_FeeRateTag>().begin()->GetFeePerKb();
+}
+
+bool CTxMemPool::TrimToSize(vector<uint256> &vcRemoved) {
+	{
+		LOCK(m_cs);
+		IndexedTxSet::index<ST_FeeRateTag>::type &cByFeeRate = m_mapTx.get<ST_FeeRateTag>();
+		set<uint256> setEvicted;
+		uint64_t ullUsage = m_ullUsage;
+		for (IndexedTxSet::index<ST_FeeRateTag>::type::iterator iterTx = cByFeeRate.begin();
+				iterTx != cByFeeRate.end() && ullUsage > m_ullMaxUsage; ++iterTx) {
+			LogPrint("mempool", "evict tx hash:%s feeperkb:%f\n", iterTx->GetHash().GetHex(), iterTx->GetFeePerKb());
+			setEvicted.insert(iterTx->GetHash());
+			ullUsage -= iterTx->GetUsage();
+		}
+		if (setEvicted.empty()) {
+			return false;
+		}
+		RemoveWithDependents(setEvicted, vcRemoved);
+		m_unTransactionsUpdated++;
+	}
+	SyncMemPoolWithWallets();
+	return true;
+}
+
+void CTxMemPool::RemoveWithDependents(const set<uint256> &setHashes, vector<uint256> &vcRemoved) {
+	AssertLockHeld(m_cs);
+	// keys written by the transactions removed so far
+	set<CKeyID> setWrittenAccounts;
+	set<vector<unsigned char> > setWrittenKeyIds;
+	set<vector<unsigned char> > setWrittenKeys;
+	IndexedTxSet::index<ST_EntryTimeTag>::type &cByTime = m_mapTx.get<ST_EntryTimeTag>();
+	vector<IndexedTxSet::index<ST_EntryTimeTag>::type::iterator> vcRemove;
+	for (IndexedTxSet::index<ST_EntryTimeTag>::type::iterator iterTx = cByTime.begin(); iterTx != cByTime.end();
+			++iterTx) {
+		const CTxMemPoolFootprint *pFootprint = iterTx->GetFootprint().get();
+		if (!setHashes.count(iterTx->GetHash())) {
+			if (vcRemove.empty()) {
+				continue;
+			}
+			if (pFootprint && !pFootprint->m_bUntracked
+					&& !IntersectsKeys(pFootprint->m_setReadAccounts, setWrittenAccounts)
+					&& !IntersectsKeys(pFootprint->m_setReadKeyIds, setWrittenKeyIds)
+					&& !IntersectsKeys(pFootprint->m_setReadKeys, setWrittenKeys)
+					&& !IntersectsPrefixes(pFootprint->m_setReadPrefixes, setWrittenKeys)
+					&& !WritesAnyKey(pFootprint->m_mapPrevAccounts, setWrittenAccounts)
+					&& !WritesAnyKey(pFootprint->m_mapPrevKeyIds, setWrittenKeyIds)
+					&& !WritesAnyKey(pFootprint->m_mapPrevDatas, setWrittenKeys)) {
+				continue;
+			}
+			LogPrint("mempool", "remove tx hash:%s depending on an evicted tx\n", iterTx->GetHash().GetHex());
+		}
+		vcRemove.push_back(iterTx);
+		if (pFootprint) {
+			for (const auto &item : pFootprint->m_mapPrevAccounts) {
+				setWrittenAccounts.insert(item.first);
+			}
+			for (const auto &item : pFootprint->m_mapPrevKeyIds) {
+				setWrittenKeyIds.insert(item.first);
+			}
+			for (const auto &item : pFootprint->m_mapPrevDatas) {
+				setWrittenKeys.insert(item.first);
+			}
+		}
+	}
+	// no transaction left in the pool touched what the removed ones wrote, so putting back the
+	// replaced values newest first leaves the view as if they had never been executed
+	for (auto iterRemove = vcRemove.rbegin(); iterRemove != vcRemove.rend(); ++iterRemove) {
+		const CTxMemPoolFootprint *pFootprint = (*iterRemove)->GetFootprint().get();
+		if (!pFootprint) {
+			continue;
+		}
+		for (const auto &item : pFootprint->m_mapPrevAccounts) {
+			m_pAccountViewCache->SetCacheAccount(item.first, item.second);
+		}
+		for (const auto &item : pFootprint->m_mapPrevKeyIds) {
+			m_pAccountViewCache->SetCacheKeyId(item.first, item.second);
+		}
+		for (const auto &item : pFootprint->m_mapPrevDatas) {
+			m_pScriptDBViewCache->SetCacheData(item.first, item.second);
+		}
+	}
+	for (const auto &iterTx : vcRemove) {
+		uint256 cHash = iterTx->GetHash();
+		vcRemoved.push_back(cHash);
+		EraseEntry(m_mapTx.project<0>(iterTx));
+		g_cUIInterface.RemoveTransaction(cHash);
+		EraseTransaction(cHash);
+	}
 }
 
 void CTxMemPool::SetAccountViewDB(CAccountViewCache *pAccountViewCacheIn) {
@@ -63,19 +320,30 @@ void CTxMemPool::ReScanMemPoolTx(CAccountViewCache *pAccountViewCacheIn, CScript
 	{
 		LOCK(m_cs);
 		CValidationState cState;
-		list<std::shared_ptr<CBaseTransaction> > removed;
-		for (map<uint256, CTxMemPoolEntry>::iterator iterTx = m_mapTx.begin(); iterTx != m_mapTx.end();) {
-			if (!CheckTxInMemPool(iterTx->first, iterTx->second, cState, true)) {
-				uint256 hash = iterTx->first;
-				iterTx = m_mapTx.erase(iterTx++);
-				g_cUIInterface.RemoveTransaction(hash);
-				EraseTransaction(hash);
+		vector<uint256> vcRemoved;
+		ExpireTx(g_cChainActive.Tip()->m_nHeight, vcRemoved);
+		m_nFuelRate = GetElementForBurn(g_cChainActive.Tip());
+		// execute again in the order the transactions entered the pool
+		IndexedTxSet::index<ST_EntryTimeTag>::type &cByTime = m_mapTx.get<ST_EntryTimeTag>();
+		for (IndexedTxSet::index<ST_EntryTimeTag>::type::iterator iterTx = cByTime.begin(); iterTx != cByTime.end();) {
+			std::shared_ptr<const CTxMemPoolFootprint> pFootprint;
+			if (!CheckTxInMemPool(iterTx->GetHash(), *iterTx, cState, true, &pFootprint)) {
+				vcRemoved.push_back(iterTx->GetHash());
+				EraseEntry(m_mapTx.project<0>(iterTx++));
 				continue;
 			}
+			// the run step and what the transaction touches may differ on the new state
+			m_ullUsage -= iterTx->GetUsage();
+			cByTime.modify(iterTx, ST_UpdateExecution(m_nFuelRate, pFootprint));
+			m_ullUsage += iterTx->GetUsage();
 			++iterTx;
 		}
-
+		for (const auto &hash : vcRemoved) {
+			g_cUIInterface.RemoveTransaction(hash);
+			EraseTransaction(hash);
+		}
 	}
+	SyncMemPoolWithWallets();
 }
 
 unsigned int CTxMemPool::GetTransactionsUpdated() const {
@@ -94,9 +362,10 @@ void CTxMemPool::remove(CBaseTransaction *pBaseTx, list<std::shared_ptr<CBaseTra
 		LOCK(m_cs);
 		uint256 cHash = pBaseTx->GetHash();
 
-		if (m_mapTx.count(cHash)) {
-			Removed.push_front(std::shared_ptr<CBaseTransaction>(m_mapTx[cHash].GetTx()));
-			m_mapTx.erase(cHash);
+		IndexedTxSet::iterator iterTx = m_mapTx.find(cHash);
+		if (iterTx != m_mapTx.end()) {
+			Removed.push_front(iterTx->GetTx());
+			EraseEntry(iterTx);
 			g_cUIInterface.RemoveTransaction(cHash);
 			EraseTransaction(cHash);
 			m_unTransactionsUpdated++;
@@ -104,12 +373,26 @@ void CTxMemPool::remove(CBaseTransaction *pBaseTx, list<std::shared_ptr<CBaseTra
 	}
 }
 
+void CTxMemPool::removeForBlock(const vector<std::shared_ptr<CBaseTransaction> > &vptx) {
+	LOCK(m_cs);
+	for (const auto &pTx : vptx) {
+		IndexedTxSet::iterator iterTx = m_mapTx.find(pTx->GetHash());
+		if (iterTx != m_mapTx.end()) {
+			EraseEntry(iterTx);
+		}
+	}
+}
+
 bool CTxMemPool::CheckTxInMemPool(const uint256& cHash, const CTxMemPoolEntry &cTxMemPoolEntry,
-		CValidationState &cValidationState, bool bExcute) {
+		CValidationState &cValidationState, bool bExcute, std::shared_ptr<const CTxMemPoolFootprint> *pFootprint) {
+	AssertLockHeld(m_cs);
 	CTxUndo cTxundo;
 	CTransactionDBCache cTempTxCache(*g_pTxCacheTip, true);
-	CAccountViewCache cTempAcctView(*m_pAccountViewCache, true);
-	CScriptDBViewCache cTempScriptDBView(*m_pScriptDBViewCache, true);
+	// the reads through the pool view are tracked to find later what depends on the transaction
+	CReadTrackingAccountView cTrackingAcctView(*m_pAccountViewCache, m_cs);
+	CReadTrackingScriptDBView cTrackingScriptDBView(*m_pScriptDBViewCache, m_cs);
+	CAccountViewCache cTempAcctView(cTrackingAcctView, true);
+	CScriptDBViewCache cTempScriptDBView(cTrackingScriptDBView, true);
 
 	// is it already confirmed in block
 	if (uint256() != g_pTxCacheTip->IsContainTx(cHash)) {
@@ -131,7 +414,44 @@ bool CTxMemPool::CheckTxInMemPool(const uint256& cHash, const CTxMemPoolEntry &c
 			return false;
 		}
 	}
-	assert(cTempAcctView.Flush() && cTempScriptDBView.Flush());
+	map<CKeyID, CAccount> mapAccounts;
+	map<vector<unsigned char>, CKeyID> mapKeyIds;
+	map<vector<unsigned char>, vector<unsigned char> > mapDatas;
+	cTrackingAcctView.GetWrites(cTempAcctView, mapAccounts, mapKeyIds);
+	cTrackingScriptDBView.GetWrites(cTempScriptDBView, mapDatas);
+	std::shared_ptr<CTxMemPoolFootprint> pNewFootprint = std::make_shared<CTxMemPoolFootprint>();
+	pNewFootprint->m_bUntracked = cTrackingAcctView.m_bUntracked || cTrackingScriptDBView.m_bUntracked;
+	pNewFootprint->m_setReadAccounts.swap(cTrackingAcctView.m_setReadAccounts);
+	pNewFootprint->m_setReadKeyIds.swap(cTrackingAcctView.m_setReadKeyIds);
+	pNewFootprint->m_setReadKeys.swap(cTrackingScriptDBView.m_setReadKeys);
+	pNewFootprint->m_setReadPrefixes.swap(cTrackingScriptDBView.m_setReadPrefixes);
+	// write into the pool view, keeping what each write replaces
+	CAccountView &cPoolAcctView = *m_pAccountViewCache;
+	CScriptDBView &cPoolScriptDBView = *m_pScriptDBViewCache;
+	for (const auto &item : mapAccounts) {
+		CAccount &cPrevAccount = pNewFootprint->m_mapPrevAccounts[item.first];
+		if (!cPoolAcctView.GetAccount(item.first, cPrevAccount)) {
+			cPrevAccount = CAccount();
+		}
+		m_pAccountViewCache->SetCacheAccount(item.first, item.second);
+	}
+	for (const auto &item : mapKeyIds) {
+		CKeyID &cPrevKeyId = pNewFootprint->m_mapPrevKeyIds[item.first];
+		if (!cPoolAcctView.GetKeyId(item.first, cPrevKeyId)) {
+			cPrevKeyId = CKeyID();
+		}
+		m_pAccountViewCache->SetCacheKeyId(item.first, item.second);
+	}
+	for (const auto &item : mapDatas) {
+		vector<unsigned char> &vchPrevValue = pNewFootprint->m_mapPrevDatas[item.first];
+		if (!cPoolScriptDBView.GetData(item.first, vchPrevValue)) {
+			vchPrevValue.clear();
+		}
+		m_pScriptDBViewCache->SetCacheData(item.first, item.second);
+	}
+	if (pFootprint) {
+		*pFootprint = pNewFootprint;
+	}
 	return true;
 }
 
@@ -141,10 +461,20 @@ bool CTxMemPool::addUnchecked(const uint256& cHash, const CTxMemPoolEntry &cTxMe
 	// all the appropriate checks.
 	LOCK(m_cs);
 	{
-		if(!CheckTxInMemPool(cHash, cTxMemPoolEntry, cValidationState)) {
+		std::shared_ptr<const CTxMemPoolFootprint> pFootprint;
+		if(!CheckTxInMemPool(cHash, cTxMemPoolEntry, cValidationState, true, &pFootprint)) {
 			return false;
 		}
-		m_mapTx.insert(make_pair(cHash, cTxMemPoolEntry));
+		if (0 == m_nFuelRate) {
+			m_nFuelRate = GetElementForBurn(g_cChainActive.Tip());
+		}
+		// the entry's transaction now carries the run step of its execution
+		CTxMemPoolEntry cEntry(cTxMemPoolEntry);
+		cEntry.UpdateFeePerKb(m_nFuelRate);
+		cEntry.SetSourceKeyId(GetSourceKeyId(cEntry.GetTx().get(), *m_pAccountViewCache));
+		cEntry.SetFootprint(pFootprint);
+		m_ullUsage += cEntry.GetUsage();
+		m_mapTx.insert(cEntry);
 		LogPrint("addtomempool", "add tx hash:%s time:%ld\n", cHash.GetHex(), GetTime());
 		m_unTransactionsUpdated++;
 	}
@@ -152,10 +482,14 @@ bool CTxMemPool::addUnchecked(const uint256& cHash, const CTxMemPoolEntry &cTxMe
 }
 
 void CTxMemPool::clear() {
-	LOCK(m_cs);
-	m_mapTx.clear();
-	m_pAccountViewCache.reset(new CAccountViewCache(*g_pAccountViewTip, false));
-	++m_unTransactionsUpdated;
+	{
+		LOCK(m_cs);
+		m_mapTx.clear();
+		m_ullUsage = 0;
+		m_pAccountViewCache.reset(new CAccountViewCache(*g_pAccountViewTip, false));
+		++m_unTransactionsUpdated;
+	}
+	SyncMemPoolWithWallets();
 }
 
 void CTxMemPool::queryHashes(vector<uint256>& vctxid) {
@@ -163,16 +497,16 @@ void CTxMemPool::queryHashes(vector<uint256>& vctxid) {
 
 	LOCK(m_cs);
 	vctxid.reserve(m_mapTx.size());
-	for (typename map<uint256, CTxMemPoolEntry>::iterator mi = m_mapTx.begin(); mi != m_mapTx.end(); ++mi) {
-		vctxid.push_back((*mi).first);
+	for (const auto &entry : m_mapTx) {
+		vctxid.push_back(entry.GetHash());
 	}
 }
 
 std::shared_ptr<CBaseTransaction> CTxMemPool::lookup(uint256 cHash) const {
 	LOCK(m_cs);
-	typename map<uint256, CTxMemPoolEntry>::const_iterator iter = m_mapTx.find(cHash);
+	IndexedTxSet::const_iterator iter = m_mapTx.find(cHash);
 	if (iter == m_mapTx.end()) {
 		return std::shared_ptr<CBaseTransaction>();
 	}
-	return iter->second.GetTx();
+	return iter->GetTx();
 }
@@ -7,16 +7,26 @@
 
 #include <list>
 #include <map>
+#include <set>
 
 #include "core.h"
 #include "sync.h"
 #include <memory>
 
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/mem_fun.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/tag.hpp>
+
 using namespace std;
 
 class CAccountViewCache;
 class CScriptDBViewCache;
 class CValidationState;
+class CTxMemPoolFootprint;
+
+// -maxmempool default (MiB)
+static const unsigned int DEFAULT_MAX_MEMPOOL_SIZE = 300;
 
 /*
  * CTxMemPool stores these:
@@ -26,6 +36,7 @@ class CTxMemPoolEntry {
 	CTxMemPoolEntry(CBaseTransaction *pTx, int64_t llFee, int64_t llTime, double dPriority, unsigned int unHeight);
 	CTxMemPoolEntry();
 	CTxMemPoolEntry(const CTxMemPoolEntry& cOther);
+	CTxMemPoolEntry& operator=(const CTxMemPoolEntry& cOther);
 
 	std::shared_ptr<CBaseTransaction> GetTx() const {
 		return m_pTx;
@@ -44,16 +55,76 @@ class CTxMemPoolEntry {
 	unsigned int GetHeight() const {
 		return m_unHeight;
 	}
+	uint256 GetHash() const {
+		return m_cHash;
+	}
+	// fee net of fuel per KB at the fuel rate of the last UpdateFeePerKb
+	double GetFeePerKb() const {
+		return m_dFeePerKb;
+	}
+	double GetFeePerKb(int nFuelRate) const;
+	int GetFuelRate() const {
+		return m_nFuelRate;
+	}
+	const CKeyID &GetSourceKeyId() const {
+		return m_cSourceKeyId;
+	}
+	// last chain height the transaction can be mined at
+	int GetExpiryHeight() const;
+	// estimate of the memory held by the entry and its index nodes
+	size_t GetUsage() const;
+
+	void UpdateFeePerKb(int nFuelRate);
+	void SetSourceKeyId(const CKeyID &cKeyId) {
+		m_cSourceKeyId = cKeyId;
+	}
+	// reads and replaced values of the transaction's execution on the pool view, NULL before it ran
+	const std::shared_ptr<const CTxMemPoolFootprint> &GetFootprint() const {
+		return m_pFootprint;
+	}
+	void SetFootprint(const std::shared_ptr<const CTxMemPoolFootprint> &pFootprint);
 
  private:
 	std::shared_ptr<CBaseTransaction> m_pTx;
+	uint256 m_cHash;
 	int64_t m_llFee; 								// Cached to avoid expensive parent-transaction lookups
 	size_t 	m_unTxSize; 							// ... and avoid recomputing tx size
 	int64_t m_llTime; 								// Local time when entering the mempool
 	double 	m_dPriority; 							// Priority when entering the mempool
 	unsigned int m_unHeight; 						// Chain height when entering the mempool
+	int 	m_nFuelRate; 							// Fuel rate m_dFeePerKb was computed at
+	double 	m_dFeePerKb; 							// Cached fee net of fuel per KB
+	CKeyID 	m_cSourceKeyId; 						// Account paying the fee, empty if unknown
+	std::shared_ptr<const CTxMemPoolFootprint> m_pFootprint;
+	size_t 	m_unFootprintUsage; 					// Cached memory held by m_pFootprint
 };
 
+struct ST_FeeRateTag {};
+struct ST_EntryTimeTag {};
+struct ST_SourceTag {};
+struct ST_ExpiryTag {};
+
+/*
+ * Pool entries indexed by hash (the default index, iterating like the former map), by fee per
+ * KB for mining and eviction, by entry time for re-execution order, by source account and by
+ * expiry height.
+ */
+typedef boost::multi_index_container<
+	CTxMemPoolEntry,
+	boost::multi_index::indexed_by<
+		boost::multi_index::ordered_unique<
+			boost::multi_index::const_mem_fun<CTxMemPoolEntry, uint256, &CTxMemPoolEntry::GetHash> >,
+		boost::multi_index::ordered_non_unique<boost::multi_index::tag<ST_FeeRateTag>,
+			boost::multi_index::const_mem_fun<CTxMemPoolEntry, double, &CTxMemPoolEntry::GetFeePerKb> >,
+		boost::multi_index::ordered_non_unique<boost::multi_index::tag<ST_EntryTimeTag>,
+			boost::multi_index::const_mem_fun<CTxMemPoolEntry, int64_t, &CTxMemPoolEntry::GetTime> >,
+		boost::multi_index::ordered_non_unique<boost::multi_index::tag<ST_SourceTag>,
+			boost::multi_index::const_mem_fun<CTxMemPoolEntry, const CKeyID&, &CTxMemPoolEntry::GetSourceKeyId> >,
+		boost::multi_index::ordered_non_unique<boost::multi_index::tag<ST_ExpiryTag>,
+			boost::multi_index::const_mem_fun<CTxMemPoolEntry, int, &CTxMemPoolEntry::GetExpiryHeight> >
+	>
+> IndexedTxSet;
+
 /*
  * CTxMemPool stores valid-according-to-the-current-best-chain
  * transactions that may be included in the next block.
@@ -75,6 +146,8 @@ class CTxMemPool {
 	bool addUnchecked(const uint256& cHash, const CTxMemPoolEntry &cTxMemPoolEntry, CValidationState &cValidationState);
 
 	void remove(CBaseTransaction *pBaseTx, list<std::shared_ptr<CBaseTransaction> >& Removed, bool bRecursive = false);
+	// drop the transactions of a connected block without touching the wallet
+	void removeForBlock(const vector<std::shared_ptr<CBaseTransaction> > &vptx);
 
 	void clear();
 	void queryHashes(vector<uint256>& vctxid);
@@ -91,6 +164,34 @@ class CTxMemPool {
 		return ((m_mapTx.count(hash) != 0));
 	}
 
+	uint64_t GetUsage() const {
+		LOCK(m_cs);
+		return m_ullUsage;
+	}
+
+	void SetMaxUsage(uint64_t ullMaxUsage) {
+		m_ullMaxUsage = ullMaxUsage;
+	}
+
+	uint64_t GetMaxUsage() const {
+		return m_ullMaxUsage;
+	}
+
+	/**
+	 * @brief Fee per KB a transaction must pay above to enter the pool
+	 * @param unTxSize serialized size of the transaction
+	 * @return 0 while the pool has room for the transaction, otherwise the lowest fee per KB in the pool
+	 */
+	double GetMinFeePerKb(unsigned int unTxSize) const;
+
+	/**
+	 * @brief Evict the lowest fee per KB transactions until the pool fits into -maxmempool, together
+	 * with the transactions that used what they wrote, and take them out of the pool view
+	 * @param vcRemoved hashes of the removed transactions
+	 * @return true if anything was removed
+	 */
+	bool TrimToSize(vector<uint256> &vcRemoved);
+
 	std::shared_ptr<CBaseTransaction> lookup(uint256 cHash) const;
 
 	void SetAccountViewDB(CAccountViewCache *pAccountViewCacheIn);
@@ -98,18 +199,25 @@ class CTxMemPool {
 	void SetScriptDBViewDB(CScriptDBViewCache *pScriptDBViewCacheIn);
 
 	bool CheckTxInMemPool(const uint256& cHash, const CTxMemPoolEntry &cTxMemPoolEntry, CValidationState &cValidationState, bool bExcute =
-			true);
+			true, std::shared_ptr<const CTxMemPoolFootprint> *pFootprint = NULL);
 
 	void ReScanMemPoolTx(CAccountViewCache *pAccountViewCacheIn, CScriptDBViewCache *pScriptDBViewCacheIn);
 
 	mutable CCriticalSection m_cs;
-	map<uint256, CTxMemPoolEntry> m_mapTx;
+	IndexedTxSet m_mapTx;
 	std::shared_ptr<CAccountViewCache> m_pAccountViewCache;
 	std::shared_ptr<CScriptDBViewCache> m_pScriptDBViewCache;
 
  private:
  	bool m_bSanityCheck; 					// Normally false, true if -checkmempool or -regtest
  	unsigned int m_unTransactionsUpdated;  	//TODO meaning
+ 	uint64_t m_ullUsage; 					// sum of the entries' GetUsage()
+ 	uint64_t m_ullMaxUsage;
+ 	int m_nFuelRate; 						// fuel rate of the next block, set by ReScanMemPoolTx
+
+ 	void EraseEntry(IndexedTxSet::iterator iterTx);
+ 	void ExpireTx(int nHeight, vector<uint256> &vcRemoved);
+	void RemoveWithDependents(const set<uint256> &setHashes, vector<uint256> &vcRemoved);
 };
 
 #endif
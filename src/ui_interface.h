@@ -7,6 +7,7 @@
 #define DACRS_UI_INTERFACE_H_
 
 #include <stdint.h>
+#include <memory>
 #include <string>
 
 #include <boost/signals2/last_value.hpp>
@@ -16,6 +17,7 @@ class CBasicKeyStore;
 class CWallet;
 class uint256;
 class CBlock;
+class CBaseTransaction;
 
 /** General change type (added, updated, removed). */
 enum ChangeType {
@@ -74,10 +76,10 @@ class CClientUIInterface {
     boost::signals2::signal<bool (const string& message, const string& caption, unsigned int style), boost::signals2::last_value<bool> > ThreadSafeMessageBox;
 
     /** rev tran box. */
-     boost::signals2::signal<bool (const uint256 &hash) > RevTransaction;
+     boost::signals2::signal<bool (const std::shared_ptr<CBaseTransaction> &pTx, const CBlock *pBlock) > RevTransaction;
 
-    /** rev app tran . */
-     boost::signals2::signal<bool (const CBlock *pBlock ,int nIndex) > RevAppTransaction;
+    /** Block connected to the active chain. */
+    boost::signals2::signal<void (const CBlock &block)> NotifyBlockConnected;
 
     /** Progress message during initialization. */
     boost::signals2::signal<void (const string &message)> InitMessage;
@@ -107,6 +109,9 @@ class CClientUIInterface {
 
     /** remove transaction from mempool */
     boost::signals2::signal<bool (const uint256 &hash) > RemoveTransaction;
+
+    /** transaction accepted into mempool */
+    boost::signals2::signal<void (const uint256 &hash)> AcceptTransaction;
 };
 
 extern CClientUIInterface g_cUIInterface;
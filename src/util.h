@@ -14,6 +14,7 @@
 #include "serialize.h"
 #include "tinyformat.h"
 
+#include <chrono>
 #include <cstdio>
 #include <exception>
 #include <map>
@@ -277,6 +278,12 @@ inline int64_t GetTimeMicros() {
 			- boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1))).total_microseconds();
 }
 
+// for measuring durations, unaffected by clock adjustments
+inline int64_t GetMonotonicMicros() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 string DateTimeStrFormat(const char* pszFormat, int64_t llTime);
 
 template<typename T>
@@ -63,44 +63,71 @@ CAppCFund::CAppCFund(const CAppFundOperate& cOp) {
 CAppUserAccout::CAppUserAccout() {
 	m_vuchAccUserID.clear();
 	m_ullValues = 0;
-	m_vcFreezedFund.clear();
 }
 
 CAppUserAccout::CAppUserAccout(const vector<unsigned char> &vuchUserId) {
 	m_vuchAccUserID.clear();
 	m_vuchAccUserID = vuchUserId;
 	m_ullValues = 0;
-	m_vcFreezedFund.clear();
 }
 
 bool CAppUserAccout::GetAppCFund(CAppCFund& cOutFound, const vector<unsigned char>& vuchTag , int nHight) {
-	auto it = find_if(m_vcFreezedFund.begin(), m_vcFreezedFund.end(), [&](const CAppCFund& CfundIn) {
-		return nHight ==CfundIn.getHeight() && CfundIn.getTag()== vuchTag;});
-	if (it != m_vcFreezedFund.end()) {
-		cOutFound = *it;
+	auto it = m_mapFreezedFund.find(make_pair(nHight, vuchTag));
+	if (it != m_mapFreezedFund.end()) {
+		cOutFound = it->second;
 		return true;
 	}
 	return false;
 }
 
 bool CAppUserAccout::AddAppCFund(const CAppCFund& cInFound) {
-	//Ҫҵʱ߶Ⱥtag ͬĲſԺϲ
-	auto it = find_if(m_vcFreezedFund.begin(), m_vcFreezedFund.end(), [&](const CAppCFund& CfundIn) {
-		return CfundIn.getTag()== cInFound.getTag() && CfundIn.getHeight() ==cInFound.getHeight();});
-	if (it != m_vcFreezedFund.end()) { //ҵ
-		it->MergeCFund(cInFound);
-		return true;
+	FundKey tKey(cInFound.getHeight(), cInFound.getTag());
+	auto it = m_mapFreezedFund.find(tKey);
+	if (it != m_mapFreezedFund.end()) { //ҵ
+		it->second.MergeCFund(cInFound);
+	} else {
+		m_mapFreezedFund.insert(make_pair(tKey, cInFound));
 	}
-	//ûҵͼһµ
-	m_vcFreezedFund.insert(m_vcFreezedFund.end(), cInFound);
+	SetChanged(tKey);
 	return true;
 
 }
 
+vector<CAppCFund> CAppUserAccout::getFreezedFund() const {
+	vector<CAppCFund> vcFund;
+	vcFund.reserve(m_mapFreezedFund.size());
+	for (const auto &item : m_mapFreezedFund) {
+		vcFund.push_back(item.second);
+	}
+	return vcFund;
+}
+
+void CAppUserAccout::setFreezedFund(const vector<CAppCFund>& vtmp) {
+	for (const auto &item : m_mapFreezedFund) {
+		SetChanged(item.first);
+	}
+	m_mapFreezedFund.clear();
+	for (const auto &fund : vtmp) {
+		AddAppCFund(fund);
+	}
+}
+
+void CAppUserAccout::LoadAppCFund(const CAppCFund &cFund) {
+	m_mapFreezedFund[FundKey(cFund.getHeight(), cFund.getTag())] = cFund;
+}
+
+void CAppUserAccout::LoadEmbeddedFund(const vector<CAppCFund> &vcFund) {
+	m_mapFreezedFund.clear();
+	m_setChangedFund.clear();
+	for (const auto &fund : vcFund) {
+		AddAppCFund(fund);
+	}
+}
+
 uint64_t CAppUserAccout::GetAllFreezedValues() {
 	uint64_t ullTotal = 0;
-	for (auto &Fund : m_vcFreezedFund) {
-		ullTotal += Fund.getValue();
+	for (auto &item : m_mapFreezedFund) {
+		ullTotal += item.second.getValue();
 	}
 
 	return ullTotal;
@@ -117,33 +144,28 @@ bool CAppUserAccout::AutoMergeFreezeToFree(uint32_t unAppHeight, int nHeight) {
 			}
 		}
 	}
-	bool bIsNeedRemvoe = false;
-	for (auto &Fund : m_vcFreezedFund) {
-		if (Fund.getHeight() <= nHeightOrTime) {
-			//m_ullValues += Fund.getvalue();
-			uint64_t ullTempValue = 0;
-			if (!SafeAdd(m_ullValues, Fund.getValue(), ullTempValue)) {
-				return ERRORMSG("Operate overflow !");
-			}
-			m_ullValues = ullTempValue;
-			bIsNeedRemvoe = true;
+	// matured funds are the ones at the front
+	auto itEnd = m_mapFreezedFund.begin();
+	for (; itEnd != m_mapFreezedFund.end() && itEnd->first.first <= nHeightOrTime; ++itEnd) {
+		//m_ullValues += Fund.getvalue();
+		uint64_t ullTempValue = 0;
+		if (!SafeAdd(m_ullValues, itEnd->second.getValue(), ullTempValue)) {
+			return ERRORMSG("Operate overflow !");
 		}
+		m_ullValues = ullTempValue;
+		SetChanged(itEnd->first);
 	}
-	if (bIsNeedRemvoe) {
-		m_vcFreezedFund.erase(remove_if(m_vcFreezedFund.begin(), m_vcFreezedFund.end(), [&](const CAppCFund& CfundIn) {
-			return (CfundIn.getHeight() <= nHeightOrTime);}), m_vcFreezedFund.end());
-	}
+	m_mapFreezedFund.erase(m_mapFreezedFund.begin(), itEnd);
 	return true;
 
 }
 
 bool CAppUserAccout::ChangeAppCFund(const CAppCFund& cInFound) {
-	//Ҫҵʱ߶Ⱥtag ͬĲſԺϲ
 	assert(cInFound.getHeight() > 0);
-	auto it = find_if(m_vcFreezedFund.begin(), m_vcFreezedFund.end(), [&](const CAppCFund& CfundIn) {
-		return CfundIn.getTag()== cInFound.getTag() && CfundIn.getHeight() ==cInFound.getHeight();});
-	if (it != m_vcFreezedFund.end()) { //ҵ
-		*it = cInFound;
+	auto it = m_mapFreezedFund.find(FundKey(cInFound.getHeight(), cInFound.getTag()));
+	if (it != m_mapFreezedFund.end()) { //ҵ
+		it->second = cInFound;
+		SetChanged(it->first);
 		return true;
 	}
 	return false;
@@ -151,15 +173,15 @@ bool CAppUserAccout::ChangeAppCFund(const CAppCFund& cInFound) {
 
 bool CAppUserAccout::MinusAppCFund(const CAppCFund& cInFound) {
 	assert(cInFound.getHeight() > 0);
-	auto it = find_if(m_vcFreezedFund.begin(), m_vcFreezedFund.end(), [&](const CAppCFund& CfundIn) {
-		return CfundIn.getTag()== cInFound.getTag() && CfundIn.getHeight() ==cInFound.getHeight();});
-	if (it != m_vcFreezedFund.end()) { //ҵ
-		if (it->getValue() >= cInFound.getValue()) {
-			if (it->getValue() == cInFound.getValue()) {
-				m_vcFreezedFund.erase(it);
+	auto it = m_mapFreezedFund.find(FundKey(cInFound.getHeight(), cInFound.getTag()));
+	if (it != m_mapFreezedFund.end()) { //ҵ
+		if (it->second.getValue() >= cInFound.getValue()) {
+			SetChanged(it->first);
+			if (it->second.getValue() == cInFound.getValue()) {
+				m_mapFreezedFund.erase(it);
 				return true;
 			}
-			it->setValue(it->getValue() - cInFound.getValue());
+			it->second.setValue(it->second.getValue() - cInFound.getValue());
 			return true;
 		}
 	}
@@ -245,8 +267,8 @@ Object CAppUserAccout::toJSON() const {
 	result.push_back(Pair("m_vuchAccUserID", HexStr(m_vuchAccUserID)));
 	result.push_back(Pair("FreeValues", m_ullValues));
 	Array arry;
-	for (auto const te : m_vcFreezedFund) {
-		arry.push_back(te.toJSON());
+	for (auto const &item : m_mapFreezedFund) {
+		arry.push_back(item.second.toJSON());
 	}
 	result.push_back(Pair("m_vcFreezedFund", arry));
 	return std::move(result);
@@ -10,6 +10,9 @@
 
 #include "tx.h"
 
+#include <map>
+#include <set>
+
 class CAppFundOperate;
 
 class CAppCFund {
@@ -145,8 +148,17 @@ class CAppFundOperate {
 	}
 };
 
+/**
+ * An app user's free balance and frozen funds. The frozen funds are kept ordered by unlock
+ * height (or time) and tag, which is both the (tag, height) index operations look them up by
+ * and the order matured funds are merged in. In the script db they are stored under a key of
+ * their own each (see CScriptDBViewCache::SetScriptAcc); the funds changed since the account
+ * was read are remembered so that writing it back only touches those keys.
+ */
 class CAppUserAccout {
  public:
+	typedef pair<int, vector<unsigned char> > FundKey; 			// (height, tag)
+
 	CAppUserAccout();
 	CAppUserAccout(const vector<unsigned char> &vuchUserId);
 	bool Operate(const vector<CAppFundOperate> &vcOp);
@@ -174,23 +186,32 @@ class CAppUserAccout {
 		m_vuchAccUserID = accUserId;
 	}
 
-	vector<CAppCFund>& getFreezedFund() {
-		return m_vcFreezedFund;
-	}
+	/** Frozen funds in unlock order */
+	vector<CAppCFund> getFreezedFund() const;
+	void setFreezedFund(const vector<CAppCFund>& vtmp);
 
-	void setFreezedFund(const vector<CAppCFund>& vtmp) {
-		m_vcFreezedFund.clear();
-		for (int i = 0; i < (int) vtmp.size(); i++) {
-			m_vcFreezedFund.push_back(vtmp[i]);
-		}
+	const map<FundKey, CAppCFund>& getFreezedFundMap() const {
+		return m_mapFreezedFund;
 	}
+	/** Funds added, changed or removed since the account was read */
+	const set<FundKey>& getChangedFund() const {
+		return m_setChangedFund;
+	}
+	/** Puts a fund read from the script db, without marking it changed */
+	void LoadAppCFund(const CAppCFund &cFund);
 
 	uint64_t GetAllFreezedValues();
+	// The frozen funds are stored apart, the account record keeps an always empty vector in their
+	// place. Records written before carry them there, they are moved out on the next write.
 	IMPLEMENT_SERIALIZE
 	(
 		READWRITE(VARINT(m_ullValues));
 		READWRITE(m_vuchAccUserID);
-		READWRITE(m_vcFreezedFund);
+		vector<CAppCFund> vcEmbeddedFund;
+		READWRITE(vcEmbeddedFund);
+		if (fRead) {
+			const_cast<CAppUserAccout*>(this)->LoadEmbeddedFund(vcEmbeddedFund);
+		}
 	)
 
 	bool MinusAppCFund(const vector<unsigned char> &vuchTag,uint64_t ullVal,int nHight);
@@ -201,9 +222,15 @@ class CAppUserAccout {
 	bool Operate(const CAppFundOperate &cOp);
 
  private:
+	void LoadEmbeddedFund(const vector<CAppCFund> &vcFund);
+	void SetChanged(const FundKey &tKey) {
+		m_setChangedFund.insert(tKey);
+	}
+
 	uint64_t m_ullValues;       //ɽ
 	vector<unsigned char>  m_vuchAccUserID;
-	vector<CAppCFund> m_vcFreezedFund;
+	map<FundKey, CAppCFund> m_mapFreezedFund;
+	set<FundKey> m_setChangedFund;
 };
 
 class CAssetOperate {
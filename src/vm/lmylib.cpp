@@ -2113,6 +2113,43 @@ static const luaL_Reg mylib[] = { //
 
 		};
 
+// which host calls the contract profiler counts as script DB reads and writes
+static emVmHostCallKind GetHostCallKind(const char *pszName) {
+	static const char *arrpszReads[] = { "ReadData", "GetScriptData", "GetUserAppAccValue", "GetUserAppAccFoudWithTag" };
+	static const char *arrpszWrites[] = { "WriteData", "DeleteData", "ModifyData" };
+	for (const char *pszRead : arrpszReads) {
+		if (0 == strcmp(pszName, pszRead)) {
+			return EM_HOST_CALL_DB_READ;
+		}
+	}
+	for (const char *pszWrite : arrpszWrites) {
+		if (0 == strcmp(pszName, pszWrite)) {
+			return EM_HOST_CALL_DB_WRITE;
+		}
+	}
+	return EM_HOST_CALL_OTHER;
+}
+
+/*
+ * Calls the mylib function at upvalue 1 and, while the contract profiler is on, records it
+ * with the host call kind at upvalue 2 */
+static int ProfiledHostCall(lua_State *L) {
+	const luaL_Reg &tReg = mylib[lua_tointeger(L, lua_upvalueindex(1))];
+	if (!CVmProfiler::IsEnabled()) {
+		return tReg.func(L);
+	}
+	CVmRunEvn* pcVmRunEvn = GetVmRunEvn(L);
+	ST_VmRunProfile *pProfile = (NULL != pcVmRunEvn) ? pcVmRunEvn->GetProfile() : NULL;
+	if (NULL == pProfile) {
+		return tReg.func(L);
+	}
+	int64_t llStart = GetMonotonicMicros();
+	int nRet = tReg.func(L);
+	pProfile->AddHostCall(tReg.name, (emVmHostCallKind) lua_tointeger(L, lua_upvalueindex(2)),
+			GetMonotonicMicros() - llStart);
+	return nRet;
+}
+
 /*
  * עһLuaģ*/
 #ifdef WIN_DLL
@@ -2121,7 +2158,13 @@ extern "C" __declspec(dllexport)int luaopen_mylib(lua_State *L)
 LUAMOD_API int luaopen_mylib(lua_State *L)
 #endif
 {
-	luaL_newlib(L,mylib);//һtable,mylibsкȥ
+	luaL_newlibtable(L, mylib);//һtable,mylibsкȥ
+	for (int i = 0; mylib[i].name != NULL; ++i) {
+		lua_pushinteger(L, i);
+		lua_pushinteger(L, GetHostCallKind(mylib[i].name));
+		lua_pushcclosure(L, ProfiledHostCall, 2);
+		lua_setfield(L, -2, mylib[i].name);
+	}
 	return 1;
 }
 
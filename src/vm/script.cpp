@@ -15,3 +15,85 @@ CVmScript::~CVmScript() {
 	// LEARN Auto-generated destructor stub
 }
 
+
+CVmScriptCache g_cVmScriptCache(DEFAULT_SCRIPT_CACHE_SIZE << 20);
+
+CVmScriptCache::CVmScriptCache(size_t unMaxBytes) :
+		m_unBytes(0), m_unMaxBytes(unMaxBytes), m_ullGeneration(0), m_nBypass(0) {
+}
+
+static size_t ScriptBytes(const CVmScript &cScript) {
+	return cScript.m_vuchRom.size() + cScript.m_vuchScriptExplain.size() + sizeof(CVmScript);
+}
+
+std::shared_ptr<const CVmScript> CVmScriptCache::Get(const vector<unsigned char> &vchScriptId) {
+	if (m_nBypass > 0) {
+		return std::shared_ptr<const CVmScript>();
+	}
+	LOCK(m_cs);
+	auto it = m_mapEntries.find(vchScriptId);
+	if (it == m_mapEntries.end()) {
+		return std::shared_ptr<const CVmScript>();
+	}
+	m_lstEntries.splice(m_lstEntries.begin(), m_lstEntries, it->second);
+	return it->second->second;
+}
+
+void CVmScriptCache::Put(const vector<unsigned char> &vchScriptId, const std::shared_ptr<const CVmScript> &pScript,
+		uint64_t ullGeneration) {
+	if (m_nBypass > 0) {
+		return;
+	}
+	LOCK(m_cs);
+	if (ullGeneration != m_ullGeneration || m_mapEntries.count(vchScriptId)) {
+		return;
+	}
+	m_lstEntries.push_front(make_pair(vchScriptId, pScript));
+	m_mapEntries[vchScriptId] = m_lstEntries.begin();
+	m_unBytes += ScriptBytes(*pScript);
+	Evict();
+}
+
+void CVmScriptCache::Erase(const vector<unsigned char> &vchScriptId) {
+	LOCK(m_cs);
+	++m_ullGeneration;
+	auto it = m_mapEntries.find(vchScriptId);
+	if (it == m_mapEntries.end()) {
+		return;
+	}
+	m_unBytes -= ScriptBytes(*it->second->second);
+	m_lstEntries.erase(it->second);
+	m_mapEntries.erase(it);
+}
+
+void CVmScriptCache::Clear() {
+	LOCK(m_cs);
+	++m_ullGeneration;
+	m_lstEntries.clear();
+	m_mapEntries.clear();
+	m_unBytes = 0;
+}
+
+void CVmScriptCache::SetMaxBytes(size_t unMaxBytes) {
+	LOCK(m_cs);
+	m_unMaxBytes = unMaxBytes;
+	Evict();
+}
+
+size_t CVmScriptCache::GetBytes() const {
+	LOCK(m_cs);
+	return m_unBytes;
+}
+
+size_t CVmScriptCache::GetCount() const {
+	LOCK(m_cs);
+	return m_mapEntries.size();
+}
+
+void CVmScriptCache::Evict() {
+	while (m_unBytes > m_unMaxBytes && !m_lstEntries.empty()) {
+		m_unBytes -= ScriptBytes(*m_lstEntries.back().second);
+		m_mapEntries.erase(m_lstEntries.back().first);
+		m_lstEntries.pop_back();
+	}
+}
@@ -9,6 +9,12 @@
 #define DACRS_VM_SCRIPT_H_
 
 #include "serialize.h"
+#include "sync.h"
+
+#include <atomic>
+#include <list>
+#include <map>
+#include <memory>
 using namespace std;
 
 /**
@@ -49,7 +55,7 @@ class CVmScript {
 		return true;
 	}
 
-	bool IsCheckAccount(void) {
+	bool IsCheckAccount(void) const {
 		if (m_nScriptType) {
 			return false;                    //luaűֱӷ(ص˻ƽ)
 		}
@@ -65,7 +71,7 @@ class CVmScript {
 
 	CVmScript();
 
-	int getScriptType() {
+	int getScriptType() const {
 		return m_nScriptType;
 	}
 	IMPLEMENT_SERIALIZE
@@ -77,4 +83,61 @@ class CVmScript {
 	virtual ~CVmScript();
 };
 
+/** Default for -maxscriptcache, in megabytes */
+static const unsigned int DEFAULT_SCRIPT_CACHE_SIZE = 16;
+
+/**
+ * LRU of decoded, validated app scripts keyed by the app's 6-byte CRegID, shared by block
+ * connection, the mempool and the miner. The script of a CRegID is fixed once its registration
+ * block is in the chain, so entries are only dropped when a registration is written, erased or
+ * undone. Scripts of forks being validated may differ from the active chain's, those lookups
+ * bypass the cache through CVmScriptCacheBypass.
+ */
+class CVmScriptCache {
+ public:
+	explicit CVmScriptCache(size_t unMaxBytes);
+
+	/** Returns NULL on a miss or while bypassed */
+	std::shared_ptr<const CVmScript> Get(const vector<unsigned char> &vchScriptId);
+	/** Generation to pass to Put, read before reading the script from a view */
+	uint64_t GetGeneration() const {
+		return m_ullGeneration.load();
+	}
+	/** Ignored if anything was erased since ullGeneration was read */
+	void Put(const vector<unsigned char> &vchScriptId, const std::shared_ptr<const CVmScript> &pScript,
+			uint64_t ullGeneration);
+	void Erase(const vector<unsigned char> &vchScriptId);
+	void Clear();
+	void SetMaxBytes(size_t unMaxBytes);
+	size_t GetBytes() const;
+	size_t GetCount() const;
+
+ private:
+	friend class CVmScriptCacheBypass;
+	typedef list<pair<vector<unsigned char>, std::shared_ptr<const CVmScript> > > EntryList;
+
+	void Evict();
+
+	mutable CCriticalSection m_cs;
+	EntryList m_lstEntries; 										// most recently used first
+	map<vector<unsigned char>, EntryList::iterator> m_mapEntries;
+	size_t m_unBytes;
+	size_t m_unMaxBytes;
+	std::atomic<uint64_t> m_ullGeneration;
+	std::atomic<int> m_nBypass;
+};
+
+extern CVmScriptCache g_cVmScriptCache;
+
+/** While one exists, the decoded script cache is neither read nor filled */
+class CVmScriptCacheBypass {
+ public:
+	CVmScriptCacheBypass() {
+		++g_cVmScriptCache.m_nBypass;
+	}
+	~CVmScriptCacheBypass() {
+		--g_cVmScriptCache.m_nBypass;
+	}
+};
+
 #endif /* DACRS_VM_SCRIPT_H_ */
@@ -1450,6 +1450,25 @@ RET_DEFINE CallExternalFunc(INT16U method, unsigned char *ipara,CVmRunEvn *pVmEv
 
 }
 
+// which host calls the contract profiler counts as script DB reads and writes
+static emVmHostCallKind GetHostCallKind(INT16U method) {
+	switch (method) {
+	case READDB_FUNC:
+	case GETDBSIZE_FUNC:
+	case GETDBVALUE_FUNC:
+	case GETSCRIPTDATA_FUNC:
+	case GET_APP_USER_ACC_VALUE_FUN:
+	case GET_APP_USER_ACC_FUND_WITH_TAG_FUN:
+		return EM_HOST_CALL_DB_READ;
+	case WRITEDB_FUNC:
+	case DELETEDB_FUNC:
+	case MODIFYDBVALUE_FUNC:
+		return EM_HOST_CALL_DB_WRITE;
+	default:
+		return EM_HOST_CALL_OTHER;
+	}
+}
+
 int64_t CVm8051::run(uint64_t maxstep, CVmRunEvn *pVmEvn) {
 	INT8U code = 0;
 	int64_t step = 0;  //uint64_t
@@ -1467,7 +1486,13 @@ int64_t CVm8051::run(uint64_t maxstep, CVmRunEvn *pVmEvn) {
 			//get what func will be called
 			INT16U methodID = ((INT16U) GetExRam(VM_FUN_CALL_ADDR) | ((INT16U) GetExRam(VM_FUN_CALL_ADDR+1) << 8));
 			unsigned char *ipara = (unsigned char *) GetExRamAddr(VM_SHARE_ADDR);		//input para
+			ST_VmRunProfile *pProfile = pVmEvn->GetProfile();
+			int64_t llCallStart = (NULL != pProfile) ? GetMonotonicMicros() : 0;
 			RET_DEFINE retdata = CallExternalFunc(methodID, ipara, pVmEvn);
+			if (NULL != pProfile && methodID < ARRAYLEN(API_METOHD)) {
+				pProfile->AddHostCall(API_METOHD[methodID].c_str(), GetHostCallKind(methodID),
+						GetMonotonicMicros() - llCallStart);
+			}
 			memset(ipara, 0, MAX_SHARE_RAM);
 			step += std::get<1>(retdata) - 1;
 			if (std::get<0>(retdata) == 1) {
@@ -0,0 +1,40 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "vmprofiler.h"
+
+std::atomic<bool> CVmProfiler::s_bEnabled(false);
+
+CVmProfiler g_cVmProfiler;
+
+void CVmProfiler::AddRun(const vector<unsigned char> &vchScriptId, int nScriptType, int64_t llSteps,
+		int64_t llMicros, const ST_VmRunProfile &tRun) {
+	LOCK(m_cs);
+	ST_VmScriptProfile &tProfile = m_mapScripts[vchScriptId];
+	tProfile.nScriptType = nScriptType;
+	++tProfile.ullRuns;
+	if (llSteps > 0) {
+		tProfile.ullSteps += llSteps;
+		tProfile.ullMaxSteps = max<uint64_t>(tProfile.ullMaxSteps, llSteps);
+	} else {
+		++tProfile.ullFailed;
+	}
+	tProfile.llMicros += llMicros;
+	tProfile.llMaxMicros = max(tProfile.llMaxMicros, llMicros);
+	tProfile.ullDbReads += tRun.ullDbReads;
+	tProfile.ullDbWrites += tRun.ullDbWrites;
+	for (const auto &item : tRun.mapHostCalls) {
+		tProfile.mapHostCalls[item.first].Add(item.second);
+	}
+}
+
+map<vector<unsigned char>, ST_VmScriptProfile> CVmProfiler::GetProfiles() const {
+	LOCK(m_cs);
+	return m_mapScripts;
+}
+
+void CVmProfiler::Reset() {
+	LOCK(m_cs);
+	m_mapScripts.clear();
+}
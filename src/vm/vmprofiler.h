@@ -0,0 +1,115 @@
+// Copyright (c) 2014-2015 The Dacrs developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DACRS_VM_VMPROFILER_H_
+#define DACRS_VM_VMPROFILER_H_
+
+#include "sync.h"
+
+#include <stdint.h>
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+enum emVmHostCallKind {
+	EM_HOST_CALL_OTHER,
+	EM_HOST_CALL_DB_READ, 		// reads the app's script data or app accounts
+	EM_HOST_CALL_DB_WRITE, 		// writes or erases the app's script data
+};
+
+struct ST_VmHostCallStats {
+	ST_VmHostCallStats() :
+			ullCalls(0), llMicros(0), llMaxMicros(0) {
+	}
+
+	uint64_t ullCalls;
+	int64_t llMicros;
+	int64_t llMaxMicros;
+
+	void Add(int64_t llCallMicros) {
+		++ullCalls;
+		llMicros += llCallMicros;
+		llMaxMicros = max(llMaxMicros, llCallMicros);
+	}
+	void Add(const ST_VmHostCallStats &tOther) {
+		ullCalls += tOther.ullCalls;
+		llMicros += tOther.llMicros;
+		llMaxMicros = max(llMaxMicros, tOther.llMaxMicros);
+	}
+};
+
+/**
+ * Host calls of a single VM run, gathered without locking by the CVmRunEvn running it.
+ * Methods are keyed by the address of their static name (API_METOHD entry or mylib name).
+ */
+struct ST_VmRunProfile {
+	ST_VmRunProfile() :
+			ullDbReads(0), ullDbWrites(0) {
+	}
+
+	map<const char *, ST_VmHostCallStats> mapHostCalls;
+	uint64_t ullDbReads;
+	uint64_t ullDbWrites;
+
+	void AddHostCall(const char *pszMethod, emVmHostCallKind emKind, int64_t llMicros) {
+		mapHostCalls[pszMethod].Add(llMicros);
+		if (EM_HOST_CALL_DB_READ == emKind) {
+			++ullDbReads;
+		} else if (EM_HOST_CALL_DB_WRITE == emKind) {
+			++ullDbWrites;
+		}
+	}
+};
+
+/** Totals of one app since the profiler was enabled or last reset */
+struct ST_VmScriptProfile {
+	ST_VmScriptProfile() :
+			nScriptType(0), ullRuns(0), ullFailed(0), ullSteps(0), ullMaxSteps(0), llMicros(0), llMaxMicros(0),
+			ullDbReads(0), ullDbWrites(0) {
+	}
+
+	int nScriptType; 					// 0:8051, 1:lua
+	uint64_t ullRuns;
+	uint64_t ullFailed; 				// runs the VM aborted or that ran out of steps
+	uint64_t ullSteps;
+	uint64_t ullMaxSteps;
+	int64_t llMicros;
+	int64_t llMaxMicros;
+	uint64_t ullDbReads;
+	uint64_t ullDbWrites;
+	map<string, ST_VmHostCallStats> mapHostCalls;
+};
+
+/**
+ * Opt-in (-contractprofile) per-app profile of the 8051 and Lua VMs: steps, wall time,
+ * host calls by method and script DB accesses, keyed by the app's 6-byte CRegID.
+ * Runs made for mempool acceptance are counted as well as those in blocks.
+ */
+class CVmProfiler {
+ public:
+	static void SetEnabled(bool bEnabled) {
+		s_bEnabled.store(bEnabled, std::memory_order_relaxed);
+	}
+	static bool IsEnabled() {
+		return s_bEnabled.load(std::memory_order_relaxed);
+	}
+
+	void AddRun(const vector<unsigned char> &vchScriptId, int nScriptType, int64_t llSteps, int64_t llMicros,
+			const ST_VmRunProfile &tRun);
+	map<vector<unsigned char>, ST_VmScriptProfile> GetProfiles() const;
+	void Reset();
+
+ private:
+	static std::atomic<bool> s_bEnabled;
+
+	mutable CCriticalSection m_cs;
+	map<vector<unsigned char>, ST_VmScriptProfile> m_mapScripts;
+};
+
+extern CVmProfiler g_cVmProfiler;
+
+#endif // DACRS_VM_VMPROFILER_H_
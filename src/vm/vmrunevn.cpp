@@ -25,6 +25,7 @@ CVmRunEvn::CVmRunEvn() {
 	m_view = NULL;
 	m_dblog = std::make_shared<std::vector<CScriptDBOperLog> >();
 	m_bIsCheckAccount = false;
+	m_bProfile = false;
 	m_nScriptType = 0; //Ĭ8051ű
 }
 
@@ -57,36 +58,51 @@ bool CVmRunEvn::intial(shared_ptr<CBaseTransaction> & Tx, CAccountViewCache& cVi
 	}
 
 	CTransaction* pcSecure = static_cast<CTransaction*>(Tx.get());
+	const CRegID &cAppId = boost::get<CRegID>(pcSecure->m_cDesUserId);
+	vector<unsigned char> vchAppId = cAppId.GetVec6();
+
+	// apps registered in the block being run may still be undone with it, don't cache them
+	bool bCacheable = cAppId.getHight() < (uint32_t) nHeight;
+	if (bCacheable) {
+		m_pVmScript = g_cVmScriptCache.Get(vchAppId);
+	}
+	if (!m_pVmScript) {
+		uint64_t ullGeneration = g_cVmScriptCache.GetGeneration();
+		if (!m_ScriptDBTip->GetScript(cAppId, vuchScript)) {
+			LogPrint("ERROR", "Script is not Registed %s\r\n", cAppId.ToString());
+			return false;
+		}
 
-	if (!m_ScriptDBTip->GetScript(boost::get<CRegID>(pcSecure->m_cDesUserId), vuchScript)) {
-		LogPrint("ERROR", "Script is not Registed %s\r\n", boost::get<CRegID>(pcSecure->m_cDesUserId).ToString());
-		return false;
-	}
-
-	CDataStream cDataStream(vuchScript, SER_DISK, g_sClientVersion);
-	try {
-		cDataStream >> m_cVmScript;
-	} catch (exception& e) {
-		LogPrint("ERROR", "%s\r\n", "CVmScriptRun::intial() Unserialize to vmScript error");
-		throw runtime_error("CVmScriptRun::intial() Unserialize to vmScript error:" + string(e.what()));
-	}
+		std::shared_ptr<CVmScript> pVmScript = std::make_shared<CVmScript>();
+		CDataStream cDataStream(vuchScript, SER_DISK, g_sClientVersion);
+		try {
+			cDataStream >> *pVmScript;
+		} catch (exception& e) {
+			LogPrint("ERROR", "%s\r\n", "CVmScriptRun::intial() Unserialize to vmScript error");
+			throw runtime_error("CVmScriptRun::intial() Unserialize to vmScript error:" + string(e.what()));
+		}
 
-	if (m_cVmScript.IsValid() == false) {
-		LogPrint("ERROR", "%s\r\n", "CVmScriptRun::intial() vmScript.IsValid error");
-		return false;
+		if (pVmScript->IsValid() == false) {
+			LogPrint("ERROR", "%s\r\n", "CVmScriptRun::intial() vmScript.IsValid error");
+			return false;
+		}
+		m_pVmScript = pVmScript;
+		if (bCacheable) {
+			g_cVmScriptCache.Put(vchAppId, m_pVmScript, ullGeneration);
+		}
 	}
-	m_bIsCheckAccount = m_cVmScript.IsCheckAccount();
-	m_nScriptType = m_cVmScript.getScriptType(); //ʼű
+	m_bIsCheckAccount = m_pVmScript->IsCheckAccount();
+	m_nScriptType = m_pVmScript->getScriptType(); //ʼű
 	if (pcSecure->m_vchContract.size() >= 4 * 1024) {
 		LogPrint("ERROR", "%s\r\n", "CVmScriptRun::intial() vContract context size lager 4096");
 		return false;
 	}
 	try {
 		if (0 == m_nScriptType) {
-			m_pMcu = std::make_shared<CVm8051>(m_cVmScript.m_vuchRom, pcSecure->m_vchContract);
+			m_pMcu = std::make_shared<CVm8051>(m_pVmScript->m_vuchRom, pcSecure->m_vchContract);
 			LogPrint("vm", "%s\r\n", "CVmScriptRun::intial() MCU");
 		} else {
-			m_pLua = std::make_shared<CVmlua>(m_cVmScript.m_vuchRom, pcSecure->m_vchContract);
+			m_pLua = std::make_shared<CVmlua>(m_pVmScript->m_vuchRom, pcSecure->m_vchContract);
 			//pVmRunEvn = this; //CVmRunEvnָlmylib.cppʹ
 			LogPrint("vm", "%s\r\n", "CVmScriptRun::intial() LUA");
 		}
@@ -125,12 +141,22 @@ tuple<bool, uint64_t, string> CVmRunEvn::run(shared_ptr<CBaseTransaction>& Tx, C
 	}
 
 	int64_t llStep = 0;
-	if (0 == m_nScriptType) {
-		llStep = m_pMcu.get()->run(ullMaxStep, this);
-		LogPrint("vm", "%s\r\n", "CVmScriptRun::run() MCU");
-	} else {
-		llStep = m_pLua.get()->run(ullMaxStep, this);
-		LogPrint("vm", "%s\r\n", "CVmScriptRun::run() LUA");
+	m_bProfile = CVmProfiler::IsEnabled();
+	m_tProfile = ST_VmRunProfile();
+	{
+		CBlockPhaseTimer cTimer(0 == m_nScriptType ? EM_BLOCK_PHASE_VM_8051 : EM_BLOCK_PHASE_VM_LUA);
+		int64_t llStart = GetMonotonicMicros();
+		if (0 == m_nScriptType) {
+			llStep = m_pMcu.get()->run(ullMaxStep, this);
+			LogPrint("vm", "%s\r\n", "CVmScriptRun::run() MCU");
+		} else {
+			llStep = m_pLua.get()->run(ullMaxStep, this);
+			LogPrint("vm", "%s\r\n", "CVmScriptRun::run() LUA");
+		}
+		if (m_bProfile) {
+			g_cVmProfiler.AddRun(GetScriptRegID().GetVec6(), m_nScriptType, llStep, GetMonotonicMicros() - llStart,
+					m_tProfile);
+		}
 	}
 	if (0 == llStep) {
 		return std::make_tuple(false, 0, string("VmScript run Failed\n"));
@@ -578,10 +604,10 @@ bool CVmRunEvn::OpeatorAppAccount(const map<vector<unsigned char>, vector<CAppFu
 			}
 			LogPrint("vm", "after user: %s\r\n", sptrAcc.get()->toString());
 			m_NewAppUserAccout.push_back(sptrAcc);
-			CScriptDBOperLog log;
-			cView.SetScriptAcc(GetScriptRegID(), *sptrAcc.get(), log);
 			shared_ptr<vector<CScriptDBOperLog> > m_dblog = GetDbLog();
-			m_dblog.get()->push_back(log);
+			if (!cView.SetScriptAcc(GetScriptRegID(), *sptrAcc.get(), *m_dblog.get())) {
+				return false;
+			}
 		}
 	}
 	return true;
@@ -12,6 +12,7 @@
 #include "vmlua.h"
 #include "serialize.h"
 #include "script.h"
+#include "vmprofiler.h"
 #include "main.h"
 #include "txdb.h"
 #include <memory>
@@ -41,9 +42,9 @@ class CVmRunEvn {
 	 */
 	shared_ptr<CBaseTransaction> m_plistTx;
 	/**
-	 * run the script
+	 * run the script, shared with the decoded script cache
 	 */
-	CVmScript m_cVmScript;
+	std::shared_ptr<const CVmScript> m_pVmScript;
 	/**
 	 * the block height
 	 */
@@ -64,6 +65,8 @@ class CVmRunEvn {
 
 	map<vector<unsigned char >,vector<CAppFundOperate> > m_MapAppOperate;  //vector<unsigned char > accountId
 	shared_ptr<vector<CScriptDBOperLog> > m_dblog;
+	bool m_bProfile; 				// -contractprofile was on when the run started
+	ST_VmRunProfile m_tProfile;
 
  private:
 	/**
@@ -156,6 +159,13 @@ class CVmRunEvn {
 	bool InsertOutputData(const vector<CVmOperate>& vcSource);
 	void InsertOutAPPOperte(const vector<unsigned char>& vuchUserId, const CAppFundOperate &vcSource);
 	shared_ptr<vector<CScriptDBOperLog> > GetDbLog();
+	/**
+	 * @brief host calls of the current run are recorded here while the contract profiler is on
+	 * @return: NULL when the run is not profiled
+	 */
+	ST_VmRunProfile *GetProfile() {
+		return m_bProfile ? &m_tProfile : NULL;
+	}
 
 	bool GetAppUserAccout(const vector<unsigned char> &vuchAppUserId, shared_ptr<CAppUserAccout> &sptrAcc);
 	bool CheckAppAcctOperate(CTransaction* pcTx);
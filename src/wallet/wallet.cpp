@@ -221,14 +221,12 @@ void CWallet::SetBestChain(const ST_BlockLocator& loc) {
 }
 
 void CWallet::SyncTransaction(const uint256 &hash, CBaseTransaction*pTx, const CBlock* pblock) {
-	static std::shared_ptr<vector<string> > monitoring_appid = NULL;
-	if(monitoring_appid == NULL) {
-		monitoring_appid = SysCfg().GetMultiArgsMap("-appid");
-	}
-
 	LOCK2(g_cs_main, m_cs_wallet);
 
 	assert(pTx != NULL || pblock != NULL);
+	int64_t llSyncStart = GetTimeMicros();
+	std::shared_ptr<CWalletWriteBatch> pBatch = std::make_shared<CWalletWriteBatch>();
+	set<CKeyID> setBalanceKeyId;
 
 	//this is block Sync
 	if(hash.IsNull() && pTx == NULL) {
@@ -249,19 +247,10 @@ void CWallet::SyncTransaction(const uint256 &hash, CBaseTransaction*pTx, const C
 
 		auto ConnectBlockProgress = [&]() {
 			CAccountTx newtx(this, blockhash,pblock->GetHeight());
-			int i=0;
 			for (const auto &sptx : pblock->vptx) {
 				uint256 hashtx = sptx->GetHash();
-				if(sptx->m_chTxType == EM_CONTRACT_TX) {
-					string thisapp = boost::get<CRegID>(static_cast<CTransaction const*>(sptx.get())->m_cDesUserId).ToString();
-					auto it = find_if(monitoring_appid->begin(), monitoring_appid->end(), [&](const string& appid) {
-						return appid ==  thisapp;});
-			        if(monitoring_appid->end() != it) {
-			        	g_cUIInterface.RevAppTransaction(pblock, i);
-			        }
-				}
 				//confirm the tx is mine
-				if (IsMine(sptx.get())) {
+				if (GetMyKeys(sptx.get(), setBalanceKeyId)) {
 					if (sptx->m_chTxType == EM_REG_ACCT_TX) {
 						//fIsNeedUpDataRegID = true;
 					} else if (sptx->m_chTxType == EM_CONTRACT_TX) {
@@ -273,18 +262,17 @@ void CWallet::SyncTransaction(const uint256 &hash, CBaseTransaction*pTx, const C
 						}*/
 					}
 					newtx.AddTx(hashtx,sptx.get());
-					g_cUIInterface.RevTransaction(sptx.get()->GetHash());
+					g_cUIInterface.RevTransaction(sptx, pblock);
 				}
 				if (m_mapUnConfirmTx.count(hashtx)> 0) {
-					CWalletDB(m_strWalletFile).EraseUnComFirmedTx(hashtx);
+					pBatch->EraseUnConfirmTx(hashtx);
 					m_mapUnConfirmTx.erase(hashtx);
 				}
-				++i;
 			}
 			//write to disk
 			if (newtx.GetTxSize() > 0) {
 				m_mapInBlockTx[blockhash] = newtx; //add to map
-				newtx.WriteToDisk();
+				pBatch->WriteBlockTx(blockhash, newtx);
 			}
 		};
 		auto DisConnectBlockProgress = [&]() {
@@ -295,13 +283,13 @@ void CWallet::SyncTransaction(const uint256 &hash, CBaseTransaction*pTx, const C
 					continue;
 				}
 				CRegID regid(index, i++);
-				if(IsMine(sptx.get())) {
+				if(GetMyKeys(sptx.get(), setBalanceKeyId)) {
 					m_mapUnConfirmTx[sptx.get()->GetHash()] = sptx.get()->GetNewInstance();
-					CWalletDB(m_strWalletFile).WriteUnComFirmedTx(sptx.get()->GetHash(),m_mapUnConfirmTx[sptx.get()->GetHash()]);
+					pBatch->WriteUnConfirmTx(sptx.get()->GetHash(), m_mapUnConfirmTx[sptx.get()->GetHash()]);
 				}
 			}
 			if (m_mapInBlockTx.count(blockhash)) {
-				CWalletDB(m_strWalletFile).EraseBlockTx(blockhash);
+				pBatch->EraseBlockTx(blockhash);
 				m_mapInBlockTx.erase(blockhash);
 			}
 		};
@@ -320,9 +308,17 @@ void CWallet::SyncTransaction(const uint256 &hash, CBaseTransaction*pTx, const C
 			//disconnect block
 			DisConnectBlockProgress();
 		}
+		QueueWriteBatch(pBatch);
+		UpdateBalance(setBalanceKeyId);
+		m_llLastBlockSyncTime = GetTimeMicros() - llSyncStart;
+		m_llTotalBlockSyncTime += m_llLastBlockSyncTime;
+		++m_ullSyncBlockCount;
 	}
 	else if (pTx != NULL) {
 		LogPrint("todo","acept in mempool tx %s\r\n",pTx->GetHash().ToString());
+		if (GetMyKeys(pTx, setBalanceKeyId)) {
+			UpdateBalance(setBalanceKeyId);
+		}
     }
 }
 
@@ -335,7 +331,9 @@ void CWallet::EraseFromWallet(const uint256 &hash) {
 		LOCK(m_cs_wallet);
 		if(m_mapUnConfirmTx.count(hash)) {
 			m_mapUnConfirmTx.erase(hash);
-			CWalletDB(m_strWalletFile).EraseUnComFirmedTx(hash);
+			std::shared_ptr<CWalletWriteBatch> pBatch = std::make_shared<CWalletWriteBatch>();
+			pBatch->EraseUnConfirmTx(hash);
+			QueueWriteBatch(pBatch);
 		}
 	}
 
@@ -405,11 +403,100 @@ void CWallet::ResendWalletTransactions() {
 			LogPrint("CWallet","abort inavlibal tx %s reason:%s\r\n",te.second.get()->ToString(*g_pAccountViewTip),std::get<1>(ret));
 		}
 	}
+	std::shared_ptr<CWalletWriteBatch> pBatch = std::make_shared<CWalletWriteBatch>();
 	for (auto const & tee : erase) {
-		CWalletDB(m_strWalletFile).EraseUnComFirmedTx(tee);
+		pBatch->EraseUnConfirmTx(tee);
 		g_cUIInterface.RemoveTransaction(tee);
 		m_mapUnConfirmTx.erase(tee);
 	}
+	QueueWriteBatch(pBatch);
+}
+
+void CWallet::QueueWriteBatch(const std::shared_ptr<CWalletWriteBatch> &pBatch) {
+	if (pBatch->IsEmpty()) {
+		return;
+	}
+	{
+		LOCK(m_cs_writeQueue);
+		if (m_bWriteBehind) {
+			m_dequeWriteBatch.push_back(pBatch);
+			return;
+		}
+	}
+	//no writer thread running, keep the old synchronous behaviour
+	LOCK(m_cs_writeDisk);
+	WriteBatchToDisk(*pBatch);
+}
+
+bool CWallet::FlushWriteBatch() {
+	LOCK(m_cs_writeDisk);
+	bool bRet = true;
+	while (true) {
+		std::shared_ptr<CWalletWriteBatch> pBatch;
+		{
+			LOCK(m_cs_writeQueue);
+			if (m_dequeWriteBatch.empty()) {
+				break;
+			}
+			pBatch = m_dequeWriteBatch.front();
+		}
+		if (!WriteBatchToDisk(*pBatch)) {
+			bRet = false;
+		}
+		{
+			LOCK(m_cs_writeQueue);
+			m_dequeWriteBatch.pop_front();
+		}
+	}
+	return bRet;
+}
+
+bool CWallet::WriteBatchToDisk(const CWalletWriteBatch &cBatch) {
+	if (!m_bFileBacked) {
+		return true;
+	}
+	int64_t llWriteStart = GetTimeMicros();
+	CWalletDB cWalletDB(m_strWalletFile);
+	if (!cWalletDB.TxnBegin()) {
+		return ERRORMSG("WriteBatchToDisk() : begin wallet db transaction failed");
+	}
+	bool bRet = true;
+	for (auto const &item : cBatch.m_setEraseUnConfirmTx) {
+		bRet = bRet && cWalletDB.EraseUnComFirmedTx(item);
+	}
+	for (auto const &item : cBatch.m_mapWriteUnConfirmTx) {
+		bRet = bRet && cWalletDB.WriteUnComFirmedTx(item.first, item.second);
+	}
+	for (auto const &item : cBatch.m_setEraseBlockTx) {
+		bRet = bRet && cWalletDB.EraseBlockTx(item);
+	}
+	for (auto const &item : cBatch.m_mapWriteBlockTx) {
+		bRet = bRet && cWalletDB.WriteBlockTx(item.first, item.second);
+	}
+	if (!bRet) {
+		cWalletDB.TxnAbort();
+		return ERRORMSG("WriteBatchToDisk() : write wallet db failed, transaction aborted");
+	}
+	if (!cWalletDB.TxnCommit()) {
+		return ERRORMSG("WriteBatchToDisk() : commit wallet db transaction failed");
+	}
+	m_llLastBlockWriteTime = GetTimeMicros() - llWriteStart;
+	return true;
+}
+
+void CWallet::SetWriteBehind(bool bWriteBehind) {
+	{
+		LOCK(m_cs_writeQueue);
+		m_bWriteBehind = bWriteBehind;
+	}
+	if (!bWriteBehind) {
+		FlushWriteBatch();
+	}
+}
+
+size_t CWallet::GetPendingWriteBatchSize() const {
+	LOCK(m_cs_writeQueue);
+	return m_dequeWriteBatch.size();
 }
 
 //// Call after CreateTransaction unless you want to abort
@@ -437,20 +524,85 @@ emDBErrors CWallet::LoadWallet(bool bFirstRunRet) {
 }
 
 int64_t CWallet::GetRawBalance(bool bIsConfirmed) const {
-	int64_t llRet = 0;
+	LOCK(m_cs_balance);
+	return bIsConfirmed ? m_llConfirmedBalance : m_llUnConfirmedBalance;
+}
+
+int64_t CWallet::GetRawBalance(const CKeyID &keyId, bool bIsConfirmed) const {
+	LOCK(m_cs_balance);
+	if (!bIsConfirmed) {
+		map<CKeyID, int64_t>::const_iterator iter = m_mapUnConfirmedBalance.find(keyId);
+		if (iter != m_mapUnConfirmedBalance.end()) {
+			return iter->second;
+		}
+	}
+	map<CKeyID, int64_t>::const_iterator iter = m_mapConfirmedBalance.find(keyId);
+	if (iter != m_mapConfirmedBalance.end()) {
+		return iter->second;
+	}
+	return 0;
+}
+
+void CWallet::SetBalance(const CKeyID &keyId, int64_t llConfirmed, int64_t llUnConfirmed) {
+	AssertLockHeld(m_cs_balance);
+	int64_t llOldConfirmed = m_mapConfirmedBalance.count(keyId) ? m_mapConfirmedBalance[keyId] : 0;
+	int64_t llOldUnConfirmed = m_mapUnConfirmedBalance.count(keyId) ? m_mapUnConfirmedBalance[keyId] : llOldConfirmed;
+	m_llConfirmedBalance += llConfirmed - llOldConfirmed;
+	m_llUnConfirmedBalance += llUnConfirmed - llOldUnConfirmed;
+	m_mapConfirmedBalance[keyId] = llConfirmed;
+	if (llUnConfirmed != llConfirmed) {
+		m_mapUnConfirmedBalance[keyId] = llUnConfirmed;
+	} else {
+		m_mapUnConfirmedBalance.erase(keyId);
+	}
+}
+
+void CWallet::UpdateBalance(const set<CKeyID> &setKeyId) {
+	AssertLockHeld(g_cs_main);
+	LOCK(m_cs_balance);
+	for (auto &keyId : setKeyId) {
+		int64_t llConfirmed = g_pAccountViewTip->GetRawBalance(keyId);
+		int64_t llUnConfirmed = llConfirmed;
+		if (g_cTxMemPool.m_pAccountViewCache) {
+			llUnConfirmed = g_cTxMemPool.m_pAccountViewCache->GetRawBalance(keyId);
+		}
+		SetBalance(keyId, llConfirmed, llUnConfirmed);
+		//the mempool view is only consistent with the tip again after ReScanMemPoolTx
+		m_setMemPoolDirtyKeys.insert(keyId);
+	}
+}
+
+void CWallet::RebuildBalanceIndex() {
+	LOCK2(g_cs_main, m_cs_wallet);
 	{
-		LOCK2(g_cs_main, m_cs_wallet);
-		set<CKeyID> setKeyId;
-		GetKeys(setKeyId);
-		for (auto &keyId :setKeyId) {
-			if (!bIsConfirmed) {
-				llRet += g_cTxMemPool.m_pAccountViewCache->GetRawBalance(keyId);
-			} else {
-				llRet += g_pAccountViewTip->GetRawBalance(keyId);
-			}
+		LOCK(m_cs_balance);
+		m_mapConfirmedBalance.clear();
+		m_mapUnConfirmedBalance.clear();
+		m_setMemPoolDirtyKeys.clear();
+		m_llConfirmedBalance = 0;
+		m_llUnConfirmedBalance = 0;
+	}
+	set<CKeyID> setKeyId;
+	GetKeys(setKeyId);
+	UpdateBalance(setKeyId);
+}
+
+void CWallet::UpdatedMemPool() {
+	LOCK2(g_cs_main, m_cs_wallet);
+	LOCK(m_cs_balance);
+	set<CKeyID> setKeyId;
+	setKeyId.swap(m_setMemPoolDirtyKeys);
+	for (auto &item : m_mapUnConfirmedBalance) {
+		setKeyId.insert(item.first);
+	}
+	for (auto &keyId : setKeyId) {
+		int64_t llConfirmed = m_mapConfirmedBalance.count(keyId) ? m_mapConfirmedBalance[keyId] : 0;
+		int64_t llUnConfirmed = llConfirmed;
+		if (g_cTxMemPool.m_pAccountViewCache) {
+			llUnConfirmed = g_cTxMemPool.m_pAccountViewCache->GetRawBalance(keyId);
 		}
+		SetBalance(keyId, llConfirmed, llUnConfirmed);
 	}
-	return llRet;
 }
 
 
@@ -722,21 +874,29 @@ uint256 CWallet::GetCheckSum() const {
 }
 
 bool CWallet::IsMine(CBaseTransaction* pTx) const {
+	set<CKeyID> setKeyId;
+	return GetMyKeys(pTx, setKeyId);
+}
+
+bool CWallet::GetMyKeys(CBaseTransaction* pTx, set<CKeyID> &setKeyId) const {
 	set<CKeyID> vaddr;
 	CAccountViewCache view(*g_pAccountViewTip, true);
 	CScriptDBViewCache scriptDB(*g_pScriptDBTip, true);
 	if (!pTx->GetAddress(vaddr, view, scriptDB)) {
 		return false;
 	}
+	bool bMine = false;
 	for (auto &keyid : vaddr) {
 		if (HaveKey(keyid) > 0) {
-			return true;
+			setKeyId.insert(keyid);
+			bMine = true;
 		}
 	}
-	return false;
+	return bMine;
 }
 
 bool CWallet::CleanAll() {
+	FlushWriteBatch();
 
 	for_each(m_mapUnConfirmTx.begin(), m_mapUnConfirmTx.end(),
 			[&](std::map<uint256, std::shared_ptr<CBaseTransaction> >::reference a) {
@@ -756,6 +916,12 @@ bool CWallet::CleanAll() {
 			CWalletDB(m_strWalletFile).EraseKeyStoreValue(item.first);
 		});
 		mapKeys.clear();
+		LOCK(m_cs_balance);
+		m_mapConfirmedBalance.clear();
+		m_mapUnConfirmedBalance.clear();
+		m_setMemPoolDirtyKeys.clear();
+		m_llConfirmedBalance = 0;
+		m_llUnConfirmedBalance = 0;
 	} else {
 		return ERRORMSG("wallet encrypt forbid clear data failed!");
 	}
@@ -820,8 +986,16 @@ bool CWallet::AddKey(const CKeyID &KeyId, const CKeyCombi& keyCombi) {
 	if (!CWalletDB(m_strWalletFile).WriteKeyStoreValue(KeyId, keyCombi, m_nWalletVersion)) {
 		return false;
 	}
-
-	return CCryptoKeyStore::AddKeyCombi(KeyId, keyCombi);
+	if (!CCryptoKeyStore::AddKeyCombi(KeyId, keyCombi)) {
+		return false;
+	}
+	if (g_pAccountViewTip) {
+		LOCK(g_cs_main);
+		set<CKeyID> setKeyId;
+		setKeyId.insert(KeyId);
+		UpdateBalance(setKeyId);
+	}
+	return true;
 }
 
 bool CWallet::AddKey(const CKey& key) {
@@ -866,6 +1040,13 @@ void CWallet::SetNull() {
 	m_bFileBacked = false;
 	m_unMasterKeyMaxID = 0;
 	m_pWalletdbEncryption = NULL;
+	m_bWriteBehind = false;
+	m_llLastBlockSyncTime = 0;
+	m_llTotalBlockSyncTime = 0;
+	m_llLastBlockWriteTime = 0;
+	m_ullSyncBlockCount = 0;
+	m_llConfirmedBalance = 0;
+	m_llUnConfirmedBalance = 0;
 }
 
 bool CWallet::LoadMinVersion(int nVersion) {
@@ -15,6 +15,7 @@
 #include "walletdb.h"
 
 #include <algorithm>
+#include <deque>
 #include <map>
 #include <set>
 #include <stdexcept>
@@ -34,6 +35,7 @@ enum emWalletFeature {
 static const int nHighTransactionFeeWarning = 0.01 * COIN;
 
 class CAccountingEntry;
+class CWalletWriteBatch;
 
 /** A CWallet is an extension of a keystore, which also maintains a set of transactions and balances,
  * and provides the ability to create new transactions.
@@ -62,7 +64,14 @@ class CWallet : public CCryptoKeyStore, public CWalletInterface {
 		}
 	)
 	virtual ~CWallet() {};
+	//balance queries are answered from the balance index and take neither g_cs_main nor m_cs_wallet
 	int64_t GetRawBalance(bool bIsConfirmed=true) const;
+	int64_t GetRawBalance(const CKeyID &keyId, bool bIsConfirmed=true) const;
+	//recompute the indexed balance of the keys from the tip and mempool views, g_cs_main must be held
+	void UpdateBalance(const set<CKeyID> &setKeyId);
+	void RebuildBalanceIndex();
+	//called after the mempool has been rescanned or cleared
+	void UpdatedMemPool();
 
     bool Sign(const CKeyID &keyID, const uint256 &hash, vector<unsigned char> &vchSignature, bool bIsMiner=false) const;
     //! Adds an encrypted key to the store, and saves it to disk.
@@ -86,12 +95,20 @@ class CWallet : public CCryptoKeyStore, public CWalletInterface {
 	bool LoadMinVersion(int nVersion);
 
 	void SyncTransaction(const uint256 &hash, CBaseTransaction *pTx, const CBlock* pblock);
+	//queue wallet db mutations, they are committed by ThreadWalletWriter in one db transaction
+	void QueueWriteBatch(const std::shared_ptr<CWalletWriteBatch> &pBatch);
+	//commit all queued write batches to disk, return false if any batch failed
+	bool FlushWriteBatch();
+	bool WriteBatchToDisk(const CWalletWriteBatch &cBatch);
+	void SetWriteBehind(bool bWriteBehind);
+	size_t GetPendingWriteBatchSize() const;
 	void EraseFromWallet(const uint256 &hash);
 	int ScanForWalletTransactions(CBlockIndex* pindexStart, bool bUpdate = false);
 	//	void ReacceptWalletTransactions();
 	void ResendWalletTransactions();
 
 	bool IsMine(CBaseTransaction*pTx) const;
+	bool GetMyKeys(CBaseTransaction*pTx, set<CKeyID> &setKeyId) const;
 
 	void SetBestChain(const ST_BlockLocator& loc);
 
@@ -146,6 +163,12 @@ public:
 	MapMasterKeyMap m_mapMasterKeys;
 	unsigned int m_unMasterKeyMaxID;
 
+	//per-block wallet sync statistics, in microseconds
+	int64_t m_llLastBlockSyncTime;
+	int64_t m_llTotalBlockSyncTime;
+	int64_t m_llLastBlockWriteTime;
+	uint64_t m_ullSyncBlockCount;
+
 	static string m_stadefaultFilename;    //ĬǮļ  wallet.dat
 
  private:
@@ -153,6 +176,20 @@ public:
 
 	CWalletDB *m_pWalletdbEncryption;
 
+	bool m_bWriteBehind;
+	mutable CCriticalSection m_cs_writeQueue;
+	CCriticalSection m_cs_writeDisk;
+	deque<std::shared_ptr<CWalletWriteBatch> > m_dequeWriteBatch;
+
+	void SetBalance(const CKeyID &keyId, int64_t llConfirmed, int64_t llUnConfirmed);
+
+	mutable CCriticalSection m_cs_balance;
+	map<CKeyID, int64_t> m_mapConfirmedBalance;
+	map<CKeyID, int64_t> m_mapUnConfirmedBalance;	//only keys whose mempool balance differs from the tip
+	set<CKeyID> m_setMemPoolDirtyKeys;				//keys touched by a block, mempool balance pending rescan
+	int64_t m_llConfirmedBalance;
+	int64_t m_llUnConfirmedBalance;
+
 	static bool StartUp(string &strWalletFile);
 	uint256 GetCheckSum() const;
 
@@ -410,4 +447,34 @@ class CAccountTx {
 	CWallet* m_pWallet;
 };
 
+/** Wallet database mutations generated while syncing one block, written in a single db transaction */
+class CWalletWriteBatch {
+ public:
+	map<uint256, CAccountTx> m_mapWriteBlockTx;
+	set<uint256> m_setEraseBlockTx;
+	map<uint256, std::shared_ptr<CBaseTransaction> > m_mapWriteUnConfirmTx;
+	set<uint256> m_setEraseUnConfirmTx;
+
+	void WriteBlockTx(const uint256 &hash, const CAccountTx &cAccountTx) {
+		m_setEraseBlockTx.erase(hash);
+		m_mapWriteBlockTx[hash] = cAccountTx;
+	}
+	void EraseBlockTx(const uint256 &hash) {
+		m_mapWriteBlockTx.erase(hash);
+		m_setEraseBlockTx.insert(hash);
+	}
+	void WriteUnConfirmTx(const uint256 &hash, const std::shared_ptr<CBaseTransaction> &pTx) {
+		m_setEraseUnConfirmTx.erase(hash);
+		m_mapWriteUnConfirmTx[hash] = pTx;
+	}
+	void EraseUnConfirmTx(const uint256 &hash) {
+		m_mapWriteUnConfirmTx.erase(hash);
+		m_setEraseUnConfirmTx.insert(hash);
+	}
+	bool IsEmpty() const {
+		return m_mapWriteBlockTx.empty() && m_setEraseBlockTx.empty() && m_mapWriteUnConfirmTx.empty()
+				&& m_setEraseUnConfirmTx.empty();
+	}
+};
+
 #endif
@@ -435,6 +435,20 @@ void ThreadRelayTx(CWallet* pWallet) {
 	}
 }
 
+void ThreadWalletWriter(CWallet* pWallet) {
+	RenameThread("wallet-writer");
+	pWallet->SetWriteBehind(true);
+	try {
+		while (true) {
+			pWallet->FlushWriteBatch();
+			MilliSleep(10);
+		}
+	} catch (boost::thread_interrupted&) {
+		pWallet->SetWriteBehind(false);
+		throw;
+	}
+}
+
 bool BackupWallet(const CWallet& wallet, const string& strDest) {
     while (true) {
         {
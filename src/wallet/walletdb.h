@@ -106,4 +106,6 @@ bool BackupWallet(const CWallet& wallet, const string& strDest);
 extern void ThreadFlushWalletDB(const string& kstrWalletFile);
 
 extern void ThreadRelayTx(CWallet* pWallet);
+
+extern void ThreadWalletWriter(CWallet* pWallet);
 #endif // DACRS_WALLET_WALLETDB_H